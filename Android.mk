@@ -31,6 +31,7 @@ LOCAL_SRC_FILES := \
 	$(wildcard ${LOCAL_PATH}/src/modules/audio/*.cpp) \
  	$(wildcard ${LOCAL_PATH}/src/modules/audio/null/*.cpp) \
  	$(wildcard ${LOCAL_PATH}/src/modules/audio/openal/*.cpp) \
+ 	$(wildcard ${LOCAL_PATH}/src/modules/audio/software/*.cpp) \
  	$(wildcard ${LOCAL_PATH}/src/modules/data/*.cpp) \
 	$(wildcard ${LOCAL_PATH}/src/modules/event/*.cpp) \
  	$(wildcard ${LOCAL_PATH}/src/modules/event/sdl/*.cpp) \
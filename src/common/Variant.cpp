@@ -18,7 +18,10 @@
  * 3. This notice may not be removed or altered from any source distribution.
  **/
 
+#include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <math.h>
 
 #include "Variant.h"
 #include "common/StringMap.h"
@@ -41,6 +44,273 @@ static Proxy *tryextractproxy(lua_State *L, int idx)
 	return nullptr;
 }
 
+namespace
+{
+
+// Value types in the serialized table format.
+enum TableTag : uint8
+{
+	TABLETAG_NIL,
+	TABLETAG_FALSE,
+	TABLETAG_TRUE,
+	TABLETAG_NUMBER,
+	TABLETAG_STRING,
+	TABLETAG_LUSERDATA,
+	TABLETAG_LOVEOBJECT,
+	TABLETAG_TABLE,
+};
+
+// A table is stored as its pair count and array size (used to pre-size the
+// Lua table), followed by a tag and payload for each key and value. Strings
+// are an offset into the string section and a length, objects an index into
+// the objects list.
+class TableWriter
+{
+public:
+
+	TableWriter(Variant::SharedTable *table)
+		: table(table)
+	{
+	}
+
+	bool writeTable(lua_State *L, int idx)
+	{
+		const void *tablepointer = lua_topointer(L, idx);
+		if (std::find(tableStack.begin(), tableStack.end(), tablepointer) != tableStack.end())
+			throw love::Exception("Cycle detected in table");
+
+		tableStack.push_back(tablepointer);
+		luaL_checkstack(L, 2, "table is too deeply nested");
+
+		size_t headerpos = table->data.size();
+		write<uint32>(0);
+		write<uint32>(0);
+
+		uint32 count = 0;
+		uint32 arraycount = 0;
+
+		lua_pushnil(L);
+
+		while (lua_next(L, idx))
+		{
+			if (!writeValue(L, -2) || !writeValue(L, -1))
+			{
+				lua_pop(L, 2);
+				return false;
+			}
+
+			if (lua_type(L, -2) == LUA_TNUMBER)
+			{
+				lua_Number n = lua_tonumber(L, -2);
+				if (n >= 1 && n == floor(n))
+					arraycount++;
+			}
+
+			count++;
+			lua_pop(L, 1);
+		}
+
+		memcpy(&table->data[headerpos], &count, sizeof(uint32));
+		memcpy(&table->data[headerpos + sizeof(uint32)], &arraycount, sizeof(uint32));
+
+		tableStack.pop_back();
+		return true;
+	}
+
+	void finish()
+	{
+		table->stringsOffset = table->data.size();
+		table->data.insert(table->data.end(), strings.begin(), strings.end());
+	}
+
+private:
+
+	template <typename T>
+	void write(const T &v)
+	{
+		size_t pos = table->data.size();
+		table->data.resize(pos + sizeof(T));
+		memcpy(&table->data[pos], &v, sizeof(T));
+	}
+
+	void writeString(const char *str, size_t len)
+	{
+		uint32 offset = 0;
+
+		if (len <= Variant::MAX_SMALL_STRING_LENGTH)
+		{
+			auto result = internedStrings.emplace(std::string(str, len), (uint32) strings.size());
+			offset = result.first->second;
+			if (result.second)
+				strings.insert(strings.end(), str, str + len);
+		}
+		else
+		{
+			offset = (uint32) strings.size();
+			strings.insert(strings.end(), str, str + len);
+		}
+
+		write<uint8>(TABLETAG_STRING);
+		write<uint32>(offset);
+		write<uint32>((uint32) len);
+	}
+
+	bool writeValue(lua_State *L, int idx)
+	{
+		if (idx < 0)
+			idx += lua_gettop(L) + 1;
+
+		switch (lua_type(L, idx))
+		{
+		case LUA_TNIL:
+			write<uint8>(TABLETAG_NIL);
+			return true;
+		case LUA_TBOOLEAN:
+			write<uint8>(lua_toboolean(L, idx) ? TABLETAG_TRUE : TABLETAG_FALSE);
+			return true;
+		case LUA_TNUMBER:
+			write<uint8>(TABLETAG_NUMBER);
+			write<double>(lua_tonumber(L, idx));
+			return true;
+		case LUA_TSTRING:
+			{
+				size_t len = 0;
+				const char *str = lua_tolstring(L, idx, &len);
+				writeString(str, len);
+			}
+			return true;
+		case LUA_TLIGHTUSERDATA:
+			write<uint8>(TABLETAG_LUSERDATA);
+			write<void *>(lua_touserdata(L, idx));
+			return true;
+		case LUA_TUSERDATA:
+			{
+				Proxy *p = tryextractproxy(L, idx);
+				if (p == nullptr)
+					return false;
+
+				if (p->object != nullptr)
+					p->object->retain();
+
+				write<uint8>(TABLETAG_LOVEOBJECT);
+				write<uint32>((uint32) table->objects.size());
+				table->objects.push_back(*p);
+			}
+			return true;
+		case LUA_TTABLE:
+			write<uint8>(TABLETAG_TABLE);
+			return writeTable(L, idx);
+		default:
+			return false;
+		}
+	}
+
+	Variant::SharedTable *table;
+
+	std::vector<uint8> strings;
+	std::unordered_map<std::string, uint32> internedStrings;
+
+	std::vector<const void *> tableStack;
+
+}; // TableWriter
+
+class TableReader
+{
+public:
+
+	TableReader(const Variant::SharedTable *table)
+		: data(table->data.data())
+		, strings(table->data.data() + table->stringsOffset)
+		, objects(table->objects.data())
+		, pos(0)
+	{
+	}
+
+	void pushTable(lua_State *L)
+	{
+		luaL_checkstack(L, 3, "table is too deeply nested");
+
+		uint32 count = read<uint32>();
+		uint32 arraycount = read<uint32>();
+
+		lua_createtable(L, (int) arraycount, (int) (count - arraycount));
+
+		for (uint32 i = 0; i < count; i++)
+		{
+			pushValue(L);
+			pushValue(L);
+			lua_rawset(L, -3);
+		}
+	}
+
+private:
+
+	template <typename T>
+	T read()
+	{
+		T v;
+		memcpy(&v, data + pos, sizeof(T));
+		pos += sizeof(T);
+		return v;
+	}
+
+	void pushValue(lua_State *L)
+	{
+		switch (read<uint8>())
+		{
+		case TABLETAG_FALSE:
+			lua_pushboolean(L, 0);
+			break;
+		case TABLETAG_TRUE:
+			lua_pushboolean(L, 1);
+			break;
+		case TABLETAG_NUMBER:
+			lua_pushnumber(L, read<double>());
+			break;
+		case TABLETAG_STRING:
+			{
+				uint32 offset = read<uint32>();
+				uint32 len = read<uint32>();
+				lua_pushlstring(L, (const char *) strings + offset, len);
+			}
+			break;
+		case TABLETAG_LUSERDATA:
+			lua_pushlightuserdata(L, read<void *>());
+			break;
+		case TABLETAG_LOVEOBJECT:
+			{
+				const Proxy &p = objects[read<uint32>()];
+				luax_pushtype(L, *p.type, p.object);
+			}
+			break;
+		case TABLETAG_TABLE:
+			pushTable(L);
+			break;
+		case TABLETAG_NIL:
+		default:
+			lua_pushnil(L);
+			break;
+		}
+	}
+
+	const uint8 *data;
+	const uint8 *strings;
+	const Proxy *objects;
+	size_t pos;
+
+}; // TableReader
+
+} // anonymous namespace
+
+Variant::SharedTable::~SharedTable()
+{
+	for (const Proxy &p : objects)
+	{
+		if (p.object != nullptr)
+			p.object->release();
+	}
+}
+
 Variant::Variant()
 	: type(NIL)
 {
@@ -94,13 +364,6 @@ Variant::Variant(love::Type *lovetype, love::Object *object)
 		data.objectproxy.object->retain();
 }
 
-// Variant gets ownership of the vector.
-Variant::Variant(std::vector<std::pair<Variant, Variant>> *table)
-	: type(TABLE)
-{
-	data.table = new SharedTable(table);
-}
-
 Variant::Variant(const Variant &v)
 	: type(v.type)
 	, data(v.data)
@@ -152,7 +415,7 @@ Variant &Variant::operator = (const Variant &v)
 	return *this;
 }
 
-Variant Variant::fromLua(lua_State *L, int n, std::set<const void*> *tableSet)
+Variant Variant::fromLua(lua_State *L, int n)
 {
 	size_t len;
 	const char *str;
@@ -185,49 +448,19 @@ Variant Variant::fromLua(lua_State *L, int n, std::set<const void*> *tableSet)
 		return Variant();
 	case LUA_TTABLE:
 		{
-			bool success = true;
-			std::set<const void *> topTableSet;
-			std::vector<std::pair<Variant, Variant>> *table = new std::vector<std::pair<Variant, Variant>>();
+			StrongRef<SharedTable> table(new SharedTable(), Acquire::NORETAIN);
 
-			// We can use a pointer to a stack-allocated variable because it's
-			// never used after the stack-allocated variable is destroyed.
-			if (tableSet == nullptr)
-				tableSet = &topTableSet;
-
-			// Now make sure this table wasn't already serialised
-			const void *tablePointer = lua_topointer(L, n);
+			TableWriter writer(table);
+			if (writer.writeTable(L, n))
 			{
-				auto result = tableSet->insert(tablePointer);
-				if (!result.second) // insertion failed
-					throw love::Exception("Cycle detected in table");
-			}
+				writer.finish();
 
-			size_t len = luax_objlen(L, -1);
-			if (len > 0)
-				table->reserve(len);
-
-			lua_pushnil(L);
-
-			while (lua_next(L, n))
-			{
-				table->emplace_back(fromLua(L, -2, tableSet), fromLua(L, -1, tableSet));
-				lua_pop(L, 1);
-
-				const auto &p = table->back();
-				if (p.first.getType() == UNKNOWN || p.second.getType() == UNKNOWN)
-				{
-					success = false;
-					break;
-				}
+				Variant v;
+				v.type = TABLE;
+				v.data.table = table;
+				v.data.table->retain();
+				return v;
 			}
-
-			// And remove the table from the set again
-			tableSet->erase(tablePointer);
-
-			if (success)
-				return Variant(table);
-			else
-				delete table;
 		}
 		break;
 	}
@@ -261,19 +494,8 @@ void Variant::toLua(lua_State *L) const
 		break;
 	case TABLE:
 	{
-		std::vector<std::pair<Variant, Variant>> *table = data.table->table;
-		int tsize = (int) table->size();
-
-		lua_createtable(L, 0, tsize);
-
-		for (int i = 0; i < tsize; ++i)
-		{
-			std::pair<Variant, Variant> &kv = (*table)[i];
-			kv.first.toLua(L);
-			kv.second.toLua(L);
-			lua_settable(L, -3);
-		}
-
+		TableReader reader(data.table);
+		reader.pushTable(L);
 		break;
 	}
 	case NIL:
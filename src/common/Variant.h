@@ -28,7 +28,6 @@
 #include <cstring>
 #include <string>
 #include <vector>
-#include <set>
 
 namespace love
 {
@@ -69,18 +68,23 @@ class Variant
 		size_t len;
 	};
 
+	/**
+	 * A Lua table serialized into a single buffer. Nested tables are stored
+	 * inline, and strings are stored after the table data and referred to by
+	 * offset, with short strings stored only once.
+	 **/
 	class SharedTable : public love::Object
 	{
 	public:
 
-		SharedTable(std::vector<std::pair<Variant, Variant>> *table)
-			: table(table)
-		{
-		}
+		SharedTable() : stringsOffset(0) {}
+		virtual ~SharedTable();
 
-		virtual ~SharedTable() { delete table; }
+		std::vector<uint8> data;
+		size_t stringsOffset;
 
-		std::vector<std::pair<Variant, Variant>> *table;
+		// Retained by the table.
+		std::vector<Proxy> objects;
 	};
 
 	union Data
@@ -105,7 +109,6 @@ class Variant
 	Variant(const std::string &str);
 	Variant(void *lightuserdata);
 	Variant(love::Type *type, love::Object *object);
-	Variant(std::vector<std::pair<Variant, Variant>> *table);
 	Variant(const Variant &v);
 	Variant(Variant &&v);
 	~Variant();
@@ -115,7 +118,7 @@ class Variant
 	Type getType() const { return type; }
 	const Data &getData() const { return data; }
 
-	static Variant fromLua(lua_State *L, int n, std::set<const void*> *tableSet = nullptr);
+	static Variant fromLua(lua_State *L, int n);
 	void toLua(lua_State *L) const;
 
 private:
@@ -161,7 +161,49 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 void b2Contact::Update(b2ContactListener* listener)
 {
 	b2Manifold oldManifold = m_manifold;
+	UpdateManifold(oldManifold);
+	ApplyManifold(listener, oldManifold);
+}
+
+void b2Contact::UpdateManifold(const b2Manifold& oldManifold)
+{
+	// Sensors don't generate manifolds, their overlap test is done in
+	// ApplyManifold because b2Distance keeps global statistics.
+	if (m_fixtureA->IsSensor() || m_fixtureB->IsSensor())
+	{
+		return;
+	}
+
+	const b2Transform& xfA = m_fixtureA->GetBody()->GetTransform();
+	const b2Transform& xfB = m_fixtureB->GetBody()->GetTransform();
+
+	Evaluate(&m_manifold, xfA, xfB);
+
+	// Match old contact ids to new contact ids and copy the
+	// stored impulses to warm start the solver.
+	for (int32 i = 0; i < m_manifold.pointCount; ++i)
+	{
+		b2ManifoldPoint* mp2 = m_manifold.points + i;
+		mp2->normalImpulse = 0.0f;
+		mp2->tangentImpulse = 0.0f;
+		b2ContactID id2 = mp2->id;
+
+		for (int32 j = 0; j < oldManifold.pointCount; ++j)
+		{
+			const b2ManifoldPoint* mp1 = oldManifold.points + j;
+
+			if (mp1->id.key == id2.key)
+			{
+				mp2->normalImpulse = mp1->normalImpulse;
+				mp2->tangentImpulse = mp1->tangentImpulse;
+				break;
+			}
+		}
+	}
+}
 
+void b2Contact::ApplyManifold(b2ContactListener* listener, const b2Manifold& oldManifold)
+{
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
 
@@ -174,46 +216,21 @@ void b2Contact::Update(b2ContactListener* listener)
 
 	b2Body* bodyA = m_fixtureA->GetBody();
 	b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Transform& xfA = bodyA->GetTransform();
-	const b2Transform& xfB = bodyB->GetTransform();
 
 	// Is this contact a sensor?
 	if (sensor)
 	{
 		const b2Shape* shapeA = m_fixtureA->GetShape();
 		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, bodyA->GetTransform(), bodyB->GetTransform());
 
 		// Sensors don't generate manifolds.
 		m_manifold.pointCount = 0;
 	}
 	else
 	{
-		Evaluate(&m_manifold, xfA, xfB);
 		touching = m_manifold.pointCount > 0;
 
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (int32 i = 0; i < m_manifold.pointCount; ++i)
-		{
-			b2ManifoldPoint* mp2 = m_manifold.points + i;
-			mp2->normalImpulse = 0.0f;
-			mp2->tangentImpulse = 0.0f;
-			b2ContactID id2 = mp2->id;
-
-			for (int32 j = 0; j < oldManifold.pointCount; ++j)
-			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
-
-				if (mp1->id.key == id2.key)
-				{
-					mp2->normalImpulse = mp1->normalImpulse;
-					mp2->tangentImpulse = mp1->tangentImpulse;
-					break;
-				}
-			}
-		}
-
 		if (touching != wasTouching)
 		{
 			bodyA->SetAwake(true);
@@ -150,6 +150,7 @@ class b2Contact
 	friend class b2ContactSolver;
 	friend class b2Body;
 	friend class b2Fixture;
+	friend struct b2CollideTask;
 
 	// Flags stored in m_flags
 	enum
@@ -189,6 +190,12 @@ class b2Contact
 
 	void Update(b2ContactListener* listener);
 
+	// Update split in two, so the expensive half can run on several threads.
+	// UpdateManifold only writes to this contact's manifold, ApplyManifold
+	// must be called afterwards in contact list order.
+	void UpdateManifold(const b2Manifold& oldManifold);
+	void ApplyManifold(b2ContactListener* listener, const b2Manifold& oldManifold);
+
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
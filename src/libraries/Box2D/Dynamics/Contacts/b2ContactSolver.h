@@ -64,6 +64,8 @@ struct b2ContactSolverDef
 	b2Position* positions;
 	b2Velocity* velocities;
 	b2StackAllocator* allocator;
+	const b2IslandStatic* statics;
+	int32 staticCount;
 };
 
 class b2ContactSolver
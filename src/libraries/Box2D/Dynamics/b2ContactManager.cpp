@@ -21,6 +21,7 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Common/b2StackAllocator.h>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
@@ -32,6 +33,9 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_stackAllocator = NULL;
+	m_taskRunner = NULL;
+	m_taskCount = 1;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -104,69 +108,177 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
+	if (m_taskRunner != NULL && m_taskCount > 1)
+	{
+		CollideParallel();
+		return;
+	}
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
 	{
-		b2Fixture* fixtureA = c->GetFixtureA();
-		b2Fixture* fixtureB = c->GetFixtureB();
-		int32 indexA = c->GetChildIndexA();
-		int32 indexB = c->GetChildIndexB();
-		b2Body* bodyA = fixtureA->GetBody();
-		b2Body* bodyB = fixtureB->GetBody();
-		 
-		// Is this contact flagged for filtering?
-		if (c->m_flags & b2Contact::e_filterFlag)
+		b2Contact* next = c->GetNext();
+
+		switch (GetCollideAction(c))
 		{
-			// Should these bodies collide?
-			if (bodyB->ShouldCollide(bodyA) == false)
-			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
+		case e_collideDestroy:
+			Destroy(c);
+			break;
+		case e_collideUpdate:
+			c->Update(m_contactListener);
+			break;
+		default:
+			break;
+		}
 
-			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
-			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
+		c = next;
+	}
+}
+
+b2ContactManager::CollideAction b2ContactManager::GetCollideAction(b2Contact* c)
+{
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	int32 indexA = c->GetChildIndexA();
+	int32 indexB = c->GetChildIndexB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+	 
+	// Is this contact flagged for filtering?
+	if (c->m_flags & b2Contact::e_filterFlag)
+	{
+		// Should these bodies collide?
+		if (bodyB->ShouldCollide(bodyA) == false)
+		{
+			return e_collideDestroy;
+		}
+
+		// Check user filtering.
+		if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+		{
+			return e_collideDestroy;
+		}
+
+		// Clear the filtering flag.
+		c->m_flags &= ~b2Contact::e_filterFlag;
+	}
+
+	bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+	bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+
+	// At least one body must be awake and it must be dynamic or kinematic.
+	if (activeA == false && activeB == false)
+	{
+		return e_collideSkip;
+	}
+
+	int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+	int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+	bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+	// Here we destroy contacts that cease to overlap in the broad-phase.
+	if (overlap == false)
+	{
+		return e_collideDestroy;
+	}
+
+	// The contact persists.
+	return e_collideUpdate;
+}
 
-			// Clear the filtering flag.
-			c->m_flags &= ~b2Contact::e_filterFlag;
+struct b2CollideTask : public b2Task
+{
+	void Execute(int32 index)
+	{
+		int32 begin = count * index / taskCount;
+		int32 end = count * (index + 1) / taskCount;
+		for (int32 i = begin; i < end; ++i)
+		{
+			contacts[i]->UpdateManifold(oldManifolds[i]);
 		}
+	}
 
-		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
-		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+	b2Contact** contacts;
+	b2Manifold* oldManifolds;
+	int32 count;
+	int32 taskCount;
+};
 
-		// At least one body must be awake and it must be dynamic or kinematic.
-		if (activeA == false && activeB == false)
+// Same as Collide, but the narrow phase of the contacts which are known to
+// need an update runs on the task runner. Everything that can call back into
+// user code or wake bodies still happens here, in contact list order.
+void b2ContactManager::CollideParallel()
+{
+	b2Contact** contacts = (b2Contact**)m_stackAllocator->Allocate(m_contactCount * sizeof(b2Contact*));
+	b2Manifold* oldManifolds = (b2Manifold*)m_stackAllocator->Allocate(m_contactCount * sizeof(b2Manifold));
+	int32 count = 0;
+
+	b2Contact* c = m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->GetNext();
+
+		switch (GetCollideAction(c))
 		{
-			c = c->GetNext();
-			continue;
+		case e_collideDestroy:
+			Destroy(c);
+			break;
+		case e_collideUpdate:
+			contacts[count] = c;
+			oldManifolds[count] = c->m_manifold;
+			++count;
+			break;
+		default:
+			break;
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		c = next;
+	}
+
+	if (count > 0)
+	{
+		b2CollideTask task;
+		task.contacts = contacts;
+		task.oldManifolds = oldManifolds;
+		task.count = count;
+		task.taskCount = b2Min(count, m_taskCount);
+		m_taskRunner->ParallelFor(task.taskCount, &task);
+	}
+
+	// Contacts updated above can wake bodies, which makes later contacts in
+	// the list need an update as well. Those are done here, like in Collide.
+	int32 index = 0;
+	c = m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->GetNext();
 
-		// Here we destroy contacts that cease to overlap in the broad-phase.
-		if (overlap == false)
+		if (index < count && contacts[index] == c)
 		{
-			b2Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
-			continue;
+			c->ApplyManifold(m_contactListener, oldManifolds[index]);
+			++index;
+		}
+		else
+		{
+			switch (GetCollideAction(c))
+			{
+			case e_collideDestroy:
+				Destroy(c);
+				break;
+			case e_collideUpdate:
+				c->Update(m_contactListener);
+				break;
+			default:
+				break;
+			}
 		}
 
-		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+		c = next;
 	}
+
+	m_stackAllocator->Free(oldManifolds);
+	m_stackAllocator->Free(contacts);
 }
 
 void b2ContactManager::FindNewContacts()
@@ -25,6 +25,8 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2StackAllocator;
+class b2TaskRunner;
 
 // Delegate of b2World.
 class b2ContactManager
@@ -40,6 +42,17 @@ class b2ContactManager
 	void Destroy(b2Contact* c);
 
 	void Collide();
+
+	// What Collide does with a contact.
+	enum CollideAction
+	{
+		e_collideSkip,
+		e_collideDestroy,
+		e_collideUpdate
+	};
+
+	CollideAction GetCollideAction(b2Contact* c);
+	void CollideParallel();
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -47,6 +60,9 @@ class b2ContactManager
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+	b2StackAllocator* m_stackAllocator;
+	b2TaskRunner* m_taskRunner;
+	int32 m_taskCount;
 };
 
 #endif
@@ -27,6 +27,8 @@
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Timer.h>
 
+#include <algorithm>
+
 /*
 Position Correction Notes
 =========================
@@ -162,6 +164,10 @@ b2Island::b2Island(
 	m_allocator = allocator;
 	m_listener = listener;
 
+	m_statics = NULL;
+	m_staticCount = 0;
+	m_impulses = NULL;
+
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
 	m_joints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
@@ -180,12 +186,24 @@ b2Island::~b2Island()
 	m_allocator->Free(m_bodies);
 }
 
-void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+static bool b2IslandStaticLessThan(const b2IslandStatic& a, const b2IslandStatic& b)
+{
+	return a.body < b.body;
+}
+
+bool b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
 	b2Timer timer;
 
 	float32 h = step.dt;
 
+	// Static bodies may be read by other islands at the same time.
+	bool shareStatics = m_statics != NULL;
+	if (shareStatics)
+	{
+		std::sort(m_statics, m_statics + m_staticCount, b2IslandStaticLessThan);
+	}
+
 	// Integrate velocities and apply damping. Initialize the body state.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
@@ -197,8 +215,11 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		float32 w = b->m_angularVelocity;
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		if (shareStatics == false || b->m_type != b2_staticBody)
+		{
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
 
 		if (b->m_type == b2_dynamicBody)
 		{
@@ -230,6 +251,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	solverData.step = step;
 	solverData.positions = m_positions;
 	solverData.velocities = m_velocities;
+	solverData.statics = m_statics;
+	solverData.staticCount = m_staticCount;
 
 	// Initialize velocity constraints.
 	b2ContactSolverDef contactSolverDef;
@@ -239,6 +262,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
 	contactSolverDef.allocator = m_allocator;
+	contactSolverDef.statics = m_statics;
+	contactSolverDef.staticCount = m_staticCount;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
 	contactSolver.InitializeVelocityConstraints();
@@ -330,6 +355,11 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
+		if (shareStatics && body->m_type == b2_staticBody)
+		{
+			// Static bodies don't move, their state is already up to date.
+			continue;
+		}
 		body->m_sweep.c = m_positions[i].c;
 		body->m_sweep.a = m_positions[i].a;
 		body->m_linearVelocity = m_velocities[i].v;
@@ -341,6 +371,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	Report(contactSolver.m_velocityConstraints);
 
+	bool asleep = false;
 	if (allowSleep)
 	{
 		float32 minSleepTime = b2_maxFloat;
@@ -375,10 +406,18 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			for (int32 i = 0; i < m_bodyCount; ++i)
 			{
 				b2Body* b = m_bodies[i];
+				if (shareStatics && b->m_type == b2_staticBody)
+				{
+					// The world does this once all islands are solved.
+					continue;
+				}
 				b->SetAwake(false);
 			}
+			asleep = true;
 		}
 	}
+
+	return asleep;
 }
 
 void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB)
@@ -403,6 +442,8 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	contactSolverDef.step = subStep;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.statics = NULL;
+	contactSolverDef.staticCount = 0;
 	b2ContactSolver contactSolver(&contactSolverDef);
 
 	// Solve position constraints.
@@ -515,7 +556,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_impulses == NULL)
 	{
 		return;
 	}
@@ -534,6 +575,13 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_impulses != NULL)
+		{
+			m_impulses[i] = impulse;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
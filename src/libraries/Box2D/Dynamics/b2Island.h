@@ -28,6 +28,7 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2ContactImpulse;
 struct b2Profile;
 
 /// This is an internal class.
@@ -45,14 +46,25 @@ class b2Island
 		m_jointCount = 0;
 	}
 
-	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+	/// @return true if the island was put to sleep.
+	bool Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
 	void Add(b2Body* body)
 	{
 		b2Assert(m_bodyCount < m_bodyCapacity);
-		body->m_islandIndex = m_bodyCount;
+		if (m_statics != NULL && body->m_type == b2_staticBody)
+		{
+			// Shared with other islands, see b2IslandStatic.
+			m_statics[m_staticCount].body = body;
+			m_statics[m_staticCount].index = m_bodyCount;
+			++m_staticCount;
+		}
+		else
+		{
+			body->m_islandIndex = m_bodyCount;
+		}
 		m_bodies[m_bodyCount] = body;
 		++m_bodyCount;
 	}
@@ -71,6 +83,9 @@ class b2Island
 
 	void Report(const b2ContactVelocityConstraint* constraints);
 
+	/// Get the index of a body in the island being solved.
+	static int32 GetIndex(const b2Body* body, const b2IslandStatic* statics, int32 staticCount);
+
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
@@ -88,6 +103,42 @@ class b2Island
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+
+	// Only set when islands are solved in parallel. Static bodies are then
+	// left untouched, and impulses are stored for the world to report later.
+	b2IslandStatic* m_statics;
+	int32 m_staticCount;
+	b2ContactImpulse* m_impulses;
 };
 
+inline int32 b2Island::GetIndex(const b2Body* body, const b2IslandStatic* statics, int32 staticCount)
+{
+	if (statics == NULL || body->m_type != b2_staticBody)
+	{
+		return body->m_islandIndex;
+	}
+
+	int32 low = 0;
+	int32 high = staticCount - 1;
+	while (low <= high)
+	{
+		int32 mid = (low + high) / 2;
+		if (statics[mid].body == body)
+		{
+			return statics[mid].index;
+		}
+		else if (statics[mid].body < body)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	// Not part of this island, which the sequential solver tolerates too.
+	return body->m_islandIndex;
+}
+
 #endif
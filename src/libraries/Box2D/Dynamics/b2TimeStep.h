@@ -21,6 +21,8 @@
 
 #include <Box2D/Common/b2Math.h>
 
+class b2Body;
+
 /// Profiling data. Times are in milliseconds.
 struct b2Profile
 {
@@ -59,12 +61,23 @@ struct b2Velocity
 	float32 w;
 };
 
+/// This is an internal structure. When islands are solved in parallel a static
+/// body can be part of several islands at once, so its index in each island is
+/// kept here rather than in b2Body::m_islandIndex.
+struct b2IslandStatic
+{
+	const b2Body* body;
+	int32 index;
+};
+
 /// Solver Data
 struct b2SolverData
 {
 	b2TimeStep step;
 	b2Position* positions;
 	b2Velocity* velocities;
+	const b2IslandStatic* statics;	// sorted by body, NULL if not solving in parallel
+	int32 staticCount;
 };
 
 #endif
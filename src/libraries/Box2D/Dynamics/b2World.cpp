@@ -59,6 +59,11 @@ b2World::b2World(const b2Vec2& gravity)
 	m_inv_dt0 = 0.0f;
 
 	m_contactManager.m_allocator = &m_blockAllocator;
+	m_contactManager.m_stackAllocator = &m_stackAllocator;
+
+	m_taskRunner = NULL;
+	m_taskCount = 1;
+	m_taskAllocators = NULL;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
@@ -82,6 +87,8 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	SetTaskRunner(NULL, 1);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -382,170 +389,223 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+void b2World::SetTaskRunner(b2TaskRunner* runner, int32 taskCount)
 {
-	m_profile.solveInit = 0.0f;
-	m_profile.solveVelocity = 0.0f;
-	m_profile.solvePosition = 0.0f;
-
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
-
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		return;
 	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+
+	if (m_taskAllocators != NULL)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		for (int32 i = 0; i < m_taskCount; ++i)
+		{
+			m_taskAllocators[i].~b2StackAllocator();
+		}
+		b2Free(m_taskAllocators);
+		m_taskAllocators = NULL;
 	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+
+	if (runner == NULL || taskCount < 1)
 	{
-		j->m_islandFlag = false;
+		taskCount = 1;
 	}
 
-	// Build and simulate all awake islands.
-	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	m_taskRunner = runner;
+	m_taskCount = taskCount;
+
+	if (m_taskRunner != NULL && m_taskCount > 1)
 	{
-		if (seed->m_flags & b2Body::e_islandFlag)
+		// Each task solves its islands with its own stack allocator.
+		m_taskAllocators = (b2StackAllocator*)b2Alloc(m_taskCount * sizeof(b2StackAllocator));
+		for (int32 i = 0; i < m_taskCount; ++i)
 		{
-			continue;
+			new (m_taskAllocators + i) b2StackAllocator;
 		}
+	}
 
-		if (seed->IsAwake() == false || seed->IsActive() == false)
-		{
-			continue;
-		}
+	m_contactManager.m_taskRunner = m_taskRunner;
+	m_contactManager.m_taskCount = m_taskCount;
+}
 
-		// The seed can be dynamic or kinematic.
-		if (seed->GetType() == b2_staticBody)
+// Add the bodies, contacts and joints connected to the seed to the island.
+void b2World::BuildIsland(b2Island* island, b2Body* seed, b2Body** stack, int32 stackSize)
+{
+	int32 stackCount = 0;
+	stack[stackCount++] = seed;
+	seed->m_flags |= b2Body::e_islandFlag;
+
+	// Perform a depth first search (DFS) on the constraint graph.
+	while (stackCount > 0)
+	{
+		// Grab the next body off the stack and add it to the island.
+		b2Body* b = stack[--stackCount];
+		b2Assert(b->IsActive() == true);
+		island->Add(b);
+
+		// Make sure the body is awake.
+		b->SetAwake(true);
+
+		// To keep islands as small as possible, we don't
+		// propagate islands across static bodies.
+		if (b->GetType() == b2_staticBody)
 		{
 			continue;
 		}
 
-		// Reset island and stack.
-		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
-
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+		// Search all contacts connected to this body.
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
+			b2Contact* contact = ce->contact;
 
-			// Make sure the body is awake.
-			b->SetAwake(true);
+			// Has this contact already been added to an island?
+			if (contact->m_flags & b2Contact::e_islandFlag)
+			{
+				continue;
+			}
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->GetType() == b2_staticBody)
+			// Is this contact solid and touching?
+			if (contact->IsEnabled() == false ||
+				contact->IsTouching() == false)
 			{
 				continue;
 			}
 
-			// Search all contacts connected to this body.
-			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			// Skip sensors.
+			bool sensorA = contact->m_fixtureA->m_isSensor;
+			bool sensorB = contact->m_fixtureB->m_isSensor;
+			if (sensorA || sensorB)
 			{
-				b2Contact* contact = ce->contact;
+				continue;
+			}
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
-				{
-					continue;
-				}
+			island->Add(contact);
+			contact->m_flags |= b2Contact::e_islandFlag;
 
-				// Is this contact solid and touching?
-				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
-				{
-					continue;
-				}
+			b2Body* other = ce->other;
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
+			// Was the other body already added to this island?
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
 
-				b2Body* other = ce->other;
+		// Search all joints connect to this body.
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			if (je->joint->m_islandFlag == true)
+			{
+				continue;
+			}
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+			b2Body* other = je->other;
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+			// Don't simulate joints connected to inactive bodies.
+			if (other->IsActive() == false)
+			{
+				continue;
 			}
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			island->Add(je->joint);
+			je->joint->m_islandFlag = true;
+
+			if (other->m_flags & b2Body::e_islandFlag)
 			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
+				continue;
+			}
 
-				b2Body* other = je->other;
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
+	}
+}
 
-				// Don't simulate joints connected to inactive bodies.
-				if (other->IsActive() == false)
-				{
-					continue;
-				}
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
 
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
 
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+	if (m_taskRunner != NULL && m_taskCount > 1)
+	{
+		SolveParallel(step);
+	}
+	else
+	{
+		// Size the island for the worst case.
+		b2Island island(m_bodyCount,
+						m_contactManager.m_contactCount,
+						m_jointCount,
+						&m_stackAllocator,
+						m_contactManager.m_contactListener);
+
+		// Build and simulate all awake islands.
+		int32 stackSize = m_bodyCount;
+		b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+		for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+		{
+			if (seed->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+			if (seed->IsAwake() == false || seed->IsActive() == false)
+			{
+				continue;
 			}
-		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+			// The seed can be dynamic or kinematic.
+			if (seed->GetType() == b2_staticBody)
+			{
+				continue;
+			}
 
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
-		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->GetType() == b2_staticBody)
+			// Reset island and stack.
+			island.Clear();
+			BuildIsland(&island, seed, stack, stackSize);
+
+			b2Profile profile;
+			island.Solve(&profile, step, m_gravity, m_allowSleep);
+			m_profile.solveInit += profile.solveInit;
+			m_profile.solveVelocity += profile.solveVelocity;
+			m_profile.solvePosition += profile.solvePosition;
+
+			// Post solve cleanup.
+			for (int32 i = 0; i < island.m_bodyCount; ++i)
 			{
-				b->m_flags &= ~b2Body::e_islandFlag;
+				// Allow static bodies to participate in other islands.
+				b2Body* b = island.m_bodies[i];
+				if (b->GetType() == b2_staticBody)
+				{
+					b->m_flags &= ~b2Body::e_islandFlag;
+				}
 			}
 		}
-	}
 
-	m_stackAllocator.Free(stack);
+		m_stackAllocator.Free(stack);
+	}
 
 	{
 		b2Timer timer;
@@ -573,6 +633,213 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
+// An island found by SolveParallel. The ranges index into the arrays of a
+// b2Island that holds every island of the step.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+	bool asleep;
+};
+
+struct b2SolveTask : public b2Task
+{
+	void Execute(int32 index)
+	{
+		b2StackAllocator* allocator = allocators + index;
+		b2Profile* profile = profiles + index;
+		profile->solveInit = 0.0f;
+		profile->solveVelocity = 0.0f;
+		profile->solvePosition = 0.0f;
+
+		for (int32 i = taskStarts[index]; i < taskStarts[index + 1]; ++i)
+		{
+			b2IslandRange* range = ranges + i;
+
+			b2Island island(range->bodyCount, range->contactCount, range->jointCount, allocator, NULL);
+			island.m_statics = (b2IslandStatic*)allocator->Allocate(range->bodyCount * sizeof(b2IslandStatic));
+			island.m_impulses = impulses + range->contactStart;
+
+			for (int32 j = 0; j < range->bodyCount; ++j)
+			{
+				island.Add(all->m_bodies[range->bodyStart + j]);
+			}
+			for (int32 j = 0; j < range->contactCount; ++j)
+			{
+				island.Add(all->m_contacts[range->contactStart + j]);
+			}
+			for (int32 j = 0; j < range->jointCount; ++j)
+			{
+				island.Add(all->m_joints[range->jointStart + j]);
+			}
+
+			b2Profile islandProfile;
+			range->asleep = island.Solve(&islandProfile, *step, gravity, allowSleep);
+			profile->solveInit += islandProfile.solveInit;
+			profile->solveVelocity += islandProfile.solveVelocity;
+			profile->solvePosition += islandProfile.solvePosition;
+
+			allocator->Free(island.m_statics);
+		}
+	}
+
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	const b2Island* all;
+	b2IslandRange* ranges;
+	const int32* taskStarts;
+	b2ContactImpulse* impulses;
+	b2StackAllocator* allocators;
+	b2Profile* profiles;
+};
+
+// Same as the island loop in Solve, except that all islands are found first
+// and then solved on the task runner. Islands never share a dynamic or
+// kinematic body, contact or joint, so they can be solved concurrently. The
+// results don't depend on how the islands are split up among the tasks.
+void b2World::SolveParallel(const b2TimeStep& step)
+{
+	// Static bodies can show up in more than one island, once per contact
+	// or joint at most.
+	int32 contactCount = m_contactManager.m_contactCount;
+	b2Island all(m_bodyCount + contactCount + m_jointCount,
+				 contactCount,
+				 m_jointCount,
+				 &m_stackAllocator,
+				 NULL);
+
+	// Every island has at least one body which isn't static.
+	b2IslandRange* ranges = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	int32 islandCount = 0;
+
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2IslandRange* range = ranges + islandCount++;
+		range->bodyStart = all.m_bodyCount;
+		range->contactStart = all.m_contactCount;
+		range->jointStart = all.m_jointCount;
+
+		BuildIsland(&all, seed, stack, stackSize);
+
+		range->bodyCount = all.m_bodyCount - range->bodyStart;
+		range->contactCount = all.m_contactCount - range->contactStart;
+		range->jointCount = all.m_jointCount - range->jointStart;
+		range->asleep = false;
+
+		// Allow static bodies to participate in other islands.
+		for (int32 i = range->bodyStart; i < all.m_bodyCount; ++i)
+		{
+			b2Body* b = all.m_bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->m_flags &= ~b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	m_stackAllocator.Free(stack);
+
+	// Split the islands into runs of roughly the same amount of work.
+	int32 taskCount = b2Min(m_taskCount, islandCount);
+	int32* taskStarts = (int32*)m_stackAllocator.Allocate((taskCount + 1) * sizeof(int32));
+	{
+		int32 totalWork = all.m_bodyCount + all.m_contactCount + all.m_jointCount;
+		int32 work = 0;
+		int32 task = 1;
+		taskStarts[0] = 0;
+		for (int32 i = 0; i < islandCount && task < taskCount; ++i)
+		{
+			work += ranges[i].bodyCount + ranges[i].contactCount + ranges[i].jointCount;
+			if ((float32)work * taskCount >= (float32)totalWork * task)
+			{
+				taskStarts[task++] = i + 1;
+			}
+		}
+		while (task <= taskCount)
+		{
+			taskStarts[task++] = islandCount;
+		}
+	}
+
+	b2ContactImpulse* impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(contactCount * sizeof(b2ContactImpulse));
+	b2Profile* profiles = (b2Profile*)m_stackAllocator.Allocate(taskCount * sizeof(b2Profile));
+
+	if (taskCount > 0)
+	{
+		b2SolveTask task;
+		task.step = &step;
+		task.gravity = m_gravity;
+		task.allowSleep = m_allowSleep;
+		task.all = &all;
+		task.ranges = ranges;
+		task.taskStarts = taskStarts;
+		task.impulses = impulses;
+		task.allocators = m_taskAllocators;
+		task.profiles = profiles;
+		m_taskRunner->ParallelFor(taskCount, &task);
+	}
+
+	for (int32 i = 0; i < taskCount; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+	}
+
+	// Finish up in island order on this thread: report the impulses and let
+	// the island solved last decide whether a static body is asleep.
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* range = ranges + i;
+
+		if (listener != NULL)
+		{
+			for (int32 j = range->contactStart; j < range->contactStart + range->contactCount; ++j)
+			{
+				listener->PostSolve(all.m_contacts[j], impulses + j);
+			}
+		}
+
+		for (int32 j = range->bodyStart; j < range->bodyStart + range->bodyCount; ++j)
+		{
+			b2Body* b = all.m_bodies[j];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->SetAwake(range->asleep == false);
+			}
+		}
+	}
+
+	m_stackAllocator.Free(profiles);
+	m_stackAllocator.Free(impulses);
+	m_stackAllocator.Free(taskStarts);
+	m_stackAllocator.Free(ranges);
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
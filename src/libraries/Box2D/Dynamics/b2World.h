@@ -34,6 +34,7 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2Island;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -145,6 +146,14 @@ class b2World
 	void SetAllowSleeping(bool flag);
 	bool GetAllowSleeping() const { return m_allowSleep; }
 
+	/// Solve islands and update contacts on multiple threads, by splitting those
+	/// parts of the step into taskCount tasks. The results are the same for any
+	/// task count greater than one. Pass NULL to step on the calling thread only.
+	/// @warning this function is locked during callbacks.
+	void SetTaskRunner(b2TaskRunner* runner, int32 taskCount);
+	b2TaskRunner* GetTaskRunner() const { return m_taskRunner; }
+	int32 GetTaskCount() const { return m_taskCount; }
+
 	/// Enable/disable warm starting. For testing.
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
@@ -225,8 +234,11 @@ class b2World
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveParallel(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	void BuildIsland(b2Island* island, b2Body* seed, b2Body** stack, int32 stackSize);
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
@@ -261,6 +273,10 @@ class b2World
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	b2TaskRunner* m_taskRunner;
+	int32 m_taskCount;
+	b2StackAllocator* m_taskAllocators;
 };
 
 inline b2Body* b2World::GetBodyList()
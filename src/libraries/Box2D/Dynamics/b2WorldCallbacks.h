@@ -152,4 +152,26 @@ class b2RayCastCallback
 									const b2Vec2& normal, float32 fraction) = 0;
 };
 
+/// A unit of work that can be split into independent parts. See b2TaskRunner.
+class b2Task
+{
+public:
+	virtual ~b2Task() {}
+
+	/// Do part of the work. Parts never touch each other's data.
+	virtual void Execute(int32 index) = 0;
+};
+
+/// Implement this class to let the world solve islands and update contacts
+/// on multiple threads. See b2World::SetTaskRunner.
+class b2TaskRunner
+{
+public:
+	virtual ~b2TaskRunner() {}
+
+	/// Call task->Execute(i) for every i in [0, count) and return once all
+	/// calls have finished. The calls may run concurrently and in any order.
+	virtual void ParallelFor(int32 count, b2Task* task) = 0;
+};
+
 #endif
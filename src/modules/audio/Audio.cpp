@@ -20,6 +20,13 @@
 
 #include "Audio.h"
 #include "common/config.h"
+#include "common/Exception.h"
+#include "sound/SoundData.h"
+#include "filesystem/File.h"
+
+// C++
+#include <algorithm>
+#include <cstring>
 
 #if defined(LOVE_IOS)
 #include "common/ios.h"
@@ -68,6 +75,209 @@ void showRecordingPermissionMissingDialog()
 #endif
 }
 
+static std::string requestedBackend;
+
+void setRequestedBackend(const std::string &backend)
+{
+	requestedBackend = backend;
+}
+
+const std::string &getRequestedBackend()
+{
+	return requestedBackend;
+}
+
+Audio::Audio()
+	: cacheMemory(0)
+	, cacheMemoryBudget(0)
+	, cacheHits(0)
+	, cacheMisses(0)
+	, cacheEvictions(0)
+{
+}
+
+Source *Audio::newCachedSource(const std::string &key)
+{
+	StrongRef<Object> data;
+
+	{
+		love::thread::Lock lock(cacheMutex);
+
+		auto it = cache.find(key);
+		if (it == cache.end())
+		{
+			cacheMisses++;
+			return nullptr;
+		}
+
+		cacheHits++;
+		cacheLRU.splice(cacheLRU.begin(), cacheLRU, it->second.lruPosition);
+		data = it->second.data;
+	}
+
+	return newSharedSource(nullptr, data);
+}
+
+Source *Audio::newCachedSource(const std::string &key, love::sound::SoundData *soundData)
+{
+	StrongRef<Object> data;
+	Source *source = newSharedSource(soundData, data);
+
+	int64 size = (int64) soundData->getSize();
+
+	love::thread::Lock lock(cacheMutex);
+
+	if (size > cacheMemoryBudget || cache.find(key) != cache.end())
+		return source;
+
+	evictCache(cacheMemoryBudget - size);
+
+	cacheLRU.push_front(key);
+
+	CacheEntry &entry = cache[key];
+	entry.data = data;
+	entry.size = size;
+	entry.lruPosition = cacheLRU.begin();
+
+	cacheMemory += size;
+
+	return source;
+}
+
+void Audio::setCacheMemoryBudget(int64 bytes)
+{
+	love::thread::Lock lock(cacheMutex);
+	cacheMemoryBudget = std::max(bytes, (int64) 0);
+	evictCache(cacheMemoryBudget);
+}
+
+int64 Audio::getCacheMemoryBudget() const
+{
+	return cacheMemoryBudget;
+}
+
+void Audio::clearCache()
+{
+	love::thread::Lock lock(cacheMutex);
+	cache.clear();
+	cacheLRU.clear();
+	cacheMemory = 0;
+}
+
+Audio::CacheStats Audio::getCacheStats() const
+{
+	love::thread::Lock lock(cacheMutex);
+
+	CacheStats stats;
+	stats.entries = (int) cache.size();
+	stats.memory = cacheMemory;
+	stats.memoryBudget = cacheMemoryBudget;
+	stats.hits = cacheHits;
+	stats.misses = cacheMisses;
+	stats.evictions = cacheEvictions;
+
+	return stats;
+}
+
+void Audio::render(love::sound::SoundData *)
+{
+	throw love::Exception("%s can't render audio.", getName());
+}
+
+static void writeLE(uint8 *dst, uint32 value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		dst[i] = (uint8) (value >> (i * 8));
+}
+
+void Audio::renderToFile(love::filesystem::File *file, int samples, int sampleRate)
+{
+	if (samples < 0)
+		throw love::Exception("Invalid sample count: %d", samples);
+
+	if (sampleRate <= 0)
+		throw love::Exception("Invalid sample rate: %d", sampleRate);
+
+	const int channels = 2;
+	const int bitDepth = 16;
+	const int chunkSamples = 4096;
+
+	// The RIFF chunk size (36 + the data size) has to fit in 32 bits.
+	uint64 datasize = (uint64) samples * channels * (bitDepth / 8);
+	if (36 + datasize > 0xFFFFFFFF)
+		throw love::Exception("Too many samples for a WAV file: %d", samples);
+
+	uint64 byterate = (uint64) sampleRate * channels * (bitDepth / 8);
+	if (byterate > 0xFFFFFFFF)
+		throw love::Exception("Invalid sample rate: %d", sampleRate);
+
+	// Canonical 44 byte PCM WAV header.
+	uint8 header[44];
+	memcpy(header + 0, "RIFF", 4);
+	writeLE(header + 4, (uint32) (36 + datasize), 4);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	writeLE(header + 16, 16, 4);
+	writeLE(header + 20, 1, 2);
+	writeLE(header + 22, channels, 2);
+	writeLE(header + 24, sampleRate, 4);
+	writeLE(header + 28, (uint32) byterate, 4);
+	writeLE(header + 32, channels * (bitDepth / 8), 2);
+	writeLE(header + 34, bitDepth, 2);
+	memcpy(header + 36, "data", 4);
+	writeLE(header + 40, (uint32) datasize, 4);
+
+	StrongRef<love::sound::SoundData> chunk;
+	chunk.set(new love::sound::SoundData(std::min(samples, chunkSamples), sampleRate, bitDepth, channels), Acquire::NORETAIN);
+
+	if (!file->open(love::filesystem::File::MODE_WRITE))
+		throw love::Exception("Could not open file %s for writing.", file->getFilename().c_str());
+
+	try
+	{
+		file->write(header, sizeof(header));
+
+		for (int offset = 0; offset < samples; offset += chunkSamples)
+		{
+			int count = std::min(samples - offset, chunkSamples);
+			if (count != chunk->getSampleCount())
+				chunk.set(new love::sound::SoundData(count, sampleRate, bitDepth, channels), Acquire::NORETAIN);
+
+			render(chunk);
+
+#ifdef LOVE_BIG_ENDIAN
+			uint16 *data = (uint16 *) chunk->getData();
+			for (int i = 0; i < count * channels; i++)
+				data[i] = (uint16) ((data[i] << 8) | (data[i] >> 8));
+#endif
+
+			if (!file->write(chunk->getData(), (int64) chunk->getSize()))
+				throw love::Exception("Could not write to file %s.", file->getFilename().c_str());
+		}
+	}
+	catch (love::Exception &)
+	{
+		file->close();
+		throw;
+	}
+
+	file->close();
+}
+
+void Audio::evictCache(int64 bytes)
+{
+	// Must be called with the cache mutex locked.
+	while (cacheMemory > bytes && !cacheLRU.empty())
+	{
+		auto it = cache.find(cacheLRU.back());
+
+		cacheMemory -= it->second.size;
+		cacheEvictions++;
+
+		cache.erase(it);
+		cacheLRU.pop_back();
+	}
+}
+
 bool Audio::setMixWithSystem(bool mix)
 {
 #ifdef LOVE_IOS
@@ -23,10 +23,15 @@
 
 // STL
 #include <vector>
+#include <list>
+#include <string>
+#include <unordered_map>
 
 // LOVE
 #include "common/Module.h"
 #include "common/StringMap.h"
+#include "common/int.h"
+#include "thread/threads.h"
 #include "Source.h"
 #include "Effect.h"
 #include "RecordingDevice.h"
@@ -42,6 +47,13 @@ class SoundData;
 
 } // sound
 
+namespace filesystem
+{
+
+class File;
+
+} // filesystem
+
 namespace audio
 {
 
@@ -73,6 +85,17 @@ void requestRecordingPermission();
  */
 void showRecordingPermissionMissingDialog();
 
+/*
+ * Sets which backend love.audio should use when it's loaded. An empty
+ * string uses the first one that works.
+ */
+void setRequestedBackend(const std::string &backend);
+
+/*
+ * Gets the requested backend.
+ */
+const std::string &getRequestedBackend();
+
 /**
  * The Audio module is responsible for playing back raw sound samples.
  **/
@@ -99,6 +122,17 @@ class Audio : public Module
 	static bool getConstant(DistanceModel in, const char  *&out);
 	static std::vector<std::string> getConstants(DistanceModel);
 
+	struct CacheStats
+	{
+		int entries;
+		int64 memory;
+		int64 memoryBudget;
+		int64 hits;
+		int64 misses;
+		int64 evictions;
+	};
+
+	Audio();
 	virtual ~Audio() {}
 
 	// Implements Module.
@@ -108,6 +142,50 @@ class Audio : public Module
 	virtual Source *newSource(love::sound::SoundData *soundData) = 0;
 	virtual Source *newSource(int sampleRate, int bitDepth, int channels, int buffers) = 0;
 
+	/**
+	 * Creates a static Source which shares the decoded audio stored in the
+	 * cache with the given key.
+	 * @return The new Source, or null if nothing is cached with that key.
+	 **/
+	Source *newCachedSource(const std::string &key);
+
+	/**
+	 * Creates a static Source from the given SoundData, and stores its decoded
+	 * audio in the cache with the given key so later Sources can share it.
+	 * If the cache is disabled or the SoundData alone is larger than the
+	 * budget, this is the same as newSource(soundData).
+	 **/
+	Source *newCachedSource(const std::string &key, love::sound::SoundData *soundData);
+
+	/**
+	 * Sets the amount of memory the decoded-audio cache may use, in bytes.
+	 * The least recently used entries are evicted to stay within it. Sources
+	 * which already use an evicted entry keep their own reference to it. A
+	 * budget of 0 disables the cache.
+	 **/
+	void setCacheMemoryBudget(int64 bytes);
+	int64 getCacheMemoryBudget() const;
+
+	/**
+	 * Removes everything from the decoded-audio cache.
+	 **/
+	void clearCache();
+
+	CacheStats getCacheStats() const;
+
+	/**
+	 * Mixes everything which is playing into the given SoundData, using its
+	 * sample rate, bit depth and channel count, and advances playback by its
+	 * length. Only backends which mix in software can do this.
+	 **/
+	virtual void render(love::sound::SoundData *target);
+
+	/**
+	 * Renders the given number of samples and writes them to a file as a
+	 * 16-bit stereo WAV. The file must not be open.
+	 **/
+	void renderToFile(love::filesystem::File *file, int samples, int sampleRate);
+
 	/**
 	 * Gets the current number of simultaneous playing sources.
 	 * @return The current number of simultaneous playing sources.
@@ -297,8 +375,43 @@ class Audio : public Module
 	virtual void pauseContext() = 0;
 	virtual void resumeContext() = 0;
 
+protected:
+
+	/**
+	 * Creates a static Source whose decoded audio can be shared with other
+	 * Sources. If shared is empty, the backend fills it with whatever it
+	 * needs from soundData (e.g. an uploaded buffer). Otherwise soundData is
+	 * null and the existing shared data is used.
+	 **/
+	virtual Source *newSharedSource(love::sound::SoundData *soundData, StrongRef<Object> &shared) = 0;
+
 private:
 
+	struct CacheEntry
+	{
+		StrongRef<Object> data;
+		int64 size;
+
+		// Position in the LRU list.
+		std::list<std::string>::iterator lruPosition;
+	};
+
+	void evictCache(int64 bytes);
+
+	std::unordered_map<std::string, CacheEntry> cache;
+
+	// Most recently used keys are at the front.
+	std::list<std::string> cacheLRU;
+
+	int64 cacheMemory;
+	int64 cacheMemoryBudget;
+	int64 cacheHits;
+	int64 cacheMisses;
+	int64 cacheEvictions;
+
+	love::thread::MutexRef cacheMutex;
+
+
 	static StringMap<DistanceModel, DISTANCE_MAX_ENUM>::Entry distanceModelEntries[];
 	static StringMap<DistanceModel, DISTANCE_MAX_ENUM> distanceModels;
 }; // Audio
@@ -54,6 +54,19 @@ class Source : public Object
 		UNIT_MAX_ENUM
 	};
 
+	// Buffer health of a playing streaming Source.
+	struct StreamStats
+	{
+		// Number of times playback ran out of queued data.
+		int underruns = 0;
+		// Total and longest time spent decoding a single buffer, in seconds.
+		double decodeTime = 0.0;
+		double maxDecodeTime = 0.0;
+		// Amount of audio currently queued ahead of the playback position, in
+		// seconds.
+		double bufferedTime = 0.0;
+	};
+
 	Source(Type type);
 	virtual ~Source();
 
@@ -122,6 +135,8 @@ class Source : public Object
 	virtual int getFreeBufferCount() const = 0;
 	virtual bool queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels) = 0;
 
+	virtual StreamStats getStreamStats() const = 0;
+
 	virtual Type getType() const;
 
 	static bool getConstant(const char *in, Type &out);
@@ -56,6 +56,14 @@ love::audio::Source *Audio::newSource(int, int, int, int)
 	return new Source();
 }
 
+love::audio::Source *Audio::newSharedSource(love::sound::SoundData *soundData, StrongRef<Object> &shared)
+{
+	if (shared.get() == nullptr)
+		shared.set(soundData);
+
+	return new Source();
+}
+
 int Audio::getActiveSourceCount() const
 {
 	return 0;
@@ -89,6 +89,11 @@ class Audio : public love::audio::Audio
 	void pauseContext();
 	void resumeContext();
 
+protected:
+
+	// Implements Audio.
+	love::audio::Source *newSharedSource(love::sound::SoundData *soundData, StrongRef<Object> &shared);
+
 private:
 	float volume;
 	DistanceModel distanceModel;
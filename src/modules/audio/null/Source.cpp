@@ -239,6 +239,11 @@ bool Source::queue(void *, size_t, int, int, int)
 	return false;
 }
 
+Source::StreamStats Source::getStreamStats() const
+{
+	return StreamStats();
+}
+
 bool Source::setFilter(const std::map<Filter::Parameter, float> &)
 {
 	return false;
@@ -81,6 +81,7 @@ class Source : public love::audio::Source
 
 	virtual int getFreeBufferCount() const;
 	virtual bool queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels);
+	virtual StreamStats getStreamStats() const;
 
 	virtual bool setFilter(const std::map<Filter::Parameter, float> &params);
 	virtual bool setFilter();
@@ -61,15 +61,19 @@ void Audio::PoolThread::threadFunction()
 			}
 		}
 
+		// Returns once sources need more data or the pool is woken up.
 		pool->update();
-		sleep(5);
 	}
 }
 
 void Audio::PoolThread::setFinish()
 {
-	thread::Lock lock(mutex);
-	finish = true;
+	{
+		thread::Lock lock(mutex);
+		finish = true;
+	}
+
+	pool->wake();
 }
 
 ALenum Audio::getFormat(int bitDepth, int channels)
@@ -202,6 +206,9 @@ Audio::Audio()
 
 Audio::~Audio()
 {
+	// Cached buffers have to be deleted while the context is still current.
+	clearCache();
+
 #ifdef LOVE_IOS
 	love::ios::destroyAudioSessionInterruptionHandler();
 #endif
@@ -255,6 +262,15 @@ love::audio::Source *Audio::newSource(int sampleRate, int bitDepth, int channels
 	return new Source(pool, sampleRate, bitDepth, channels, buffers);
 }
 
+love::audio::Source *Audio::newSharedSource(love::sound::SoundData *soundData, StrongRef<Object> &shared)
+{
+	// Only the uploaded buffer needs to be kept around, not the SoundData.
+	if (shared.get() == nullptr)
+		shared.set(new StaticDataBuffer(soundData), Acquire::NORETAIN);
+
+	return new Source(pool, (StaticDataBuffer *) shared.get());
+}
+
 int Audio::getActiveSourceCount() const
 {
 	return pool->getActiveSourceCount();
@@ -127,6 +127,11 @@ class Audio : public love::audio::Audio
 
 	bool getEffectID(const char *name, ALuint &id);
 
+protected:
+
+	// Implements Audio.
+	love::audio::Source *newSharedSource(love::sound::SoundData *soundData, StrongRef<Object> &shared);
+
 private:
 	void initializeEFX();
 	// The OpenAL device.
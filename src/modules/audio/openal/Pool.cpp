@@ -22,6 +22,10 @@
 
 #include "Source.h"
 
+// C++
+#include <algorithm>
+#include <thread>
+
 namespace love
 {
 namespace audio
@@ -29,9 +33,19 @@ namespace audio
 namespace openal
 {
 
+// Bounds for how long update() sleeps, in seconds.
+static const double MIN_UPDATE_DELAY = 0.001;
+static const double MAX_UPDATE_DELAY = 0.1;
+
+// Maximum number of threads used to decode streaming sources, in addition to
+// the pool thread itself.
+static const int MAX_DECODE_THREADS = 2;
+
 Pool::Pool()
 	: sources()
 	, totalSources(0)
+	, woken(false)
+	, decodePool(nullptr)
 {
 	// Clear errors.
 	alGetError();
@@ -69,12 +83,18 @@ Pool::Pool()
 
 		available.push(sources[i]);
 	}
+
+	int decodethreads = std::min(MAX_DECODE_THREADS, (int) std::thread::hardware_concurrency() - 1);
+	if (decodethreads > 0)
+		decodePool = new love::thread::WorkerPool(decodethreads);
 }
 
 Pool::~Pool()
 {
 	Source::stop(this);
 
+	delete decodePool;
+
 	// Free all sources.
 	alDeleteSources(totalSources, sources);
 }
@@ -104,15 +124,68 @@ void Pool::update()
 	thread::Lock lock(mutex);
 
 	std::vector<Source *> torelease;
+	std::vector<Source *> streams;
 
 	for (const auto &i : playing)
 	{
-		if (!i.first->update())
+		// Decoding is the expensive part, so streaming sources are updated
+		// together afterwards.
+		if (decodePool != nullptr && i.first->getType() == Source::TYPE_STREAM)
+			streams.push_back(i.first);
+		else if (!i.first->update())
 			torelease.push_back(i.first);
 	}
 
+	if (streams.size() > 1)
+	{
+		// Each source only touches its own decoder and OpenAL buffers.
+		std::vector<char> finished(streams.size(), 0);
+
+		decodePool->parallelFor((int) streams.size(), [&](int i)
+		{
+			finished[i] = !streams[i]->update();
+		});
+
+		for (size_t i = 0; i < streams.size(); i++)
+		{
+			if (finished[i])
+				torelease.push_back(streams[i]);
+		}
+	}
+	else if (streams.size() == 1 && !streams[0]->update())
+		torelease.push_back(streams[0]);
+
 	for (Source *s : torelease)
 		releaseSource(s);
+
+	if (woken)
+	{
+		woken = false;
+		return;
+	}
+
+	// Sleep until the source closest to running out of queued data needs to
+	// be refilled. With nothing playing there's nothing to do until wake().
+	if (playing.empty())
+		wakeCond->wait(mutex);
+	else
+	{
+		double delay = MAX_UPDATE_DELAY;
+		for (const auto &i : playing)
+			delay = std::min(delay, i.first->getUpdateDelay());
+
+		delay = std::max(delay, MIN_UPDATE_DELAY);
+		wakeCond->wait(mutex, (int) (delay * 1000.0));
+	}
+
+	woken = false;
+}
+
+void Pool::wake()
+{
+	thread::Lock lock(mutex);
+	woken = true;
+	wakeCond->signal();
 }
 
 int Pool::getActiveSourceCount() const
@@ -129,6 +202,12 @@ bool Pool::assignSource(Source *source, ALuint &out, char &wasPlaying)
 {
 	out = 0;
 
+	// The pool thread may be sleeping with nothing to do, or for longer than
+	// a newly played or resumed source can wait. Callers already hold the
+	// lock.
+	woken = true;
+	wakeCond->signal();
+
 	if (findSource(source, out))
 		return wasPlaying = true;
 
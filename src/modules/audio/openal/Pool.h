@@ -31,6 +31,7 @@
 #include "common/config.h"
 #include "common/Exception.h"
 #include "thread/threads.h"
+#include "thread/WorkerPool.h"
 #include "audio/Source.h"
 
 // OpenAL
@@ -78,8 +79,17 @@ class Pool
 	 **/
 	bool isPlaying(Source *s);
 
+	/**
+	 * Updates all playing sources, then sleeps until the earliest of them
+	 * will need more data, or until wake() is called.
+	 **/
 	void update();
 
+	/**
+	 * Makes a sleeping update() return early.
+	 **/
+	void wake();
+
 	int getActiveSourceCount() const;
 	int getMaxSources() const;
 
@@ -117,6 +127,13 @@ class Pool
 	// make sure of that.
 	love::thread::MutexRef mutex;
 
+	// Signalled when update() should stop sleeping.
+	love::thread::ConditionalRef wakeCond;
+	bool woken;
+
+	// Decodes streaming sources in parallel. Null if there's only one core.
+	love::thread::WorkerPool *decodePool;
+
 }; // Pool
 
 } // openal
@@ -23,6 +23,7 @@
 #include "Pool.h"
 #include "Audio.h"
 #include "common/math.h"
+#include "timer/Timer.h"
 
 // STD
 #include <iostream>
@@ -106,11 +107,18 @@ class QueueLoopingException : public love::Exception
 
 };
 
-StaticDataBuffer::StaticDataBuffer(ALenum format, const ALvoid *data, ALsizei size, ALsizei freq)
-	: size(size)
+StaticDataBuffer::StaticDataBuffer(love::sound::SoundData *soundData)
+	: size((ALsizei) soundData->getSize())
+	, sampleRate(soundData->getSampleRate())
+	, bitDepth(soundData->getBitDepth())
+	, channels(soundData->getChannelCount())
 {
+	ALenum fmt = Audio::getFormat(bitDepth, channels);
+	if (fmt == AL_NONE)
+		throw InvalidFormatException(channels, bitDepth);
+
 	alGenBuffers(1, &buffer);
-	alBufferData(buffer, format, data, size, freq);
+	alBufferData(buffer, fmt, soundData->getData(), size, sampleRate);
 }
 
 StaticDataBuffer::~StaticDataBuffer()
@@ -125,12 +133,31 @@ Source::Source(Pool *pool, love::sound::SoundData *soundData)
 	, channels(soundData->getChannelCount())
 	, bitDepth(soundData->getBitDepth())
 {
-	ALenum fmt = Audio::getFormat(soundData->getBitDepth(), soundData->getChannelCount());
-	if (fmt == AL_NONE)
-		throw InvalidFormatException(soundData->getChannelCount(), soundData->getBitDepth());
+	if (soundData->isReady())
+		staticBuffer.set(new StaticDataBuffer(soundData), Acquire::NORETAIN);
+	else if (Audio::getFormat(bitDepth, channels) != AL_NONE)
+		pendingData.set(soundData);
+	else
+		throw InvalidFormatException(channels, bitDepth);
 
-	staticBuffer.set(new StaticDataBuffer(fmt, soundData->getData(), (ALsizei) soundData->getSize(), sampleRate), Acquire::NORETAIN);
+	float z[3] = {0, 0, 0};
+
+	setFloatv(position, z);
+	setFloatv(velocity, z);
+	setFloatv(direction, z);
+
+	for (int i = 0; i < audiomodule()->getMaxSourceEffects(); i++)
+		slotlist.push(i);
+}
 
+Source::Source(Pool *pool, StaticDataBuffer *buffer)
+	: love::audio::Source(Source::TYPE_STATIC)
+	, pool(pool)
+	, staticBuffer(buffer)
+	, sampleRate(buffer->getSampleRate())
+	, channels(buffer->getChannelCount())
+	, bitDepth(buffer->getBitDepth())
+{
 	float z[3] = {0, 0, 0};
 
 	setFloatv(position, z);
@@ -221,6 +248,7 @@ Source::Source(const Source &s)
 	, pool(s.pool)
 	, valid(false)
 	, staticBuffer(s.staticBuffer)
+	, pendingData(s.pendingData)
 	, pitch(s.pitch)
 	, volume(s.volume)
 	, relative(s.relative)
@@ -294,6 +322,9 @@ Source::~Source()
 {
 	stop();
 
+	if (!pendingBuffers.empty())
+		alDeleteBuffers((ALsizei) pendingBuffers.size(), &pendingBuffers[0]);
+
 	if (sourceType != TYPE_STATIC)
 	{
 		while (!streamBuffers.empty())
@@ -387,6 +418,9 @@ bool Source::update()
 	{
 		case TYPE_STATIC:
 		{
+			if (pendingData.get() != nullptr)
+				return updatePendingData();
+
 			// Looping mode could have changed.
 			// FIXME: make looping mode change atomically so this is not needed
 			alSourcei(source, AL_LOOPING, isLooping() ? AL_TRUE : AL_FALSE);
@@ -398,6 +432,13 @@ bool Source::update()
 				ALint processed;
 				alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
 
+				// If every queued buffer was played before we could refill
+				// them, OpenAL has stopped the source and its sample offset
+				// no longer tells us how far playback got.
+				ALint state;
+				alGetSourcei(source, AL_SOURCE_STATE, &state);
+				bool starved = state == AL_STOPPED;
+
 				// It would theoretically be better to unqueue all processed
 				// buffers in a single call to alSourceUnqueueBuffers, but on
 				// iOS I observed occasional (every ~5-10 seconds) pops in the
@@ -408,16 +449,26 @@ bool Source::update()
 				// from https://bitbucket.org/rude/love/issues/1484/
 				while (processed--)
 				{
-					int curOffsetSamples;
-					alGetSourcei(source, AL_SAMPLE_OFFSET, &curOffsetSamples);
+					int curOffsetSamples = 0;
+					if (!starved)
+						alGetSourcei(source, AL_SAMPLE_OFFSET, &curOffsetSamples);
 
 					ALuint buffer;
 					alSourceUnqueueBuffers(source, 1, &buffer);
 
-					int newOffsetSamples;
-					alGetSourcei(source, AL_SAMPLE_OFFSET, &newOffsetSamples);
+					ALint size;
+					alGetBufferi(buffer, AL_SIZE, &size);
+					bufferedBytes -= size;
+
+					if (starved)
+						offsetSamples += size / (channels * bitDepth / 8);
+					else
+					{
+						int newOffsetSamples;
+						alGetSourcei(source, AL_SAMPLE_OFFSET, &newOffsetSamples);
 
-					offsetSamples += (curOffsetSamples - newOffsetSamples);
+						offsetSamples += (curOffsetSamples - newOffsetSamples);
+					}
 
 					if (streamAtomic(buffer, decoder.get()) > 0)
 						alSourceQueueBuffers(source, 1, &buffer);
@@ -437,6 +488,18 @@ bool Source::update()
 						break;
 				}
 
+				if (starved)
+				{
+					ALint queued;
+					alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+
+					if (queued > 0)
+					{
+						underruns++;
+						alSourcePlay(source);
+					}
+				}
+
 				return true;
 			}
 			return false;
@@ -616,7 +679,7 @@ double Source::getDuration(Unit unit)
 	{
 	case TYPE_STATIC:
 	{
-		ALsizei size = staticBuffer->getSize();
+		ALsizei size = pendingData.get() ? (ALsizei) pendingData->getSize() : staticBuffer->getSize();
 		ALsizei samples = (size / channels) / (bitDepth / 8);
 
 		if (unit == UNIT_SAMPLES)
@@ -829,6 +892,188 @@ int Source::getFreeBufferCount() const
 	return 0;
 }
 
+Source::StreamStats Source::getStreamStats() const
+{
+	Lock l = pool->lock();
+
+	StreamStats stats;
+	stats.underruns = underruns;
+	stats.decodeTime = decodeTime;
+	stats.maxDecodeTime = maxDecodeTime;
+	stats.bufferedTime = getBufferedTime();
+
+	return stats;
+}
+
+double Source::getUpdateDelay() const
+{
+	if (!valid)
+		return 0.0;
+
+	ALint state;
+	alGetSourcei(source, AL_SOURCE_STATE, &state);
+
+	// Keep checking for more decoded data while waiting for it.
+	if (pendingData.get() != nullptr && state == AL_STOPPED)
+		return 0.005;
+
+	// Paused sources don't consume anything. Stopped ones need to be released
+	// or restarted right away.
+	if (state == AL_PAUSED)
+		return DBL_MAX;
+	else if (state != AL_PLAYING)
+		return 0.0;
+
+	double p = std::max(pitch, 0.001f);
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+	{
+		bool pending = pendingData.get() != nullptr && !isPendingDataQueued();
+
+		if (isLooping() && !pending)
+			return DBL_MAX;
+
+		ALint offset;
+		alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+
+		// Pending data only goes as far as what's been queued so far. Wake up
+		// halfway there so more can be queued before playback catches up.
+		if (pending)
+		{
+			ALsizei queuedsamples = (ALsizei) ((pendingQueuedSize / channels) / (bitDepth / 8));
+			return std::max(queuedsamples - offset, 0) / (double) sampleRate / p * 0.5;
+		}
+
+		ALsizei size = pendingData.get() ? (ALsizei) pendingData->getSize() : staticBuffer->getSize();
+		ALsizei samples = (size / channels) / (bitDepth / 8);
+		return std::max(samples - offset, 0) / (double) sampleRate / p;
+	}
+	case TYPE_STREAM:
+	case TYPE_QUEUE:
+	{
+		// Wake up once about a buffer's worth of audio has been played, so
+		// the freed buffer can be refilled long before the queue runs dry.
+		ALint queued;
+		alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+
+		if (queued <= 0)
+			return 0.0;
+
+		return getBufferedTime() / queued / p;
+	}
+	case TYPE_MAX_ENUM:
+		break;
+	}
+
+	return 0.0;
+}
+
+double Source::getBufferedTime() const
+{
+	if (sourceType == TYPE_STATIC || sampleRate <= 0)
+		return 0.0;
+
+	ALint offset = 0;
+	if (valid)
+		alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+
+	ALsizei samples = (bufferedBytes / channels) / (bitDepth / 8);
+	return std::max(samples - offset, 0) / (double) sampleRate;
+}
+
+void Source::queuePendingData()
+{
+	// Buffers made during an earlier play() were unqueued when it stopped.
+	for (; pendingBuffersQueued < pendingBuffers.size(); pendingBuffersQueued++)
+		alSourceQueueBuffers(source, 1, &pendingBuffers[pendingBuffersQueued]);
+
+	// Check isReady first, so the decoded size is final if it's true.
+	bool ready = pendingData->isReady();
+	size_t decoded = pendingData->getDecodedSize();
+
+	size_t framesize = channels * (bitDepth / 8);
+	size_t end = ready ? pendingData->getSize() : decoded - (decoded % framesize);
+
+	// Avoid making lots of tiny buffers while decoding is still going.
+	const size_t minsize = 65536;
+
+	if (end <= pendingQueuedSize || (!ready && end - pendingQueuedSize < minsize))
+		return;
+
+	const uint8 *data = (const uint8 *) pendingData->getData();
+	ALenum fmt = Audio::getFormat(bitDepth, channels);
+
+	ALuint buffer;
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, fmt, data + pendingQueuedSize, (ALsizei) (end - pendingQueuedSize), sampleRate);
+	alSourceQueueBuffers(source, 1, &buffer);
+
+	pendingBuffers.push_back(buffer);
+	pendingBuffersQueued++;
+	pendingQueuedSize = end;
+}
+
+bool Source::updatePendingData()
+{
+	ALint state;
+	alGetSourcei(source, AL_SOURCE_STATE, &state);
+
+	size_t played = pendingQueuedSize;
+	queuePendingData();
+
+	bool queued = isPendingDataQueued();
+	alSourcei(source, AL_LOOPING, queued && isLooping() ? AL_TRUE : AL_FALSE);
+
+	if (state != AL_STOPPED)
+		return true;
+
+	size_t framesize = channels * (bitDepth / 8);
+
+	if (pendingQueuedSize > played)
+	{
+		// Playback caught up with decoding, and more has been decoded since.
+		// Continue from where it stopped.
+		underruns++;
+		alSourcei(source, AL_SAMPLE_OFFSET, (ALint) (played / framesize));
+		alSourcePlay(source);
+		return true;
+	}
+	else if (!queued)
+	{
+		// Wait for more to be decoded.
+		return true;
+	}
+	else if (isLooping())
+	{
+		// The end was queued after playback had already stopped.
+		alSourcePlay(source);
+		return true;
+	}
+
+	return false;
+}
+
+bool Source::isPendingDataQueued() const
+{
+	return pendingData->isReady() && pendingQueuedSize == pendingData->getSize();
+}
+
+void Source::finishPendingData()
+{
+	// Must only be called while the buffers aren't queued.
+	staticBuffer.set(new StaticDataBuffer(pendingData.get()), Acquire::NORETAIN);
+	pendingData.set(nullptr);
+
+	if (!pendingBuffers.empty())
+		alDeleteBuffers((ALsizei) pendingBuffers.size(), &pendingBuffers[0]);
+
+	pendingBuffers.clear();
+	pendingQueuedSize = 0;
+	pendingBuffersQueued = 0;
+}
+
 void Source::prepareAtomic()
 {
 	// This Source may now be associated with an OpenAL source that still has
@@ -839,7 +1084,16 @@ void Source::prepareAtomic()
 	switch (sourceType)
 	{
 	case TYPE_STATIC:
-		alSourcei(source, AL_BUFFER, staticBuffer->getBuffer());
+		if (pendingData.get() != nullptr && pendingData->isReady())
+			finishPendingData();
+
+		if (pendingData.get() != nullptr)
+		{
+			queuePendingData();
+			alSourcei(source, AL_LOOPING, isPendingDataQueued() && isLooping() ? AL_TRUE : AL_FALSE);
+		}
+		else
+			alSourcei(source, AL_BUFFER, staticBuffer->getBuffer());
 		break;
 	case TYPE_STREAM:
 		while (!unusedBuffers.empty())
@@ -895,6 +1149,8 @@ void Source::teardownAtomic()
 
 		for (int i = 0; i < queued; i++)
 			unusedBuffers.push(buffers[i]);
+
+		bufferedBytes = 0;
 		break;
 	}
 	case TYPE_QUEUE:
@@ -915,6 +1171,13 @@ void Source::teardownAtomic()
 
 	alSourcei(source, AL_BUFFER, AL_NONE);
 
+	if (pendingData.get() != nullptr)
+	{
+		pendingBuffersQueued = 0;
+		if (pendingData->isReady())
+			finishPendingData();
+	}
+
 	toLoop = 0;
 	valid = false;
 	offsetSamples = 0;
@@ -1146,16 +1409,25 @@ void Source::setFloatv(float *dst, const float *src) const
 
 int Source::streamAtomic(ALuint buffer, love::sound::Decoder *d)
 {
+	double start = love::timer::Timer::getTime();
+
 	// Get more sound data.
 	int decoded = std::max(d->decode(), 0);
 
+	double elapsed = love::timer::Timer::getTime() - start;
+	decodeTime += elapsed;
+	maxDecodeTime = std::max(maxDecodeTime, elapsed);
+
 	// OpenAL implementations are allowed to ignore 0-size alBufferData calls.
 	if (decoded > 0)
 	{
 		int fmt = Audio::getFormat(d->getBitDepth(), d->getChannelCount());
 
 		if (fmt != AL_NONE)
+		{
 			alBufferData(buffer, fmt, d->getBuffer(), decoded, d->getSampleRate());
+			bufferedBytes += decoded;
+		}
 		else
 			decoded = 0;
 	}
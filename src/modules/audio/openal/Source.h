@@ -74,7 +74,7 @@ class StaticDataBuffer : public love::Object
 {
 public:
 
-	StaticDataBuffer(ALenum format, const ALvoid *data, ALsizei size, ALsizei freq);
+	StaticDataBuffer(love::sound::SoundData *soundData);
 	virtual ~StaticDataBuffer();
 
 	inline ALuint getBuffer() const
@@ -87,11 +87,30 @@ class StaticDataBuffer : public love::Object
 		return size;
 	}
 
+	inline int getSampleRate() const
+	{
+		return sampleRate;
+	}
+
+	inline int getBitDepth() const
+	{
+		return bitDepth;
+	}
+
+	inline int getChannelCount() const
+	{
+		return channels;
+	}
+
 private:
 
 	ALuint buffer;
 	ALsizei size;
 
+	int sampleRate;
+	int bitDepth;
+	int channels;
+
 }; // StaticDataBuffer
 
 class Source : public love::audio::Source
@@ -99,6 +118,7 @@ class Source : public love::audio::Source
 public:
 
 	Source(Pool *pool, love::sound::SoundData *soundData);
+	Source(Pool *pool, StaticDataBuffer *buffer);
 	Source(Pool *pool, love::sound::Decoder *decoder);
 	Source(Pool *pool, int sampleRate, int bitDepth, int channels, int buffers);
 	Source(const Source &s);
@@ -156,6 +176,13 @@ class Source : public love::audio::Source
 
 	virtual int getFreeBufferCount() const;
 	virtual bool queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels);
+	virtual StreamStats getStreamStats() const;
+
+	/**
+	 * Gets how long the pool can wait before this Source needs to be updated
+	 * again, in seconds. Must be called with the pool locked.
+	 **/
+	double getUpdateDelay() const;
 
 	void prepareAtomic();
 	void teardownAtomic();
@@ -180,6 +207,16 @@ class Source : public love::audio::Source
 
 	int streamAtomic(ALuint buffer, love::sound::Decoder *d);
 
+	// Seconds of queued audio which haven't been played yet.
+	double getBufferedTime() const;
+
+	// Queues newly decoded parts of a SoundData which is still being decoded
+	// in the background.
+	void queuePendingData();
+	bool updatePendingData();
+	bool isPendingDataQueued() const;
+	void finishPendingData();
+
 	Pool *pool = nullptr;
 	ALuint source = 0;
 	bool valid = false;
@@ -191,6 +228,14 @@ class Source : public love::audio::Source
 
 	StrongRef<StaticDataBuffer> staticBuffer;
 
+	// Static Sources made from SoundData that isn't fully decoded yet play
+	// what has been decoded so far from a queue of buffers, and switch to a
+	// single staticBuffer the next time they're played once it's ready.
+	StrongRef<love::sound::SoundData> pendingData;
+	std::vector<ALuint> pendingBuffers;
+	size_t pendingQueuedSize = 0;
+	size_t pendingBuffersQueued = 0;
+
 	float pitch = 1.0f;
 	float volume = 1.0f;
 	float position[3];
@@ -225,6 +270,11 @@ class Source : public love::audio::Source
 	ALsizei bufferedBytes = 0;
 	int buffers = 0;
 
+	// Streaming statistics, accumulated over the lifetime of the Source.
+	int underruns = 0;
+	double decodeTime = 0.0;
+	double maxDecodeTime = 0.0;
+
 	Filter *directfilter = nullptr;
 
 	struct EffectMapStorage
@@ -0,0 +1,314 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "Audio.h"
+#include "sound/SoundData.h"
+
+// STL
+#include <algorithm>
+
+using love::thread::Lock;
+
+namespace love
+{
+namespace audio
+{
+namespace software
+{
+
+Audio::Audio()
+	: mixer(new Mixer())
+	, mixBuffer(MIX_FRAMES * 2)
+{
+}
+
+Audio::~Audio()
+{
+	delete mixer;
+}
+
+const char *Audio::getName() const
+{
+	return "love.audio.software";
+}
+
+love::audio::Source *Audio::newSource(love::sound::Decoder *decoder)
+{
+	return new Source(mixer, decoder);
+}
+
+love::audio::Source *Audio::newSource(love::sound::SoundData *soundData)
+{
+	return new Source(mixer, soundData);
+}
+
+love::audio::Source *Audio::newSource(int sampleRate, int bitDepth, int channels, int buffers)
+{
+	return new Source(mixer, sampleRate, bitDepth, channels, buffers);
+}
+
+love::audio::Source *Audio::newSharedSource(love::sound::SoundData *soundData, StrongRef<Object> &shared)
+{
+	// Static Sources read straight from their SoundData, so it's all there is
+	// to share.
+	if (shared.get() == nullptr)
+		shared.set(soundData);
+
+	return new Source(mixer, (love::sound::SoundData *) shared.get());
+}
+
+int Audio::getActiveSourceCount() const
+{
+	Lock l = mixer->lock();
+	return mixer->getActiveSourceCount();
+}
+
+int Audio::getMaxSources() const
+{
+	return mixer->getMaxSources();
+}
+
+bool Audio::play(love::audio::Source *source)
+{
+	return source->play();
+}
+
+bool Audio::play(const std::vector<love::audio::Source*> &sources)
+{
+	Lock l = mixer->lock();
+
+	bool success = true;
+	for (love::audio::Source *source : sources)
+		success = source->play() && success;
+
+	return success;
+}
+
+void Audio::stop(love::audio::Source *source)
+{
+	source->stop();
+}
+
+void Audio::stop(const std::vector<love::audio::Source*> &sources)
+{
+	Lock l = mixer->lock();
+
+	for (love::audio::Source *source : sources)
+		source->stop();
+}
+
+void Audio::stop()
+{
+	Lock l = mixer->lock();
+
+	for (love::audio::Source *source : mixer->getPlayingSources())
+		source->stop();
+}
+
+void Audio::pause(love::audio::Source *source)
+{
+	source->pause();
+}
+
+void Audio::pause(const std::vector<love::audio::Source*> &sources)
+{
+	Lock l = mixer->lock();
+
+	for (love::audio::Source *source : sources)
+		source->pause();
+}
+
+std::vector<love::audio::Source*> Audio::pause()
+{
+	Lock l = mixer->lock();
+
+	std::vector<love::audio::Source*> paused;
+	for (love::audio::Source *source : mixer->getPlayingSources())
+	{
+		if (source->isPlaying())
+		{
+			source->pause();
+			paused.push_back(source);
+		}
+	}
+
+	return paused;
+}
+
+void Audio::setVolume(float volume)
+{
+	Lock l = mixer->lock();
+	mixer->listener.volume = volume;
+}
+
+float Audio::getVolume() const
+{
+	return mixer->listener.volume;
+}
+
+void Audio::getPosition(float *v) const
+{
+	std::copy(mixer->listener.position, mixer->listener.position + 3, v);
+}
+
+void Audio::setPosition(float *v)
+{
+	Lock l = mixer->lock();
+	std::copy(v, v + 3, mixer->listener.position);
+}
+
+void Audio::getOrientation(float *v) const
+{
+	std::copy(mixer->listener.orientation, mixer->listener.orientation + 6, v);
+}
+
+void Audio::setOrientation(float *v)
+{
+	Lock l = mixer->lock();
+	std::copy(v, v + 6, mixer->listener.orientation);
+}
+
+void Audio::getVelocity(float *v) const
+{
+	std::copy(mixer->listener.velocity, mixer->listener.velocity + 3, v);
+}
+
+void Audio::setVelocity(float *v)
+{
+	Lock l = mixer->lock();
+	std::copy(v, v + 3, mixer->listener.velocity);
+}
+
+void Audio::setDopplerScale(float scale)
+{
+	if (scale >= 0.0f)
+		mixer->listener.dopplerScale = scale;
+}
+
+float Audio::getDopplerScale() const
+{
+	return mixer->listener.dopplerScale;
+}
+
+const std::vector<love::audio::RecordingDevice*> &Audio::getRecordingDevices()
+{
+	return capture;
+}
+
+Audio::DistanceModel Audio::getDistanceModel() const
+{
+	return mixer->listener.distanceModel;
+}
+
+void Audio::setDistanceModel(DistanceModel distanceModel)
+{
+	Lock l = mixer->lock();
+	mixer->listener.distanceModel = distanceModel;
+}
+
+bool Audio::setEffect(const char *, std::map<Effect::Parameter, float> &)
+{
+	return false;
+}
+
+bool Audio::unsetEffect(const char *)
+{
+	return false;
+}
+
+bool Audio::getEffect(const char *, std::map<Effect::Parameter, float> &)
+{
+	return false;
+}
+
+bool Audio::getActiveEffects(std::vector<std::string> &) const
+{
+	return false;
+}
+
+int Audio::getMaxSceneEffects() const
+{
+	return 0;
+}
+
+int Audio::getMaxSourceEffects() const
+{
+	return 0;
+}
+
+bool Audio::isEFXsupported() const
+{
+	return false;
+}
+
+void Audio::pauseContext()
+{
+}
+
+void Audio::resumeContext()
+{
+}
+
+void Audio::render(love::sound::SoundData *target)
+{
+	int channels = target->getChannelCount();
+	int bitDepth = target->getBitDepth();
+	int sampleRate = target->getSampleRate();
+	int samples = target->getSampleCount();
+
+	Lock l = mixer->lock();
+
+	for (int offset = 0; offset < samples; offset += MIX_FRAMES)
+	{
+		int frames = std::min(samples - offset, MIX_FRAMES);
+		const float *mixed = &mixBuffer[0];
+
+		mixer->render(&mixBuffer[0], frames, sampleRate);
+
+		for (int i = 0; i < frames; i++)
+		{
+			float left = mixed[i * 2 + 0];
+			float right = mixed[i * 2 + 1];
+
+			for (int c = 0; c < channels; c++)
+			{
+				float v = 0.0f;
+				if (channels == 1)
+					v = (left + right) * 0.5f;
+				else if (c == 0)
+					v = left;
+				else if (c == 1)
+					v = right;
+
+				v = std::min(std::max(v, -1.0f), 1.0f);
+
+				size_t index = (size_t) (offset + i) * channels + c;
+				if (bitDepth == 16)
+					((int16 *) target->getData())[index] = (int16) (v * 32767.0f);
+				else
+					((uint8 *) target->getData())[index] = (uint8) (v * 127.0f + 128.0f);
+			}
+		}
+	}
+}
+
+} // software
+} // audio
+} // love
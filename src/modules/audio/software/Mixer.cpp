@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "Mixer.h"
+#include "Source.h"
+
+// STL
+#include <algorithm>
+
+namespace love
+{
+namespace audio
+{
+namespace software
+{
+
+Mixer::Mixer()
+{
+	float z[3] = {0, 0, 0};
+	float orientation[6] = {0, 0, -1, 0, 1, 0};
+
+	std::copy(z, z + 3, listener.position);
+	std::copy(z, z + 3, listener.velocity);
+	std::copy(orientation, orientation + 6, listener.orientation);
+
+	listener.volume = 1.0f;
+	listener.dopplerScale = 1.0f;
+	listener.distanceModel = Audio::DISTANCE_INVERSE_CLAMPED;
+}
+
+Mixer::~Mixer()
+{
+	for (Source *s : playing)
+		s->release();
+}
+
+void Mixer::render(float *out, int frames, int sampleRate)
+{
+	thread::Lock l(mutex);
+
+	std::fill(out, out + frames * 2, 0.0f);
+
+	for (size_t i = 0; i < playing.size(); )
+	{
+		if (playing[i]->mix(out, frames, sampleRate, listener))
+			i++;
+		else
+			removeSource(playing[i]);
+	}
+
+	for (int i = 0; i < frames * 2; i++)
+		out[i] *= listener.volume;
+}
+
+bool Mixer::isPlaying(Source *source)
+{
+	thread::Lock l(mutex);
+	return std::find(playing.begin(), playing.end(), source) != playing.end();
+}
+
+int Mixer::getActiveSourceCount() const
+{
+	thread::Lock l(mutex);
+	return (int) playing.size();
+}
+
+int Mixer::getMaxSources() const
+{
+	return MAX_SOURCES;
+}
+
+thread::Lock Mixer::lock()
+{
+	return thread::Lock(mutex);
+}
+
+std::vector<love::audio::Source *> Mixer::getPlayingSources()
+{
+	thread::Lock l(mutex);
+	return std::vector<love::audio::Source *>(playing.begin(), playing.end());
+}
+
+bool Mixer::addSource(Source *source)
+{
+	if (std::find(playing.begin(), playing.end(), source) != playing.end())
+		return true;
+
+	if ((int) playing.size() >= MAX_SOURCES)
+		return false;
+
+	source->retain();
+	playing.push_back(source);
+	return true;
+}
+
+bool Mixer::removeSource(Source *source)
+{
+	auto it = std::find(playing.begin(), playing.end(), source);
+	if (it == playing.end())
+		return false;
+
+	playing.erase(it);
+	source->stopAtomic();
+	source->release();
+	return true;
+}
+
+} // software
+} // audio
+} // love
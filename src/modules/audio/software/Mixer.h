@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_AUDIO_SOFTWARE_MIXER_H
+#define LOVE_AUDIO_SOFTWARE_MIXER_H
+
+// LOVE
+#include "common/config.h"
+#include "audio/Audio.h"
+#include "thread/threads.h"
+
+// STD
+#include <vector>
+
+namespace love
+{
+namespace audio
+{
+namespace software
+{
+
+class Source;
+
+/**
+ * Mixes all playing Sources together in software. Nothing is played by
+ * itself: time only advances when render() is called.
+ **/
+class Mixer
+{
+public:
+
+	struct Listener
+	{
+		float position[3];
+		float velocity[3];
+		// Forward vector, followed by the up vector.
+		float orientation[6];
+		float volume;
+		float dopplerScale;
+		Audio::DistanceModel distanceModel;
+	};
+
+	Mixer();
+	~Mixer();
+
+	/**
+	 * Adds the output of every playing Source to an interleaved stereo
+	 * buffer, and advances their playback by the given number of frames.
+	 **/
+	void render(float *out, int frames, int sampleRate);
+
+	bool isPlaying(Source *source);
+
+	int getActiveSourceCount() const;
+	int getMaxSources() const;
+
+	Listener listener;
+
+private:
+
+	friend class Source;
+	friend class Audio;
+
+	LOVE_WARN_UNUSED thread::Lock lock();
+	std::vector<love::audio::Source *> getPlayingSources();
+
+	bool addSource(Source *source);
+	bool removeSource(Source *source);
+
+	static const int MAX_SOURCES = 256;
+
+	std::vector<Source *> playing;
+
+	love::thread::MutexRef mutex;
+
+}; // Mixer
+
+} // software
+} // audio
+} // love
+
+#endif // LOVE_AUDIO_SOFTWARE_MIXER_H
@@ -0,0 +1,1027 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "Source.h"
+#include "common/Exception.h"
+#include "timer/Timer.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+using love::thread::Lock;
+
+namespace love
+{
+namespace audio
+{
+namespace software
+{
+
+class InvalidFormatException : public love::Exception
+{
+public:
+
+	InvalidFormatException(int channels, int bitdepth)
+		: Exception("%d-channel Sources with %d bits per sample are not supported.", channels, bitdepth)
+	{
+	}
+
+};
+
+class SpatialSupportException : public love::Exception
+{
+public:
+
+	SpatialSupportException()
+		: Exception("This spatial audio functionality is only available for mono Sources.")
+	{
+	}
+
+};
+
+class QueueFormatMismatchException : public love::Exception
+{
+public:
+
+	QueueFormatMismatchException()
+		: Exception("Queued sound data must have same format as sound Source.")
+	{
+	}
+
+};
+
+class QueueTypeMismatchException : public love::Exception
+{
+public:
+
+	QueueTypeMismatchException()
+		: Exception("Only queueable Sources can be queued with sound data.")
+	{
+	}
+
+};
+
+class QueueMalformedLengthException : public love::Exception
+{
+public:
+
+	QueueMalformedLengthException(int bytes)
+		: Exception("Data length must be a multiple of sample size (%d bytes).", bytes)
+	{
+	}
+
+};
+
+class QueueLoopingException : public love::Exception
+{
+public:
+
+	QueueLoopingException()
+		: Exception("Queueable Sources can not be looped.")
+	{
+	}
+
+};
+
+static bool isValidFormat(int bitDepth, int channels)
+{
+	return (bitDepth == 8 || bitDepth == 16) && channels >= 1 && channels <= 8;
+}
+
+static inline float toFloat(const void *data, size_t i, int bitDepth)
+{
+	if (bitDepth == 16)
+		return ((const int16 *) data)[i] / 32767.0f;
+	else
+		return (((const uint8 *) data)[i] - 128) / 127.0f;
+}
+
+static void setFloatv(float *dst, const float *src)
+{
+	dst[0] = src[0];
+	dst[1] = src[1];
+	dst[2] = src[2];
+}
+
+Source::Source(Mixer *mixer, love::sound::SoundData *soundData)
+	: love::audio::Source(Source::TYPE_STATIC)
+	, mixer(mixer)
+	, sampleRate(soundData->getSampleRate())
+	, channels(soundData->getChannelCount())
+	, bitDepth(soundData->getBitDepth())
+	, soundData(soundData)
+{
+	if (!isValidFormat(bitDepth, channels))
+		throw InvalidFormatException(channels, bitDepth);
+
+	float z[3] = {0, 0, 0};
+
+	setFloatv(position3D, z);
+	setFloatv(velocity, z);
+	setFloatv(direction, z);
+}
+
+Source::Source(Mixer *mixer, love::sound::Decoder *decoder)
+	: love::audio::Source(Source::TYPE_STREAM)
+	, mixer(mixer)
+	, sampleRate(decoder->getSampleRate())
+	, channels(decoder->getChannelCount())
+	, bitDepth(decoder->getBitDepth())
+	, decoder(decoder)
+	, buffers(DEFAULT_BUFFERS)
+{
+	if (!isValidFormat(bitDepth, channels))
+		throw InvalidFormatException(channels, bitDepth);
+
+	float z[3] = {0, 0, 0};
+
+	setFloatv(position3D, z);
+	setFloatv(velocity, z);
+	setFloatv(direction, z);
+}
+
+Source::Source(Mixer *mixer, int sampleRate, int bitDepth, int channels, int buffers)
+	: love::audio::Source(Source::TYPE_QUEUE)
+	, mixer(mixer)
+	, sampleRate(sampleRate)
+	, channels(channels)
+	, bitDepth(bitDepth)
+	, buffers(buffers)
+{
+	if (!isValidFormat(bitDepth, channels))
+		throw InvalidFormatException(channels, bitDepth);
+
+	if (this->buffers < 1)
+		this->buffers = DEFAULT_BUFFERS;
+	if (this->buffers > MAX_BUFFERS)
+		this->buffers = MAX_BUFFERS;
+
+	float z[3] = {0, 0, 0};
+
+	setFloatv(position3D, z);
+	setFloatv(velocity, z);
+	setFloatv(direction, z);
+}
+
+Source::Source(const Source &s)
+	: love::audio::Source(s.sourceType)
+	, mixer(s.mixer)
+	, sampleRate(s.sampleRate)
+	, channels(s.channels)
+	, bitDepth(s.bitDepth)
+	, soundData(s.soundData)
+	, buffers(s.buffers)
+	, pitch(s.pitch)
+	, volume(s.volume)
+	, relative(s.relative)
+	, looping(s.looping)
+	, minVolume(s.minVolume)
+	, maxVolume(s.maxVolume)
+	, referenceDistance(s.referenceDistance)
+	, rolloffFactor(s.rolloffFactor)
+	, maxDistance(s.maxDistance)
+	, absorptionFactor(s.absorptionFactor)
+	, cone(s.cone)
+{
+	if (sourceType == TYPE_STREAM && s.decoder.get())
+		decoder.set(s.decoder->clone(), Acquire::NORETAIN);
+
+	setFloatv(position3D, s.position3D);
+	setFloatv(velocity, s.velocity);
+	setFloatv(direction, s.direction);
+}
+
+Source::~Source()
+{
+	// The mixer keeps playing Sources alive, so there's nothing to stop here.
+}
+
+love::audio::Source *Source::clone()
+{
+	return new Source(*this);
+}
+
+bool Source::play()
+{
+	Lock l = mixer->lock();
+
+	paused = false;
+
+	if (mixer->isPlaying(this))
+		return true;
+
+	finished = false;
+	return mixer->addSource(this);
+}
+
+void Source::stop()
+{
+	Lock l = mixer->lock();
+
+	if (mixer->isPlaying(this))
+		mixer->removeSource(this);
+	else
+		stopAtomic();
+}
+
+void Source::pause()
+{
+	Lock l = mixer->lock();
+
+	if (mixer->isPlaying(this))
+		paused = true;
+}
+
+bool Source::isPlaying() const
+{
+	Lock l = mixer->lock();
+	return !paused && mixer->isPlaying(const_cast<Source *>(this));
+}
+
+bool Source::isFinished() const
+{
+	return finished;
+}
+
+bool Source::update()
+{
+	return isPlaying();
+}
+
+void Source::stopAtomic()
+{
+	paused = false;
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+		position = 0.0;
+		break;
+	case TYPE_STREAM:
+		if (decoder.get())
+			decoder->rewind();
+		buffer.clear();
+		loopPoints.clear();
+		bufferStart = 0;
+		offsetBase = 0;
+		position = 0.0;
+		break;
+	case TYPE_QUEUE:
+		// Like OpenAL, stopping a queueable Source discards what's queued.
+		buffer.clear();
+		queuedBuffers.clear();
+		bufferStart = 0;
+		position = 0.0;
+		break;
+	case TYPE_MAX_ENUM:
+		break;
+	}
+}
+
+void Source::setPitch(float pitch)
+{
+	this->pitch = pitch;
+}
+
+float Source::getPitch() const
+{
+	return pitch;
+}
+
+void Source::setVolume(float volume)
+{
+	this->volume = volume;
+}
+
+float Source::getVolume() const
+{
+	return volume;
+}
+
+void Source::seek(double offset, Source::Unit unit)
+{
+	Lock l = mixer->lock();
+
+	int64 offsetSamples = 0;
+	double offsetSeconds = 0.0;
+
+	switch (unit)
+	{
+	case Source::UNIT_SAMPLES:
+		offsetSamples = (int64) offset;
+		offsetSeconds = offset / (double) sampleRate;
+		break;
+	case Source::UNIT_SECONDS:
+	default:
+		offsetSeconds = offset;
+		offsetSamples = (int64) (offset * sampleRate);
+		break;
+	}
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+		position = (double) offsetSamples;
+		break;
+	case TYPE_STREAM:
+		decoder->seek(offsetSeconds);
+		buffer.clear();
+		loopPoints.clear();
+		bufferStart = 0;
+		offsetBase = -offsetSamples;
+		position = 0.0;
+		break;
+	case TYPE_QUEUE:
+		// Discard every queued buffer which the new position is past.
+		while (!queuedBuffers.empty() && bufferStart + offsetSamples >= queuedBuffers.front())
+		{
+			int64 end = queuedBuffers.front();
+			queuedBuffers.pop_front();
+
+			offsetSamples -= end - bufferStart;
+			buffer.erase(buffer.begin(), buffer.begin() + (end - bufferStart) * channels);
+			bufferStart = end;
+		}
+		if (queuedBuffers.empty())
+			offsetSamples = 0;
+		position = (double) (bufferStart + offsetSamples);
+		break;
+	case TYPE_MAX_ENUM:
+		break;
+	}
+}
+
+double Source::tell(Source::Unit unit)
+{
+	Lock l = mixer->lock();
+
+	int64 offset = 0;
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+		offset = (int64) position;
+		break;
+	case TYPE_STREAM:
+	{
+		int64 base = offsetBase;
+		for (int64 loop : loopPoints)
+		{
+			if (loop <= (int64) position)
+				base = loop;
+		}
+		offset = (int64) position - base;
+		break;
+	}
+	case TYPE_QUEUE:
+		offset = (int64) position - bufferStart;
+		break;
+	case TYPE_MAX_ENUM:
+		break;
+	}
+
+	if (unit == UNIT_SECONDS)
+		return offset / (double) sampleRate;
+	else
+		return (double) offset;
+}
+
+double Source::getDuration(Unit unit)
+{
+	Lock l = mixer->lock();
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+	{
+		int64 samples = getFrameCount();
+
+		if (unit == UNIT_SAMPLES)
+			return (double) samples;
+		else
+			return (double) samples / (double) sampleRate;
+	}
+	case TYPE_STREAM:
+	{
+		double seconds = decoder->getDuration();
+
+		if (unit == UNIT_SECONDS)
+			return seconds;
+		else
+			return seconds * decoder->getSampleRate();
+	}
+	case TYPE_QUEUE:
+	{
+		int64 samples = getBufferedFrames();
+
+		if (unit == UNIT_SAMPLES)
+			return (double) samples;
+		else
+			return (double) samples / (double) sampleRate;
+	}
+	case TYPE_MAX_ENUM:
+		return 0.0;
+	}
+	return 0.0;
+}
+
+void Source::setPosition(float *v)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	setFloatv(position3D, v);
+}
+
+void Source::getPosition(float *v) const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	setFloatv(v, position3D);
+}
+
+void Source::setVelocity(float *v)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	setFloatv(velocity, v);
+}
+
+void Source::getVelocity(float *v) const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	setFloatv(v, velocity);
+}
+
+void Source::setDirection(float *v)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	setFloatv(direction, v);
+}
+
+void Source::getDirection(float *v) const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	setFloatv(v, direction);
+}
+
+void Source::setCone(float innerAngle, float outerAngle, float outerVolume, float outerHighGain)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	cone.innerAngle = innerAngle;
+	cone.outerAngle = outerAngle;
+	cone.outerVolume = outerVolume;
+	cone.outerHighGain = outerHighGain;
+}
+
+void Source::getCone(float &innerAngle, float &outerAngle, float &outerVolume, float &outerHighGain) const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	innerAngle = cone.innerAngle;
+	outerAngle = cone.outerAngle;
+	outerVolume = cone.outerVolume;
+	outerHighGain = cone.outerHighGain;
+}
+
+void Source::setRelative(bool enable)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	relative = enable;
+}
+
+bool Source::isRelative() const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	return relative;
+}
+
+void Source::setLooping(bool enable)
+{
+	if (sourceType == TYPE_QUEUE)
+		throw QueueLoopingException();
+
+	looping = enable;
+}
+
+bool Source::isLooping() const
+{
+	return looping;
+}
+
+void Source::setMinVolume(float volume)
+{
+	minVolume = volume;
+}
+
+float Source::getMinVolume() const
+{
+	return minVolume;
+}
+
+void Source::setMaxVolume(float volume)
+{
+	maxVolume = volume;
+}
+
+float Source::getMaxVolume() const
+{
+	return maxVolume;
+}
+
+void Source::setReferenceDistance(float distance)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	referenceDistance = distance;
+}
+
+float Source::getReferenceDistance() const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	return referenceDistance;
+}
+
+void Source::setRolloffFactor(float factor)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	rolloffFactor = factor;
+}
+
+float Source::getRolloffFactor() const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	return rolloffFactor;
+}
+
+void Source::setMaxDistance(float distance)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	maxDistance = distance;
+}
+
+float Source::getMaxDistance() const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	return maxDistance;
+}
+
+void Source::setAirAbsorptionFactor(float factor)
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	absorptionFactor = factor;
+}
+
+float Source::getAirAbsorptionFactor() const
+{
+	if (channels > 1)
+		throw SpatialSupportException();
+
+	return absorptionFactor;
+}
+
+int Source::getChannelCount() const
+{
+	return channels;
+}
+
+int Source::getFreeBufferCount() const
+{
+	Lock l = mixer->lock();
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+		return 0;
+	case TYPE_STREAM:
+		return buffers;
+	case TYPE_QUEUE:
+		return buffers - (int) queuedBuffers.size();
+	case TYPE_MAX_ENUM:
+		return 0;
+	}
+	return 0;
+}
+
+bool Source::queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels)
+{
+	if (sourceType != TYPE_QUEUE)
+		throw QueueTypeMismatchException();
+
+	if (dataSampleRate != sampleRate || dataBitDepth != bitDepth || dataChannels != channels)
+		throw QueueFormatMismatchException();
+
+	if (length % (bitDepth / 8 * channels) != 0)
+		throw QueueMalformedLengthException(bitDepth / 8 * channels);
+
+	if (length == 0)
+		return true;
+
+	Lock l = mixer->lock();
+
+	if ((int) queuedBuffers.size() >= buffers)
+		return false;
+
+	appendToBuffer(data, length, bitDepth);
+	queuedBuffers.push_back(bufferStart + getBufferedFrames());
+
+	return true;
+}
+
+love::audio::Source::StreamStats Source::getStreamStats() const
+{
+	Lock l = mixer->lock();
+
+	StreamStats s = stats;
+
+	if (sourceType != TYPE_STATIC)
+	{
+		int64 ahead = bufferStart + getBufferedFrames() - (int64) position;
+		s.bufferedTime = std::max(ahead, (int64) 0) / (double) sampleRate;
+	}
+
+	return s;
+}
+
+bool Source::setFilter(const std::map<Filter::Parameter, float> &)
+{
+	return false;
+}
+
+bool Source::setFilter()
+{
+	return false;
+}
+
+bool Source::getFilter(std::map<Filter::Parameter, float> &)
+{
+	return false;
+}
+
+bool Source::setEffect(const char *)
+{
+	return false;
+}
+
+bool Source::setEffect(const char *, const std::map<Filter::Parameter, float> &)
+{
+	return false;
+}
+
+bool Source::unsetEffect(const char *)
+{
+	return false;
+}
+
+bool Source::getEffect(const char *, std::map<Filter::Parameter, float> &)
+{
+	return false;
+}
+
+bool Source::getActiveEffects(std::vector<std::string> &) const
+{
+	return false;
+}
+
+int64 Source::getBufferedFrames() const
+{
+	return (int64) buffer.size() / channels;
+}
+
+int64 Source::getFrameCount() const
+{
+	return (int64) soundData->getSize() / (channels * (bitDepth / 8));
+}
+
+void Source::appendToBuffer(const void *data, size_t length, int bitDepth)
+{
+	size_t samples = length / (bitDepth / 8);
+	size_t start = buffer.size();
+
+	buffer.resize(start + samples);
+
+	for (size_t i = 0; i < samples; i++)
+		buffer[start + i] = toFloat(data, i, bitDepth);
+}
+
+bool Source::decodeMore()
+{
+	bool rewound = false;
+
+	if (decoder->isFinished())
+	{
+		if (!looping)
+			return false;
+
+		decoder->rewind();
+		loopPoints.push_back(bufferStart + getBufferedFrames());
+		rewound = true;
+	}
+
+	double start = love::timer::Timer::getTime();
+	int decoded = decoder->decode();
+	double elapsed = love::timer::Timer::getTime() - start;
+
+	stats.decodeTime += elapsed;
+	stats.maxDecodeTime = std::max(stats.maxDecodeTime, elapsed);
+
+	// Nothing was decoded, but a looping decoder can still be rewound (unless
+	// it was just rewound and is empty).
+	if (decoded <= 0)
+		return looping && !rewound && decoder->isFinished();
+
+	appendToBuffer(decoder->getBuffer(), decoded - (decoded % (channels * (bitDepth / 8))), bitDepth);
+	return true;
+}
+
+void Source::discardPlayed()
+{
+	if (sourceType == TYPE_STREAM)
+	{
+		// Keep the current frame, which is still needed for interpolation.
+		int64 played = std::min((int64) position - bufferStart, getBufferedFrames());
+		if (played > 0)
+		{
+			buffer.erase(buffer.begin(), buffer.begin() + played * channels);
+			bufferStart += played;
+		}
+
+		while (loopPoints.size() > 1 && loopPoints[1] <= (int64) position)
+			loopPoints.pop_front();
+		if (!loopPoints.empty() && loopPoints.front() <= (int64) position)
+		{
+			offsetBase = loopPoints.front();
+			loopPoints.pop_front();
+		}
+	}
+	else if (sourceType == TYPE_QUEUE)
+	{
+		// Buffers are released whole, like OpenAL's processed buffers.
+		while (!queuedBuffers.empty() && queuedBuffers.front() <= (int64) position)
+		{
+			int64 end = queuedBuffers.front();
+			queuedBuffers.pop_front();
+
+			buffer.erase(buffer.begin(), buffer.begin() + (end - bufferStart) * channels);
+			bufferStart = end;
+		}
+	}
+}
+
+bool Source::getFrame(int64 frame, float &left, float &right)
+{
+	if (sourceType == TYPE_STATIC)
+	{
+		int64 count = getFrameCount();
+
+		if (frame >= count)
+		{
+			if (!looping || count == 0)
+				return false;
+			frame %= count;
+		}
+
+		size_t framesize = channels * (bitDepth / 8);
+
+		// Play silence for the parts of a SoundData which are still being
+		// decoded in the background.
+		if (!soundData->isReady() && (size_t) (frame + 1) * framesize > soundData->getDecodedSize())
+		{
+			left = right = 0.0f;
+			return true;
+		}
+
+		size_t i = (size_t) frame * channels;
+		left = toFloat(soundData->getData(), i, bitDepth);
+		right = channels > 1 ? toFloat(soundData->getData(), i + 1, bitDepth) : left;
+		return true;
+	}
+
+	int64 i = frame - bufferStart;
+	if (i < 0 || i >= getBufferedFrames())
+		return false;
+
+	left = buffer[i * channels];
+	right = channels > 1 ? buffer[i * channels + 1] : left;
+	return true;
+}
+
+void Source::getGains(const Mixer::Listener &listener, float &left, float &right) const
+{
+	float gain = volume;
+
+	if (channels > 1)
+	{
+		gain = std::min(std::max(gain, minVolume), maxVolume);
+		left = right = gain;
+		return;
+	}
+
+	float rel[3];
+	for (int i = 0; i < 3; i++)
+		rel[i] = relative ? position3D[i] : position3D[i] - listener.position[i];
+
+	float distance = sqrtf(rel[0]*rel[0] + rel[1]*rel[1] + rel[2]*rel[2]);
+
+	// Distance attenuation, using the same formulas as OpenAL.
+	float d = distance;
+	switch (listener.distanceModel)
+	{
+	case Audio::DISTANCE_INVERSE_CLAMPED:
+	case Audio::DISTANCE_LINEAR_CLAMPED:
+	case Audio::DISTANCE_EXPONENT_CLAMPED:
+		d = std::min(std::max(d, referenceDistance), maxDistance);
+		break;
+	default:
+		break;
+	}
+
+	switch (listener.distanceModel)
+	{
+	case Audio::DISTANCE_INVERSE:
+	case Audio::DISTANCE_INVERSE_CLAMPED:
+	{
+		float denom = referenceDistance + rolloffFactor * (d - referenceDistance);
+		if (denom > 0.0f)
+			gain *= referenceDistance / denom;
+		break;
+	}
+	case Audio::DISTANCE_LINEAR:
+	case Audio::DISTANCE_LINEAR_CLAMPED:
+		if (maxDistance > referenceDistance)
+			gain *= std::max(1.0f - rolloffFactor * (d - referenceDistance) / (maxDistance - referenceDistance), 0.0f);
+		break;
+	case Audio::DISTANCE_EXPONENT:
+	case Audio::DISTANCE_EXPONENT_CLAMPED:
+		if (d > 0.0f && referenceDistance > 0.0f)
+			gain *= powf(d / referenceDistance, -rolloffFactor);
+		break;
+	default:
+		break;
+	}
+
+	// Cone attenuation, based on the angle between the Source's direction and
+	// the listener.
+	float dirlength = sqrtf(direction[0]*direction[0] + direction[1]*direction[1] + direction[2]*direction[2]);
+	if (dirlength > 0.0f && distance > 0.0f)
+	{
+		float cosangle = -(rel[0]*direction[0] + rel[1]*direction[1] + rel[2]*direction[2]) / (distance * dirlength);
+		float angle = acosf(std::min(std::max(cosangle, -1.0f), 1.0f)) * 2.0f;
+
+		if (angle >= cone.outerAngle)
+			gain *= cone.outerVolume;
+		else if (angle > cone.innerAngle && cone.outerAngle > cone.innerAngle)
+		{
+			float t = (angle - cone.innerAngle) / (cone.outerAngle - cone.innerAngle);
+			gain *= 1.0f + (cone.outerVolume - 1.0f) * t;
+		}
+	}
+
+	gain = std::min(std::max(gain, minVolume), maxVolume);
+
+	// Equal-power panning, using the listener's right vector.
+	float pan = 0.0f;
+	if (distance > 0.0f)
+	{
+		const float *f = listener.orientation;
+		const float *u = listener.orientation + 3;
+		float r[3] = {
+			f[1]*u[2] - f[2]*u[1],
+			f[2]*u[0] - f[0]*u[2],
+			f[0]*u[1] - f[1]*u[0],
+		};
+
+		float rlength = sqrtf(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+		if (rlength > 0.0f)
+			pan = (rel[0]*r[0] + rel[1]*r[1] + rel[2]*r[2]) / (distance * rlength);
+	}
+
+	float angle = (pan + 1.0f) * (float) LOVE_M_PI_4;
+	left = gain * cosf(angle);
+	right = gain * sinf(angle);
+}
+
+bool Source::mix(float *out, int frames, int outSampleRate, const Mixer::Listener &listener)
+{
+	if (paused)
+		return true;
+
+	double step = sampleRate * (double) pitch / outSampleRate;
+	if (step <= 0.0)
+		return true;
+
+	if (sourceType == TYPE_STREAM)
+	{
+		// Make sure everything this call will read is decoded.
+		int64 needed = (int64) (position + frames * step) + 2;
+		while (bufferStart + getBufferedFrames() < needed)
+		{
+			if (!decodeMore())
+				break;
+		}
+	}
+
+	float leftgain, rightgain;
+	getGains(listener, leftgain, rightgain);
+
+	bool playing = true;
+
+	for (int i = 0; i < frames; i++)
+	{
+		int64 frame = (int64) position;
+		float l0, r0, l1, r1;
+
+		if (!getFrame(frame, l0, r0))
+		{
+			playing = false;
+			break;
+		}
+
+		// Hold the last frame when there's nothing after it to interpolate
+		// with.
+		if (!getFrame(frame + 1, l1, r1))
+		{
+			l1 = l0;
+			r1 = r0;
+		}
+
+		float t = (float) (position - frame);
+		out[i * 2 + 0] += (l0 + (l1 - l0) * t) * leftgain;
+		out[i * 2 + 1] += (r0 + (r1 - r0) * t) * rightgain;
+
+		position += step;
+	}
+
+	if (sourceType == TYPE_STATIC && looping)
+	{
+		int64 count = getFrameCount();
+		if (count > 0 && position >= count)
+			position = fmod(position, (double) count);
+	}
+
+	discardPlayed();
+
+	if (!playing)
+	{
+		// The decoder couldn't keep up, but there's more to come.
+		if (sourceType == TYPE_STREAM && (looping || !decoder->isFinished()))
+		{
+			stats.underruns++;
+			return true;
+		}
+
+		finished = true;
+	}
+
+	return playing;
+}
+
+} // software
+} // audio
+} // love
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_AUDIO_SOFTWARE_SOURCE_H
+#define LOVE_AUDIO_SOFTWARE_SOURCE_H
+
+// LOVE
+#include "common/config.h"
+#include "common/Object.h"
+#include "common/int.h"
+#include "common/math.h"
+#include "audio/Source.h"
+#include "audio/Filter.h"
+#include "sound/SoundData.h"
+#include "sound/Decoder.h"
+#include "Mixer.h"
+
+// STL
+#include <vector>
+#include <deque>
+#include <cfloat>
+
+namespace love
+{
+namespace audio
+{
+namespace software
+{
+
+class Source : public love::audio::Source
+{
+public:
+
+	Source(Mixer *mixer, love::sound::SoundData *soundData);
+	Source(Mixer *mixer, love::sound::Decoder *decoder);
+	Source(Mixer *mixer, int sampleRate, int bitDepth, int channels, int buffers);
+	Source(const Source &s);
+	virtual ~Source();
+
+	virtual love::audio::Source *clone();
+	virtual bool play();
+	virtual void stop();
+	virtual void pause();
+	virtual bool isPlaying() const;
+	virtual bool isFinished() const;
+	virtual bool update();
+	virtual void setPitch(float pitch);
+	virtual float getPitch() const;
+	virtual void setVolume(float volume);
+	virtual float getVolume() const;
+	virtual void seek(double offset, Unit unit);
+	virtual double tell(Unit unit);
+	virtual double getDuration(Unit unit);
+	virtual void setPosition(float *v);
+	virtual void getPosition(float *v) const;
+	virtual void setVelocity(float *v);
+	virtual void getVelocity(float *v) const;
+	virtual void setDirection(float *v);
+	virtual void getDirection(float *v) const;
+	virtual void setCone(float innerAngle, float outerAngle, float outerVolume, float outerHighGain);
+	virtual void getCone(float &innerAngle, float &outerAngle, float &outerVolume, float &outerHighGain) const;
+	virtual void setRelative(bool enable);
+	virtual bool isRelative() const;
+	virtual void setLooping(bool looping);
+	virtual bool isLooping() const;
+	virtual void setMinVolume(float volume);
+	virtual float getMinVolume() const;
+	virtual void setMaxVolume(float volume);
+	virtual float getMaxVolume() const;
+	virtual void setReferenceDistance(float distance);
+	virtual float getReferenceDistance() const;
+	virtual void setRolloffFactor(float factor);
+	virtual float getRolloffFactor() const;
+	virtual void setMaxDistance(float distance);
+	virtual float getMaxDistance() const;
+	virtual void setAirAbsorptionFactor(float factor);
+	virtual float getAirAbsorptionFactor() const;
+	virtual int getChannelCount() const;
+
+	virtual int getFreeBufferCount() const;
+	virtual bool queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels);
+	virtual StreamStats getStreamStats() const;
+
+	virtual bool setFilter(const std::map<Filter::Parameter, float> &params);
+	virtual bool setFilter();
+	virtual bool getFilter(std::map<Filter::Parameter, float> &params);
+
+	virtual bool setEffect(const char *effect);
+	virtual bool setEffect(const char *effect, const std::map<Filter::Parameter, float> &params);
+	virtual bool unsetEffect(const char *effect);
+	virtual bool getEffect(const char *effect, std::map<Filter::Parameter, float> &params);
+	virtual bool getActiveEffects(std::vector<std::string> &list) const;
+
+	/**
+	 * Adds this Source's output to an interleaved stereo buffer. Returns
+	 * false once the Source has reached its end. Must be called with the
+	 * mixer locked.
+	 **/
+	bool mix(float *out, int frames, int outSampleRate, const Mixer::Listener &listener);
+
+	// Rewinds the Source after it's removed from the mixer.
+	void stopAtomic();
+
+private:
+
+	// Gets a frame at the given playback position as a stereo pair. Returns
+	// false if the position is past the end.
+	bool getFrame(int64 frame, float &left, float &right);
+
+	// Decodes more of a streaming Source into the buffer.
+	bool decodeMore();
+
+	// Appends 8 or 16 bit audio to the buffer as floats.
+	void appendToBuffer(const void *data, size_t length, int bitDepth);
+
+	// Drops buffered audio which has already been played.
+	void discardPlayed();
+
+	int64 getBufferedFrames() const;
+	int64 getFrameCount() const;
+
+	void getGains(const Mixer::Listener &listener, float &left, float &right) const;
+
+	static const int DEFAULT_BUFFERS = 8;
+	static const int MAX_BUFFERS = 64;
+
+	Mixer *mixer;
+	bool finished = false;
+	bool paused = false;
+
+	int sampleRate = 0;
+	int channels = 0;
+	int bitDepth = 0;
+
+	// Static Sources read straight from their SoundData.
+	StrongRef<love::sound::SoundData> soundData;
+
+	StrongRef<love::sound::Decoder> decoder;
+
+	// Decoded or queued audio, as floats with the Source's channel count.
+	// The first frame in it is frame bufferStart of playback.
+	std::vector<float> buffer;
+	int64 bufferStart = 0;
+
+	// Playback position in frames, fractional when the Source is resampled.
+	double position = 0.0;
+
+	// The playback frame which corresponds to the start of the decoded file
+	// or of the queue, for tell().
+	int64 offsetBase = 0;
+
+	// Playback frames at which a looping stream's decoder was rewound.
+	std::deque<int64> loopPoints;
+
+	// Playback frames at which each queued buffer ends.
+	std::deque<int64> queuedBuffers;
+	int buffers = 0;
+
+	float pitch = 1.0f;
+	float volume = 1.0f;
+	float position3D[3];
+	float velocity[3];
+	float direction[3];
+	bool relative = false;
+	bool looping = false;
+	float minVolume = 0.0f;
+	float maxVolume = 1.0f;
+	float referenceDistance = 1.0f;
+	float rolloffFactor = 1.0f;
+	float maxDistance = FLT_MAX;
+	float absorptionFactor = 0.0f;
+
+	struct Cone
+	{
+		float innerAngle = (float) LOVE_M_PI * 2.0f; // radians
+		float outerAngle = (float) LOVE_M_PI * 2.0f; // radians
+		float outerVolume = 0.0f;
+		float outerHighGain = 1.0f;
+	} cone;
+
+	StreamStats stats;
+
+}; // Source
+
+} // software
+} // audio
+} // love
+
+#endif // LOVE_AUDIO_SOFTWARE_SOURCE_H
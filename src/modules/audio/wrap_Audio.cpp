@@ -23,8 +23,13 @@
 
 #include "openal/Audio.h"
 #include "null/Audio.h"
+#include "software/Audio.h"
 
 #include "common/runtime.h"
+#include "filesystem/Filesystem.h"
+#include "filesystem/wrap_Filesystem.h"
+#include "sound/SoundData.h"
+#include "sound/Decoder.h"
 
 // C++
 #include <iostream>
@@ -43,6 +48,28 @@ int w_getActiveSourceCount(lua_State *L)
 	return 1;
 }
 
+// Files are identified by their path, size and modification time. Other
+// arguments can't be cached, and give an empty key.
+static std::string getCacheKey(lua_State *L, int idx)
+{
+	std::string filename;
+
+	if (lua_isstring(L, idx))
+		filename = lua_tostring(L, idx);
+	else if (luax_istype(L, idx, love::filesystem::File::type))
+		filename = luax_totype<love::filesystem::File>(L, idx)->getFilename();
+	else
+		return std::string();
+
+	auto fs = Module::getInstance<love::filesystem::Filesystem>(Module::M_FILESYSTEM);
+	love::filesystem::Filesystem::Info info = {};
+
+	if (fs == nullptr || !fs->getInfo(filename.c_str(), info))
+		return std::string();
+
+	return filename + ":" + std::to_string(info.size) + ":" + std::to_string(info.modtime);
+}
+
 int w_newSource(lua_State *L)
 {
 	Source::Type stype = Source::TYPE_STREAM;
@@ -57,16 +84,35 @@ int w_newSource(lua_State *L)
 			return luaL_error(L, "Cannot create queueable sources using newSource. Use newQueueableSource instead.");
 	}
 
+	Source *t = nullptr;
+	std::string cachekey;
+
+	if (stype == Source::TYPE_STATIC && instance()->getCacheMemoryBudget() > 0)
+		cachekey = getCacheKey(L, 1);
+
+	// Static Sources of the same file can share already decoded audio.
+	if (!cachekey.empty())
+	{
+		luax_catchexcept(L, [&]() { t = instance()->newCachedSource(cachekey); });
+
+		if (t != nullptr)
+		{
+			luax_pushtype(L, t);
+			t->release();
+			return 1;
+		}
+	}
+
 	if (lua_isstring(L, 1) || luax_istype(L, 1, love::filesystem::File::type) || luax_istype(L, 1, love::filesystem::FileData::type))
 		luax_convobj(L, 1, "sound", "newDecoder");
 
 	if (stype == Source::TYPE_STATIC && luax_istype(L, 1, love::sound::Decoder::type))
 		luax_convobj(L, 1, "sound", "newSoundData");
 
-	Source *t = nullptr;
-
 	luax_catchexcept(L, [&]() {
-		if (luax_istype(L, 1, love::sound::SoundData::type))
+		if (luax_istype(L, 1, love::sound::SoundData::type) && !cachekey.empty())
+			t = instance()->newCachedSource(cachekey, luax_totype<love::sound::SoundData>(L, 1));
+		else if (luax_istype(L, 1, love::sound::SoundData::type))
 			t = instance()->newSource(luax_totype<love::sound::SoundData>(L, 1));
 		else if (luax_istype(L, 1, love::sound::Decoder::type))
 			t = instance()->newSource(luax_totype<love::sound::Decoder>(L, 1));
@@ -530,6 +576,101 @@ int w_setMixWithSystem(lua_State *L)
 	return 1;
 }
 
+int w_setCacheMemoryBudget(lua_State *L)
+{
+	lua_Number bytes = luaL_checknumber(L, 1);
+	instance()->setCacheMemoryBudget((int64) bytes);
+	return 0;
+}
+
+int w_getCacheMemoryBudget(lua_State *L)
+{
+	lua_pushnumber(L, (lua_Number) instance()->getCacheMemoryBudget());
+	return 1;
+}
+
+int w_clearCache(lua_State *)
+{
+	instance()->clearCache();
+	return 0;
+}
+
+int w_getCacheStats(lua_State *L)
+{
+	Audio::CacheStats stats = instance()->getCacheStats();
+
+	if (lua_istable(L, 1))
+		lua_pushvalue(L, 1);
+	else
+		lua_createtable(L, 0, 6);
+
+	lua_pushinteger(L, stats.entries);
+	lua_setfield(L, -2, "entries");
+
+	lua_pushnumber(L, (lua_Number) stats.memory);
+	lua_setfield(L, -2, "memory");
+
+	lua_pushnumber(L, (lua_Number) stats.memoryBudget);
+	lua_setfield(L, -2, "memorybudget");
+
+	lua_pushnumber(L, (lua_Number) stats.hits);
+	lua_setfield(L, -2, "hits");
+
+	lua_pushnumber(L, (lua_Number) stats.misses);
+	lua_setfield(L, -2, "misses");
+
+	lua_pushnumber(L, (lua_Number) stats.evictions);
+	lua_setfield(L, -2, "evictions");
+
+	return 1;
+}
+
+int w_render(lua_State *L)
+{
+	love::sound::SoundData *target = nullptr;
+
+	if (luax_istype(L, 1, love::sound::SoundData::type))
+	{
+		target = luax_checktype<love::sound::SoundData>(L, 1);
+		target->retain();
+	}
+	else
+	{
+		int samples = (int) luaL_checkinteger(L, 1);
+		int sampleRate = (int) luaL_optinteger(L, 2, love::sound::Decoder::DEFAULT_SAMPLE_RATE);
+		int bitDepth = (int) luaL_optinteger(L, 3, love::sound::Decoder::DEFAULT_BIT_DEPTH);
+		int channels = (int) luaL_optinteger(L, 4, love::sound::Decoder::DEFAULT_CHANNELS);
+
+		luax_catchexcept(L, [&]() {
+			target = new love::sound::SoundData(samples, sampleRate, bitDepth, channels);
+		});
+	}
+
+	luax_catchexcept(L,
+		[&]() { instance()->render(target); },
+		[&](bool failed) { if (failed) target->release(); }
+	);
+
+	luax_pushtype(L, target);
+	target->release();
+	return 1;
+}
+
+int w_renderToFile(lua_State *L)
+{
+	int samples = (int) luaL_checkinteger(L, 2);
+	int sampleRate = (int) luaL_optinteger(L, 3, love::sound::Decoder::DEFAULT_SAMPLE_RATE);
+
+	love::filesystem::File *file = love::filesystem::luax_getfile(L, 1);
+
+	luax_catchexcept(L,
+		[&]() { instance()->renderToFile(file, samples, sampleRate); },
+		[&](bool) { file->release(); }
+	);
+
+	return 0;
+}
+
 int w_getSourceCount(lua_State *L)
 {
 	luax_markdeprecated(L, "love.audio.getSourceCount", API_FUNCTION, DEPRECATED_RENAMED, "love.audio.getActiveSourceCount");
@@ -567,6 +708,12 @@ static const luaL_Reg functions[] =
 	{ "getMaxSourceEffects", w_getMaxSourceEffects },
 	{ "isEffectsSupported", w_isEffectsSupported },
 	{ "setMixWithSystem", w_setMixWithSystem },
+	{ "setCacheMemoryBudget", w_setCacheMemoryBudget },
+	{ "getCacheMemoryBudget", w_getCacheMemoryBudget },
+	{ "clearCache", w_clearCache },
+	{ "getCacheStats", w_getCacheStats },
+	{ "render", w_render },
+	{ "renderToFile", w_renderToFile },
 
 	// Deprecated
 	{ "getSourceCount", w_getSourceCount },
@@ -587,14 +734,33 @@ extern "C" int luaopen_love_audio(lua_State *L)
 
 	if (instance == nullptr)
 	{
-		// Try OpenAL first.
-		try
+		const std::string &backend = getRequestedBackend();
+
+		if (!backend.empty() && backend != "openal" && backend != "software" && backend != "null")
+			return luaL_error(L, "Invalid audio backend: %s", backend.c_str());
+
+		if (backend == "software")
 		{
-			instance = new love::audio::openal::Audio();
+			try
+			{
+				instance = new love::audio::software::Audio();
+			}
+			catch(love::Exception &e)
+			{
+				std::cout << e.what() << std::endl;
+			}
 		}
-		catch(love::Exception &e)
+		else if (backend != "null")
 		{
-			std::cout << e.what() << std::endl;
+			// Try OpenAL first.
+			try
+			{
+				instance = new love::audio::openal::Audio();
+			}
+			catch(love::Exception &e)
+			{
+				std::cout << e.what() << std::endl;
+			}
 		}
 	}
 	else
@@ -588,6 +588,28 @@ int w_Source_queue(lua_State *L)
 	return 1;
 }
 
+int w_Source_getStreamStats(lua_State *L)
+{
+	Source *t = luax_checksource(L, 1);
+	Source::StreamStats stats = t->getStreamStats();
+
+	lua_createtable(L, 0, 4);
+
+	lua_pushinteger(L, stats.underruns);
+	lua_setfield(L, -2, "underruns");
+
+	lua_pushnumber(L, stats.decodeTime);
+	lua_setfield(L, -2, "decodetime");
+
+	lua_pushnumber(L, stats.maxDecodeTime);
+	lua_setfield(L, -2, "maxdecodetime");
+
+	lua_pushnumber(L, stats.bufferedTime);
+	lua_setfield(L, -2, "bufferedtime");
+
+	return 1;
+}
+
 int w_Source_getType(lua_State *L)
 {
 	Source *t = luax_checksource(L, 1);
@@ -659,6 +681,7 @@ static const luaL_Reg w_Source_functions[] =
 
 	{ "getFreeBufferCount", w_Source_getFreeBufferCount },
 	{ "queue", w_Source_queue },
+	{ "getStreamStats", w_Source_getStreamStats },
 
 	{ "getType", w_Source_getType },
 
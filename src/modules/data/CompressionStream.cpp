@@ -0,0 +1,981 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "CompressionStream.h"
+#include "common/Exception.h"
+#include "thread/WorkerPool.h"
+
+#include "libraries/lz4/lz4.h"
+#include "libraries/lz4/lz4hc.h"
+#include "libraries/xxHash/xxhash.h"
+
+// C++
+#include <algorithm>
+#include <string.h>
+
+#include <zlib.h>
+
+namespace love
+{
+namespace data
+{
+
+// Byte order helpers. Every multi-byte value in the LZ4 frame and gzip formats
+// is little-endian, and the zlib format's checksum is big-endian.
+
+static inline uint32 readLE32(const char *p)
+{
+	const uint8 *b = (const uint8 *) p;
+	return (uint32) b[0] | ((uint32) b[1] << 8) | ((uint32) b[2] << 16) | ((uint32) b[3] << 24);
+}
+
+static inline void writeLE32(char *p, uint32 v)
+{
+	p[0] = (char) (v & 0xFF);
+	p[1] = (char) ((v >> 8) & 0xFF);
+	p[2] = (char) ((v >> 16) & 0xFF);
+	p[3] = (char) ((v >> 24) & 0xFF);
+}
+
+static inline void writeLE32(std::vector<char> &out, uint32 v)
+{
+	char b[4];
+	writeLE32(b, v);
+	out.insert(out.end(), b, b + 4);
+}
+
+static inline void writeBE32(std::vector<char> &out, uint32 v)
+{
+	char b[4] = {(char) ((v >> 24) & 0xFF), (char) ((v >> 16) & 0xFF), (char) ((v >> 8) & 0xFF), (char) (v & 0xFF)};
+	out.insert(out.end(), b, b + 4);
+}
+
+/**
+ * Splits the input into blocks of BLOCK_SIZE bytes, and compresses batches of
+ * blocks in parallel. Subclasses produce the actual format.
+ **/
+class BlockCompressStream : public CompressionStream
+{
+public:
+
+	BlockCompressStream(Compressor::Format format, int level)
+		: CompressionStream(MODE_COMPRESS, format)
+		, level(level)
+		, wroteHeader(false)
+	{
+	}
+
+	virtual ~BlockCompressStream() {}
+
+	void update(const char *data, size_t size, std::vector<char> &out) override
+	{
+		checkNotFinished();
+
+		if (!wroteHeader)
+		{
+			writeHeader(out);
+			wroteHeader = true;
+		}
+
+		std::vector<Block> blocks;
+
+		// Complete the partial block left over from the last update first.
+		if (!pending.empty())
+		{
+			size_t count = std::min(size, BLOCK_SIZE - pending.size());
+			pending.insert(pending.end(), data, data + count);
+			data += count;
+			size -= count;
+
+			if (pending.size() < BLOCK_SIZE)
+				return;
+
+			blocks.push_back(Block(pending.data(), pending.size(), false));
+		}
+
+		while (size >= BLOCK_SIZE)
+		{
+			blocks.push_back(Block(data, BLOCK_SIZE, false));
+			data += BLOCK_SIZE;
+			size -= BLOCK_SIZE;
+		}
+
+		processBlocks(blocks, out);
+
+		pending.assign(data, data + size);
+	}
+
+	void finish(std::vector<char> &out) override
+	{
+		checkNotFinished();
+
+		if (!wroteHeader)
+		{
+			writeHeader(out);
+			wroteHeader = true;
+		}
+
+		// The last block may be empty, since some formats need an explicit end.
+		std::vector<Block> blocks;
+		blocks.push_back(Block(pending.data(), pending.size(), true));
+		processBlocks(blocks, out);
+
+		pending.clear();
+		writeTrailer(out);
+		finished = true;
+	}
+
+protected:
+
+	struct Block
+	{
+		Block(const char *data, size_t size, bool last)
+			: data(data)
+			, size(size)
+			, last(last)
+			, dictionary(nullptr)
+			, dictionarySize(0)
+			, checksum(0)
+		{}
+
+		const char *data;
+		size_t size;
+		bool last;
+
+		// The input which came right before this block.
+		const char *dictionary;
+		size_t dictionarySize;
+
+		std::vector<char> output;
+		uint32 checksum;
+	};
+
+	// The largest amount of previous input a block can refer to.
+	static const size_t MAX_DICTIONARY_SIZE = 32 * 1024;
+
+	virtual void writeHeader(std::vector<char> &out) = 0;
+	virtual void writeTrailer(std::vector<char> &out) = 0;
+
+	/**
+	 * Called in parallel for the blocks in a batch.
+	 **/
+	virtual void compressBlock(Block &block) = 0;
+
+	/**
+	 * Called in order for each compressed block.
+	 **/
+	virtual void writeBlock(const Block &block, std::vector<char> &out) = 0;
+
+	int level;
+
+private:
+
+	void processBlocks(std::vector<Block> &blocks, std::vector<char> &out)
+	{
+		if (blocks.empty())
+			return;
+
+		auto pool = thread::WorkerPool::getShared();
+
+		// Limit how much compressed output is held at once.
+		size_t batchsize = (size_t) pool->getThreadCount() * 2 + 1;
+
+		for (size_t i = 0; i < blocks.size(); i++)
+		{
+			if (i > 0)
+			{
+				const Block &prev = blocks[i - 1];
+				size_t dictsize = std::min(prev.size, MAX_DICTIONARY_SIZE);
+				blocks[i].dictionary = prev.data + prev.size - dictsize;
+				blocks[i].dictionarySize = dictsize;
+			}
+			else
+			{
+				blocks[i].dictionary = dictionary.data();
+				blocks[i].dictionarySize = dictionary.size();
+			}
+		}
+
+		for (size_t start = 0; start < blocks.size(); start += batchsize)
+		{
+			size_t count = std::min(batchsize, blocks.size() - start);
+
+			pool->parallelFor((int) count, [&](int i)
+			{
+				compressBlock(blocks[start + i]);
+			});
+
+			for (size_t i = start; i < start + count; i++)
+			{
+				writeBlock(blocks[i], out);
+				std::vector<char>().swap(blocks[i].output);
+			}
+		}
+
+		const Block &last = blocks.back();
+		size_t dictsize = std::min(last.size, MAX_DICTIONARY_SIZE);
+		if (dictsize > 0)
+			dictionary.assign(last.data + last.size - dictsize, last.data + last.size);
+	}
+
+	bool wroteHeader;
+
+	std::vector<char> pending;
+	std::vector<char> dictionary;
+
+}; // BlockCompressStream
+
+const size_t BlockCompressStream::MAX_DICTIONARY_SIZE;
+
+/**
+ * Compresses each block as a separate raw deflate stream which uses the end of
+ * the previous block as its dictionary, and ends on a byte boundary without
+ * marking the end of the data. Put together they make one deflate stream.
+ * The same approach is used by pigz.
+ **/
+class DeflateCompressStream : public BlockCompressStream
+{
+public:
+
+	DeflateCompressStream(Compressor::Format format, int level)
+		: BlockCompressStream(format, level < 0 ? Z_DEFAULT_COMPRESSION : std::min(level, 9))
+		, checksum(format == Compressor::FORMAT_ZLIB ? adler32(0, nullptr, 0) : crc32(0, nullptr, 0))
+		, totalSize(0)
+	{
+	}
+
+protected:
+
+	void writeHeader(std::vector<char> &out) override
+	{
+		if (format == Compressor::FORMAT_ZLIB)
+		{
+			// Deflate with a 32 KB window, plus the compression level.
+			uint8 cmf = 0x78;
+			uint8 flevel = 2;
+			if (level == 0 || level == 1)
+				flevel = 0;
+			else if (level >= 2 && level <= 5)
+				flevel = 1;
+			else if (level >= 7)
+				flevel = 3;
+
+			uint8 flg = (uint8) (flevel << 6);
+			flg += (uint8) (31 - ((cmf * 256 + flg) % 31));
+
+			out.push_back((char) cmf);
+			out.push_back((char) flg);
+		}
+		else if (format == Compressor::FORMAT_GZIP)
+		{
+			// Magic number, deflate, no flags, no modification time, extra
+			// flags for the compression level, unknown OS.
+			uint8 xfl = level == 9 ? 2 : (level == 1 ? 4 : 0);
+			const uint8 header[] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, xfl, 0xFF};
+			out.insert(out.end(), (const char *) header, (const char *) header + sizeof(header));
+		}
+	}
+
+	void writeTrailer(std::vector<char> &out) override
+	{
+		if (format == Compressor::FORMAT_ZLIB)
+			writeBE32(out, (uint32) checksum);
+		else if (format == Compressor::FORMAT_GZIP)
+		{
+			writeLE32(out, (uint32) checksum);
+			writeLE32(out, (uint32) (totalSize & 0xFFFFFFFF));
+		}
+	}
+
+	void compressBlock(Block &block) override
+	{
+		if (format == Compressor::FORMAT_ZLIB)
+			block.checksum = (uint32) adler32(adler32(0, nullptr, 0), (const Bytef *) block.data, (uInt) block.size);
+		else if (format == Compressor::FORMAT_GZIP)
+			block.checksum = (uint32) crc32(crc32(0, nullptr, 0), (const Bytef *) block.data, (uInt) block.size);
+
+		z_stream stream = {};
+
+		if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			throw love::Exception("Could not initialize zlib compressor.");
+
+		if (block.dictionarySize > 0)
+			deflateSetDictionary(&stream, (const Bytef *) block.dictionary, (uInt) block.dictionarySize);
+
+		// Room for the sync flush marker, in addition to the usual bound.
+		block.output.resize(deflateBound(&stream, (uLong) block.size) + 16);
+
+		stream.next_in = (Bytef *) block.data;
+		stream.avail_in = (uInt) block.size;
+		stream.next_out = (Bytef *) block.output.data();
+		stream.avail_out = (uInt) block.output.size();
+
+		int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+
+		while (true)
+		{
+			int err = deflate(&stream, flush);
+
+			if (err == Z_STREAM_ERROR)
+			{
+				deflateEnd(&stream);
+				throw love::Exception("Could not zlib/gzip-compress data.");
+			}
+
+			if (block.last ? err == Z_STREAM_END : (stream.avail_in == 0 && stream.avail_out > 0))
+				break;
+
+			if (stream.avail_out == 0)
+			{
+				size_t used = block.output.size();
+				block.output.resize(used * 2);
+				stream.next_out = (Bytef *) block.output.data() + used;
+				stream.avail_out = (uInt) (block.output.size() - used);
+			}
+		}
+
+		block.output.resize(stream.total_out);
+		deflateEnd(&stream);
+	}
+
+	void writeBlock(const Block &block, std::vector<char> &out) override
+	{
+		out.insert(out.end(), block.output.begin(), block.output.end());
+
+		if (format == Compressor::FORMAT_ZLIB)
+			checksum = adler32_combine(checksum, block.checksum, (z_off_t) block.size);
+		else if (format == Compressor::FORMAT_GZIP)
+			checksum = crc32_combine(checksum, block.checksum, (z_off_t) block.size);
+
+		totalSize += block.size;
+	}
+
+private:
+
+	uLong checksum;
+	uint64 totalSize;
+
+}; // DeflateCompressStream
+
+// LZ4 frame format constants.
+static const uint32 LZ4_FRAME_MAGIC = 0x184D2204;
+static const uint32 LZ4_SKIPPABLE_MAGIC = 0x184D2A50; // To 0x184D2A5F.
+static const uint32 LZ4_UNCOMPRESSED_BIT = 0x80000000;
+
+/**
+ * Writes an LZ4 frame with independent blocks and a content checksum.
+ **/
+class LZ4FrameCompressStream : public BlockCompressStream
+{
+public:
+
+	LZ4FrameCompressStream(int level)
+		: BlockCompressStream(Compressor::FORMAT_LZ4_FRAME, level)
+		, contentHash(XXH32_createState())
+	{
+		XXH32_reset(contentHash, 0);
+	}
+
+	virtual ~LZ4FrameCompressStream()
+	{
+		XXH32_freeState(contentHash);
+	}
+
+protected:
+
+	void writeHeader(std::vector<char> &out) override
+	{
+		writeLE32(out, LZ4_FRAME_MAGIC);
+
+		// Version 1, independent blocks, content checksum. 1 MB blocks.
+		const uint8 descriptor[] = {0x64, 0x60};
+		uint8 hc = (uint8) ((XXH32(descriptor, sizeof(descriptor), 0) >> 8) & 0xFF);
+
+		out.push_back((char) descriptor[0]);
+		out.push_back((char) descriptor[1]);
+		out.push_back((char) hc);
+	}
+
+	void writeTrailer(std::vector<char> &out) override
+	{
+		writeLE32(out, 0); // End mark.
+		writeLE32(out, XXH32_digest(contentHash));
+	}
+
+	void compressBlock(Block &block) override
+	{
+		if (block.size == 0)
+			return;
+
+		int maxsize = LZ4_compressBound((int) block.size);
+		block.output.resize(sizeof(uint32) + maxsize);
+		char *dst = block.output.data() + sizeof(uint32);
+
+		// Use LZ4-HC for compression level 9 and higher.
+		int csize = 0;
+		if (level > 8)
+			csize = LZ4_compress_HC(block.data, dst, (int) block.size, maxsize, LZ4HC_CLEVEL_DEFAULT);
+		else
+			csize = LZ4_compress_default(block.data, dst, (int) block.size, maxsize);
+
+		// Blocks which don't get smaller are stored as-is.
+		uint32 header = (uint32) csize;
+		if (csize <= 0 || (size_t) csize >= block.size)
+		{
+			memcpy(dst, block.data, block.size);
+			csize = (int) block.size;
+			header = (uint32) csize | LZ4_UNCOMPRESSED_BIT;
+		}
+
+		writeLE32(block.output.data(), header);
+		block.output.resize(sizeof(uint32) + csize);
+	}
+
+	void writeBlock(const Block &block, std::vector<char> &out) override
+	{
+		out.insert(out.end(), block.output.begin(), block.output.end());
+		XXH32_update(contentHash, block.data, block.size);
+	}
+
+private:
+
+	XXH32_state_t *contentHash;
+
+}; // LZ4FrameCompressStream
+
+/**
+ * Decompresses zlib, gzip (including multiple gzip members) and deflate data.
+ **/
+class InflateStream : public CompressionStream
+{
+public:
+
+	InflateStream(Compressor::Format format)
+		: CompressionStream(MODE_DECOMPRESS, format)
+		, stream()
+		, ended(false)
+		, pendingMagic(false)
+	{
+		// 15 is the default. Adding 32 makes zlib auto-detect the header type.
+		int windowbits = format == Compressor::FORMAT_DEFLATE ? -15 : 15 + 32;
+
+		if (inflateInit2(&stream, windowbits) != Z_OK)
+			throw love::Exception("Could not initialize zlib decompressor.");
+	}
+
+	virtual ~InflateStream()
+	{
+		inflateEnd(&stream);
+	}
+
+	void update(const char *data, size_t size, std::vector<char> &out) override
+	{
+		checkNotFinished();
+
+		while (size > 0)
+		{
+			if (ended)
+			{
+				// Only another gzip member can come after the end of the data.
+				if (format != Compressor::FORMAT_GZIP)
+					throw love::Exception("Could not decompress zlib/gzip-compressed data: unexpected data after the end of the stream.");
+
+				const uint8 *bytes = (const uint8 *) data;
+
+				if (pendingMagic)
+				{
+					if (bytes[0] != 0x8B)
+						throw love::Exception("Could not decompress gzip-compressed data: unexpected data after the end of the stream.");
+
+					inflateReset(&stream);
+					ended = false;
+					pendingMagic = false;
+
+					// The first byte of the member was in the previous update.
+					const char first = (char) 0x1F;
+					inflateData(&first, 1, out);
+				}
+				else
+				{
+					if (bytes[0] != 0x1F || (size > 1 && bytes[1] != 0x8B))
+						throw love::Exception("Could not decompress gzip-compressed data: unexpected data after the end of the stream.");
+
+					if (size == 1)
+					{
+						// The rest of the magic number is in the next update.
+						pendingMagic = true;
+						break;
+					}
+
+					inflateReset(&stream);
+					ended = false;
+				}
+			}
+
+			size_t used = inflateData(data, size, out);
+			data += used;
+			size -= used;
+		}
+	}
+
+	void finish(std::vector<char> &/*out*/) override
+	{
+		checkNotFinished();
+		finished = true;
+
+		if (!ended || pendingMagic)
+			throw love::Exception("Could not decompress zlib/gzip-compressed data: the data is incomplete.");
+	}
+
+private:
+
+	/**
+	 * Decompresses until the input runs out or the end of the stream (or gzip
+	 * member) is reached. Returns the number of bytes used.
+	 **/
+	size_t inflateData(const char *data, size_t size, std::vector<char> &out)
+	{
+		const size_t chunksize = 64 * 1024;
+
+		// avail_in is only 32 bits.
+		size_t insize = std::min(size, (size_t) 1 << 30);
+
+		stream.next_in = (Bytef *) data;
+		stream.avail_in = (uInt) insize;
+
+		while (true)
+		{
+			size_t used = out.size();
+			out.resize(used + chunksize);
+
+			stream.next_out = (Bytef *) out.data() + used;
+			stream.avail_out = (uInt) chunksize;
+
+			int err = inflate(&stream, Z_NO_FLUSH);
+
+			out.resize(used + chunksize - stream.avail_out);
+
+			if (err == Z_STREAM_END)
+			{
+				ended = true;
+				break;
+			}
+			else if (err != Z_OK && err != Z_BUF_ERROR)
+				throw love::Exception("Could not decompress zlib/gzip-compressed data.");
+
+			if (stream.avail_in == 0 && stream.avail_out > 0)
+				break;
+
+			// inflate can't make progress with input and output space left.
+			if (err == Z_BUF_ERROR)
+				throw love::Exception("Could not decompress zlib/gzip-compressed data.");
+		}
+
+		return insize - stream.avail_in;
+	}
+
+	z_stream stream;
+
+	// Whether the end of the stream (or the current gzip member) was reached.
+	bool ended;
+
+	// Whether the first byte of another gzip member's magic number was the
+	// last byte of the previous update.
+	bool pendingMagic;
+
+}; // InflateStream
+
+/**
+ * Decompresses LZ4 frames, including frames with linked blocks, and skips
+ * skippable frames.
+ **/
+class LZ4FrameDecompressStream : public CompressionStream
+{
+public:
+
+	LZ4FrameDecompressStream()
+		: CompressionStream(MODE_DECOMPRESS, Compressor::FORMAT_LZ4_FRAME)
+		, state(STATE_MAGIC)
+		, skipSize(0)
+		, blockMaxSize(0)
+		, linkedBlocks(false)
+		, blockChecksums(false)
+		, contentChecksum(false)
+		, blockSize(0)
+		, blockUncompressed(false)
+		, frames(0)
+		, contentHash(XXH32_createState())
+	{
+	}
+
+	virtual ~LZ4FrameDecompressStream()
+	{
+		XXH32_freeState(contentHash);
+	}
+
+	void update(const char *data, size_t size, std::vector<char> &out) override
+	{
+		checkNotFinished();
+
+		size_t pos = 0;
+
+		// Avoid copying the input when nothing is left over from last time.
+		if (input.empty())
+		{
+			while (parse(data, size, pos, out));
+			input.assign(data + pos, data + size);
+		}
+		else
+		{
+			input.insert(input.end(), data, data + size);
+			while (parse(input.data(), input.size(), pos, out));
+			input.erase(input.begin(), input.begin() + pos);
+		}
+	}
+
+	void finish(std::vector<char> &/*out*/) override
+	{
+		checkNotFinished();
+		finished = true;
+
+		if (state != STATE_MAGIC || !input.empty() || frames == 0)
+			throw love::Exception("Could not decompress LZ4 frame data: the data is incomplete.");
+	}
+
+private:
+
+	enum State
+	{
+		STATE_MAGIC,
+		STATE_SKIP,
+		STATE_HEADER,
+		STATE_BLOCK_SIZE,
+		STATE_BLOCK,
+		STATE_CHECKSUM,
+	};
+
+	static const size_t MAX_WINDOW_SIZE = 64 * 1024;
+
+	/**
+	 * Parses the next part of the input at pos, if enough of it is available.
+	 * Returns false if more input is needed.
+	 **/
+	bool parse(const char *data, size_t size, size_t &pos, std::vector<char> &out)
+	{
+		const char *p = data + pos;
+		size_t available = size - pos;
+
+		switch (state)
+		{
+		case STATE_MAGIC:
+		{
+			if (available < 4)
+				return false;
+
+			uint32 magic = readLE32(p);
+
+			if ((magic & 0xFFFFFFF0) == LZ4_SKIPPABLE_MAGIC)
+			{
+				if (available < 8)
+					return false;
+
+				skipSize = readLE32(p + 4);
+				pos += 8;
+				state = STATE_SKIP;
+			}
+			else if (magic == LZ4_FRAME_MAGIC)
+			{
+				pos += 4;
+				state = STATE_HEADER;
+			}
+			else
+				throw love::Exception("Could not decompress LZ4 frame data: invalid magic number.");
+
+			return true;
+		}
+		case STATE_SKIP:
+		{
+			size_t count = std::min((size_t) skipSize, available);
+			pos += count;
+			skipSize -= (uint32) count;
+
+			if (skipSize > 0)
+				return false;
+
+			state = STATE_MAGIC;
+			return true;
+		}
+		case STATE_HEADER:
+		{
+			if (available < 3)
+				return false;
+
+			uint8 flg = (uint8) p[0];
+			uint8 bd = (uint8) p[1];
+
+			size_t descsize = 2 + ((flg & 0x08) ? 8 : 0) + ((flg & 0x01) ? 4 : 0);
+			if (available < descsize + 1)
+				return false;
+
+			if ((flg >> 6) != 1)
+				throw love::Exception("Could not decompress LZ4 frame data: unsupported version.");
+
+			if (flg & 0x01)
+				throw love::Exception("Could not decompress LZ4 frame data: dictionaries are not supported.");
+
+			uint8 hc = (uint8) ((XXH32(p, descsize, 0) >> 8) & 0xFF);
+			if (hc != (uint8) p[descsize])
+				throw love::Exception("Could not decompress LZ4 frame data: invalid header checksum.");
+
+			int blockcode = (bd >> 4) & 0x7;
+			if (blockcode < 4)
+				throw love::Exception("Could not decompress LZ4 frame data: invalid block size.");
+
+			blockMaxSize = (size_t) 1 << (8 + 2 * blockcode);
+			linkedBlocks = (flg & 0x20) == 0;
+			blockChecksums = (flg & 0x10) != 0;
+			contentChecksum = (flg & 0x04) != 0;
+
+			window.clear();
+			XXH32_reset(contentHash, 0);
+
+			pos += descsize + 1;
+			state = STATE_BLOCK_SIZE;
+			return true;
+		}
+		case STATE_BLOCK_SIZE:
+		{
+			if (available < 4)
+				return false;
+
+			uint32 word = readLE32(p);
+			pos += 4;
+
+			if (word == 0)
+			{
+				// End mark.
+				if (contentChecksum)
+					state = STATE_CHECKSUM;
+				else
+				{
+					frames++;
+					state = STATE_MAGIC;
+				}
+				return true;
+			}
+
+			blockUncompressed = (word & LZ4_UNCOMPRESSED_BIT) != 0;
+			blockSize = word & ~LZ4_UNCOMPRESSED_BIT;
+
+			if (blockSize > blockMaxSize)
+				throw love::Exception("Could not decompress LZ4 frame data: invalid block size.");
+
+			state = STATE_BLOCK;
+			return true;
+		}
+		case STATE_BLOCK:
+		{
+			size_t needed = blockSize + (blockChecksums ? 4 : 0);
+			if (available < needed)
+				return false;
+
+			if (blockChecksums && XXH32(p, blockSize, 0) != readLE32(p + blockSize))
+				throw love::Exception("Could not decompress LZ4 frame data: invalid block checksum.");
+
+			size_t used = out.size();
+			size_t decodedsize = 0;
+
+			if (blockUncompressed)
+			{
+				out.insert(out.end(), p, p + blockSize);
+				decodedsize = blockSize;
+			}
+			else
+			{
+				out.resize(used + blockMaxSize);
+				char *dst = out.data() + used;
+
+				int result = 0;
+				if (linkedBlocks && !window.empty())
+					result = LZ4_decompress_safe_usingDict(p, dst, (int) blockSize, (int) blockMaxSize, window.data(), (int) window.size());
+				else
+					result = LZ4_decompress_safe(p, dst, (int) blockSize, (int) blockMaxSize);
+
+				if (result < 0)
+					throw love::Exception("Could not decompress LZ4 frame data.");
+
+				decodedsize = (size_t) result;
+				out.resize(used + decodedsize);
+			}
+
+			const char *decoded = out.data() + used;
+
+			if (contentChecksum)
+				XXH32_update(contentHash, decoded, decodedsize);
+
+			// Linked blocks can refer to the previous 64 KB of output.
+			if (linkedBlocks)
+			{
+				window.insert(window.end(), decoded, decoded + decodedsize);
+				if (window.size() > MAX_WINDOW_SIZE)
+					window.erase(window.begin(), window.end() - MAX_WINDOW_SIZE);
+			}
+
+			pos += needed;
+			state = STATE_BLOCK_SIZE;
+			return true;
+		}
+		case STATE_CHECKSUM:
+		{
+			if (available < 4)
+				return false;
+
+			if (XXH32_digest(contentHash) != readLE32(p))
+				throw love::Exception("Could not decompress LZ4 frame data: invalid content checksum.");
+
+			pos += 4;
+			frames++;
+			state = STATE_MAGIC;
+			return true;
+		}
+		}
+
+		return false;
+	}
+
+	State state;
+	std::vector<char> input;
+
+	uint32 skipSize;
+
+	size_t blockMaxSize;
+	bool linkedBlocks;
+	bool blockChecksums;
+	bool contentChecksum;
+
+	size_t blockSize;
+	bool blockUncompressed;
+
+	int frames;
+
+	std::vector<char> window;
+	XXH32_state_t *contentHash;
+
+}; // LZ4FrameDecompressStream
+
+const size_t LZ4FrameDecompressStream::MAX_WINDOW_SIZE;
+
+love::Type CompressionStream::type("CompressionStream", &Object::type);
+
+const size_t CompressionStream::BLOCK_SIZE;
+
+CompressionStream::CompressionStream(Mode mode, Compressor::Format format)
+	: mode(mode)
+	, format(format)
+	, finished(false)
+{
+}
+
+CompressionStream::~CompressionStream()
+{
+}
+
+CompressionStream *CompressionStream::create(Mode mode, Compressor::Format format, int level)
+{
+	if (!isSupported(format))
+		throw love::Exception("The lz4 format can't be used with a CompressionStream (use lz4frame instead).");
+
+	if (mode == MODE_COMPRESS)
+	{
+		if (format == Compressor::FORMAT_LZ4_FRAME)
+			return new LZ4FrameCompressStream(level);
+		else
+			return new DeflateCompressStream(format, level);
+	}
+	else
+	{
+		if (format == Compressor::FORMAT_LZ4_FRAME)
+			return new LZ4FrameDecompressStream();
+		else
+			return new InflateStream(format);
+	}
+}
+
+bool CompressionStream::isSupported(Compressor::Format format)
+{
+	switch (format)
+	{
+	case Compressor::FORMAT_ZLIB:
+	case Compressor::FORMAT_GZIP:
+	case Compressor::FORMAT_DEFLATE:
+	case Compressor::FORMAT_LZ4_FRAME:
+		return true;
+	default:
+		return false;
+	}
+}
+
+CompressionStream::Mode CompressionStream::getMode() const
+{
+	return mode;
+}
+
+Compressor::Format CompressionStream::getFormat() const
+{
+	return format;
+}
+
+bool CompressionStream::isFinished() const
+{
+	return finished;
+}
+
+void CompressionStream::checkNotFinished() const
+{
+	if (finished)
+		throw love::Exception("The CompressionStream has already been finished.");
+}
+
+static StringMap<CompressionStream::Mode, CompressionStream::MODE_MAX_ENUM>::Entry modeEntries[] =
+{
+	{ "compress",   CompressionStream::MODE_COMPRESS   },
+	{ "decompress", CompressionStream::MODE_DECOMPRESS },
+};
+
+static StringMap<CompressionStream::Mode, CompressionStream::MODE_MAX_ENUM> modes(modeEntries, sizeof(modeEntries));
+
+bool CompressionStream::getConstant(const char *in, Mode &out)
+{
+	return modes.find(in, out);
+}
+
+bool CompressionStream::getConstant(Mode in, const char *&out)
+{
+	return modes.find(in, out);
+}
+
+std::vector<std::string> CompressionStream::getConstants(Mode)
+{
+	return modes.getNames();
+}
+
+} // data
+} // love
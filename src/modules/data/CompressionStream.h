@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/Object.h"
+#include "common/StringMap.h"
+#include "common/int.h"
+#include "Compressor.h"
+
+// C++
+#include <vector>
+#include <string>
+
+namespace love
+{
+namespace data
+{
+
+/**
+ * Compresses or decompresses data which is given in pieces, producing output
+ * as it goes, so large data doesn't need to be held in memory all at once.
+ *
+ * Compression splits the input into independent blocks, which are compressed
+ * in parallel on the shared worker pool. zlib, gzip and deflate blocks still
+ * produce a single standard stream, and lz4frame produces the standard LZ4
+ * frame format. The lz4 format can't be streamed.
+ *
+ * A CompressionStream must not be used by more than one thread at a time.
+ **/
+class CompressionStream : public love::Object
+{
+public:
+
+	static love::Type type;
+
+	enum Mode
+	{
+		MODE_COMPRESS,
+		MODE_DECOMPRESS,
+		MODE_MAX_ENUM
+	};
+
+	// The amount of input in each independently compressed block.
+	static const size_t BLOCK_SIZE = 1024 * 1024;
+
+	/**
+	 * @param level The amount of compression to apply (between 0 and 9), or -1
+	 *        for the default. Ignored when decompressing.
+	 **/
+	static CompressionStream *create(Mode mode, Compressor::Format format, int level = -1);
+
+	/**
+	 * Gets whether a format can be used with a CompressionStream.
+	 **/
+	static bool isSupported(Compressor::Format format);
+
+	virtual ~CompressionStream();
+
+	/**
+	 * Processes more input, and appends any output that is ready to out.
+	 **/
+	virtual void update(const char *data, size_t size, std::vector<char> &out) = 0;
+
+	/**
+	 * Processes the remaining buffered input and appends the rest of the output
+	 * to out. The stream can't be updated afterwards. When decompressing, this
+	 * throws if the compressed data was incomplete.
+	 **/
+	virtual void finish(std::vector<char> &out) = 0;
+
+	Mode getMode() const;
+	Compressor::Format getFormat() const;
+	bool isFinished() const;
+
+	static bool getConstant(const char *in, Mode &out);
+	static bool getConstant(Mode in, const char *&out);
+	static std::vector<std::string> getConstants(Mode);
+
+protected:
+
+	CompressionStream(Mode mode, Compressor::Format format);
+
+	void checkNotFinished() const;
+
+	Mode mode;
+	Compressor::Format format;
+	bool finished;
+
+}; // CompressionStream
+
+} // data
+} // love
@@ -20,8 +20,10 @@
 
 // LOVE
 #include "Compressor.h"
+#include "CompressionStream.h"
 #include "common/config.h"
 #include "common/int.h"
+#include "thread/WorkerPool.h"
 
 #include "libraries/lz4/lz4.h"
 #include "libraries/lz4/lz4hc.h"
@@ -262,6 +264,10 @@ class zlibCompressor : public Compressor
 		if (!isSupported(format))
 			throw love::Exception("Invalid format (expecting zlib or gzip)");
 
+		// Large data is compressed in blocks on multiple threads.
+		if (dataSize >= CompressionStream::BLOCK_SIZE * 2 && thread::WorkerPool::getShared()->getThreadCount() > 0)
+			return compressStream(format, data, dataSize, level, compressedSize);
+
 		if (level < 0)
 			level = Z_DEFAULT_COMPRESSION;
 		else if (level > 9)
@@ -358,12 +364,82 @@ class zlibCompressor : public Compressor
 
 }; // zlibCompressor
 
+
+class LZ4FrameCompressor : public Compressor
+{
+public:
+
+	char *compress(Format format, const char *data, size_t dataSize, int level, size_t &compressedSize) override
+	{
+		if (format != FORMAT_LZ4_FRAME)
+			throw love::Exception("Invalid format (expecting LZ4 frame)");
+
+		return compressStream(format, data, dataSize, level, compressedSize);
+	}
+
+	char *decompress(Format format, const char *data, size_t dataSize, size_t &decompressedSize) override
+	{
+		if (format != FORMAT_LZ4_FRAME)
+			throw love::Exception("Invalid format (expecting LZ4 frame)");
+
+		StrongRef<CompressionStream> stream(CompressionStream::create(CompressionStream::MODE_DECOMPRESS, format), Acquire::NORETAIN);
+
+		std::vector<char> output;
+		output.reserve(decompressedSize);
+
+		stream->update(data, dataSize, output);
+		stream->finish(output);
+
+		decompressedSize = output.size();
+		return copyBytes(output);
+	}
+
+	bool isSupported(Format format) const override
+	{
+		return format == FORMAT_LZ4_FRAME;
+	}
+
+}; // LZ4FrameCompressor
+
+char *Compressor::compressStream(Format format, const char *data, size_t dataSize, int level, size_t &compressedSize)
+{
+	StrongRef<CompressionStream> stream(CompressionStream::create(CompressionStream::MODE_COMPRESS, format, level), Acquire::NORETAIN);
+
+	std::vector<char> output;
+	stream->update(data, dataSize, output);
+	stream->finish(output);
+
+	compressedSize = output.size();
+	return copyBytes(output);
+}
+
+char *Compressor::copyBytes(const std::vector<char> &bytes)
+{
+	char *result = nullptr;
+
+	try
+	{
+		// new[] of size 0 is valid and returns a unique pointer.
+		result = new char[bytes.size()];
+	}
+	catch (std::bad_alloc &)
+	{
+		throw love::Exception("Out of memory.");
+	}
+
+	if (!bytes.empty())
+		memcpy(result, bytes.data(), bytes.size());
+
+	return result;
+}
+
 Compressor *Compressor::getCompressor(Format format)
 {
 	static LZ4Compressor lz4compressor;
 	static zlibCompressor zlibcompressor;
+	static LZ4FrameCompressor lz4framecompressor;
 
-	Compressor *compressors[] = {&lz4compressor, &zlibcompressor};
+	Compressor *compressors[] = {&lz4compressor, &zlibcompressor, &lz4framecompressor};
 
 	for (Compressor *c : compressors)
 	{
@@ -391,10 +467,11 @@ std::vector<std::string> Compressor::getConstants(Format)
 
 StringMap<Compressor::Format, Compressor::FORMAT_MAX_ENUM>::Entry Compressor::formatEntries[] =
 {
-	{ "lz4",     FORMAT_LZ4     },
-	{ "zlib",    FORMAT_ZLIB    },
-	{ "gzip",    FORMAT_GZIP    },
-	{ "deflate", FORMAT_DEFLATE },
+	{ "lz4",      FORMAT_LZ4       },
+	{ "zlib",     FORMAT_ZLIB      },
+	{ "gzip",     FORMAT_GZIP      },
+	{ "deflate",  FORMAT_DEFLATE   },
+	{ "lz4frame", FORMAT_LZ4_FRAME },
 };
 
 StringMap<Compressor::Format, Compressor::FORMAT_MAX_ENUM> Compressor::formatNames(Compressor::formatEntries, sizeof(Compressor::formatEntries));
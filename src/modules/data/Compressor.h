@@ -41,6 +41,7 @@ class Compressor
 		FORMAT_ZLIB,
 		FORMAT_GZIP,
 		FORMAT_DEFLATE,
+		FORMAT_LZ4_FRAME, // Standard LZ4 frame format, without a size limit.
 		FORMAT_MAX_ENUM
 	};
 
@@ -94,6 +95,17 @@ class Compressor
 
 	Compressor() {}
 
+	/**
+	 * Compresses data with a CompressionStream, which uses multiple threads for
+	 * large data.
+	 **/
+	static char *compressStream(Format format, const char *data, size_t dataSize, int level, size_t &compressedSize);
+
+	/**
+	 * Copies bytes into a new[]-allocated array.
+	 **/
+	static char *copyBytes(const std::vector<char> &bytes);
+
 private:
 
 	static StringMap<Format, FORMAT_MAX_ENUM>::Entry formatEntries[];
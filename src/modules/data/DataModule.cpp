@@ -241,6 +241,26 @@ ByteData *DataModule::newByteData(void *d, size_t size, bool own)
 	return new ByteData(d, size, own);
 }
 
+SharedByteData *DataModule::newSharedByteData(size_t size)
+{
+	return new SharedByteData(size);
+}
+
+SharedByteData *DataModule::newSharedByteData(const void *d, size_t size)
+{
+	return new SharedByteData(d, size);
+}
+
+CompressionStream *DataModule::newCompressionStream(CompressionStream::Mode mode, Compressor::Format format, int level)
+{
+	return CompressionStream::create(mode, format, level);
+}
+
+Hasher *DataModule::newHasher(HashFunction::Function function)
+{
+	return new Hasher(function);
+}
+
 static StringMap<EncodeFormat, ENCODE_MAX_ENUM>::Entry encoderEntries[] =
 {
 	{ "base64", ENCODE_BASE64 },
@@ -22,9 +22,12 @@
 
 #include "CompressedData.h"
 #include "Compressor.h"
+#include "CompressionStream.h"
 #include "HashFunction.h"
+#include "Hasher.h"
 #include "DataView.h"
 #include "ByteData.h"
+#include "SharedByteData.h"
 
 // LOVE
 #include "common/Module.h"
@@ -125,6 +128,10 @@ class DataModule : public Module
 	ByteData *newByteData(size_t size);
 	ByteData *newByteData(const void *d, size_t size);
 	ByteData *newByteData(void *d, size_t size, bool own);
+	SharedByteData *newSharedByteData(size_t size);
+	SharedByteData *newSharedByteData(const void *d, size_t size);
+	CompressionStream *newCompressionStream(CompressionStream::Mode mode, Compressor::Format format, int level);
+	Hasher *newHasher(HashFunction::Function function);
 
 }; // DataModule
 
@@ -19,12 +19,38 @@
  **/
 
 #include "HashFunction.h"
+#include "libraries/xxHash/xxhash.h"
+
+// C++
+#include <algorithm>
+#include <memory>
 
 // FIXME: Probably trivial by having tole and tobe functions, which can be ifdeffed to being identity functions
 #ifdef LOVE_BIG_ENDIAN
 #	error Hashing not yet implemented for big endian
 #endif
 
+// Hardware SHA-1 and SHA-256 instructions. The x86 SHA extensions are checked
+// for at runtime, the ARMv8 crypto extensions only when the compiler has been
+// told they're available.
+#if defined(LOVE_SIMD_SSE) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#	define LOVE_HASH_SHA_X86
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#	if defined(__GNUC__) || defined(__clang__)
+#		define LOVE_TARGET_SHA __attribute__((target("sha,sse4.1")))
+#	else
+#		define LOVE_TARGET_SHA
+#	endif
+#elif defined(LOVE_SIMD_NEON) && defined(__ARM_FEATURE_CRYPTO)
+#	define LOVE_HASH_SHA_ARM
+#	include <arm_neon.h>
+#endif
+
 namespace love
 {
 namespace data
@@ -50,6 +76,161 @@ inline uint64 rightrot(uint64 x, uint8 amount)
 	return (x >> amount) | (x << (64 - amount));
 }
 
+inline uint32 loadLE32(const uint8 *p)
+{
+	uint32 x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+inline uint32 loadBE32(const uint8 *p)
+{
+	return ((uint32) p[0] << 24) | ((uint32) p[1] << 16) | ((uint32) p[2] << 8) | (uint32) p[3];
+}
+
+inline uint64 loadBE64(const uint8 *p)
+{
+	return ((uint64) loadBE32(p) << 32) | loadBE32(p + 4);
+}
+
+inline void storeBE32(char *p, uint32 x)
+{
+	for (int i = 0; i < 4; i++)
+		p[i] = (x >> (24 - i * 8)) & 0xFF;
+}
+
+inline void storeBE64(char *p, uint64 x)
+{
+	for (int i = 0; i < 8; i++)
+		p[i] = (x >> (56 - i * 8)) & 0xFF;
+}
+
+#ifdef LOVE_HASH_SHA_X86
+
+bool hasSHAExtensions()
+{
+	static const bool supported = []()
+	{
+		unsigned int ecx1 = 0;
+		unsigned int ebx7 = 0;
+
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		ecx1 = (unsigned int) info[2];
+		__cpuidex(info, 7, 0);
+		ebx7 = (unsigned int) info[1];
+#else
+		unsigned int eax, ebx, ecx, edx;
+		if (__get_cpuid_max(0, nullptr) < 7)
+			return false;
+		__cpuid(1, eax, ebx, ecx, edx);
+		ecx1 = ecx;
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		ebx7 = ebx;
+#endif
+
+		bool ssse3 = (ecx1 & (1u << 9)) != 0;
+		bool sse41 = (ecx1 & (1u << 19)) != 0;
+		bool sha = (ebx7 & (1u << 29)) != 0;
+		return ssse3 && sse41 && sha;
+	}();
+
+	return supported;
+}
+
+#endif // LOVE_HASH_SHA_X86
+
+/**
+ * Input buffering and padding shared by MD5, SHA1 and SHA2. Whole blocks are
+ * processed straight from the input, so only the partial blocks at either end
+ * of an update are copied.
+ **/
+template <size_t blockSize, bool bigEndian>
+class BlockState : public HashFunction::State
+{
+public:
+
+	BlockState()
+		: buffered(0)
+		, length(0)
+	{
+	}
+
+	void update(const char *input, uint64 size) override
+	{
+		const uint8 *bytes = (const uint8 *) input;
+		length += size;
+
+		if (buffered > 0)
+		{
+			size_t count = (size_t) std::min<uint64>(size, blockSize - buffered);
+			memcpy(buffer + buffered, bytes, count);
+			buffered += count;
+			bytes += count;
+			size -= count;
+
+			if (buffered < blockSize)
+				return;
+
+			processBlocks(buffer, 1);
+			buffered = 0;
+		}
+
+		size_t blocks = (size_t) (size / blockSize);
+		if (blocks > 0)
+		{
+			processBlocks(bytes, blocks);
+			bytes += blocks * blockSize;
+			size -= blocks * blockSize;
+		}
+
+		memcpy(buffer, bytes, (size_t) size);
+		buffered = (size_t) size;
+	}
+
+	void finish(HashFunction::Value &output) override
+	{
+		// The message is followed by a set bit, zeroes, and then its length in
+		// bits at the end of the last block. SHA-384 and SHA-512 reserve 16
+		// bytes for the length, but only the lower 8 can be non-zero here.
+		const size_t lengthSize = blockSize / 8;
+		uint64 bits = length * 8;
+
+		buffer[buffered++] = 0x80;
+		if (buffered > blockSize - lengthSize)
+		{
+			memset(buffer + buffered, 0, blockSize - buffered);
+			processBlocks(buffer, 1);
+			buffered = 0;
+		}
+
+		memset(buffer + buffered, 0, blockSize - 8 - buffered);
+		for (int i = 0; i < 8; i++)
+			buffer[blockSize - 8 + i] = (bits >> (bigEndian ? 56 - i * 8 : i * 8)) & 0xFF;
+
+		processBlocks(buffer, 1);
+		buffered = 0;
+
+		digest(output);
+	}
+
+protected:
+
+	virtual void processBlocks(const uint8 *blocks, size_t count) = 0;
+	virtual void digest(HashFunction::Value &output) = 0;
+
+private:
+
+	uint8 buffer[blockSize];
+	size_t buffered;
+	uint64 length;
+
+}; // BlockState
+
 /**
  * The following implementation is based on the pseudocode provided by multiple
  * authors on wikipedia: https://en.wikipedia.org/wiki/MD5
@@ -63,92 +244,92 @@ class MD5 : public HashFunction
 	static const uint8 shifts[64];
 	static const uint32 constants[64];
 
-public:
-	bool isSupported(Function function) const override
+	class MD5State : public BlockState<64, false>
 	{
-		return function == FUNCTION_MD5;
-	}
-
-	void hash(Function function, const char *input, uint64 length, Value &output) const override
-	{
-		if (function != FUNCTION_MD5)
-			throw love::Exception("Hash function not supported by MD5 implementation");
-
-		uint32 a0 = 0x67452301;
-		uint32 b0 = 0xefcdab89;
-		uint32 c0 = 0x98badcfe;
-		uint32 d0 = 0x10325476;
-
-		//Do the required padding (MD5, SHA1 and SHA2 use the same padding)
-		uint64 paddedLength = length + 1; //Consider the appended bit
-		if (paddedLength % 64 < 56)
-			paddedLength += 56 - paddedLength % 64;
-		if (paddedLength % 64 > 56)
-			paddedLength += 120 - paddedLength % 64;
-
-		uint8 *padded = new uint8[paddedLength + 8];
-		memcpy(padded, input, length);
-		memset(padded + length, 0, paddedLength - length);
-		padded[length] = 0x80;
+	public:
 
-		//Now we need the length in bits
-		*((uint64*) &padded[paddedLength]) = length * 8;
-		paddedLength += 8;
-
-		for (uint64 i = 0; i < paddedLength; i += 64)
+		MD5State()
+			: intermediate {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476}
 		{
-			uint32 *chunk = (uint32*) &padded[i];
+		}
 
-			uint32 A = a0;
-			uint32 B = b0;
-			uint32 C = c0;
-			uint32 D = d0;
-			uint32 F;
-			uint32 g;
+	protected:
 
-			for (int j = 0; j < 64; j++)
+		void processBlocks(const uint8 *blocks, size_t count) override
+		{
+			for (size_t i = 0; i < count; i++, blocks += 64)
 			{
-				if (j < 16)
-				{
-					F = (B & C) | (~B & D);
-					g = j;
-				}
-				else if (j < 32)
-				{
-					F = (D & B) | (~D & C);
-					g = (5*j + 1) % 16;
-				}
-				else if (j < 48)
-				{
-					F = B ^ C ^ D;
-					g = (3*j + 5) % 16;
-				}
-				else
+				uint32 chunk[16];
+				for (int j = 0; j < 16; j++)
+					chunk[j] = loadLE32(blocks + j * 4);
+
+				uint32 A = intermediate[0];
+				uint32 B = intermediate[1];
+				uint32 C = intermediate[2];
+				uint32 D = intermediate[3];
+				uint32 F;
+				uint32 g;
+
+				for (int j = 0; j < 64; j++)
 				{
-					F = C ^ (B | ~D);
-					g = (7*j) % 16;
+					if (j < 16)
+					{
+						F = (B & C) | (~B & D);
+						g = j;
+					}
+					else if (j < 32)
+					{
+						F = (D & B) | (~D & C);
+						g = (5*j + 1) % 16;
+					}
+					else if (j < 48)
+					{
+						F = B ^ C ^ D;
+						g = (3*j + 5) % 16;
+					}
+					else
+					{
+						F = C ^ (B | ~D);
+						g = (7*j) % 16;
+					}
+
+					uint32 temp = D;
+					D = C;
+					C = B;
+					B += leftrot(A + F + constants[j] + chunk[g], shifts[j]);
+					A = temp;
 				}
 
-				uint32 temp = D;
-				D = C;
-				C = B;
-				B += leftrot(A + F + constants[j] + chunk[g], shifts[j]);
-				A = temp;
+				intermediate[0] += A;
+				intermediate[1] += B;
+				intermediate[2] += C;
+				intermediate[3] += D;
 			}
+		}
 
-			a0 += A;
-			b0 += B;
-			c0 += C;
-			d0 += D;
+		void digest(Value &output) override
+		{
+			memcpy(output.data, intermediate, 16);
+			output.size = 16;
 		}
 
-		delete[] padded;
+	private:
+
+		uint32 intermediate[4];
+	};
 
-		memcpy(&output.data[ 0], &a0, 4);
-		memcpy(&output.data[ 4], &b0, 4);
-		memcpy(&output.data[ 8], &c0, 4);
-		memcpy(&output.data[12], &d0, 4);
-		output.size = 16;
+public:
+	bool isSupported(Function function) const override
+	{
+		return function == FUNCTION_MD5;
+	}
+
+	State *newState(Function function) const override
+	{
+		if (function != FUNCTION_MD5)
+			throw love::Exception("Hash function not supported by MD5 implementation");
+
+		return new MD5State();
 	}
 } md5;
 
@@ -185,99 +366,204 @@ const uint32 MD5::constants[64] = {
  **/
 class SHA1 : public HashFunction
 {
-public:
-	bool isSupported(Function function) const override
-	{
-		return function == FUNCTION_SHA1;
-	}
+private:
 
-	void hash(Function function, const char *input, uint64 length, Value &output) const override
+	class SHA1State : public BlockState<64, true>
 	{
-		if (function != FUNCTION_SHA1)
-			throw love::Exception("Hash function not supported by SHA1 implementation");
+	public:
 
-		uint32 intermediate[5] = {
-			0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
-		};
+		SHA1State()
+			: intermediate {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0}
+		{
+		}
 
-		//Do the required padding (MD5, SHA1 and SHA2 use the same padding)
-		uint64 paddedLength = length + 1; //Consider the appended bit
-		if (paddedLength % 64 < 56)
-			paddedLength += 56 - paddedLength % 64;
-		if (paddedLength % 64 > 56)
-			paddedLength += 120 - paddedLength % 64;
+	protected:
 
-		uint8 *padded = new uint8[paddedLength + 8];
-		memcpy(padded, input, length);
-		memset(padded + length, 0, paddedLength - length);
-		padded[length] = 0x80;
+		void processBlocks(const uint8 *blocks, size_t count) override
+		{
+#if defined(LOVE_HASH_SHA_ARM)
+			processBlocksARM(intermediate, blocks, count);
+#else
+#	if defined(LOVE_HASH_SHA_X86)
+			if (hasSHAExtensions())
+			{
+				processBlocksX86(intermediate, blocks, count);
+				return;
+			}
+#	endif
+			// Allocate our extended words
+			uint32 words[80];
 
-		// Now we need the length in bits (big endian)
-		length *= 8;
-		for (int i = 0; i < 8; ++i, ++paddedLength)
-			padded[paddedLength] = (length >> (56 - i * 8)) & 0xFF;
+			for (size_t i = 0; i < count; i++, blocks += 64)
+			{
+				for (int j = 0; j < 16; j++)
+					words[j] = loadBE32(blocks + j * 4);
+				for (int j = 16; j < 80; j++)
+					words[j] = leftrot(words[j-3] ^ words[j-8] ^ words[j-14] ^ words[j-16], 1);
+
+				uint32 A = intermediate[0];
+				uint32 B = intermediate[1];
+				uint32 C = intermediate[2];
+				uint32 D = intermediate[3];
+				uint32 E = intermediate[4];
+
+				for (int j = 0; j < 80; j++)
+				{
+					uint32 temp = leftrot(A, 5) + E + words[j];
+
+					if (j < 20)
+						temp += 0x5A827999 + ((B & C) | (~B & D));
+					else if (j < 40)
+						temp += 0x6ED9EBA1 + (B ^ C ^ D);
+					else if (j < 60)
+						temp += 0x8F1BBCDC + ((B & C) | (B & D) | (C & D));
+					else
+						temp += 0xCA62C1D6 + (B ^ C ^ D);
+
+					E = D;
+					D = C;
+					C = leftrot(B, 30);
+					B = A;
+					A = temp;
+				}
 
-		// Allocate our extended words
-		uint32 words[80];
+				intermediate[0] += A;
+				intermediate[1] += B;
+				intermediate[2] += C;
+				intermediate[3] += D;
+				intermediate[4] += E;
+			}
+#endif
+		}
 
-		for (uint64 i = 0; i < paddedLength; i += 64)
+		void digest(Value &output) override
 		{
-			uint32 *chunk = (uint32*) &padded[i];
-			for (int j = 0; j < 16; j++)
-			{
-				char *c = (char*) &words[j];
-				c[0] = (chunk[j] >> 24) & 0xFF;
-				c[1] = (chunk[j] >> 16) & 0xFF;
-				c[2] = (chunk[j] >>  8) & 0xFF;
-				c[3] = (chunk[j] >>  0) & 0xFF;
-			}
-			for (int j = 16; j < 80; j++)
-				words[j] = leftrot(words[j-3] ^ words[j-8] ^ words[j-14] ^ words[j-16], 1);
+			for (int i = 0; i < 5; i++)
+				storeBE32(&output.data[i * 4], intermediate[i]);
+
+			output.size = 20;
+		}
+
+	private:
+
+		uint32 intermediate[5];
+	};
+
+#if defined(LOVE_HASH_SHA_X86)
 
-			uint32 A = intermediate[0];
-			uint32 B = intermediate[1];
-			uint32 C = intermediate[2];
-			uint32 D = intermediate[3];
-			uint32 E = intermediate[4];
+	LOVE_TARGET_SHA
+	static void processBlocksX86(uint32 *state, const uint8 *blocks, size_t count)
+	{
+		const __m128i mask = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state), 0x1B);
+		__m128i e0 = _mm_set_epi32((int) state[4], 0, 0, 0);
+
+		for (size_t i = 0; i < count; i++, blocks += 64)
+		{
+			const __m128i abcdSave = abcd;
+			const __m128i e0Save = e0;
+
+			__m128i msg[4];
+			__m128i e = e0;
+			__m128i prev = abcd;
 
-			for (int j = 0; j < 80; j++)
+			// 4 rounds at a time, with the message schedule computed 4 words
+			// ahead in a ring buffer.
+			for (int j = 0; j < 20; j++)
 			{
-				uint32 temp = leftrot(A, 5) + E + words[j];
-
-				if (j < 20)
-					temp += 0x5A827999 + ((B & C) | (~B & D));
-				else if (j < 40)
-					temp += 0x6ED9EBA1 + (B ^ C ^ D);
-				else if (j < 60)
-					temp += 0x8F1BBCDC + ((B & C) | (B & D) | (C & D));
+				__m128i &w = msg[j & 3];
+
+				if (j < 4)
+					w = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (blocks + j * 16)), mask);
 				else
-					temp += 0xCA62C1D6 + (B ^ C ^ D);
+				{
+					__m128i t = _mm_sha1msg1_epu32(w, msg[(j + 1) & 3]);
+					t = _mm_xor_si128(t, msg[(j + 2) & 3]);
+					w = _mm_sha1msg2_epu32(t, msg[(j + 3) & 3]);
+				}
+
+				e = j == 0 ? _mm_add_epi32(e0, w) : _mm_sha1nexte_epu32(prev, w);
+				prev = abcd;
 
-				E = D;
-				D = C;
-				C = leftrot(B, 30);
-				B = A;
-				A = temp;
+				switch (j / 5)
+				{
+				case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+				case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+				case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+				default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+				}
 			}
 
-			intermediate[0] += A;
-			intermediate[1] += B;
-			intermediate[2] += C;
-			intermediate[3] += D;
-			intermediate[4] += E;
+			e0 = _mm_sha1nexte_epu32(prev, e0Save);
+			abcd = _mm_add_epi32(abcd, abcdSave);
 		}
 
-		delete[] padded;
+		_mm_storeu_si128((__m128i *) state, _mm_shuffle_epi32(abcd, 0x1B));
+		state[4] = (uint32) _mm_extract_epi32(e0, 3);
+	}
+
+#elif defined(LOVE_HASH_SHA_ARM)
+
+	static void processBlocksARM(uint32 *state, const uint8 *blocks, size_t count)
+	{
+		static const uint32 K[4] = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+
+		uint32x4_t abcd = vld1q_u32(state);
+		uint32 e0 = state[4];
 
-		for (int i = 0; i < 20; i += 4)
+		for (size_t i = 0; i < count; i++, blocks += 64)
 		{
-			output.data[i+0] = (intermediate[i/4] >> 24) & 0xFF;
-			output.data[i+1] = (intermediate[i/4] >> 16) & 0xFF;
-			output.data[i+2] = (intermediate[i/4] >>  8) & 0xFF;
-			output.data[i+3] = (intermediate[i/4] >>  0) & 0xFF;
+			const uint32x4_t abcdSave = abcd;
+			const uint32 e0Save = e0;
+
+			uint32x4_t msg[4];
+			uint32 e = e0;
+
+			for (int j = 0; j < 20; j++)
+			{
+				uint32x4_t &w = msg[j & 3];
+
+				if (j < 4)
+					w = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + j * 16)));
+				else
+					w = vsha1su1q_u32(vsha1su0q_u32(w, msg[(j + 1) & 3], msg[(j + 2) & 3]), msg[(j + 3) & 3]);
+
+				uint32x4_t wk = vaddq_u32(w, vdupq_n_u32(K[j / 5]));
+				uint32 next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+
+				if (j < 5)
+					abcd = vsha1cq_u32(abcd, e, wk);
+				else if (j < 10 || j >= 15)
+					abcd = vsha1pq_u32(abcd, e, wk);
+				else
+					abcd = vsha1mq_u32(abcd, e, wk);
+
+				e = next;
+			}
+
+			e0 = e + e0Save;
+			abcd = vaddq_u32(abcd, abcdSave);
 		}
 
-		output.size = 20;
+		vst1q_u32(state, abcd);
+		state[4] = e0;
+	}
+
+#endif
+
+public:
+	bool isSupported(Function function) const override
+	{
+		return function == FUNCTION_SHA1;
+	}
+
+	State *newState(Function function) const override
+	{
+		if (function != FUNCTION_SHA1)
+			throw love::Exception("Hash function not supported by SHA1 implementation");
+
+		return new SHA1State();
 	}
 } sha1;
 
@@ -292,113 +578,204 @@ class SHA256 : public HashFunction
 	static const uint32 initial256[8];
 	static const uint32 constants[64];
 
-public:
-	bool isSupported(Function function) const override
+	class SHA256State : public BlockState<64, true>
 	{
-		return function == FUNCTION_SHA224 || function == FUNCTION_SHA256;
-	}
+	public:
 
-	void hash(Function function, const char *input, uint64 length, Value &output) const override
-	{
-		if (!isSupported(function))
-			throw love::Exception("Hash function not supported by SHA-224/SHA-256 implementation");
+		SHA256State(Function function)
+			: hashlength(function == FUNCTION_SHA224 ? 28 : 32)
+		{
+			if (function == FUNCTION_SHA224)
+				memcpy(intermediate, initial224, sizeof(intermediate));
+			else
+				memcpy(intermediate, initial256, sizeof(intermediate));
+		}
+
+	protected:
+
+		void processBlocks(const uint8 *blocks, size_t count) override
+		{
+#if defined(LOVE_HASH_SHA_ARM)
+			processBlocksARM(intermediate, blocks, count);
+#else
+#	if defined(LOVE_HASH_SHA_X86)
+			if (hasSHAExtensions())
+			{
+				processBlocksX86(intermediate, blocks, count);
+				return;
+			}
+#	endif
+			// Allocate our extended words
+			uint32 words[64];
+
+			for (size_t i = 0; i < count; i++, blocks += 64)
+			{
+				for (int j = 0; j < 16; j++)
+					words[j] = loadBE32(blocks + j * 4);
+				for (int j = 16; j < 64; j++)
+				{
+					words[j] = rightrot(words[j-2], 17) ^ rightrot(words[j-2], 19) ^ (words[j-2] >> 10);
+					words[j] += rightrot(words[j-15], 7) ^ rightrot(words[j-15], 18) ^ (words[j-15] >> 3);
+					words[j] += words[j-7] + words[j-16];
+				}
+
+				uint32 A = intermediate[0];
+				uint32 B = intermediate[1];
+				uint32 C = intermediate[2];
+				uint32 D = intermediate[3];
+				uint32 E = intermediate[4];
+				uint32 F = intermediate[5];
+				uint32 G = intermediate[6];
+				uint32 H = intermediate[7];
+
+				for (int j = 0; j < 64; j++)
+				{
+					uint32 temp1 = H + constants[j] + words[j];
+					temp1 += rightrot(E, 6) ^ rightrot(E, 11) ^ rightrot(E, 25);
+					temp1 += (E & F) ^ (~E & G);
+					uint32 temp2 = rightrot(A, 2) ^ rightrot(A, 13) ^ rightrot(A, 22);
+					temp2 += (A & B) ^ (A & C) ^ (B & C);
+
+					H = G;
+					G = F;
+					F = E;
+					E = D + temp1;
+					D = C;
+					C = B;
+					B = A;
+					A = temp1 + temp2;
+				}
 
-		//Do the required padding (MD5, SHA1 and SHA2 use the same padding)
-		uint64 paddedLength = length + 1; //Consider the appended bit
-		if (paddedLength % 64 < 56)
-			paddedLength += 56 - paddedLength % 64;
-		if (paddedLength % 64 > 56)
-			paddedLength += 120 - paddedLength % 64;
+				intermediate[0] += A;
+				intermediate[1] += B;
+				intermediate[2] += C;
+				intermediate[3] += D;
+				intermediate[4] += E;
+				intermediate[5] += F;
+				intermediate[6] += G;
+				intermediate[7] += H;
+			}
+#endif
+		}
 
-		uint8 *padded = new uint8[paddedLength + 8];
-		memcpy(padded, input, length);
-		memset(padded + length, 0, paddedLength - length);
-		padded[length] = 0x80;
+		void digest(Value &output) override
+		{
+			for (int i = 0; i < hashlength; i += 4)
+				storeBE32(&output.data[i], intermediate[i/4]);
 
-		// Now we need the length in bits (big endian)
-		length *= 8;
-		for (int i = 0; i < 8; ++i, ++paddedLength)
-			padded[paddedLength] = (length >> (56 - i * 8)) & 0xFF;
+			output.size = hashlength;
+		}
+
+	private:
 
 		uint32 intermediate[8];
-		if (function == FUNCTION_SHA224)
-			memcpy(intermediate, initial224, sizeof(intermediate));
-		else
-			memcpy(intermediate, initial256, sizeof(intermediate));
+		int hashlength;
+	};
 
-		// Allocate our extended words
-		uint32 words[64];
+#if defined(LOVE_HASH_SHA_X86)
+
+	LOVE_TARGET_SHA
+	static void processBlocksX86(uint32 *state, const uint8 *blocks, size_t count)
+	{
+		const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
 
-		for (uint64 i = 0; i < paddedLength; i += 64)
+		// The instructions work on the state as ABEF and CDGH.
+		__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[0]), 0xB1);
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[4]), 0x1B);
+		__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+		state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+		for (size_t i = 0; i < count; i++, blocks += 64)
 		{
-			uint32 *chunk = (uint32*) &padded[i];
+			const __m128i state0Save = state0;
+			const __m128i state1Save = state1;
+
+			__m128i msg[4];
+
+			// 4 rounds at a time, with the message schedule computed 4 words
+			// ahead in a ring buffer.
 			for (int j = 0; j < 16; j++)
 			{
-				char *c = (char*) &words[j];
-				c[0] = (chunk[j] >> 24) & 0xFF;
-				c[1] = (chunk[j] >> 16) & 0xFF;
-				c[2] = (chunk[j] >>  8) & 0xFF;
-				c[3] = (chunk[j] >>  0) & 0xFF;
-			}
-			for (int j = 16; j < 64; j++)
-			{
-				words[j] = rightrot(words[j-2], 17) ^ rightrot(words[j-2], 19) ^ (words[j-2] >> 10);
-				words[j] += rightrot(words[j-15], 7) ^ rightrot(words[j-15], 18) ^ (words[j-15] >> 3);
-				words[j] += words[j-7] + words[j-16];
-			}
+				__m128i &w = msg[j & 3];
 
-			uint32 A = intermediate[0];
-			uint32 B = intermediate[1];
-			uint32 C = intermediate[2];
-			uint32 D = intermediate[3];
-			uint32 E = intermediate[4];
-			uint32 F = intermediate[5];
-			uint32 G = intermediate[6];
-			uint32 H = intermediate[7];
+				if (j < 4)
+					w = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (blocks + j * 16)), mask);
+				else
+				{
+					__m128i t = _mm_sha256msg1_epu32(w, msg[(j + 1) & 3]);
+					t = _mm_add_epi32(t, _mm_alignr_epi8(msg[(j + 3) & 3], msg[(j + 2) & 3], 4));
+					w = _mm_sha256msg2_epu32(t, msg[(j + 3) & 3]);
+				}
 
-			for (int j = 0; j < 64; j++)
-			{
-				uint32 temp1 = H + constants[j] + words[j];
-				temp1 += rightrot(E, 6) ^ rightrot(E, 11) ^ rightrot(E, 25);
-				temp1 += (E & F) ^ (~E & G);
-				uint32 temp2 = rightrot(A, 2) ^ rightrot(A, 13) ^ rightrot(A, 22);
-				temp2 += (A & B) ^ (A & C) ^ (B & C);
-
-				H = G;
-				G = F;
-				F = E;
-				E = D + temp1;
-				D = C;
-				C = B;
-				B = A;
-				A = temp1 + temp2;
+				__m128i wk = _mm_add_epi32(w, _mm_loadu_si128((const __m128i *) &constants[j * 4]));
+				state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+				state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
 			}
 
-			intermediate[0] += A;
-			intermediate[1] += B;
-			intermediate[2] += C;
-			intermediate[3] += D;
-			intermediate[4] += E;
-			intermediate[5] += F;
-			intermediate[6] += G;
-			intermediate[7] += H;
+			state0 = _mm_add_epi32(state0, state0Save);
+			state1 = _mm_add_epi32(state1, state1Save);
 		}
 
-		delete[] padded;
+		tmp = _mm_shuffle_epi32(state0, 0x1B);
+		state1 = _mm_shuffle_epi32(state1, 0xB1);
+		state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+		state1 = _mm_alignr_epi8(state1, tmp, 8);
 
-		int hashlength = 32;
-		if (function == FUNCTION_SHA224)
-			hashlength = 28;
+		_mm_storeu_si128((__m128i *) &state[0], state0);
+		_mm_storeu_si128((__m128i *) &state[4], state1);
+	}
+
+#elif defined(LOVE_HASH_SHA_ARM)
+
+	static void processBlocksARM(uint32 *state, const uint8 *blocks, size_t count)
+	{
+		uint32x4_t state0 = vld1q_u32(&state[0]);
+		uint32x4_t state1 = vld1q_u32(&state[4]);
 
-		for (int i = 0; i < hashlength; i += 4)
+		for (size_t i = 0; i < count; i++, blocks += 64)
 		{
-			output.data[i+0] = (intermediate[i/4] >> 24) & 0xFF;
-			output.data[i+1] = (intermediate[i/4] >> 16) & 0xFF;
-			output.data[i+2] = (intermediate[i/4] >>  8) & 0xFF;
-			output.data[i+3] = (intermediate[i/4] >>  0) & 0xFF;
+			const uint32x4_t state0Save = state0;
+			const uint32x4_t state1Save = state1;
+
+			uint32x4_t msg[4];
+
+			for (int j = 0; j < 16; j++)
+			{
+				uint32x4_t &w = msg[j & 3];
+
+				if (j < 4)
+					w = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + j * 16)));
+				else
+					w = vsha256su1q_u32(vsha256su0q_u32(w, msg[(j + 1) & 3]), msg[(j + 2) & 3], msg[(j + 3) & 3]);
+
+				uint32x4_t wk = vaddq_u32(w, vld1q_u32(&constants[j * 4]));
+				uint32x4_t prev = state0;
+				state0 = vsha256hq_u32(state0, state1, wk);
+				state1 = vsha256h2q_u32(state1, prev, wk);
+			}
+
+			state0 = vaddq_u32(state0, state0Save);
+			state1 = vaddq_u32(state1, state1Save);
 		}
 
-		output.size = hashlength;
+		vst1q_u32(&state[0], state0);
+		vst1q_u32(&state[4], state1);
+	}
+
+#endif
+
+public:
+	bool isSupported(Function function) const override
+	{
+		return function == FUNCTION_SHA224 || function == FUNCTION_SHA256;
+	}
+
+	State *newState(Function function) const override
+	{
+		if (!isSupported(function))
+			throw love::Exception("Hash function not supported by SHA-224/SHA-256 implementation");
+
+		return new SHA256State(function);
 	}
 } sha256;
 
@@ -442,122 +819,100 @@ class SHA512 : public HashFunction
 	static const uint64 initial512[8];
 	static const uint64 constants[80];
 
-public:
-	bool isSupported(Function function) const override
+	class SHA512State : public BlockState<128, true>
 	{
-		return function == FUNCTION_SHA384 || function == FUNCTION_SHA512;
-	}
+	public:
 
-	void hash(Function function, const char *input, uint64 length, Value &output) const override
-	{
-		if (!isSupported(function))
-			throw love::Exception("Hash function not supported by SHA-384/SHA-512 implementation");
+		SHA512State(Function function)
+			: hashlength(function == FUNCTION_SHA384 ? 48 : 64)
+		{
+			if (function == FUNCTION_SHA384)
+				memcpy(intermediates, initial384, sizeof(intermediates));
+			else
+				memcpy(intermediates, initial512, sizeof(intermediates));
+		}
 
-		uint64 intermediates[8];
-		if (function == FUNCTION_SHA384)
-			memcpy(intermediates, initial384, sizeof(intermediates));
-		else
-			memcpy(intermediates, initial512, sizeof(intermediates));
-
-		//Do the required padding
-		uint64 paddedLength = length + 1; //Consider the appended bit
-		if (paddedLength % 128 < 112)
-			paddedLength += 112 - paddedLength % 128;
-		if (paddedLength % 128 > 112)
-			paddedLength += 240 - paddedLength % 128;
-
-		uint8 *padded = new uint8[paddedLength + 16];
-		paddedLength += 8;
-		memcpy(padded, input, length);
-		memset(padded + length, 0, paddedLength - length);
-		padded[length] = 0x80;
-
-		// Now we need the length in bits (big endian), note we only write a 64-bit int, so
-		// we have filled the first 8 bytes with zeroes
-		length *= 8;
-		for (int i = 0; i < 8; ++i, ++paddedLength)
-			padded[paddedLength] = (length >> (56 - i * 8)) & 0xFF;
-
-		// Allocate our extended words
-		uint64 words[80];
-
-		for (uint64 i = 0; i < paddedLength; i += 128)
+	protected:
+
+		void processBlocks(const uint8 *blocks, size_t count) override
 		{
-			uint64 *chunk = (uint64*) &padded[i];
-			for (int j = 0; j < 16; ++j)
-			{
-				char *c = (char*) &words[j];
-				c[0] = (chunk[j] >> 56) & 0xFF;
-				c[1] = (chunk[j] >> 48) & 0xFF;
-				c[2] = (chunk[j] >> 40) & 0xFF;
-				c[3] = (chunk[j] >> 32) & 0xFF;
-				c[4] = (chunk[j] >> 24) & 0xFF;
-				c[5] = (chunk[j] >> 16) & 0xFF;
-				c[6] = (chunk[j] >>  8) & 0xFF;
-				c[7] = (chunk[j] >>  0) & 0xFF;
-			}
-			for (int j = 16; j < 80; ++j)
+			// Allocate our extended words
+			uint64 words[80];
+
+			for (size_t i = 0; i < count; i++, blocks += 128)
 			{
-				words[j] = words[j-7] + words[j-16];
-				words[j] += rightrot(words[j-2], 19) ^ rightrot(words[j-2], 61) ^ (words[j-2] >> 6);
-				words[j] += rightrot(words[j-15], 1) ^ rightrot(words[j-15], 8) ^ (words[j-15] >> 7);
-			}
+				for (int j = 0; j < 16; ++j)
+					words[j] = loadBE64(blocks + j * 8);
+				for (int j = 16; j < 80; ++j)
+				{
+					words[j] = words[j-7] + words[j-16];
+					words[j] += rightrot(words[j-2], 19) ^ rightrot(words[j-2], 61) ^ (words[j-2] >> 6);
+					words[j] += rightrot(words[j-15], 1) ^ rightrot(words[j-15], 8) ^ (words[j-15] >> 7);
+				}
 
-			uint64 A = intermediates[0];
-			uint64 B = intermediates[1];
-			uint64 C = intermediates[2];
-			uint64 D = intermediates[3];
-			uint64 E = intermediates[4];
-			uint64 F = intermediates[5];
-			uint64 G = intermediates[6];
-			uint64 H = intermediates[7];
+				uint64 A = intermediates[0];
+				uint64 B = intermediates[1];
+				uint64 C = intermediates[2];
+				uint64 D = intermediates[3];
+				uint64 E = intermediates[4];
+				uint64 F = intermediates[5];
+				uint64 G = intermediates[6];
+				uint64 H = intermediates[7];
 
-			for (int j = 0; j < 80; ++j)
-			{
-				uint64 temp1 = H + constants[j] + words[j];
-				temp1 += rightrot(E, 14) ^ rightrot(E, 18) ^ rightrot(E, 41);
-				temp1 += (E & F) ^ (~E & G);
-				uint64 temp2 = rightrot(A, 28) ^ rightrot(A, 34) ^ rightrot(A, 39);
-				temp2 += (A & B) ^ (A & C) ^ (B & C);
-				H = G;
-				G = F;
-				F = E;
-				E = D + temp1;
-				D = C;
-				C = B;
-				B = A;
-				A = temp1 + temp2;
+				for (int j = 0; j < 80; ++j)
+				{
+					uint64 temp1 = H + constants[j] + words[j];
+					temp1 += rightrot(E, 14) ^ rightrot(E, 18) ^ rightrot(E, 41);
+					temp1 += (E & F) ^ (~E & G);
+					uint64 temp2 = rightrot(A, 28) ^ rightrot(A, 34) ^ rightrot(A, 39);
+					temp2 += (A & B) ^ (A & C) ^ (B & C);
+					H = G;
+					G = F;
+					F = E;
+					E = D + temp1;
+					D = C;
+					C = B;
+					B = A;
+					A = temp1 + temp2;
+				}
+
+				intermediates[0] += A;
+				intermediates[1] += B;
+				intermediates[2] += C;
+				intermediates[3] += D;
+				intermediates[4] += E;
+				intermediates[5] += F;
+				intermediates[6] += G;
+				intermediates[7] += H;
 			}
+		}
 
-			intermediates[0] += A;
-			intermediates[1] += B;
-			intermediates[2] += C;
-			intermediates[3] += D;
-			intermediates[4] += E;
-			intermediates[5] += F;
-			intermediates[6] += G;
-			intermediates[7] += H;
+		void digest(Value &output) override
+		{
+			for (int i = 0; i < hashlength; i += 8)
+				storeBE64(&output.data[i], intermediates[i/8]);
+
+			output.size = hashlength;
 		}
 
-		delete[] padded;
+	private:
 
-		int hashlength = 64;
-		if (function == FUNCTION_SHA384)
-			hashlength = 48;
+		uint64 intermediates[8];
+		int hashlength;
+	};
 
-		for (int i = 0; i < hashlength; i += 8)
-		{
-			output.data[i+0] = (intermediates[i/8] >> 56) & 0xFF;
-			output.data[i+1] = (intermediates[i/8] >> 48) & 0xFF;
-			output.data[i+2] = (intermediates[i/8] >> 40) & 0xFF;
-			output.data[i+3] = (intermediates[i/8] >> 32) & 0xFF;
-			output.data[i+4] = (intermediates[i/8] >> 24) & 0xFF;
-			output.data[i+5] = (intermediates[i/8] >> 16) & 0xFF;
-			output.data[i+6] = (intermediates[i/8] >>  8) & 0xFF;
-			output.data[i+7] = (intermediates[i/8] >>  0) & 0xFF;
-		}
+public:
+	bool isSupported(Function function) const override
+	{
+		return function == FUNCTION_SHA384 || function == FUNCTION_SHA512;
+	}
 
-		output.size = hashlength;
+	State *newState(Function function) const override
+	{
+		if (!isSupported(function))
+			throw love::Exception("Hash function not supported by SHA-384/SHA-512 implementation");
+
+		return new SHA512State(function);
 	}
 } sha512;
 
@@ -594,9 +949,123 @@ const uint64 SHA512::constants[80] = {
 	0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817,
 };
 
+/**
+ * Non-cryptographic hashes from the xxHash library. The output is the
+ * canonical (big endian) form of the hash value, the same as xxhsum prints.
+ **/
+class XXHash : public HashFunction
+{
+private:
+
+	class XXH64State : public State
+	{
+	public:
+
+		XXH64State()
+			: state(XXH64_createState())
+		{
+			if (state == nullptr)
+				throw love::Exception("Out of memory.");
+			XXH64_reset(state, 0);
+		}
+
+		virtual ~XXH64State()
+		{
+			XXH64_freeState(state);
+		}
+
+		void update(const char *input, uint64 length) override
+		{
+			XXH64_update(state, input, (size_t) length);
+		}
+
+		void finish(Value &output) override
+		{
+			XXH64_canonicalFromHash((XXH64_canonical_t *) output.data, XXH64_digest(state));
+			output.size = sizeof(XXH64_canonical_t);
+		}
+
+	private:
+
+		XXH64_state_t *state;
+	};
+
+	class XXH128State : public State
+	{
+	public:
+
+		XXH128State()
+			: state(XXH3_createState())
+		{
+			if (state == nullptr)
+				throw love::Exception("Out of memory.");
+			XXH3_128bits_reset(state);
+		}
+
+		virtual ~XXH128State()
+		{
+			XXH3_freeState(state);
+		}
+
+		void update(const char *input, uint64 length) override
+		{
+			XXH3_128bits_update(state, input, (size_t) length);
+		}
+
+		void finish(Value &output) override
+		{
+			XXH128_canonicalFromHash((XXH128_canonical_t *) output.data, XXH3_128bits_digest(state));
+			output.size = sizeof(XXH128_canonical_t);
+		}
+
+	private:
+
+		XXH3_state_t *state;
+	};
+
+public:
+	bool isSupported(Function function) const override
+	{
+		return function == FUNCTION_XXH64 || function == FUNCTION_XXH128;
+	}
+
+	void hash(Function function, const char *input, uint64 length, Value &output) const override
+	{
+		if (function == FUNCTION_XXH64)
+		{
+			XXH64_canonicalFromHash((XXH64_canonical_t *) output.data, XXH64(input, (size_t) length, 0));
+			output.size = sizeof(XXH64_canonical_t);
+		}
+		else if (function == FUNCTION_XXH128)
+		{
+			XXH128_canonicalFromHash((XXH128_canonical_t *) output.data, XXH3_128bits(input, (size_t) length));
+			output.size = sizeof(XXH128_canonical_t);
+		}
+		else
+			throw love::Exception("Hash function not supported by xxHash implementation");
+	}
+
+	State *newState(Function function) const override
+	{
+		if (function == FUNCTION_XXH64)
+			return new XXH64State();
+		else if (function == FUNCTION_XXH128)
+			return new XXH128State();
+		else
+			throw love::Exception("Hash function not supported by xxHash implementation");
+	}
+} xxhash;
+
 } // impl
 }
 
+void HashFunction::hash(Function function, const char *input, uint64 length, Value &output) const
+{
+	std::unique_ptr<State> state(newState(function));
+	state->update(input, length);
+	state->finish(output);
+}
+
 HashFunction *HashFunction::getHashFunction(Function function)
 {
 	switch(function)
@@ -611,6 +1080,9 @@ HashFunction *HashFunction::getHashFunction(Function function)
 	case FUNCTION_SHA384:
 	case FUNCTION_SHA512:
 		return &impl::sha512;
+	case FUNCTION_XXH64:
+	case FUNCTION_XXH128:
+		return &impl::xxhash;
 	case FUNCTION_MAX_ENUM:
 		return nullptr;
 	// No default for compiler warnings
@@ -640,6 +1112,8 @@ StringMap<HashFunction::Function, HashFunction::FUNCTION_MAX_ENUM>::Entry HashFu
 	{"sha256", FUNCTION_SHA256},
 	{"sha384", FUNCTION_SHA384},
 	{"sha512", FUNCTION_SHA512},
+	{"xxh64",  FUNCTION_XXH64},
+	{"xxh128", FUNCTION_XXH128},
 };
 
 StringMap<HashFunction::Function, HashFunction::FUNCTION_MAX_ENUM> HashFunction::functionNames(HashFunction::functionEntries, sizeof(HashFunction::functionEntries));
@@ -42,6 +42,8 @@ class HashFunction
 		FUNCTION_SHA256,
 		FUNCTION_SHA384,
 		FUNCTION_SHA512,
+		FUNCTION_XXH64,
+		FUNCTION_XXH128,
 		FUNCTION_MAX_ENUM
 	};
 
@@ -51,6 +53,33 @@ class HashFunction
 		size_t size;
 	};
 
+	/**
+	 * Incremental hashing state, for input which isn't available all at once.
+	 * Feeding the input through any number of update calls produces the same
+	 * result as hashing it in one piece.
+	 **/
+	class State
+	{
+	public:
+
+		virtual ~State() {}
+
+		/**
+		 * Hash the next piece of input.
+		 *
+		 * @param[in] input The input data to hash.
+		 * @param[in] length The length of the input data.
+		 **/
+		virtual void update(const char *input, uint64 length) = 0;
+
+		/**
+		 * Complete the hash. The State can't be updated afterwards.
+		 *
+		 * @param[out] output The result of the hash function.
+		 **/
+		virtual void finish(Value &output) = 0;
+	};
+
 	/**
 	 * Get a HashFunction instance for the given function.
 	 *
@@ -70,7 +99,15 @@ class HashFunction
 	 * @param[in] length The length of the input data.
 	 * @param[out] output The result of the hash function.
 	 **/
-	virtual void hash(Function function, const char *input, uint64 length, Value &output) const = 0;
+	virtual void hash(Function function, const char *input, uint64 length, Value &output) const;
+
+	/**
+	 * Create a new incremental hashing state.
+	 *
+	 * @param[in] function The selected hash function.
+	 * @return A new State, owned by the caller.
+	 **/
+	virtual State *newState(Function function) const = 0;
 
 	/**
 	 * @param[in] function The requested hash function.
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "Hasher.h"
+#include "common/Exception.h"
+#include "filesystem/File.h"
+
+// C++
+#include <vector>
+
+namespace love
+{
+namespace data
+{
+
+love::Type Hasher::type("Hasher", &Object::type);
+
+// The amount read from a File at a time.
+static const size_t FILE_BUFFER_SIZE = 1024 * 1024;
+
+Hasher::Hasher(HashFunction::Function function)
+	: function(function)
+	, finished(false)
+{
+	HashFunction *hashfunction = HashFunction::getHashFunction(function);
+	if (hashfunction == nullptr)
+		throw love::Exception("Invalid hash function.");
+
+	state.reset(hashfunction->newState(function));
+}
+
+Hasher::~Hasher()
+{
+}
+
+void Hasher::update(const char *input, uint64 length)
+{
+	if (finished)
+		throw love::Exception("Cannot update a Hasher after it has been finished.");
+
+	state->update(input, length);
+}
+
+void Hasher::update(love::filesystem::File *file)
+{
+	using love::filesystem::File;
+
+	if (finished)
+		throw love::Exception("Cannot update a Hasher after it has been finished.");
+
+	bool opened = false;
+	if (!file->isOpen())
+	{
+		if (!file->open(File::MODE_READ))
+			throw love::Exception("Could not open file %s.", file->getFilename().c_str());
+		opened = true;
+	}
+
+	try
+	{
+		std::vector<char> buffer(FILE_BUFFER_SIZE);
+
+		while (true)
+		{
+			int64 count = file->read(buffer.data(), (int64) buffer.size());
+			if (count < 0)
+				throw love::Exception("Could not read from file %s.", file->getFilename().c_str());
+			else if (count == 0)
+				break;
+
+			state->update(buffer.data(), (uint64) count);
+		}
+	}
+	catch (love::Exception &)
+	{
+		if (opened)
+			file->close();
+		throw;
+	}
+
+	if (opened)
+		file->close();
+}
+
+void Hasher::finish(HashFunction::Value &output)
+{
+	if (!finished)
+	{
+		state->finish(result);
+		finished = true;
+	}
+
+	output = result;
+}
+
+HashFunction::Function Hasher::getFunction() const
+{
+	return function;
+}
+
+bool Hasher::isFinished() const
+{
+	return finished;
+}
+
+} // data
+} // love
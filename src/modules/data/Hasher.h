@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/Object.h"
+#include "common/int.h"
+#include "HashFunction.h"
+
+// C++
+#include <memory>
+
+namespace love
+{
+namespace filesystem
+{
+class File;
+}
+
+namespace data
+{
+
+/**
+ * Hashes input which is given in pieces, so large data (such as the contents
+ * of a File) doesn't need to be held in memory all at once.
+ *
+ * A Hasher must not be used by more than one thread at a time.
+ **/
+class Hasher : public love::Object
+{
+public:
+
+	static love::Type type;
+
+	Hasher(HashFunction::Function function);
+	virtual ~Hasher();
+
+	/**
+	 * Hashes the next piece of input. Throws if the Hasher has been finished.
+	 **/
+	void update(const char *input, uint64 length);
+
+	/**
+	 * Hashes the contents of a File from its current position to the end,
+	 * reading it in pieces. The File is opened (and closed again) if needed.
+	 **/
+	void update(love::filesystem::File *file);
+
+	/**
+	 * Completes the hash. Calling this again returns the same result.
+	 **/
+	void finish(HashFunction::Value &output);
+
+	HashFunction::Function getFunction() const;
+	bool isFinished() const;
+
+private:
+
+	HashFunction::Function function;
+	std::unique_ptr<HashFunction::State> state;
+
+	bool finished;
+	HashFunction::Value result;
+
+}; // Hasher
+
+} // data
+} // love
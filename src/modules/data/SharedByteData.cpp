@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "SharedByteData.h"
+#include "common/Exception.h"
+#include "common/StringMap.h"
+
+// C++
+#include <atomic>
+
+namespace love
+{
+namespace data
+{
+
+// The atomic operations are done on the raw bytes of the buffer, which is only
+// valid when the atomic types have the same layout as the plain ones and don't
+// need an internal lock.
+static_assert(sizeof(std::atomic<int32>) == sizeof(int32), "std::atomic<int32> must have the same size as int32.");
+static_assert(sizeof(std::atomic<int64>) == sizeof(int64), "std::atomic<int64> must have the same size as int64.");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "32 bit atomics must be lock-free.");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64 bit atomics must be lock-free.");
+
+template <typename T>
+static inline std::atomic<T> *getAtomic(const SharedByteData *data, size_t offset)
+{
+	return (std::atomic<T> *) ((char *) data->getData() + offset);
+}
+
+love::Type SharedByteData::type("SharedByteData", &ByteData::type);
+
+SharedByteData::SharedByteData(size_t size)
+	: ByteData(size)
+{
+}
+
+SharedByteData::SharedByteData(const void *d, size_t size)
+	: ByteData(d, size)
+{
+}
+
+SharedByteData::SharedByteData(const SharedByteData &d)
+	: ByteData(d)
+{
+}
+
+SharedByteData::~SharedByteData()
+{
+}
+
+SharedByteData *SharedByteData::clone() const
+{
+	return new SharedByteData(*this);
+}
+
+size_t SharedByteData::getAtomicSize(AtomicType atype)
+{
+	return atype == ATOMIC_INT64 ? sizeof(int64) : sizeof(int32);
+}
+
+bool SharedByteData::isValidOffset(AtomicType atype, size_t offset) const
+{
+	size_t size = getAtomicSize(atype);
+	size_t address = (size_t) getData() + offset;
+
+	return offset <= getSize() && size <= getSize() - offset && (address % size) == 0;
+}
+
+void SharedByteData::checkOffset(AtomicType atype, size_t offset) const
+{
+	size_t size = getAtomicSize(atype);
+
+	if (offset > getSize() || size > getSize() - offset)
+		throw love::Exception("Offset %d is out of range for a %d byte atomic value in SharedByteData of size %d.", (int) offset, (int) size, (int) getSize());
+
+	if ((((size_t) getData() + offset) % size) != 0)
+		throw love::Exception("Offset %d is not aligned to the %d byte size of the atomic value.", (int) offset, (int) size);
+}
+
+int64 SharedByteData::atomicLoad(AtomicType atype, size_t offset) const
+{
+	checkOffset(atype, offset);
+
+	if (atype == ATOMIC_INT64)
+		return getAtomic<int64>(this, offset)->load();
+	else
+		return getAtomic<int32>(this, offset)->load();
+}
+
+void SharedByteData::atomicStore(AtomicType atype, size_t offset, int64 value)
+{
+	checkOffset(atype, offset);
+
+	if (atype == ATOMIC_INT64)
+		getAtomic<int64>(this, offset)->store(value);
+	else
+		getAtomic<int32>(this, offset)->store((int32) value);
+}
+
+int64 SharedByteData::atomicAdd(AtomicType atype, size_t offset, int64 value)
+{
+	checkOffset(atype, offset);
+
+	if (atype == ATOMIC_INT64)
+		return getAtomic<int64>(this, offset)->fetch_add(value);
+	else
+		return getAtomic<int32>(this, offset)->fetch_add((int32) value);
+}
+
+int64 SharedByteData::atomicExchange(AtomicType atype, size_t offset, int64 value)
+{
+	checkOffset(atype, offset);
+
+	if (atype == ATOMIC_INT64)
+		return getAtomic<int64>(this, offset)->exchange(value);
+	else
+		return getAtomic<int32>(this, offset)->exchange((int32) value);
+}
+
+bool SharedByteData::compareExchange(AtomicType atype, size_t offset, int64 &expected, int64 desired)
+{
+	checkOffset(atype, offset);
+
+	if (atype == ATOMIC_INT64)
+		return getAtomic<int64>(this, offset)->compare_exchange_strong(expected, desired);
+
+	int32 expected32 = (int32) expected;
+	bool success = getAtomic<int32>(this, offset)->compare_exchange_strong(expected32, (int32) desired);
+	expected = expected32;
+	return success;
+}
+
+void SharedByteData::fence()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+static StringMap<SharedByteData::AtomicType, SharedByteData::ATOMIC_MAX_ENUM>::Entry atomicTypeEntries[] =
+{
+	{ "int32", SharedByteData::ATOMIC_INT32 },
+	{ "int64", SharedByteData::ATOMIC_INT64 },
+};
+
+static StringMap<SharedByteData::AtomicType, SharedByteData::ATOMIC_MAX_ENUM> atomicTypes(atomicTypeEntries, sizeof(atomicTypeEntries));
+
+bool SharedByteData::getConstant(const char *in, AtomicType &out)
+{
+	return atomicTypes.find(in, out);
+}
+
+bool SharedByteData::getConstant(AtomicType in, const char *&out)
+{
+	return atomicTypes.find(in, out);
+}
+
+std::vector<std::string> SharedByteData::getConstants(AtomicType)
+{
+	return atomicTypes.getNames();
+}
+
+} // data
+} // love
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "ByteData.h"
+#include "common/int.h"
+
+// C++
+#include <vector>
+#include <string>
+
+namespace love
+{
+namespace data
+{
+
+/**
+ * A ByteData whose contents are meant to be shared between threads. Sending it
+ * through a Channel shares the same memory rather than copying it, and integer
+ * values at aligned offsets can be read and modified atomically, so several
+ * threads can work on separate regions (or DataViews) of one buffer and
+ * coordinate through counters and flags stored in it.
+ **/
+class SharedByteData : public ByteData
+{
+public:
+
+	static love::Type type;
+
+	enum AtomicType
+	{
+		ATOMIC_INT32,
+		ATOMIC_INT64,
+		ATOMIC_MAX_ENUM
+	};
+
+	SharedByteData(size_t size);
+	SharedByteData(const void *d, size_t size);
+	SharedByteData(const SharedByteData &d);
+	virtual ~SharedByteData();
+
+	// Implements Data.
+	SharedByteData *clone() const override;
+
+	/**
+	 * All of the atomic operations below are sequentially consistent. The
+	 * offset is in bytes, and must be a multiple of the size of the type.
+	 **/
+	int64 atomicLoad(AtomicType atype, size_t offset) const;
+	void atomicStore(AtomicType atype, size_t offset, int64 value);
+
+	/**
+	 * @return The value stored at the offset before the operation.
+	 **/
+	int64 atomicAdd(AtomicType atype, size_t offset, int64 value);
+	int64 atomicExchange(AtomicType atype, size_t offset, int64 value);
+
+	/**
+	 * Stores 'desired' at the offset if the value there equals 'expected'.
+	 * @param[in,out] expected Receives the value stored at the offset before
+	 *                the operation.
+	 * @return Whether the new value was stored.
+	 **/
+	bool compareExchange(AtomicType atype, size_t offset, int64 &expected, int64 desired);
+
+	/**
+	 * Orders the non-atomic reads and writes done to the data (for example via
+	 * Data:getPointer or Data:getFFIPointer) with respect to atomic operations
+	 * in other threads.
+	 **/
+	static void fence();
+
+	/**
+	 * Returns whether an atomic operation of the given type is valid at the
+	 * given offset.
+	 **/
+	bool isValidOffset(AtomicType atype, size_t offset) const;
+
+	static size_t getAtomicSize(AtomicType type);
+
+	static bool getConstant(const char *in, AtomicType &out);
+	static bool getConstant(AtomicType in, const char *&out);
+	static std::vector<std::string> getConstants(AtomicType);
+
+private:
+
+	void checkOffset(AtomicType atype, size_t offset) const;
+
+}; // SharedByteData
+
+} // data
+} // love
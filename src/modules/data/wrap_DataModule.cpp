@@ -22,11 +22,16 @@
 #include "wrap_DataModule.h"
 #include "wrap_Data.h"
 #include "wrap_ByteData.h"
+#include "wrap_SharedByteData.h"
 #include "wrap_DataView.h"
 #include "wrap_CompressedData.h"
+#include "wrap_CompressionStream.h"
+#include "wrap_Hasher.h"
 #include "DataModule.h"
 #include "common/b64.h"
 
+#include "filesystem/File.h"
+
 // Lua 5.3
 #include "libraries/lua53/lstrlib.h"
 
@@ -70,52 +75,207 @@ int w_newDataView(lua_State *L)
 	return 1;
 }
 
-int w_newByteData(lua_State *L)
+/**
+ * Gets the initial contents for a new ByteData or SharedByteData from the
+ * arguments: either a size, a string, or a Data with an optional offset and
+ * size. bytes is null when the new data should be zero-filled.
+ **/
+static void luax_checkbytedataargs(lua_State *L, const char *&bytes, size_t &size)
 {
-	ByteData *d = nullptr;
+	bytes = nullptr;
 
 	if (luax_istype(L, 1, Data::type))
 	{
 		Data *data = luax_checkdata(L, 1);
 
 		if (data->getSize() > std::numeric_limits<lua_Integer>::max())
-			return luaL_error(L, "Data's size is too large!");
+			luaL_error(L, "Data's size is too large!");
 
 		lua_Integer offset = luaL_optinteger(L, 2, 0);
 		if (offset < 0)
-			return luaL_error(L, "Offset argument must not be negative.");
+			luaL_error(L, "Offset argument must not be negative.");
 
-		lua_Integer size = luaL_optinteger(L, 3, data->getSize() - offset);
-		if (size <= 0)
-			return luaL_error(L, "Size argument must be greater than zero.");
-		else if ((size_t)(offset + size) > data->getSize())
-			return luaL_error(L, "Offset and size arguments must fit within the given Data's size.");
+		lua_Integer isize = luaL_optinteger(L, 3, data->getSize() - offset);
+		if (isize <= 0)
+			luaL_error(L, "Size argument must be greater than zero.");
+		else if ((size_t)(offset + isize) > data->getSize())
+			luaL_error(L, "Offset and size arguments must fit within the given Data's size.");
 
-		const char *bytes = (const char *) data->getData() + offset;
-		luax_catchexcept(L, [&]() { d = instance()->newByteData(bytes, (size_t) size); });
+		bytes = (const char *) data->getData() + offset;
+		size = (size_t) isize;
 	}
 	else if (lua_type(L, 1) == LUA_TSTRING)
 	{
-		size_t size = 0;
-		const char *data = luaL_checklstring(L, 1, &size);
-		luax_catchexcept(L, [&]() { d = instance()->newByteData(data, size); });
+		bytes = luaL_checklstring(L, 1, &size);
 	}
 	else
 	{
-		lua_Integer size = luaL_checkinteger(L, 1);
-		if (size <= 0)
-			return luaL_error(L, "Data size must be a positive number.");
-		luax_catchexcept(L, [&]() { d = instance()->newByteData((size_t) size); });
+		lua_Integer isize = luaL_checkinteger(L, 1);
+		if (isize <= 0)
+			luaL_error(L, "Data size must be a positive number.");
+		size = (size_t) isize;
 	}
+}
+
+int w_newByteData(lua_State *L)
+{
+	const char *bytes = nullptr;
+	size_t size = 0;
+	luax_checkbytedataargs(L, bytes, size);
+
+	ByteData *d = nullptr;
+	if (bytes != nullptr)
+		luax_catchexcept(L, [&]() { d = instance()->newByteData(bytes, size); });
+	else
+		luax_catchexcept(L, [&]() { d = instance()->newByteData(size); });
 
 	luax_pushtype(L, d);
 	d->release();
 	return 1;
 }
 
+int w_newSharedByteData(lua_State *L)
+{
+	const char *bytes = nullptr;
+	size_t size = 0;
+	luax_checkbytedataargs(L, bytes, size);
+
+	SharedByteData *d = nullptr;
+	if (bytes != nullptr)
+		luax_catchexcept(L, [&]() { d = instance()->newSharedByteData(bytes, size); });
+	else
+		luax_catchexcept(L, [&]() { d = instance()->newSharedByteData(size); });
+
+	luax_pushtype(L, d);
+	d->release();
+	return 1;
+}
+
+/**
+ * Compresses or decompresses data from a File or memory with a
+ * CompressionStream, for love.data.compress and decompress calls which use
+ * Files. The output is written to dst if it isn't null, and otherwise pushed
+ * onto the stack using the given container type.
+ **/
+static int luax_processstream(lua_State *L, CompressionStream::Mode mode, Compressor::Format format, int level, love::filesystem::File *src, const char *srcbytes, size_t srcsize, love::filesystem::File *dst, ContainerType ctype)
+{
+	using love::filesystem::File;
+
+	if (!CompressionStream::isSupported(format))
+		return luaL_error(L, "The lz4 format can't be used with Files (use lz4frame instead).");
+
+	std::vector<char> output;
+	size_t rawsize = 0;
+
+	luax_catchexcept(L, [&]()
+	{
+		StrongRef<CompressionStream> stream(instance()->newCompressionStream(mode, format, level), Acquire::NORETAIN);
+
+		bool closesrc = false;
+		bool closedst = false;
+
+		auto closefiles = [&]()
+		{
+			if (closesrc)
+				src->close();
+			if (closedst)
+				dst->close();
+		};
+
+		try
+		{
+			if (src != nullptr && !src->isOpen())
+			{
+				if (!src->open(File::MODE_READ))
+					throw love::Exception("Could not open file %s.", src->getFilename().c_str());
+				closesrc = true;
+			}
+
+			if (dst != nullptr && !dst->isOpen())
+			{
+				if (!dst->open(File::MODE_WRITE))
+					throw love::Exception("Could not open file %s.", dst->getFilename().c_str());
+				closedst = true;
+			}
+
+			auto flush = [&]()
+			{
+				if (dst == nullptr || output.empty())
+					return;
+				if (!dst->write(output.data(), (int64) output.size()))
+					throw love::Exception("Could not write to file %s.", dst->getFilename().c_str());
+				output.clear();
+			};
+
+			if (src != nullptr)
+			{
+				// Read in pieces large enough to be split across threads.
+				std::vector<char> buffer(CompressionStream::BLOCK_SIZE * 4);
+
+				while (true)
+				{
+					int64 count = src->read(buffer.data(), (int64) buffer.size());
+					if (count < 0)
+						throw love::Exception("Could not read from file %s.", src->getFilename().c_str());
+					else if (count == 0)
+						break;
+
+					rawsize += (size_t) count;
+					stream->update(buffer.data(), (size_t) count, output);
+					flush();
+				}
+			}
+			else
+			{
+				rawsize = srcsize;
+				stream->update(srcbytes, srcsize, output);
+				flush();
+			}
+
+			stream->finish(output);
+			flush();
+		}
+		catch (love::Exception &)
+		{
+			closefiles();
+			throw;
+		}
+
+		closefiles();
+	});
+
+	if (dst != nullptr)
+		return 0;
+
+	if (ctype == CONTAINER_STRING)
+		lua_pushlstring(L, output.data(), output.size());
+	else if (mode == CompressionStream::MODE_COMPRESS)
+	{
+		CompressedData *cdata = nullptr;
+		luax_catchexcept(L, [&]() { cdata = new CompressedData(format, output.data(), output.size(), rawsize, false); });
+		luax_pushtype(L, cdata);
+		cdata->release();
+	}
+	else
+	{
+		ByteData *data = nullptr;
+		luax_catchexcept(L, [&]() { data = instance()->newByteData(output.data(), output.size()); });
+		luax_pushtype(L, Data::type, data);
+		data->release();
+	}
+
+	return 1;
+}
+
 int w_compress(lua_State *L)
 {
-	ContainerType ctype = luax_checkcontainertype(L, 1);
+	love::filesystem::File *dstfile = nullptr;
+	ContainerType ctype = CONTAINER_STRING;
+
+	if (luax_istype(L, 1, love::filesystem::File::type))
+		dstfile = luax_checktype<love::filesystem::File>(L, 1);
+	else
+		ctype = luax_checkcontainertype(L, 1);
 
 	const char *fstr = luaL_checkstring(L, 2);
 	Compressor::Format format = Compressor::FORMAT_LZ4;
@@ -126,8 +286,11 @@ int w_compress(lua_State *L)
 	int level = (int) luaL_optinteger(L, 4, -1);
 	size_t rawsize = 0;
 	const char *rawbytes = nullptr;
+	love::filesystem::File *srcfile = nullptr;
 
-	if (lua_isstring(L, 3))
+	if (luax_istype(L, 3, love::filesystem::File::type))
+		srcfile = luax_checktype<love::filesystem::File>(L, 3);
+	else if (lua_isstring(L, 3))
 		rawbytes = luaL_checklstring(L, 3, &rawsize);
 	else
 	{
@@ -136,6 +299,9 @@ int w_compress(lua_State *L)
 		rawbytes = (const char *) rawdata->getData();
 	}
 
+	if (srcfile != nullptr || dstfile != nullptr)
+		return luax_processstream(L, CompressionStream::MODE_COMPRESS, format, level, srcfile, rawbytes, rawsize, dstfile, ctype);
+
 	CompressedData *cdata = nullptr;
 	luax_catchexcept(L, [&](){ cdata = compress(format, rawbytes, rawsize, level); });
 
@@ -150,7 +316,13 @@ int w_compress(lua_State *L)
 
 int w_decompress(lua_State *L)
 {
-	ContainerType ctype = luax_checkcontainertype(L, 1);
+	love::filesystem::File *dstfile = nullptr;
+	ContainerType ctype = CONTAINER_STRING;
+
+	if (luax_istype(L, 1, love::filesystem::File::type))
+		dstfile = luax_checktype<love::filesystem::File>(L, 1);
+	else
+		ctype = luax_checkcontainertype(L, 1);
 
 	char *rawbytes = nullptr;
 	size_t rawsize = 0;
@@ -158,6 +330,10 @@ int w_decompress(lua_State *L)
 	if (luax_istype(L, 2, CompressedData::type))
 	{
 		CompressedData *data = luax_checkcompresseddata(L, 2);
+
+		if (dstfile != nullptr)
+			return luax_processstream(L, CompressionStream::MODE_DECOMPRESS, data->getFormat(), -1, nullptr, (const char *) data->getData(), data->getSize(), dstfile, ctype);
+
 		rawsize = data->getDecompressedSize();
 		luax_catchexcept(L, [&](){ rawbytes = decompress(data, rawsize); });
 	}
@@ -171,8 +347,11 @@ int w_decompress(lua_State *L)
 
 		size_t compressedsize = 0;
 		const char *cbytes = nullptr;
+		love::filesystem::File *srcfile = nullptr;
 
-		if (luax_istype(L, 3, Data::type))
+		if (luax_istype(L, 3, love::filesystem::File::type))
+			srcfile = luax_checktype<love::filesystem::File>(L, 3);
+		else if (luax_istype(L, 3, Data::type))
 		{
 			Data *data = luax_checktype<Data>(L, 3);
 			cbytes = (const char *) data->getData();
@@ -181,6 +360,9 @@ int w_decompress(lua_State *L)
 		else
 			cbytes = luaL_checklstring(L, 3, &compressedsize);
 
+		if (srcfile != nullptr || dstfile != nullptr)
+			return luax_processstream(L, CompressionStream::MODE_DECOMPRESS, format, -1, srcfile, cbytes, compressedsize, dstfile, ctype);
+
 		luax_catchexcept(L, [&](){ rawbytes = decompress(format, cbytes, compressedsize, rawsize); });
 	}
 
@@ -200,6 +382,28 @@ int w_decompress(lua_State *L)
 	return 1;
 }
 
+int w_newCompressionStream(lua_State *L)
+{
+	const char *mstr = luaL_checkstring(L, 1);
+	CompressionStream::Mode mode = CompressionStream::MODE_COMPRESS;
+	if (!CompressionStream::getConstant(mstr, mode))
+		return luax_enumerror(L, "compression stream mode", CompressionStream::getConstants(mode), mstr);
+
+	const char *fstr = luaL_checkstring(L, 2);
+	Compressor::Format format = Compressor::FORMAT_LZ4_FRAME;
+	if (!Compressor::getConstant(fstr, format))
+		return luax_enumerror(L, "compressed data format", Compressor::getConstants(format), fstr);
+
+	int level = (int) luaL_optinteger(L, 3, -1);
+
+	CompressionStream *stream = nullptr;
+	luax_catchexcept(L, [&]() { stream = instance()->newCompressionStream(mode, format, level); });
+
+	luax_pushtype(L, stream);
+	stream->release();
+	return 1;
+}
+
 int w_encode(lua_State *L)
 {
 	ContainerType ctype = luax_checkcontainertype(L, 1);
@@ -314,6 +518,17 @@ int w_hash(lua_State *L)
 		const char *rawbytes = luaL_checklstring(L, 2, &rawsize);
 		luax_catchexcept(L, [&](){ love::data::hash(function, rawbytes, rawsize, hashvalue); });
 	}
+	else if (luax_istype(L, 2, love::filesystem::File::type))
+	{
+		// Files are hashed in pieces rather than read into memory first.
+		love::filesystem::File *file = luax_checktype<love::filesystem::File>(L, 2);
+		luax_catchexcept(L, [&]()
+		{
+			StrongRef<Hasher> hasher(instance()->newHasher(function), Acquire::NORETAIN);
+			hasher->update(file);
+			hasher->finish(hashvalue);
+		});
+	}
 	else
 	{
 		Data *rawdata = luax_checktype<Data>(L, 2);
@@ -324,6 +539,21 @@ int w_hash(lua_State *L)
 	return 1;
 }
 
+int w_newHasher(lua_State *L)
+{
+	const char *fstr = luaL_checkstring(L, 1);
+	HashFunction::Function function;
+	if (!HashFunction::getConstant(fstr, function))
+		return luax_enumerror(L, "hash function", HashFunction::getConstants(function), fstr);
+
+	Hasher *hasher = nullptr;
+	luax_catchexcept(L, [&]() { hasher = instance()->newHasher(function); });
+
+	luax_pushtype(L, hasher);
+	hasher->release();
+	return 1;
+}
+
 int w_pack(lua_State *L)
 {
 	ContainerType ctype = luax_checkcontainertype(L, 1);
@@ -371,11 +601,14 @@ static const luaL_Reg functions[] =
 {
 	{ "newDataView", w_newDataView },
 	{ "newByteData", w_newByteData },
+	{ "newSharedByteData", w_newSharedByteData },
+	{ "newCompressionStream", w_newCompressionStream },
 	{ "compress", w_compress },
 	{ "decompress", w_decompress },
 	{ "encode", w_encode },
 	{ "decode", w_decode },
 	{ "hash", w_hash },
+	{ "newHasher", w_newHasher },
 
 	{ "pack", w_pack },
 	{ "unpack", w_unpack },
@@ -388,8 +621,11 @@ static const lua_CFunction types[] =
 {
 	luaopen_data,
 	luaopen_bytedata,
+	luaopen_sharedbytedata,
 	luaopen_dataview,
 	luaopen_compresseddata,
+	luaopen_compressionstream,
+	luaopen_hasher,
 	nullptr
 };
 
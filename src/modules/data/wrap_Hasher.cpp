@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "wrap_Hasher.h"
+#include "common/Data.h"
+#include "filesystem/File.h"
+
+namespace love
+{
+namespace data
+{
+
+Hasher *luax_checkhasher(lua_State *L, int idx)
+{
+	return luax_checktype<Hasher>(L, idx);
+}
+
+void luax_updatehasher(lua_State *L, Hasher *hasher, int idx)
+{
+	if (luax_istype(L, idx, love::filesystem::File::type))
+	{
+		love::filesystem::File *file = luax_checktype<love::filesystem::File>(L, idx);
+		luax_catchexcept(L, [&]() { hasher->update(file); });
+	}
+	else if (luax_istype(L, idx, Data::type))
+	{
+		Data *data = luax_checktype<Data>(L, idx);
+		luax_catchexcept(L, [&]() { hasher->update((const char *) data->getData(), data->getSize()); });
+	}
+	else
+	{
+		size_t size = 0;
+		const char *bytes = luaL_checklstring(L, idx, &size);
+		luax_catchexcept(L, [&]() { hasher->update(bytes, size); });
+	}
+}
+
+int w_Hasher_update(lua_State *L)
+{
+	Hasher *t = luax_checkhasher(L, 1);
+	luax_updatehasher(L, t, 2);
+	return 0;
+}
+
+int w_Hasher_finish(lua_State *L)
+{
+	Hasher *t = luax_checkhasher(L, 1);
+
+	HashFunction::Value hashvalue;
+	luax_catchexcept(L, [&]() { t->finish(hashvalue); });
+
+	lua_pushlstring(L, hashvalue.data, hashvalue.size);
+	return 1;
+}
+
+int w_Hasher_isFinished(lua_State *L)
+{
+	Hasher *t = luax_checkhasher(L, 1);
+	luax_pushboolean(L, t->isFinished());
+	return 1;
+}
+
+int w_Hasher_getFunction(lua_State *L)
+{
+	Hasher *t = luax_checkhasher(L, 1);
+
+	const char *str = nullptr;
+	if (!HashFunction::getConstant(t->getFunction(), str))
+		return luaL_error(L, "Unknown hash function.");
+
+	lua_pushstring(L, str);
+	return 1;
+}
+
+static const luaL_Reg w_Hasher_functions[] =
+{
+	{ "update", w_Hasher_update },
+	{ "finish", w_Hasher_finish },
+	{ "isFinished", w_Hasher_isFinished },
+	{ "getFunction", w_Hasher_getFunction },
+	{ 0, 0 }
+};
+
+int luaopen_hasher(lua_State *L)
+{
+	return luax_register_type(L, &Hasher::type, w_Hasher_functions, nullptr);
+}
+
+} // data
+} // love
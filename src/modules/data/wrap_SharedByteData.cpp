@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_SharedByteData.h"
+#include "wrap_Data.h"
+
+// Put the Lua code directly into a raw string literal.
+static const char sharedbytedata_lua[] =
+#include "wrap_SharedByteData.lua"
+;
+
+namespace love
+{
+namespace data
+{
+
+SharedByteData *luax_checksharedbytedata(lua_State *L, int idx)
+{
+	return luax_checktype<SharedByteData>(L, idx);
+}
+
+static SharedByteData::AtomicType luax_optatomictype(lua_State *L, int idx)
+{
+	SharedByteData::AtomicType atype = SharedByteData::ATOMIC_INT32;
+	if (!lua_isnoneornil(L, idx))
+	{
+		const char *str = luaL_checkstring(L, idx);
+		if (!SharedByteData::getConstant(str, atype))
+			luax_enumerror(L, "atomic type", SharedByteData::getConstants(atype), str);
+	}
+	return atype;
+}
+
+static size_t luax_checkatomicoffset(lua_State *L, int idx)
+{
+	lua_Integer offset = luaL_checkinteger(L, idx);
+	if (offset < 0)
+		luaL_error(L, "Offset argument must not be negative.");
+	return (size_t) offset;
+}
+
+int w_SharedByteData_atomicLoad(lua_State *L)
+{
+	SharedByteData *t = luax_checksharedbytedata(L, 1);
+	size_t offset = luax_checkatomicoffset(L, 2);
+	SharedByteData::AtomicType atype = luax_optatomictype(L, 3);
+
+	int64 value = 0;
+	luax_catchexcept(L, [&]() { value = t->atomicLoad(atype, offset); });
+
+	lua_pushnumber(L, (lua_Number) value);
+	return 1;
+}
+
+int w_SharedByteData_atomicStore(lua_State *L)
+{
+	SharedByteData *t = luax_checksharedbytedata(L, 1);
+	size_t offset = luax_checkatomicoffset(L, 2);
+	int64 value = (int64) luaL_checknumber(L, 3);
+	SharedByteData::AtomicType atype = luax_optatomictype(L, 4);
+
+	luax_catchexcept(L, [&]() { t->atomicStore(atype, offset, value); });
+	return 0;
+}
+
+int w_SharedByteData_atomicAdd(lua_State *L)
+{
+	SharedByteData *t = luax_checksharedbytedata(L, 1);
+	size_t offset = luax_checkatomicoffset(L, 2);
+	int64 value = (int64) luaL_checknumber(L, 3);
+	SharedByteData::AtomicType atype = luax_optatomictype(L, 4);
+
+	int64 previous = 0;
+	luax_catchexcept(L, [&]() { previous = t->atomicAdd(atype, offset, value); });
+
+	lua_pushnumber(L, (lua_Number) previous);
+	return 1;
+}
+
+int w_SharedByteData_atomicExchange(lua_State *L)
+{
+	SharedByteData *t = luax_checksharedbytedata(L, 1);
+	size_t offset = luax_checkatomicoffset(L, 2);
+	int64 value = (int64) luaL_checknumber(L, 3);
+	SharedByteData::AtomicType atype = luax_optatomictype(L, 4);
+
+	int64 previous = 0;
+	luax_catchexcept(L, [&]() { previous = t->atomicExchange(atype, offset, value); });
+
+	lua_pushnumber(L, (lua_Number) previous);
+	return 1;
+}
+
+int w_SharedByteData_compareExchange(lua_State *L)
+{
+	SharedByteData *t = luax_checksharedbytedata(L, 1);
+	size_t offset = luax_checkatomicoffset(L, 2);
+	int64 expected = (int64) luaL_checknumber(L, 3);
+	int64 desired = (int64) luaL_checknumber(L, 4);
+	SharedByteData::AtomicType atype = luax_optatomictype(L, 5);
+
+	bool success = false;
+	luax_catchexcept(L, [&]() { success = t->compareExchange(atype, offset, expected, desired); });
+
+	luax_pushboolean(L, success);
+	lua_pushnumber(L, (lua_Number) expected);
+	return 2;
+}
+
+int w_SharedByteData_fence(lua_State *L)
+{
+	luax_checksharedbytedata(L, 1);
+	SharedByteData::fence();
+	return 0;
+}
+
+// C functions in a struct, necessary for the FFI versions of SharedByteData
+// methods. They return false (or -1 for compareExchange) instead of throwing
+// when the arguments are invalid, and the Lua side then calls the regular
+// method to raise the error.
+struct FFI_SharedByteData
+{
+	bool (*atomicLoad)(Proxy *p, int atype, size_t offset, int64 *result);
+	bool (*atomicStore)(Proxy *p, int atype, size_t offset, int64 value);
+	bool (*atomicAdd)(Proxy *p, int atype, size_t offset, int64 value, int64 *result);
+	bool (*atomicExchange)(Proxy *p, int atype, size_t offset, int64 value, int64 *result);
+	int (*compareExchange)(Proxy *p, int atype, size_t offset, int64 expected, int64 desired, int64 *result);
+	void (*fence)();
+};
+
+static SharedByteData *ffi_checkatomic(Proxy *p, int atype, size_t offset)
+{
+	auto data = luax_ffi_checktype<SharedByteData>(p);
+	if (data == nullptr || atype < 0 || atype >= SharedByteData::ATOMIC_MAX_ENUM)
+		return nullptr;
+	if (!data->isValidOffset((SharedByteData::AtomicType) atype, offset))
+		return nullptr;
+	return data;
+}
+
+static FFI_SharedByteData ffifuncs =
+{
+	[](Proxy *p, int atype, size_t offset, int64 *result) -> bool // atomicLoad
+	{
+		auto data = ffi_checkatomic(p, atype, offset);
+		if (data == nullptr)
+			return false;
+		*result = data->atomicLoad((SharedByteData::AtomicType) atype, offset);
+		return true;
+	},
+
+	[](Proxy *p, int atype, size_t offset, int64 value) -> bool // atomicStore
+	{
+		auto data = ffi_checkatomic(p, atype, offset);
+		if (data == nullptr)
+			return false;
+		data->atomicStore((SharedByteData::AtomicType) atype, offset, value);
+		return true;
+	},
+
+	[](Proxy *p, int atype, size_t offset, int64 value, int64 *result) -> bool // atomicAdd
+	{
+		auto data = ffi_checkatomic(p, atype, offset);
+		if (data == nullptr)
+			return false;
+		*result = data->atomicAdd((SharedByteData::AtomicType) atype, offset, value);
+		return true;
+	},
+
+	[](Proxy *p, int atype, size_t offset, int64 value, int64 *result) -> bool // atomicExchange
+	{
+		auto data = ffi_checkatomic(p, atype, offset);
+		if (data == nullptr)
+			return false;
+		*result = data->atomicExchange((SharedByteData::AtomicType) atype, offset, value);
+		return true;
+	},
+
+	[](Proxy *p, int atype, size_t offset, int64 expected, int64 desired, int64 *result) -> int // compareExchange
+	{
+		auto data = ffi_checkatomic(p, atype, offset);
+		if (data == nullptr)
+			return -1;
+		bool success = data->compareExchange((SharedByteData::AtomicType) atype, offset, expected, desired);
+		*result = expected;
+		return success ? 1 : 0;
+	},
+
+	[]() // fence
+	{
+		SharedByteData::fence();
+	},
+};
+
+static const luaL_Reg w_SharedByteData_functions[] =
+{
+	{ "atomicLoad", w_SharedByteData_atomicLoad },
+	{ "atomicStore", w_SharedByteData_atomicStore },
+	{ "atomicAdd", w_SharedByteData_atomicAdd },
+	{ "atomicExchange", w_SharedByteData_atomicExchange },
+	{ "compareExchange", w_SharedByteData_compareExchange },
+	{ "fence", w_SharedByteData_fence },
+	{ 0, 0 }
+};
+
+int luaopen_sharedbytedata(lua_State *L)
+{
+	luax_register_type(L, &SharedByteData::type, w_Data_functions, w_SharedByteData_functions, nullptr);
+	love::data::luax_rundatawrapper(L, SharedByteData::type);
+	luax_runwrapper(L, sharedbytedata_lua, sizeof(sharedbytedata_lua), "SharedByteData.lua", SharedByteData::type, &ffifuncs);
+	return 0;
+}
+
+} // data
+} // love
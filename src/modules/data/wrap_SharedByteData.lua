@@ -0,0 +1,125 @@
+R"luastring"--(
+-- DO NOT REMOVE THE ABOVE LINE. It is used to load this file as a C++ string.
+-- There is a matching delimiter at the bottom of the file.
+
+--[[
+Copyright (c) 2006-2020 LOVE Development Team
+
+This software is provided 'as-is', without any express or implied
+warranty.  In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+claim that you wrote the original software. If you use this software
+in a product, an acknowledgment in the product documentation would be
+appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+--]]
+
+local SharedByteData_mt, ffifuncspointer_str = ...
+local SharedByteData = SharedByteData_mt.__index
+
+local type, tonumber = type, tonumber
+
+if type(jit) ~= "table" or not jit.status() then
+	-- LuaJIT's FFI is *much* slower than LOVE's regular methods when the JIT
+	-- compiler is disabled.
+	return
+end
+
+local status, ffi = pcall(require, "ffi")
+if not status then return end
+
+pcall(ffi.cdef, [[
+typedef struct Proxy Proxy;
+
+typedef struct FFI_SharedByteData
+{
+	bool (*atomicLoad)(Proxy *p, int atype, size_t offset, int64_t *result);
+	bool (*atomicStore)(Proxy *p, int atype, size_t offset, int64_t value);
+	bool (*atomicAdd)(Proxy *p, int atype, size_t offset, int64_t value, int64_t *result);
+	bool (*atomicExchange)(Proxy *p, int atype, size_t offset, int64_t value, int64_t *result);
+	int (*compareExchange)(Proxy *p, int atype, size_t offset, int64_t expected, int64_t desired, int64_t *result);
+	void (*fence)(void);
+} FFI_SharedByteData;
+]])
+
+local ffifuncs = ffi.cast("FFI_SharedByteData **", ffifuncspointer_str)[0]
+
+-- Must match the order of SharedByteData::AtomicType.
+local atomictypes = {
+	int32 = 0,
+	int64 = 1,
+}
+
+local result = ffi.new("int64_t[1]")
+
+-- The FFI functions return false (or -1 for compareExchange) for invalid
+-- arguments, in which case the regular methods are called to raise the
+-- appropriate error.
+
+local _atomicLoad = SharedByteData.atomicLoad
+local _atomicStore = SharedByteData.atomicStore
+local _atomicAdd = SharedByteData.atomicAdd
+local _atomicExchange = SharedByteData.atomicExchange
+local _compareExchange = SharedByteData.compareExchange
+
+local function validoffset(offset)
+	return type(offset) == "number" and offset >= 0
+end
+
+function SharedByteData:atomicLoad(offset, atype)
+	local t = atomictypes[atype or "int32"]
+	if t and validoffset(offset) and ffifuncs.atomicLoad(self, t, offset, result) then
+		return tonumber(result[0])
+	end
+	return _atomicLoad(self, offset, atype)
+end
+
+function SharedByteData:atomicStore(offset, value, atype)
+	local t = atomictypes[atype or "int32"]
+	if t and validoffset(offset) and type(value) == "number" and ffifuncs.atomicStore(self, t, offset, value) then
+		return
+	end
+	return _atomicStore(self, offset, value, atype)
+end
+
+function SharedByteData:atomicAdd(offset, value, atype)
+	local t = atomictypes[atype or "int32"]
+	if t and validoffset(offset) and type(value) == "number" and ffifuncs.atomicAdd(self, t, offset, value, result) then
+		return tonumber(result[0])
+	end
+	return _atomicAdd(self, offset, value, atype)
+end
+
+function SharedByteData:atomicExchange(offset, value, atype)
+	local t = atomictypes[atype or "int32"]
+	if t and validoffset(offset) and type(value) == "number" and ffifuncs.atomicExchange(self, t, offset, value, result) then
+		return tonumber(result[0])
+	end
+	return _atomicExchange(self, offset, value, atype)
+end
+
+function SharedByteData:compareExchange(offset, expected, desired, atype)
+	local t = atomictypes[atype or "int32"]
+	if t and validoffset(offset) and type(expected) == "number" and type(desired) == "number" then
+		local success = ffifuncs.compareExchange(self, t, offset, expected, desired, result)
+		if success >= 0 then
+			return success == 1, tonumber(result[0])
+		end
+	end
+	return _compareExchange(self, offset, expected, desired, atype)
+end
+
+function SharedByteData:fence()
+	ffifuncs.fence()
+end
+
+-- DO NOT REMOVE THE NEXT LINE. It is used to load this file as a C++ string.
+--)luastring"--"
@@ -83,6 +83,8 @@ GlyphData *TrueTypeRasterizer::getGlyphData(uint32 glyph) const
 	FT_Error err = FT_Err_Ok;
 	FT_UInt loadoption = hintingToLoadOption(hinting);
 
+	love::thread::Lock lock(mutex);
+
 	// Initialize
 	err = FT_Load_Glyph(face, FT_Get_Char_Index(face, glyph), FT_LOAD_DEFAULT | loadoption);
 
@@ -167,12 +169,14 @@ int TrueTypeRasterizer::getGlyphCount() const
 
 bool TrueTypeRasterizer::hasGlyph(uint32 glyph) const
 {
+	love::thread::Lock lock(mutex);
 	return FT_Get_Char_Index(face, glyph) != 0;
 }
 
 float TrueTypeRasterizer::getKerning(uint32 leftglyph, uint32 rightglyph) const
 {
 	FT_Vector kerning = {};
+	love::thread::Lock lock(mutex);
 	FT_Get_Kerning(face,
 	               FT_Get_Char_Index(face, leftglyph),
 	               FT_Get_Char_Index(face, rightglyph),
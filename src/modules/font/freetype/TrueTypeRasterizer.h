@@ -24,6 +24,7 @@
 // LOVE
 #include "filesystem/FileData.h"
 #include "font/TrueTypeRasterizer.h"
+#include "thread/threads.h"
 
 // FreeType2
 #include <ft2build.h>
@@ -69,6 +70,10 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 
 	Hinting hinting;
 
+	// FreeType faces can't be used by multiple threads at once, and glyphs
+	// may be rasterized on a background thread by graphics::Font.
+	love::thread::MutexRef mutex;
+
 }; // TrueTypeRasterizer
 
 } // freetype
@@ -25,11 +25,13 @@
 
 #include "common/math.h"
 #include "common/Matrix.h"
+#include "thread/threads.h"
 #include "Graphics.h"
 
 #include <math.h>
 #include <sstream>
 #include <algorithm> // for max
+#include <deque>
 #include <limits>
 
 namespace love
@@ -47,6 +49,208 @@ int Font::fontCount = 0;
 
 const vertex::CommonFormat Font::vertexFormat = vertex::CommonFormat::XYf_STus_RGBAub;
 
+std::vector<Font *> Font::asyncFonts;
+
+class Font::AsyncGlyphState : public Object
+{
+public:
+
+	struct Result
+	{
+		uint32 glyph;
+		love::font::GlyphData *data; // nullptr if rasterizing failed.
+		float dpiScale;
+	};
+
+	AsyncGlyphState(const std::vector<StrongRef<love::font::Rasterizer>> &rasterizers, bool useSpacesAsTab)
+		: rasterizers(rasterizers)
+		, useSpacesAsTab(useSpacesAsTab)
+		, cancelled(false)
+	{}
+
+	virtual ~AsyncGlyphState()
+	{
+		clearResults();
+	}
+
+	void rasterize(uint32 glyph)
+	{
+		Result result = {glyph, nullptr, 1.0f};
+
+		{
+			thread::Lock lock(rasterizerMutex);
+
+			if (cancelled)
+				return;
+
+			try
+			{
+				result.data = getRasterizerGlyphData(rasterizers, useSpacesAsTab, glyph, result.dpiScale);
+			}
+			catch (love::Exception &)
+			{
+				result.data = nullptr;
+			}
+		}
+
+		thread::Lock lock(resultMutex);
+		results.push_back(result);
+	}
+
+	void clearResults()
+	{
+		thread::Lock lock(resultMutex);
+
+		for (const Result &r : results)
+		{
+			if (r.data != nullptr)
+				r.data->release();
+		}
+
+		results.clear();
+	}
+
+	// Held while a glyph is being rasterized, so the Font can't release its
+	// rasterizers at the same time.
+	thread::MutexRef rasterizerMutex;
+	std::vector<StrongRef<love::font::Rasterizer>> rasterizers;
+	bool useSpacesAsTab;
+	bool cancelled;
+
+	thread::MutexRef resultMutex;
+	std::vector<Result> results;
+
+}; // AsyncGlyphState
+
+// A single background thread which rasterizes glyphs for every Font.
+class Font::RasterizerThread : public thread::Threadable
+{
+public:
+
+	RasterizerThread()
+		: stopping(false)
+	{
+		threadName = "GlyphRasterizer";
+	}
+
+	virtual ~RasterizerThread() {}
+
+	void threadFunction() override
+	{
+		while (true)
+		{
+			Job job;
+
+			{
+				thread::Lock lock(mutex);
+
+				while (!stopping && jobs.empty())
+					cond->wait(mutex);
+
+				if (stopping)
+					return;
+
+				job = jobs.front();
+				jobs.pop_front();
+			}
+
+			job.state->rasterize(job.glyph);
+		}
+	}
+
+	void push(AsyncGlyphState *state, uint32 glyph)
+	{
+		thread::Lock lock(mutex);
+
+		Job job;
+		job.state.set(state);
+		job.glyph = glyph;
+
+		jobs.push_back(job);
+		cond->signal();
+	}
+
+	void stop()
+	{
+		thread::Lock lock(mutex);
+		stopping = true;
+		jobs.clear();
+		cond->broadcast();
+	}
+
+	// Returns nullptr if the thread couldn't be started.
+	static RasterizerThread *getInstance()
+	{
+		struct Holder
+		{
+			RasterizerThread *thread = nullptr;
+			bool started = false;
+
+			~Holder()
+			{
+				if (thread != nullptr)
+				{
+					thread->stop();
+					thread->wait();
+					thread->release();
+				}
+			}
+		};
+
+		static Holder holder;
+
+		if (!holder.started)
+		{
+			holder.started = true;
+
+			RasterizerThread *thread = new RasterizerThread();
+
+			if (thread->start())
+				holder.thread = thread;
+			else
+				thread->release();
+		}
+
+		return holder.thread;
+	}
+
+private:
+
+	struct Job
+	{
+		StrongRef<AsyncGlyphState> state;
+		uint32 glyph;
+	};
+
+	thread::MutexRef mutex;
+	thread::ConditionalRef cond;
+	std::deque<Job> jobs;
+	bool stopping;
+
+}; // RasterizerThread
+
+namespace
+{
+
+// Marks the scope in which text is laid out for drawing.
+struct AsyncLayoutScope
+{
+	AsyncLayoutScope(int &depth)
+		: depth(depth)
+	{
+		depth++;
+	}
+
+	~AsyncLayoutScope()
+	{
+		depth--;
+	}
+
+	int &depth;
+};
+
+} // anonymous namespace
+
 Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 	: rasterizers({r})
 	, height(r->getHeight())
@@ -55,8 +259,17 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 	, textureHeight(128)
 	, filter(f)
 	, dpiScale(r->getDPIScale())
+	, textureMemoryBudget(0)
+	, evictions(0)
+	, rasterizations(0)
+	, frameRasterizations(0)
+	, rasterizationFrame(0)
 	, useSpacesAsTab(false)
 	, textureCacheID(0)
+	, asyncState(nullptr)
+	, asyncRasterization(false)
+	, asyncLayoutDepth(0)
+	, layoutCacheVertices(0)
 {
 	filter.mipmap = Texture::FILTER_NONE;
 
@@ -83,12 +296,33 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 	if (!r->hasGlyph(9)) // No tab character in the Rasterizer.
 		useSpacesAsTab = true;
 
+	// The real advance of a glyph isn't known until it's rasterized.
+	placeholderGlyph.texture = nullptr;
+	placeholderGlyph.page = -1;
+	placeholderGlyph.spacing = floorf(r->getAdvance() / dpiScale + 0.5f);
+
 	loadVolatile();
 	++fontCount;
 }
 
 Font::~Font()
 {
+	if (asyncState != nullptr)
+	{
+		asyncFonts.erase(std::remove(asyncFonts.begin(), asyncFonts.end(), this), asyncFonts.end());
+
+		// The background thread may still hold a reference to the state, but
+		// the rasterizers should be released on this thread.
+		{
+			thread::Lock lock(asyncState->rasterizerMutex);
+			asyncState->cancelled = true;
+			asyncState->rasterizers.clear();
+		}
+
+		asyncState->clearResults();
+		asyncState->release();
+	}
+
 	--fontCount;
 }
 
@@ -123,7 +357,7 @@ bool Font::loadVolatile()
 {
 	textureCacheID++;
 	glyphs.clear();
-	images.clear();
+	pages.clear();
 	createTexture();
 	return true;
 }
@@ -141,43 +375,28 @@ void Font::createTexture()
 	// If we have an existing texture already, we'll try replacing it with a
 	// larger-sized one rather than creating a second one. Having a single
 	// texture reduces texture switches and draw calls when rendering.
-	if ((nextsize.width > size.width || nextsize.height > size.height) && !images.empty())
+	if ((nextsize.width > size.width || nextsize.height > size.height) && !pages.empty())
 	{
 		recreatetexture = true;
 		size = nextsize;
-		images.pop_back();
+		pages.pop_back();
 	}
 
 	Image::Settings settings;
 	image = gfx->newImage(TEXTURE_2D, pixelFormat, size.width, size.height, 1, settings);
 	image->setFilter(filter);
 
-	{
-		size_t bpp = getPixelFormatSize(pixelFormat);
-		size_t pixelcount = size.width * size.height;
+	AtlasPage page;
+	page.image.set(image, Acquire::NORETAIN);
+	page.usedArea = 0;
+	page.lastUsedFrame = getFrameIndex();
 
-		// Initialize the texture with transparent white for Luminance-Alpha
-		// formats (since we keep luminance constant and vary alpha in those
-		// glyphs), and transparent black otherwise.
-		std::vector<uint8> emptydata(pixelcount * bpp, 0);
-
-		if (pixelFormat == PIXELFORMAT_LA8)
-		{
-			for (size_t i = 0; i < pixelcount; i++)
-				emptydata[i * 2 + 0] = 255;
-		}
-
-		Rect rect = {0, 0, size.width, size.height};
-		image->replacePixels(emptydata.data(), emptydata.size(), 0, 0, rect, false);
-	}
-
-	images.emplace_back(image, Acquire::NORETAIN);
+	pages.push_back(page);
+	clearPage(pages.back());
 
 	textureWidth  = size.width;
 	textureHeight = size.height;
 
-	rowHeight = textureX = textureY = TEXTURE_PADDING;
-
 	// Re-add the old glyphs if we re-created the existing texture object.
 	if (recreatetexture)
 	{
@@ -195,13 +414,233 @@ void Font::createTexture()
 	}
 }
 
+void Font::clearPage(AtlasPage &page)
+{
+	Image *image = page.image;
+
+	int w = image->getPixelWidth();
+	int h = image->getPixelHeight();
+
+	size_t bpp = getPixelFormatSize(pixelFormat);
+	size_t pixelcount = w * h;
+
+	// Initialize the texture with transparent white for Luminance-Alpha
+	// formats (since we keep luminance constant and vary alpha in those
+	// glyphs), and transparent black otherwise.
+	std::vector<uint8> emptydata(pixelcount * bpp, 0);
+
+	if (pixelFormat == PIXELFORMAT_LA8)
+	{
+		for (size_t i = 0; i < pixelcount; i++)
+			emptydata[i * 2 + 0] = 255;
+	}
+
+	Rect rect = {0, 0, w, h};
+	image->replacePixels(emptydata.data(), emptydata.size(), 0, 0, rect, false);
+
+	SkylineNode node = {TEXTURE_PADDING, TEXTURE_PADDING, w - TEXTURE_PADDING};
+
+	page.skyline.clear();
+	page.skyline.push_back(node);
+	page.usedArea = 0;
+}
+
+bool Font::evictPage()
+{
+	uint64 frame = getFrameIndex();
+	int oldest = -1;
+
+	// Glyphs used in the current frame may still be referenced by vertices
+	// which are about to be drawn, so their pages are never evicted.
+	for (int i = 0; i < (int) pages.size(); i++)
+	{
+		if (pages[i].lastUsedFrame == frame)
+			continue;
+
+		if (oldest < 0 || pages[i].lastUsedFrame < pages[oldest].lastUsedFrame)
+			oldest = i;
+	}
+
+	if (oldest < 0)
+		return false;
+
+	for (auto it = glyphs.begin(); it != glyphs.end(); )
+	{
+		if (it->second.page == oldest)
+		{
+			it = glyphs.erase(it);
+			evictions++;
+		}
+		else
+			++it;
+	}
+
+	clearPage(pages[oldest]);
+	pages[oldest].lastUsedFrame = frame;
+
+	textureCacheID++;
+	return true;
+}
+
+bool Font::packGlyph(int w, int h, int &page, int &x, int &y)
+{
+	for (int p = 0; p < (int) pages.size(); p++)
+	{
+		AtlasPage &atlas = pages[p];
+
+		int besttop = std::numeric_limits<int>::max();
+		int bestwidth = std::numeric_limits<int>::max();
+		int besty = -1;
+		size_t bestnode = 0;
+
+		// Bottom-left heuristic: place the rectangle where its top edge ends
+		// up lowest, preferring narrower segments to reduce wasted space.
+		for (size_t i = 0; i < atlas.skyline.size(); i++)
+		{
+			int fity = fitSkyline(atlas, i, w, h);
+			if (fity < 0)
+				continue;
+
+			int top = fity + h;
+			int width = atlas.skyline[i].width;
+
+			if (top < besttop || (top == besttop && width < bestwidth))
+			{
+				besttop = top;
+				bestwidth = width;
+				besty = fity;
+				bestnode = i;
+			}
+		}
+
+		if (besty >= 0)
+		{
+			page = p;
+			x = atlas.skyline[bestnode].x;
+			y = besty;
+
+			addSkylineNode(atlas, bestnode, x, y, w, h);
+			atlas.usedArea += w * h;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int Font::fitSkyline(const AtlasPage &page, size_t node, int w, int h) const
+{
+	const std::vector<SkylineNode> &skyline = page.skyline;
+
+	if (skyline[node].x + w > page.image->getPixelWidth())
+		return -1;
+
+	int pageheight = page.image->getPixelHeight();
+	int y = skyline[node].y;
+	int widthleft = w;
+
+	// The rectangle rests on the highest segment it spans.
+	for (size_t i = node; widthleft > 0; i++)
+	{
+		if (i >= skyline.size())
+			return -1;
+
+		y = std::max(y, skyline[i].y);
+
+		if (y + h > pageheight)
+			return -1;
+
+		widthleft -= skyline[i].width;
+	}
+
+	return y;
+}
+
+void Font::addSkylineNode(AtlasPage &page, size_t node, int x, int y, int w, int h)
+{
+	std::vector<SkylineNode> &skyline = page.skyline;
+
+	SkylineNode newnode = {x, y + h, w};
+	skyline.insert(skyline.begin() + node, newnode);
+
+	// Shrink or remove the segments which are now covered by the new one.
+	for (size_t i = node + 1; i < skyline.size(); )
+	{
+		const SkylineNode &prev = skyline[i - 1];
+		SkylineNode &n = skyline[i];
+
+		int prevright = prev.x + prev.width;
+
+		if (n.x >= prevright)
+			break;
+
+		int shrink = prevright - n.x;
+		n.x += shrink;
+		n.width -= shrink;
+
+		if (n.width > 0)
+			break;
+
+		skyline.erase(skyline.begin() + i);
+	}
+
+	// Merge neighbouring segments at the same height.
+	for (size_t i = 0; i + 1 < skyline.size(); )
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+}
+
+int64 Font::getTextureMemory() const
+{
+	int64 bytes = 0;
+	int64 bpp = (int64) getPixelFormatSize(pixelFormat);
+
+	for (const AtlasPage &page : pages)
+		bytes += (int64) page.image->getPixelWidth() * page.image->getPixelHeight() * bpp;
+
+	return bytes;
+}
+
+uint64 Font::getFrameIndex() const
+{
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+	return gfx != nullptr ? gfx->getFrameIndex() : 0;
+}
+
+void Font::countRasterization()
+{
+	uint64 frame = getFrameIndex();
+
+	if (frame != rasterizationFrame)
+	{
+		rasterizationFrame = frame;
+		frameRasterizations = 0;
+	}
+
+	frameRasterizations++;
+	rasterizations++;
+}
+
 void Font::unloadVolatile()
 {
 	glyphs.clear();
-	images.clear();
+	pages.clear();
 }
 
 love::font::GlyphData *Font::getRasterizerGlyphData(uint32 glyph, float &dpiscale)
+{
+	return getRasterizerGlyphData(rasterizers, useSpacesAsTab, glyph, dpiscale);
+}
+
+love::font::GlyphData *Font::getRasterizerGlyphData(const std::vector<StrongRef<love::font::Rasterizer>> &rasterizers, bool useSpacesAsTab, uint32 glyph, float &dpiscale)
 {
 	// Use spaces for the tab 'glyph'.
 	if (glyph == 9 && useSpacesAsTab)
@@ -238,33 +677,20 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 	float glyphdpiscale = getDPIScale();
 	StrongRef<love::font::GlyphData> gd(getRasterizerGlyphData(glyph, glyphdpiscale), Acquire::NORETAIN);
 
-	int w = gd->getWidth();
-	int h = gd->getHeight();
-
-	if (w + TEXTURE_PADDING * 2 < textureWidth && h + TEXTURE_PADDING * 2 < textureHeight)
-	{
-		if (textureX + w + TEXTURE_PADDING > textureWidth)
-		{
-			// Out of space - new row!
-			textureX = TEXTURE_PADDING;
-			textureY += rowHeight;
-			rowHeight = TEXTURE_PADDING;
-		}
+	return addGlyph(glyph, gd, glyphdpiscale);
+}
 
-		if (textureY + h + TEXTURE_PADDING > textureHeight)
-		{
-			// Totally out of space - new texture!
-			createTexture();
+const Font::Glyph &Font::addGlyph(uint32 glyph, love::font::GlyphData *gd, float glyphdpiscale)
+{
+	countRasterization();
 
-			// Makes sure the above code for checking if the glyph can fit at
-			// the current position in the texture is run again for this glyph.
-			return addGlyph(glyph);
-		}
-	}
+	int w = gd->getWidth();
+	int h = gd->getHeight();
 
 	Glyph g;
 
 	g.texture = 0;
+	g.page = -1;
 	g.spacing = floorf(gd->getAdvance() / glyphdpiscale + 0.5f);
 
 	memset(g.vertices, 0, sizeof(GlyphVertex) * 4);
@@ -272,8 +698,42 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 	// Don't waste space for empty glyphs.
 	if (w > 0 && h > 0)
 	{
-		Image *image = images.back();
+		int page = 0;
+		int textureX = 0;
+		int textureY = 0;
+
+		while (!packGlyph(w + TEXTURE_PADDING, h + TEXTURE_PADDING, page, textureX, textureY))
+		{
+			// Out of space. Grow the texture, add a new one, or reuse the least
+			// recently used one if the memory budget doesn't allow the others.
+			TextureSize nextsize = getNextTextureSize();
+			bool cangrow = nextsize.width > textureWidth || nextsize.height > textureHeight;
+			bool fitsempty = w + TEXTURE_PADDING * 2 <= textureWidth && h + TEXTURE_PADDING * 2 <= textureHeight;
+
+			if (!fitsempty && !cangrow)
+				throw love::Exception("Glyph %u is too large to fit in the Font's texture atlas.", (unsigned int) glyph);
+
+			if (fitsempty && textureMemoryBudget > 0)
+			{
+				int64 bpp = (int64) getPixelFormatSize(pixelFormat);
+				int64 newpixels = (int64) textureWidth * textureHeight;
+
+				if (cangrow)
+					newpixels = (int64) nextsize.width * nextsize.height - newpixels;
+
+				if (getTextureMemory() + newpixels * bpp > textureMemoryBudget && evictPage())
+					continue;
+			}
+
+			createTexture();
+		}
+
+		AtlasPage &atlas = pages[page];
+		atlas.lastUsedFrame = getFrameIndex();
+
+		Image *image = atlas.image;
 		g.texture = image;
+		g.page = page;
 
 		Rect rect = {textureX, textureY, gd->getWidth(), gd->getHeight()};
 		image->replacePixels(gd->getData(), gd->getSize(), 0, 0, rect, false);
@@ -306,9 +766,6 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 			g.vertices[i].x += gd->getBearingX() / glyphdpiscale;
 			g.vertices[i].y -= gd->getBearingY() / glyphdpiscale;
 		}
-
-		textureX += w + TEXTURE_PADDING;
-		rowHeight = std::max(rowHeight, h + TEXTURE_PADDING);
 	}
 
 	glyphs[glyph] = g;
@@ -320,11 +777,121 @@ const Font::Glyph &Font::findGlyph(uint32 glyph)
 	const auto it = glyphs.find(glyph);
 
 	if (it != glyphs.end())
+	{
+		if (it->second.page >= 0)
+			pages[it->second.page].lastUsedFrame = getFrameIndex();
+
 		return it->second;
+	}
+
+	if (asyncRasterization && asyncLayoutDepth > 0 && failedGlyphs.count(glyph) == 0)
+	{
+		if (requestAsyncGlyph(glyph))
+			return placeholderGlyph;
+	}
 
 	return addGlyph(glyph);
 }
 
+bool Font::requestAsyncGlyph(uint32 glyph)
+{
+	if (pendingGlyphs.count(glyph) != 0)
+		return true;
+
+	RasterizerThread *thread = RasterizerThread::getInstance();
+	if (thread == nullptr)
+		return false;
+
+	if (asyncState == nullptr)
+	{
+		asyncState = new AsyncGlyphState(rasterizers, useSpacesAsTab);
+		asyncFonts.push_back(this);
+	}
+
+	pendingGlyphs.insert(glyph);
+	thread->push(asyncState, glyph);
+
+	return true;
+}
+
+void Font::uploadAsyncGlyphResults()
+{
+	std::vector<AsyncGlyphState::Result> results;
+
+	{
+		thread::Lock lock(asyncState->resultMutex);
+		results.swap(asyncState->results);
+	}
+
+	if (results.empty())
+		return;
+
+	for (const AsyncGlyphState::Result &r : results)
+	{
+		StrongRef<love::font::GlyphData> gd(r.data, Acquire::NORETAIN);
+
+		pendingGlyphs.erase(r.glyph);
+
+		// The glyph may have been needed for measuring text in the meantime.
+		if (glyphs.find(r.glyph) != glyphs.end())
+			continue;
+
+		if (gd.get() == nullptr)
+		{
+			// Errors are reported when the glyph is rasterized on this thread.
+			failedGlyphs.insert(r.glyph);
+			continue;
+		}
+
+		try
+		{
+			addGlyph(r.glyph, gd, r.dpiScale);
+		}
+		catch (love::Exception &)
+		{
+			failedGlyphs.insert(r.glyph);
+		}
+	}
+
+	// Text which was laid out with placeholders has to be generated again.
+	textureCacheID++;
+}
+
+void Font::uploadAsyncGlyphs()
+{
+	for (Font *font : asyncFonts)
+		font->uploadAsyncGlyphResults();
+}
+
+void Font::setAsyncRasterization(bool enable)
+{
+	asyncRasterization = enable;
+}
+
+bool Font::isAsyncRasterization() const
+{
+	return asyncRasterization;
+}
+
+void Font::preload(const std::string &text)
+{
+	Codepoints codepoints;
+	getCodepointsFromString(text, codepoints);
+
+	for (uint32 g : codepoints)
+	{
+		if (g == '\n' || g == '\r')
+			continue;
+
+		if (glyphs.find(g) != glyphs.end() || failedGlyphs.count(g) != 0)
+			continue;
+
+		// Without a background thread the glyphs are loaded right away.
+		if (!requestAsyncGlyph(g))
+			findGlyph(g);
+	}
+}
+
 float Font::getKerning(uint32 leftglyph, uint32 rightglyph)
 {
 	uint64 packedglyphs = ((uint64) leftglyph << 32) | (uint64) rightglyph;
@@ -423,6 +990,8 @@ float Font::getHeight() const
 
 std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &codepoints, const Colorf &constantcolor, std::vector<GlyphVertex> &vertices, float extra_spacing, Vector2 offset, TextInfo *info)
 {
+	AsyncLayoutScope asyncscope(asyncLayoutDepth);
+
 	// Spacing counter and newline handling.
 	float dx = offset.x;
 	float dy = offset.y;
@@ -567,6 +1136,8 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 
 std::vector<Font::DrawCommand> Font::generateVerticesFormatted(const ColoredCodepoints &text, const Colorf &constantcolor, float wrap, AlignMode align, std::vector<GlyphVertex> &vertices, TextInfo *info)
 {
+	AsyncLayoutScope asyncscope(asyncLayoutDepth);
+
 	wrap = std::max(wrap, 0.0f);
 
 	uint32 cacheid = textureCacheID;
@@ -678,26 +1249,161 @@ void Font::printv(graphics::Graphics *gfx, const Matrix4 &t, const std::vector<D
 	}
 }
 
-void Font::print(graphics::Graphics *gfx, const std::vector<ColoredString> &text, const Matrix4 &m, const Colorf &constantcolor)
+size_t Font::getLayoutHash(const std::vector<ColoredString> &text, const Colorf &constantcolor, float wrap, AlignMode align, bool formatted)
 {
-	ColoredCodepoints codepoints;
-	getCodepointsFromString(text, codepoints);
+	size_t h = 0;
+
+	auto combine = [&](size_t v)
+	{
+		h ^= v + 0x9E3779B9 + (h << 6) + (h >> 2);
+	};
+
+	std::hash<float> floathash;
 
-	std::vector<GlyphVertex> vertices;
-	std::vector<DrawCommand> drawcommands = generateVertices(codepoints, constantcolor, vertices);
+	for (const ColoredString &cstr : text)
+	{
+		combine(std::hash<std::string>()(cstr.str));
+		combine(floathash(cstr.color.r));
+		combine(floathash(cstr.color.g));
+		combine(floathash(cstr.color.b));
+		combine(floathash(cstr.color.a));
+	}
+
+	combine(floathash(constantcolor.r));
+	combine(floathash(constantcolor.g));
+	combine(floathash(constantcolor.b));
+	combine(floathash(constantcolor.a));
+
+	if (formatted)
+	{
+		combine(floathash(wrap));
+		combine((size_t) align);
+	}
 
-	printv(gfx, m, drawcommands, vertices);
+	combine((size_t) formatted);
+
+	return h;
 }
 
-void Font::printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantcolor)
+const Font::CachedLayout &Font::getCachedLayout(const std::vector<ColoredString> &text, const Colorf &constantcolor, float wrap, AlignMode align, bool formatted, CachedLayout &uncached)
+{
+	size_t hash = getLayoutHash(text, constantcolor, wrap, align, formatted);
+
+	auto it = layoutCache.find(hash);
+
+	if (it != layoutCache.end())
+	{
+		CachedLayout &layout = *it->second;
+
+		bool match = layout.formatted == formatted
+			&& layout.constantColor == constantcolor
+			&& (!formatted || (layout.wrap == wrap && layout.align == align))
+			&& layout.text.size() == text.size();
+
+		for (size_t i = 0; match && i < text.size(); i++)
+			match = layout.text[i].color == text[i].color && layout.text[i].str == text[i].str;
+
+		if (match && layout.textureCacheID == textureCacheID)
+		{
+			// Move it to the front of the LRU list.
+			layoutList.splice(layoutList.begin(), layoutList, it->second);
+
+			// Keep the atlas pages used by the text from being evicted.
+			uint64 frame = getFrameIndex();
+			for (int page : layout.pages)
+				pages[page].lastUsedFrame = frame;
+
+			return layout;
+		}
+
+		// Either the glyphs have changed since the layout was generated, or
+		// this is a hash collision with different text. It'll be replaced.
+		layoutCacheVertices -= layout.vertices.size();
+		layoutList.erase(it->second);
+		layoutCache.erase(it);
+	}
+
+	CachedLayout newlayout;
+	newlayout.hash = hash;
+	newlayout.text = text;
+	newlayout.constantColor = constantcolor;
+	newlayout.wrap = wrap;
+	newlayout.align = align;
+	newlayout.formatted = formatted;
+
+	generateLayout(newlayout);
+
+	if (newlayout.vertices.size() > MAX_CACHED_LAYOUT_VERTICES / 4)
+	{
+		uncached = std::move(newlayout);
+		return uncached;
+	}
+
+	while (!layoutList.empty() && (layoutList.size() >= MAX_CACHED_LAYOUTS
+		|| layoutCacheVertices + newlayout.vertices.size() > MAX_CACHED_LAYOUT_VERTICES))
+	{
+		const CachedLayout &oldest = layoutList.back();
+		layoutCacheVertices -= oldest.vertices.size();
+		layoutCache.erase(oldest.hash);
+		layoutList.pop_back();
+	}
+
+	layoutCacheVertices += newlayout.vertices.size();
+	layoutList.push_front(std::move(newlayout));
+	layoutCache[hash] = layoutList.begin();
+
+	return layoutList.front();
+}
+
+void Font::generateLayout(CachedLayout &layout)
 {
 	ColoredCodepoints codepoints;
-	getCodepointsFromString(text, codepoints);
+	getCodepointsFromString(layout.text, codepoints);
+
+	layout.vertices.clear();
+
+	if (layout.formatted)
+		layout.drawCommands = generateVerticesFormatted(codepoints, layout.constantColor, layout.wrap, layout.align, layout.vertices);
+	else
+		layout.drawCommands = generateVertices(codepoints, layout.constantColor, layout.vertices);
 
-	std::vector<GlyphVertex> vertices;
-	std::vector<DrawCommand> drawcommands = generateVerticesFormatted(codepoints, constantcolor, wrap, align, vertices);
+	layout.textureCacheID = textureCacheID;
 
-	printv(gfx, m, drawcommands, vertices);
+	layout.pages.clear();
+	for (const DrawCommand &cmd : layout.drawCommands)
+	{
+		for (size_t i = 0; i < pages.size(); i++)
+		{
+			if (pages[i].image.get() == cmd.texture)
+			{
+				layout.pages.push_back((int) i);
+				break;
+			}
+		}
+	}
+}
+
+void Font::clearLayoutCache()
+{
+	layoutCache.clear();
+	layoutList.clear();
+	layoutCacheVertices = 0;
+}
+
+void Font::print(graphics::Graphics *gfx, const std::vector<ColoredString> &text, const Matrix4 &m, const Colorf &constantcolor)
+{
+	CachedLayout uncached;
+	const CachedLayout &layout = getCachedLayout(text, constantcolor, 0.0f, ALIGN_LEFT, false, uncached);
+
+	printv(gfx, m, layout.drawCommands, layout.vertices);
+}
+
+void Font::printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantcolor)
+{
+	CachedLayout uncached;
+	const CachedLayout &layout = getCachedLayout(text, constantcolor, wrap, align, true, uncached);
+
+	printv(gfx, m, layout.drawCommands, layout.vertices);
 }
 
 int Font::getWidth(const std::string &str)
@@ -935,6 +1641,7 @@ void Font::getWrap(const std::vector<ColoredString> &text, float wraplimit, std:
 void Font::setLineHeight(float height)
 {
 	lineHeight = height;
+	clearLayoutCache();
 }
 
 float Font::getLineHeight() const
@@ -944,8 +1651,8 @@ float Font::getLineHeight() const
 
 void Font::setFilter(const Texture::Filter &f)
 {
-	for (const auto &image : images)
-		image->setFilter(f);
+	for (const AtlasPage &page : pages)
+		page.image->setFilter(f);
 
 	filter = f;
 }
@@ -1026,6 +1733,14 @@ void Font::setFallbacks(const std::vector<Font *> &fallbacks)
 	// NOTE: this won't invalidate already-rasterized glyphs.
 	for (const Font *f : fallbacks)
 		rasterizers.push_back(f->rasterizers[0]);
+
+	clearLayoutCache();
+
+	if (asyncState != nullptr)
+	{
+		thread::Lock lock(asyncState->rasterizerMutex);
+		asyncState->rasterizers = rasterizers;
+	}
 }
 
 float Font::getDPIScale() const
@@ -1038,6 +1753,47 @@ uint32 Font::getTextureCacheID() const
 	return textureCacheID;
 }
 
+void Font::setTextureMemoryBudget(int64 bytes)
+{
+	textureMemoryBudget = std::max(bytes, (int64) 0);
+}
+
+int64 Font::getTextureMemoryBudget() const
+{
+	return textureMemoryBudget;
+}
+
+Font::AtlasStats Font::getAtlasStats()
+{
+	AtlasStats stats = {};
+
+	int64 usedarea = 0;
+	int64 totalarea = 0;
+
+	for (const AtlasPage &page : pages)
+	{
+		usedarea += page.usedArea;
+		totalarea += (int64) page.image->getPixelWidth() * page.image->getPixelHeight();
+	}
+
+	if (getFrameIndex() != rasterizationFrame)
+	{
+		rasterizationFrame = getFrameIndex();
+		frameRasterizations = 0;
+	}
+
+	stats.pages = (int) pages.size();
+	stats.glyphs = (int) glyphs.size();
+	stats.textureMemory = getTextureMemory();
+	stats.textureMemoryBudget = textureMemoryBudget;
+	stats.occupancy = totalarea > 0 ? (double) usedarea / (double) totalarea : 0.0;
+	stats.evictions = evictions;
+	stats.rasterizations = rasterizations;
+	stats.frameRasterizations = frameRasterizations;
+
+	return stats;
+}
+
 bool Font::getConstant(const char *in, AlignMode &out)
 {
 	return alignModes.find(in, out);
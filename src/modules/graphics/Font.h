@@ -21,7 +21,9 @@
 #pragma once
 
 // STD
+#include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
 #include <stddef.h>
@@ -88,6 +90,22 @@ class Font : public Object, public Volatile
 		int height;
 	};
 
+	// Statistics about the glyph atlas textures.
+	struct AtlasStats
+	{
+		int pages;
+		int glyphs;
+		int64 textureMemory;
+		int64 textureMemoryBudget;
+
+		// Fraction of the atlas area used by glyphs, in [0, 1].
+		double occupancy;
+
+		int64 evictions;
+		int64 rasterizations;
+		int frameRasterizations;
+	};
+
 	// Used to determine when to change textures in the generated vertex array.
 	struct DrawCommand
 	{
@@ -176,6 +194,39 @@ class Font : public Object, public Volatile
 
 	uint32 getTextureCacheID() const;
 
+	/**
+	 * Sets the amount of texture memory the glyph atlases should stay within,
+	 * in bytes. When an atlas runs out of space and growing it would go over
+	 * the budget, the least recently used atlas page is cleared instead. Pages
+	 * used in the current frame are never evicted, so the budget can still be
+	 * exceeded temporarily. A budget of 0 means no limit.
+	 **/
+	void setTextureMemoryBudget(int64 bytes);
+	int64 getTextureMemoryBudget() const;
+
+	AtlasStats getAtlasStats();
+
+	/**
+	 * Sets whether glyphs which aren't in the atlas yet are rasterized on a
+	 * background thread when text is drawn, instead of right away. Until a
+	 * glyph is ready its space is left empty, and the text is laid out again
+	 * once the glyph has been added. Measuring text always uses real glyphs.
+	 **/
+	void setAsyncRasterization(bool enable);
+	bool isAsyncRasterization() const;
+
+	/**
+	 * Rasterizes the glyphs in the string on a background thread, so they can
+	 * be drawn later without stalling.
+	 **/
+	void preload(const std::string &text);
+
+	/**
+	 * Adds glyphs which have finished rasterizing on the background thread to
+	 * the atlases of their Fonts. Called by Graphics at the start of a frame.
+	 **/
+	static void uploadAsyncGlyphs();
+
 	// Implements Volatile.
 	bool loadVolatile() override;
 	void unloadVolatile() override;
@@ -191,6 +242,7 @@ class Font : public Object, public Volatile
 	struct Glyph
 	{
 		Texture *texture;
+		int page; // -1 for empty glyphs, which don't use any atlas space.
 		int spacing;
 		GlyphVertex vertices[4];
 	};
@@ -201,14 +253,70 @@ class Font : public Object, public Volatile
 		int height;
 	};
 
+	// A horizontal segment of the top edge of the packed area in a page.
+	struct SkylineNode
+	{
+		int x;
+		int y;
+		int width;
+	};
+
+	struct AtlasPage
+	{
+		StrongRef<love::graphics::Image> image;
+		std::vector<SkylineNode> skyline;
+		int usedArea;
+		uint64 lastUsedFrame;
+	};
+
+	// Vertices generated by print or printf, which can be reused for later
+	// calls with the same arguments until the texture cache is invalidated.
+	struct CachedLayout
+	{
+		size_t hash;
+		std::vector<ColoredString> text;
+		Colorf constantColor;
+		float wrap;
+		AlignMode align;
+		bool formatted;
+		uint32 textureCacheID;
+		std::vector<GlyphVertex> vertices;
+		std::vector<DrawCommand> drawCommands;
+		std::vector<int> pages; // Atlas pages used by the vertices.
+	};
+
+	class AsyncGlyphState;
+	class RasterizerThread;
+
 	void createTexture();
+	void clearPage(AtlasPage &page);
+	bool evictPage();
+
+	bool packGlyph(int w, int h, int &page, int &x, int &y);
+	int fitSkyline(const AtlasPage &page, size_t node, int w, int h) const;
+	void addSkylineNode(AtlasPage &page, size_t node, int x, int y, int w, int h);
+
+	int64 getTextureMemory() const;
+	uint64 getFrameIndex() const;
+	void countRasterization();
 
 	TextureSize getNextTextureSize() const;
 	love::font::GlyphData *getRasterizerGlyphData(uint32 glyph, float &dpiscale);
 	const Glyph &addGlyph(uint32 glyph);
+	const Glyph &addGlyph(uint32 glyph, love::font::GlyphData *gd, float glyphdpiscale);
 	const Glyph &findGlyph(uint32 glyph);
+
+	bool requestAsyncGlyph(uint32 glyph);
+	void uploadAsyncGlyphResults();
+
+	static love::font::GlyphData *getRasterizerGlyphData(const std::vector<StrongRef<love::font::Rasterizer>> &rasterizers, bool useSpacesAsTab, uint32 glyph, float &dpiscale);
 	void printv(Graphics *gfx, const Matrix4 &t, const std::vector<DrawCommand> &drawcommands, const std::vector<GlyphVertex> &vertices);
 
+	static size_t getLayoutHash(const std::vector<ColoredString> &text, const Colorf &constantcolor, float wrap, AlignMode align, bool formatted);
+	const CachedLayout &getCachedLayout(const std::vector<ColoredString> &text, const Colorf &constantcolor, float wrap, AlignMode align, bool formatted, CachedLayout &uncached);
+	void generateLayout(CachedLayout &layout);
+	void clearLayoutCache();
+
 	std::vector<StrongRef<love::font::Rasterizer>> rasterizers;
 
 	int height;
@@ -217,7 +325,7 @@ class Font : public Object, public Volatile
 	int textureWidth;
 	int textureHeight;
 
-	std::vector<StrongRef<love::graphics::Image>> images;
+	std::vector<AtlasPage> pages;
 
 	// maps glyphs to glyph texture information
 	std::unordered_map<uint32, Glyph> glyphs;
@@ -231,14 +339,41 @@ class Font : public Object, public Volatile
 
 	float dpiScale;
 
-	int textureX, textureY;
-	int rowHeight;
+	int64 textureMemoryBudget;
+
+	int64 evictions;
+	int64 rasterizations;
+	int frameRasterizations;
+	uint64 rasterizationFrame;
 
 	bool useSpacesAsTab;
 
 	// ID which is incremented when the texture cache is invalidated.
 	uint32 textureCacheID;
 
+	// Shared with the background rasterization thread. Only created once a
+	// glyph is requested from it.
+	AsyncGlyphState *asyncState;
+	bool asyncRasterization;
+
+	// Non-zero while text is being laid out for drawing, which is when
+	// placeholders can be used for glyphs which aren't ready yet.
+	int asyncLayoutDepth;
+
+	// Empty glyph used in place of glyphs which are being rasterized.
+	Glyph placeholderGlyph;
+
+	std::unordered_set<uint32> pendingGlyphs;
+	std::unordered_set<uint32> failedGlyphs;
+
+	// Most recently used layouts are at the front of the list.
+	std::list<CachedLayout> layoutList;
+	std::unordered_map<size_t, std::list<CachedLayout>::iterator> layoutCache;
+	size_t layoutCacheVertices;
+
+	// Fonts which have requested glyphs from the background thread.
+	static std::vector<Font *> asyncFonts;
+
 	// 1 pixel of transparent padding between glyphs (so quads won't pick up
 	// other glyphs), plus one pixel of transparent padding that the quads will
 	// use, for edge antialiasing.
@@ -247,6 +382,11 @@ class Font : public Object, public Volatile
 	// This will be used if the Rasterizer doesn't have a tab character itself.
 	static const int SPACES_PER_TAB = 4;
 
+	// Limits for the print and printf layout cache. Layouts which would use
+	// more than a quarter of the vertex limit by themselves aren't cached.
+	static const size_t MAX_CACHED_LAYOUTS = 512;
+	static const size_t MAX_CACHED_LAYOUT_VERTICES = 64 * 1024;
+
 	static StringMap<AlignMode, ALIGN_MAX_ENUM>::Entry alignModeEntries[];
 	static StringMap<AlignMode, ALIGN_MAX_ENUM> alignModes;
 	
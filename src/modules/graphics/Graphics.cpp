@@ -32,10 +32,13 @@
 #include "Video.h"
 #include "Text.h"
 #include "common/deprecation.h"
+#include "common/memory.h"
 
 // C++
 #include <algorithm>
+#include <limits>
 #include <stdlib.h>
+#include <string.h>
 
 namespace love
 {
@@ -119,6 +122,10 @@ Graphics::Graphics()
 	, canvasSwitchCount(0)
 	, drawCalls(0)
 	, drawCallsBatched(0)
+	, sortedBatchesBefore(0)
+	, sortedBatchesAfter(0)
+	, indexLimitFlushes(0)
+	, frameIndex(0)
 	, quadIndexBuffer(nullptr)
 	, capabilities()
 	, cachedShaderStages()
@@ -982,6 +989,9 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 {
 	using namespace vertex;
 
+	if (sortedStreamDraws.active && !sortedStreamDraws.resolving)
+		return requestSortedStreamDraw(cmd);
+
 	StreamBufferState &state = streamBufferState;
 
 	bool shouldflush = false;
@@ -998,12 +1008,27 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 
 	int totalvertices = state.vertexCount + cmd.vertexCount;
 
-	// We only support uint16 index buffers for now.
-	if (totalvertices > LOVE_UINT16_MAX && cmd.indexMode != TriangleIndexMode::NONE)
+	// A new batch always starts out with uint16 indices.
+	IndexDataType indextype = shouldflush ? INDEX_UINT16 : state.indexType;
+
+	// Batches which grow too large for uint16 indices are restarted with
+	// uint32 indices when the system supports them, so they can keep growing.
+	if (cmd.indexMode != TriangleIndexMode::NONE && indextype == INDEX_UINT16
+		&& (shouldflush ? cmd.vertexCount : totalvertices) > LOVE_UINT16_MAX)
+	{
+		if (!shouldflush && state.vertexCount > 0)
+			indexLimitFlushes++;
+
 		shouldflush = true;
 
+		if (capabilities.features[FEATURE_INDEX_UINT32])
+			indextype = INDEX_UINT32;
+	}
+
+	size_t indexsize = getIndexDataSize(indextype);
+
 	int reqIndexCount = getIndexCount(cmd.indexMode, cmd.vertexCount);
-	size_t reqIndexSize = reqIndexCount * sizeof(uint16);
+	size_t reqIndexSize = reqIndexCount * indexsize;
 
 	size_t newdatasizes[2] = {0, 0};
 	size_t buffersizes[3] = {0, 0, 0};
@@ -1030,14 +1055,15 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 
 	if (cmd.indexMode != TriangleIndexMode::NONE)
 	{
-		size_t datasize = (state.indexCount + reqIndexCount) * sizeof(uint16);
+		size_t datasize = (state.indexCount + reqIndexCount) * indexsize;
 
 		if (state.indexBufferMap.data != nullptr && datasize > state.indexBufferMap.size)
 			shouldflush = true;
 
 		if (datasize > state.indexBuffer->getUsableSize())
 		{
-			buffersizes[2] = std::max(datasize, state.indexBuffer->getSize() * 2);
+			// Keep the size a multiple of 4 so uint32 indices stay aligned.
+			buffersizes[2] = alignUp(std::max(datasize, state.indexBuffer->getSize() * 2), 4);
 			shouldresize = true;
 		}
 	}
@@ -1051,6 +1077,7 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 		state.formats[1] = cmd.formats[1];
 		state.texture = cmd.texture;
 		state.standardShaderType = cmd.standardShaderType;
+		state.indexType = indextype;
 	}
 
 	if (state.vertexCount == 0 && Shader::isDefaultActive())
@@ -1082,8 +1109,16 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 		if (state.indexBufferMap.data == nullptr)
 			state.indexBufferMap = state.indexBuffer->map(reqIndexSize);
 
-		uint16 *indices = (uint16 *) state.indexBufferMap.data;
-		fillIndices(cmd.indexMode, state.vertexCount, cmd.vertexCount, indices);
+		if (state.indexType == INDEX_UINT32)
+		{
+			uint32 *indices = (uint32 *) state.indexBufferMap.data;
+			fillIndices(cmd.indexMode, (uint32) state.vertexCount, (uint32) cmd.vertexCount, indices);
+		}
+		else
+		{
+			uint16 *indices = (uint16 *) state.indexBufferMap.data;
+			fillIndices(cmd.indexMode, (uint16) state.vertexCount, (uint16) cmd.vertexCount, indices);
+		}
 
 		state.indexBufferMap.data += reqIndexSize;
 	}
@@ -1116,6 +1151,10 @@ void Graphics::flushStreamDraws()
 {
 	using namespace vertex;
 
+	// Sorted draws are emitted into the regular stream buffers first, so they
+	// get flushed below along with everything else.
+	flushSortedStreamDraws();
+
 	auto &sbstate = streamBufferState;
 
 	if (sbstate.vertexCount == 0 && sbstate.indexCount == 0)
@@ -1151,12 +1190,12 @@ void Graphics::flushStreamDraws()
 
 	if (sbstate.indexCount > 0)
 	{
-		usedsizes[2] = sizeof(uint16) * sbstate.indexCount;
+		usedsizes[2] = getIndexDataSize(sbstate.indexType) * sbstate.indexCount;
 
 		DrawIndexedCommand cmd(&attributes, &buffers, sbstate.indexBuffer);
 		cmd.primitiveType = sbstate.primitiveMode;
 		cmd.indexCount = sbstate.indexCount;
-		cmd.indexType = INDEX_UINT16;
+		cmd.indexType = sbstate.indexType;
 		cmd.indexBufferOffset = sbstate.indexBuffer->unmap(usedsizes[2]);
 		cmd.texture = sbstate.texture;
 		draw(cmd);
@@ -1179,8 +1218,10 @@ void Graphics::flushStreamDraws()
 			sbstate.vb[i]->markUsed(usedsizes[i]);
 	}
 
+	// Padding after uint16 indices keeps the next batch's offset aligned, in
+	// case it uses uint32 indices.
 	if (usedsizes[2] > 0)
-		sbstate.indexBuffer->markUsed(usedsizes[2]);
+		sbstate.indexBuffer->markUsed(alignUp(usedsizes[2], 4));
 
 	popTransform();
 
@@ -1189,6 +1230,7 @@ void Graphics::flushStreamDraws()
 
 	streamBufferState.vertexCount = 0;
 	streamBufferState.indexCount = 0;
+	streamBufferState.indexType = INDEX_UINT16;
 }
 
 void Graphics::flushStreamDrawsGlobal()
@@ -1198,6 +1240,216 @@ void Graphics::flushStreamDrawsGlobal()
 		instance->flushStreamDraws();
 }
 
+void Graphics::beginSortedBatch()
+{
+	if (sortedStreamDraws.active)
+		throw love::Exception("A sorted batch is already active.");
+
+	flushStreamDraws();
+	sortedStreamDraws.active = true;
+}
+
+void Graphics::endSortedBatch()
+{
+	if (!sortedStreamDraws.active)
+		throw love::Exception("No sorted batch is active.");
+
+	// The recorded draws can still be merged with regular draws which follow.
+	flushSortedStreamDraws();
+	sortedStreamDraws.active = false;
+}
+
+bool Graphics::isSortedBatchActive() const
+{
+	return sortedStreamDraws.active;
+}
+
+Graphics::StreamVertexData Graphics::requestSortedStreamDraw(const StreamDrawCommand &cmd)
+{
+	using namespace vertex;
+
+	auto &sorted = sortedStreamDraws;
+
+	SortedStreamDraw draw;
+	draw.command = cmd;
+	draw.texture.set(cmd.texture);
+
+	StreamVertexData d;
+
+	for (int i = 0; i < 2; i++)
+	{
+		d.stream[i] = nullptr;
+		draw.dataOffsets[i] = 0;
+
+		if (cmd.formats[i] == CommonFormat::NONE)
+			continue;
+
+		size_t offset = sorted.data[i].size();
+		sorted.data[i].resize(offset + getFormatStride(cmd.formats[i]) * cmd.vertexCount);
+
+		draw.dataOffsets[i] = offset;
+		d.stream[i] = sorted.data[i].data() + offset;
+	}
+
+	sorted.draws.push_back(draw);
+
+	return d;
+}
+
+static bool canBatchStreamDraws(const Graphics::StreamDrawCommand &a, const Graphics::StreamDrawCommand &b)
+{
+	using namespace vertex;
+
+	return a.primitiveMode == b.primitiveMode
+		&& a.formats[0] == b.formats[0] && a.formats[1] == b.formats[1]
+		&& (a.indexMode != TriangleIndexMode::NONE) == (b.indexMode != TriangleIndexMode::NONE)
+		&& a.texture == b.texture
+		&& a.standardShaderType == b.standardShaderType;
+}
+
+bool Graphics::isSortedBatchOrderIndependent() const
+{
+	const DisplayState &state = states.back();
+
+	if (state.depthTest != COMPARE_ALWAYS || state.depthWrite || writingToStencil)
+		return false;
+
+	// Blending with these modes gives the same result regardless of the order
+	// in which overlapping draws are done.
+	switch (state.blendMode)
+	{
+	case BLEND_ADD:
+	case BLEND_SUBTRACT:
+	case BLEND_MULTIPLY:
+	case BLEND_LIGHTEN:
+	case BLEND_DARKEN:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void Graphics::flushSortedStreamDraws()
+{
+	using namespace vertex;
+
+	auto &sorted = sortedStreamDraws;
+
+	if (sorted.resolving || sorted.draws.empty())
+		return;
+
+	sorted.resolving = true;
+
+	size_t drawcount = sorted.draws.size();
+
+	// Positions are always the first two floats of the first vertex stream.
+	for (SortedStreamDraw &draw : sorted.draws)
+	{
+		size_t stride = getFormatStride(draw.command.formats[0]);
+		const uint8 *data = sorted.data[0].data() + draw.dataOffsets[0];
+
+		draw.minX = draw.minY = std::numeric_limits<float>::max();
+		draw.maxX = draw.maxY = std::numeric_limits<float>::lowest();
+
+		for (int i = 0; i < draw.command.vertexCount; i++)
+		{
+			const float *pos = (const float *) (data + stride * i);
+			draw.minX = std::min(draw.minX, pos[0]);
+			draw.minY = std::min(draw.minY, pos[1]);
+			draw.maxX = std::max(draw.maxX, pos[0]);
+			draw.maxY = std::max(draw.maxY, pos[1]);
+		}
+	}
+
+	bool orderindependent = isSortedBatchOrderIndependent();
+
+	sorted.batches.clear();
+	sorted.drawBatches.resize(drawcount);
+
+	// A draw can be moved back into an earlier batch with the same state, as
+	// long as it doesn't overlap anything drawn in the batches after it.
+	for (size_t i = 0; i < drawcount; i++)
+	{
+		const SortedStreamDraw &draw = sorted.draws[i];
+
+		if (i == 0 || !canBatchStreamDraws(sorted.draws[i - 1].command, draw.command))
+			sortedBatchesBefore++;
+
+		size_t target = sorted.batches.size();
+
+		for (size_t b = sorted.batches.size(); b > 0; b--)
+		{
+			const SortedStreamBatch &batch = sorted.batches[b - 1];
+
+			if (canBatchStreamDraws(sorted.draws[batch.firstDraw].command, draw.command))
+			{
+				target = b - 1;
+				break;
+			}
+
+			if (!orderindependent && draw.minX <= batch.maxX && draw.maxX >= batch.minX
+				&& draw.minY <= batch.maxY && draw.maxY >= batch.minY)
+			{
+				break;
+			}
+		}
+
+		if (target == sorted.batches.size())
+		{
+			SortedStreamBatch batch;
+			batch.firstDraw = i;
+			batch.minX = draw.minX;
+			batch.minY = draw.minY;
+			batch.maxX = draw.maxX;
+			batch.maxY = draw.maxY;
+			sorted.batches.push_back(batch);
+		}
+		else
+		{
+			SortedStreamBatch &batch = sorted.batches[target];
+			batch.minX = std::min(batch.minX, draw.minX);
+			batch.minY = std::min(batch.minY, draw.minY);
+			batch.maxX = std::max(batch.maxX, draw.maxX);
+			batch.maxY = std::max(batch.maxY, draw.maxY);
+		}
+
+		sorted.drawBatches[i] = target;
+	}
+
+	sortedBatchesAfter += (int) sorted.batches.size();
+
+	sorted.order.resize(drawcount);
+	for (size_t i = 0; i < drawcount; i++)
+		sorted.order[i] = i;
+
+	const auto &drawbatches = sorted.drawBatches;
+	std::stable_sort(sorted.order.begin(), sorted.order.end(), [&](size_t a, size_t b)
+	{
+		return drawbatches[a] < drawbatches[b];
+	});
+
+	for (size_t i : sorted.order)
+	{
+		const SortedStreamDraw &draw = sorted.draws[i];
+		StreamVertexData d = requestStreamDraw(draw.command);
+
+		for (int s = 0; s < 2; s++)
+		{
+			if (draw.command.formats[s] == CommonFormat::NONE)
+				continue;
+
+			size_t size = getFormatStride(draw.command.formats[s]) * draw.command.vertexCount;
+			memcpy(d.stream[s], sorted.data[s].data() + draw.dataOffsets[s], size);
+		}
+	}
+
+	sorted.draws.clear();
+	sorted.data[0].clear();
+	sorted.data[1].clear();
+
+	sorted.resolving = false;
+}
+
 /**
  * Drawing
  **/
@@ -1595,6 +1847,9 @@ Graphics::Stats Graphics::getStats() const
 
 	stats.canvasSwitches = canvasSwitchCount;
 	stats.drawCallsBatched = drawCallsBatched;
+	stats.sortedBatchesBefore = sortedBatchesBefore;
+	stats.sortedBatchesAfter = sortedBatchesAfter;
+	stats.indexLimitFlushes = indexLimitFlushes;
 	stats.canvases = Canvas::canvasCount;
 	stats.images = Image::imageCount;
 	stats.fonts = Font::fontCount;
@@ -1603,6 +1858,11 @@ Graphics::Stats Graphics::getStats() const
 	return stats;
 }
 
+uint64 Graphics::getFrameIndex() const
+{
+	return frameIndex;
+}
+
 size_t Graphics::getStackDepth() const
 {
 	return stackTypeStack.size();
@@ -1940,6 +2200,7 @@ StringMap<Graphics::Feature, Graphics::FEATURE_MAX_ENUM>::Entry Graphics::featur
 	{ "shaderderivatives",  FEATURE_SHADER_DERIVATIVES   },
 	{ "glsl3",              FEATURE_GLSL3                },
 	{ "instancing",         FEATURE_INSTANCING           },
+	{ "indexuint32",        FEATURE_INDEX_UINT32         },
 };
 
 StringMap<Graphics::Feature, Graphics::FEATURE_MAX_ENUM> Graphics::features(Graphics::featureEntries, sizeof(Graphics::featureEntries));
@@ -164,6 +164,7 @@ class Graphics : public Module
 		FEATURE_SHADER_DERIVATIVES,
 		FEATURE_GLSL3,
 		FEATURE_INSTANCING,
+		FEATURE_INDEX_UINT32,
 		FEATURE_MAX_ENUM
 	};
 
@@ -219,6 +220,9 @@ class Graphics : public Module
 	{
 		int drawCalls;
 		int drawCallsBatched;
+		int sortedBatchesBefore;
+		int sortedBatchesAfter;
+		int indexLimitFlushes;
 		int canvasSwitches;
 		int shaderSwitches;
 		int canvases;
@@ -849,6 +853,11 @@ class Graphics : public Module
 	 **/
 	Stats getStats() const;
 
+	/**
+	 * Returns the number of frames presented so far.
+	 **/
+	uint64 getFrameIndex() const;
+
 	size_t getStackDepth() const;
 	void push(StackType type = STACK_TRANSFORM);
 	void pop();
@@ -875,6 +884,17 @@ class Graphics : public Module
 	void flushStreamDraws();
 	StreamVertexData requestStreamDraw(const StreamDrawCommand &command);
 
+	/**
+	 * Stream draws requested between beginSortedBatch and endSortedBatch are
+	 * recorded instead of being batched immediately. When the sorted batch is
+	 * flushed (by endSortedBatch or by any state change), the recorded draws
+	 * are grouped by texture, vertex format and shader type wherever doing so
+	 * can't change the rendered result.
+	 **/
+	void beginSortedBatch();
+	void endSortedBatch();
+	bool isSortedBatchActive() const;
+
 	static void flushStreamDrawsGlobal();
 
 	virtual Shader::Language getShaderLanguageTarget() const = 0;
@@ -982,6 +1002,7 @@ class Graphics : public Module
 		vertex::CommonFormat formats[2];
 		StrongRef<Texture> texture;
 		Shader::StandardShader standardShaderType = Shader::STANDARD_DEFAULT;
+		IndexDataType indexType = INDEX_UINT16;
 		int vertexCount = 0;
 		int indexCount = 0;
 
@@ -996,6 +1017,38 @@ class Graphics : public Module
 		}
 	};
 
+	struct SortedStreamDraw
+	{
+		StreamDrawCommand command;
+		StrongRef<Texture> texture;
+		size_t dataOffsets[2];
+
+		// Bounds of the draw's positions, after transformation.
+		float minX, minY;
+		float maxX, maxY;
+	};
+
+	struct SortedStreamBatch
+	{
+		size_t firstDraw;
+
+		float minX, minY;
+		float maxX, maxY;
+	};
+
+	struct SortedStreamDrawState
+	{
+		bool active = false;
+		bool resolving = false;
+
+		std::vector<SortedStreamDraw> draws;
+		std::vector<uint8> data[2];
+
+		std::vector<SortedStreamBatch> batches;
+		std::vector<size_t> drawBatches;
+		std::vector<size_t> order;
+	};
+
 	struct TemporaryCanvas
 	{
 		Canvas *canvas;
@@ -1018,6 +1071,10 @@ class Graphics : public Module
 
 	void createQuadIndexBuffer();
 
+	StreamVertexData requestSortedStreamDraw(const StreamDrawCommand &command);
+	void flushSortedStreamDraws();
+	bool isSortedBatchOrderIndependent() const;
+
 	Canvas *getTemporaryCanvas(PixelFormat format, int w, int h, int samples);
 
 	void restoreState(const DisplayState &s);
@@ -1042,6 +1099,7 @@ class Graphics : public Module
 	std::vector<ScreenshotInfo> pendingScreenshotCallbacks;
 
 	StreamBufferState streamBufferState;
+	SortedStreamDrawState sortedStreamDraws;
 
 	std::vector<Matrix4> transformStack;
 	Matrix4 projectionMatrix;
@@ -1056,6 +1114,11 @@ class Graphics : public Module
 	int canvasSwitchCount;
 	int drawCalls;
 	int drawCallsBatched;
+	int sortedBatchesBefore;
+	int sortedBatchesAfter;
+	int indexLimitFlushes;
+
+	uint64 frameIndex;
 
 	Buffer *quadIndexBuffer;
 
@@ -24,13 +24,24 @@
 #include "Graphics.h"
 
 #include "common/math.h"
+#include "common/memory.h"
 #include "modules/math/RandomGenerator.h"
+#include "thread/WorkerPool.h"
 
 // STD
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 
+#if defined(LOVE_SIMD_SSE)
+#include <xmmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace love
 {
 namespace graphics
@@ -39,9 +50,14 @@ namespace graphics
 namespace
 {
 
-love::math::RandomGenerator rng;
+// Seeds the random number generator of each new ParticleSystem.
+love::math::RandomGenerator seedGenerator;
 
-float calculate_variation(float inner, float outer, float var)
+// Number of particles processed by each job in a multithreaded update. This
+// is a multiple of 4 so each job can use SIMD instructions for all particles.
+const uint32 UPDATE_CHUNK_SIZE = 4096;
+
+float calculate_variation(love::math::RandomGenerator &rng, float inner, float outer, float var)
 {
 	float low = inner - (outer/2.0f)*var;
 	float high = inner + (outer/2.0f)*var;
@@ -49,15 +65,51 @@ float calculate_variation(float inner, float outer, float var)
 	return low*(1-r)+high*r;
 }
 
+inline void lerpColor(const Colorf &a, const Colorf &b, float s, Colorf &out)
+{
+#if defined(LOVE_SIMD_SSE)
+	__m128 ca = _mm_loadu_ps(&a.r);
+	__m128 cb = _mm_loadu_ps(&b.r);
+	__m128 c = _mm_add_ps(ca, _mm_mul_ps(_mm_sub_ps(cb, ca), _mm_set1_ps(s)));
+	_mm_storeu_ps(&out.r, c);
+#elif defined(LOVE_SIMD_NEON)
+	float32x4_t ca = vld1q_f32(&a.r);
+	float32x4_t cb = vld1q_f32(&b.r);
+	vst1q_f32(&out.r, vmlaq_n_f32(ca, vsubq_f32(cb, ca), s));
+#else
+	out = a * (1.0f - s) + b * s;
+#endif
+}
+
+#if defined(LOVE_SIMD_NEON)
+
+// NEON on 32 bit ARM has no division or square root, only estimates which
+// need a couple of Newton-Raphson steps to be accurate enough.
+inline float32x4_t reciprocal(float32x4_t v)
+{
+	float32x4_t r = vrecpeq_f32(v);
+	r = vmulq_f32(vrecpsq_f32(v, r), r);
+	r = vmulq_f32(vrecpsq_f32(v, r), r);
+	return r;
+}
+
+inline float32x4_t reciprocalSqrt(float32x4_t v)
+{
+	float32x4_t r = vrsqrteq_f32(v);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+	return r;
+}
+
+#endif
+
 } // anonymous namespace
 
 love::Type ParticleSystem::type("ParticleSystem", &Drawable::type);
 
 ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 	: pMem(nullptr)
-	, pFree(nullptr)
-	, pHead(nullptr)
-	, pTail(nullptr)
+	, particles()
 	, texture(texture)
 	, active(true)
 	, insertMode(INSERT_MODE_TOP)
@@ -93,8 +145,11 @@ ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 	, offset(float(texture->getWidth())*0.5f, float(texture->getHeight())*0.5f)
 	, defaultOffset(true)
 	, relativeRotation(false)
+	, instanced(false)
 	, vertexAttributes(vertex::CommonFormat::XYf_STf_RGBAub, 0)
 	, buffer(nullptr)
+	, instanceBuffer(nullptr)
+	, cornerBuffer(nullptr)
 {
 	if (size == 0 || size > MAX_PARTICLES)
 		throw love::Exception("Invalid ParticleSystem size.");
@@ -102,6 +157,10 @@ ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 	if (texture->getTextureType() != TEXTURE_2D)
 		throw love::Exception("Only 2D textures can be used with ParticleSystems.");
 
+	love::math::RandomGenerator::Seed seed;
+	seed.b64 = seedGenerator.rand();
+	rng.setSeed(seed);
+
 	sizes.push_back(1.0f);
 	colors.push_back(Colorf(1.0f, 1.0f, 1.0f, 1.0f));
 
@@ -110,9 +169,7 @@ ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 
 ParticleSystem::ParticleSystem(const ParticleSystem &p)
 	: pMem(nullptr)
-	, pFree(nullptr)
-	, pHead(nullptr)
-	, pTail(nullptr)
+	, particles()
 	, texture(p.texture)
 	, active(p.active)
 	, insertMode(p.insertMode)
@@ -154,9 +211,16 @@ ParticleSystem::ParticleSystem(const ParticleSystem &p)
 	, colors(p.colors)
 	, quads(p.quads)
 	, relativeRotation(p.relativeRotation)
+	, instanced(p.instanced)
 	, vertexAttributes(p.vertexAttributes)
 	, buffer(nullptr)
+	, instanceBuffer(nullptr)
+	, cornerBuffer(nullptr)
 {
+	love::math::RandomGenerator::Seed seed;
+	seed.b64 = seedGenerator.rand();
+	rng.setSeed(seed);
+
 	setBufferSize(maxParticles);
 }
 
@@ -185,7 +249,57 @@ void ParticleSystem::createBuffers(size_t size)
 {
 	try
 	{
-		pFree = pMem = new Particle[size];
+		// Each array is padded to 16 bytes so every one of them stays aligned.
+		size_t floatbytes = alignUp(sizeof(float) * size, 16);
+		size_t colorbytes = sizeof(Colorf) * size;
+		size_t intbytes = alignUp(sizeof(int) * size, 16);
+
+		const int floatarrays = 21;
+
+		if (!alignedMalloc(&pMem, floatbytes * floatarrays + colorbytes + intbytes, 16))
+		{
+			pMem = nullptr;
+			throw std::bad_alloc();
+		}
+
+		uint8 *mem = (uint8 *) pMem;
+		auto nextfloats = [&]() -> float *
+		{
+			float *data = (float *) mem;
+			mem += floatbytes;
+			return data;
+		};
+
+		particles.lifetime = nextfloats();
+		particles.life = nextfloats();
+		particles.positionX = nextfloats();
+		particles.positionY = nextfloats();
+		particles.originX = nextfloats();
+		particles.originY = nextfloats();
+		particles.velocityX = nextfloats();
+		particles.velocityY = nextfloats();
+		particles.linearAccelerationX = nextfloats();
+		particles.linearAccelerationY = nextfloats();
+		particles.radialAcceleration = nextfloats();
+		particles.tangentialAcceleration = nextfloats();
+		particles.linearDamping = nextfloats();
+		particles.size = nextfloats();
+		particles.sizeOffset = nextfloats();
+		particles.sizeIntervalSize = nextfloats();
+		particles.rotation = nextfloats();
+		particles.angle = nextfloats();
+		particles.spinStart = nextfloats();
+		particles.spinEnd = nextfloats();
+		particles.age = nextfloats();
+
+		particles.color = (Colorf *) mem;
+		mem += colorbytes;
+
+		particles.quadIndex = (int *) mem;
+
+		drawOrder.reserve(size);
+		particleRemap.resize(size);
+
 		maxParticles = (uint32) size;
 
 		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
@@ -202,13 +316,23 @@ void ParticleSystem::createBuffers(size_t size)
 
 void ParticleSystem::deleteBuffers()
 {
-	delete[] pMem;
+	alignedFree(pMem);
 	delete buffer;
+	delete instanceBuffer;
+	delete cornerBuffer;
 
 	pMem = nullptr;
+	particles = ParticleData();
 	buffer = nullptr;
+	instanceBuffer = nullptr;
+	cornerBuffer = nullptr;
 	maxParticles = 0;
 	activeParticles = 0;
+
+	// Release the memory rather than just clearing.
+	std::vector<uint32>().swap(drawOrder);
+	std::vector<uint32>().swap(particleRemap);
+	std::vector<uint64>().swap(insertPositions);
 }
 
 void ParticleSystem::setBufferSize(uint32 size)
@@ -230,29 +354,15 @@ void ParticleSystem::addParticle(float t)
 	if (isFull())
 		return;
 
-	// Gets a free particle and updates the allocation pointer.
-	Particle *p = pFree++;
-	initParticle(p, t);
-
-	switch (insertMode)
-	{
-	default:
-	case INSERT_MODE_TOP:
-		insertTop(p);
-		break;
-	case INSERT_MODE_BOTTOM:
-		insertBottom(p);
-		break;
-	case INSERT_MODE_RANDOM:
-		insertRandom(p);
-		break;
-	}
-
+	// New particles are always stored at the end. They're added to the draw
+	// order afterwards, by insertParticles.
+	initParticle(activeParticles, t);
 	activeParticles++;
 }
 
-void ParticleSystem::initParticle(Particle *p, float t)
+void ParticleSystem::initParticle(uint32 index, float t)
 {
+	ParticleData &p = particles;
 	float min,max;
 
 	// Linearly interpolate between the previous and current emitter position.
@@ -261,12 +371,12 @@ void ParticleSystem::initParticle(Particle *p, float t)
 	min = particleLifeMin;
 	max = particleLifeMax;
 	if (min == max)
-		p->life = min;
+		p.life[index] = min;
 	else
-		p->life = (float) rng.random(min, max);
-	p->lifetime = p->life;
+		p.life[index] = (float) rng.random(min, max);
+	p.lifetime[index] = p.life[index];
 
-	p->position = pos;
+	love::Vector2 ppos = pos;
 
 	min = direction - spread/2.0f;
 	max = direction + spread/2.0f;
@@ -282,15 +392,15 @@ void ParticleSystem::initParticle(Particle *p, float t)
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
 		rand_x = (float) rng.random(-emissionArea.x, emissionArea.x);
 		rand_y = (float) rng.random(-emissionArea.y, emissionArea.y);
-		p->position.x += c * rand_x - s * rand_y;
-		p->position.y += s * rand_x + c * rand_y;
+		ppos.x += c * rand_x - s * rand_y;
+		ppos.y += s * rand_x + c * rand_y;
 		break;
 	case DISTRIBUTION_NORMAL:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
 		rand_x = (float) rng.randomNormal(emissionArea.x);
 		rand_y = (float) rng.randomNormal(emissionArea.y);
-		p->position.x += c * rand_x - s * rand_y;
-		p->position.y += s * rand_x + c * rand_y;
+		ppos.x += c * rand_x - s * rand_y;
+		ppos.y += s * rand_x + c * rand_y;
 		break;
 	case DISTRIBUTION_ELLIPSE:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
@@ -298,16 +408,16 @@ void ParticleSystem::initParticle(Particle *p, float t)
 		rand_y = (float) rng.random(-1, 1);
 		min = emissionArea.x * (rand_x * sqrt(1 - 0.5f*pow(rand_y, 2)));
 		max = emissionArea.y * (rand_y * sqrt(1 - 0.5f*pow(rand_x, 2)));
-		p->position.x += c * min - s * max;
-		p->position.y += s * min + c * max;
+		ppos.x += c * min - s * max;
+		ppos.y += s * min + c * max;
 		break;
 	case DISTRIBUTION_BORDER_ELLIPSE:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
 		rand_x = (float) rng.random(0, LOVE_M_PI * 2);
 		min = cosf(rand_x) * emissionArea.x;
 		max = sinf(rand_x) * emissionArea.y;
-		p->position.x += c * min - s * max;
-		p->position.y += s * min + c * max;
+		ppos.x += c * min - s * max;
+		ppos.y += s * min + c * max;
 		break;
 	case DISTRIBUTION_BORDER_RECTANGLE:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
@@ -316,26 +426,26 @@ void ParticleSystem::initParticle(Particle *p, float t)
 		if (rand_x < -rand_y)
 		{
 			min = rand_x + rand_y + emissionArea.x;
-			p->position.x += c * min - s * -emissionArea.y;
-			p->position.y += s * min + c * -emissionArea.y;
+			ppos.x += c * min - s * -emissionArea.y;
+			ppos.y += s * min + c * -emissionArea.y;
 		}
 		else if (rand_x < 0)
 		{
 			max = rand_x + emissionArea.y;
-			p->position.x += c * -emissionArea.x - s * max;
-			p->position.y += s * -emissionArea.x + c * max;
+			ppos.x += c * -emissionArea.x - s * max;
+			ppos.y += s * -emissionArea.x + c * max;
 		}
 		else if (rand_x < rand_y)
 		{
 			max = rand_x - emissionArea.y;
-			p->position.x += c * emissionArea.x - s * max;
-			p->position.y += s * emissionArea.x + c * max;
+			ppos.x += c * emissionArea.x - s * max;
+			ppos.y += s * emissionArea.x + c * max;
 		}
 		else
 		{
 			min = rand_x - rand_y - emissionArea.x;
-			p->position.x += c * min - s * emissionArea.y;
-			p->position.y += s * min + c * emissionArea.y;
+			ppos.x += c * min - s * emissionArea.y;
+			ppos.y += s * min + c * emissionArea.y;
 		}
 		break;
 	case DISTRIBUTION_NONE:
@@ -345,154 +455,193 @@ void ParticleSystem::initParticle(Particle *p, float t)
 
 	// Determine if the origin of each particle is the center of the area
 	if (directionRelativeToEmissionCenter)
-		dir += atan2(p->position.y - pos.y, p->position.x - pos.x);
+		dir += atan2(ppos.y - pos.y, ppos.x - pos.x);
+
+	p.positionX[index] = ppos.x;
+	p.positionY[index] = ppos.y;
 
-	p->origin = pos;
+	p.originX[index] = pos.x;
+	p.originY[index] = pos.y;
 
 	min = speedMin;
 	max = speedMax;
 	float speed = (float) rng.random(min, max);
 
-	p->velocity = love::Vector2(cosf(dir), sinf(dir)) * speed;
+	p.velocityX[index] = cosf(dir) * speed;
+	p.velocityY[index] = sinf(dir) * speed;
 
-	p->linearAcceleration.x = (float) rng.random(linearAccelerationMin.x, linearAccelerationMax.x);
-	p->linearAcceleration.y = (float) rng.random(linearAccelerationMin.y, linearAccelerationMax.y);
+	p.linearAccelerationX[index] = (float) rng.random(linearAccelerationMin.x, linearAccelerationMax.x);
+	p.linearAccelerationY[index] = (float) rng.random(linearAccelerationMin.y, linearAccelerationMax.y);
 
 	min = radialAccelerationMin;
 	max = radialAccelerationMax;
-	p->radialAcceleration = (float) rng.random(min, max);
+	p.radialAcceleration[index] = (float) rng.random(min, max);
 
 	min = tangentialAccelerationMin;
 	max = tangentialAccelerationMax;
-	p->tangentialAcceleration = (float) rng.random(min, max);
+	p.tangentialAcceleration[index] = (float) rng.random(min, max);
 
 	min = linearDampingMin;
 	max = linearDampingMax;
-	p->linearDamping = (float) rng.random(min, max);
+	p.linearDamping[index] = (float) rng.random(min, max);
 
-	p->sizeOffset       = (float) rng.random(sizeVariation); // time offset for size change
-	p->sizeIntervalSize = (1.0f - (float) rng.random(sizeVariation)) - p->sizeOffset;
-	p->size = sizes[(size_t)(p->sizeOffset - .5f) * (sizes.size() - 1)];
+	p.sizeOffset[index]       = (float) rng.random(sizeVariation); // time offset for size change
+	p.sizeIntervalSize[index] = (1.0f - (float) rng.random(sizeVariation)) - p.sizeOffset[index];
+	p.size[index] = sizes[(size_t)(p.sizeOffset[index] - .5f) * (sizes.size() - 1)];
 
 	min = rotationMin;
 	max = rotationMax;
-	p->spinStart = calculate_variation(spinStart, spinEnd, spinVariation);
-	p->spinEnd = calculate_variation(spinEnd, spinStart, spinVariation);
-	p->rotation = (float) rng.random(min, max);
+	p.spinStart[index] = calculate_variation(rng, spinStart, spinEnd, spinVariation);
+	p.spinEnd[index] = calculate_variation(rng, spinEnd, spinStart, spinVariation);
+	p.rotation[index] = (float) rng.random(min, max);
 
-	p->angle = p->rotation;
+	p.angle[index] = p.rotation[index];
+	p.age[index] = 0.0f;
 	if (relativeRotation)
-		p->angle += atan2f(p->velocity.y, p->velocity.x);
+		p.angle[index] += atan2f(p.velocityY[index], p.velocityX[index]);
 
-	p->color = colors[0];
+	p.color[index] = colors[0];
 
-	p->quadIndex = 0;
+	p.quadIndex[index] = 0;
 }
 
-void ParticleSystem::insertTop(Particle *p)
+void ParticleSystem::copyParticle(uint32 src, uint32 dst)
 {
-	if (pHead == nullptr)
-	{
-		pHead = p;
-		p->prev = nullptr;
-	}
-	else
-	{
-		pTail->next = p;
-		p->prev = pTail;
-	}
-	p->next = nullptr;
-	pTail = p;
+	ParticleData &p = particles;
+
+	p.lifetime[dst] = p.lifetime[src];
+	p.life[dst] = p.life[src];
+	p.positionX[dst] = p.positionX[src];
+	p.positionY[dst] = p.positionY[src];
+	p.originX[dst] = p.originX[src];
+	p.originY[dst] = p.originY[src];
+	p.velocityX[dst] = p.velocityX[src];
+	p.velocityY[dst] = p.velocityY[src];
+	p.linearAccelerationX[dst] = p.linearAccelerationX[src];
+	p.linearAccelerationY[dst] = p.linearAccelerationY[src];
+	p.radialAcceleration[dst] = p.radialAcceleration[src];
+	p.tangentialAcceleration[dst] = p.tangentialAcceleration[src];
+	p.linearDamping[dst] = p.linearDamping[src];
+	p.size[dst] = p.size[src];
+	p.sizeOffset[dst] = p.sizeOffset[src];
+	p.sizeIntervalSize[dst] = p.sizeIntervalSize[src];
+	p.rotation[dst] = p.rotation[src];
+	p.angle[dst] = p.angle[src];
+	p.spinStart[dst] = p.spinStart[src];
+	p.spinEnd[dst] = p.spinEnd[src];
+	p.age[dst] = p.age[src];
+	p.color[dst] = p.color[src];
+	p.quadIndex[dst] = p.quadIndex[src];
 }
 
-void ParticleSystem::insertBottom(Particle *p)
+void ParticleSystem::removeDeadParticles()
 {
-	if (pTail == nullptr)
+	const uint32 removed = LOVE_UINT32_MAX;
+
+	bool anyremoved = false;
+	uint32 count = activeParticles;
+
+	// Dead particles are replaced by the (in memory) last particle. Since only
+	// particles at the end are moved, the particle at index i was originally
+	// at either i or at the index it was moved from.
+	uint32 i = 0;
+	uint32 original = 0;
+
+	while (i < count)
 	{
-		pTail = p;
-		p->next = nullptr;
+		if (particles.life[i] > 0.0f)
+		{
+			particleRemap[original] = i;
+			original = ++i;
+			continue;
+		}
+
+		particleRemap[original] = removed;
+		anyremoved = true;
+
+		count--;
+		if (i < count)
+		{
+			copyParticle(count, i);
+			original = count;
+		}
 	}
-	else
+
+	if (!anyremoved)
+		return;
+
+	activeParticles = count;
+
+	// Fix up the draw order, keeping the relative order of living particles.
+	size_t ordercount = 0;
+	for (size_t j = 0; j < drawOrder.size(); j++)
 	{
-		pHead->prev = p;
-		p->next = pHead;
+		uint32 index = particleRemap[drawOrder[j]];
+		if (index != removed)
+			drawOrder[ordercount++] = index;
 	}
-	p->prev = nullptr;
-	pHead = p;
+
+	drawOrder.resize(ordercount);
 }
 
-void ParticleSystem::insertRandom(Particle *p)
+void ParticleSystem::insertParticles(uint32 first)
 {
-	// Nonuniform, but 64-bit is so large nobody will notice. Hopefully.
-	uint64 pos = rng.rand() % ((int64) activeParticles + 1);
+	if (first >= activeParticles)
+		return;
+
+	uint32 count = activeParticles - first;
 
-	// Special case where the particle gets inserted before the head.
-	if (pos == activeParticles)
+	switch (insertMode)
 	{
-		Particle *pA = pHead;
-		if (pA)
-			pA->prev = p;
-		p->prev = nullptr;
-		p->next = pA;
-		pHead = p;
-		return;
+	default:
+	case INSERT_MODE_TOP:
+		for (uint32 i = first; i < activeParticles; i++)
+			drawOrder.push_back(i);
+		break;
+	case INSERT_MODE_BOTTOM:
+		// Every new particle goes below all others, including the new
+		// particles that were emitted before it.
+		drawOrder.insert(drawOrder.begin(), count, 0);
+		for (uint32 i = 0; i < count; i++)
+			drawOrder[i] = activeParticles - 1 - i;
+		break;
+	case INSERT_MODE_RANDOM:
+		insertRandom(first, count);
+		break;
 	}
-
-	// Inserts the particle after the randomly selected particle.
-	Particle *pA = pMem + pos;
-	Particle *pB = pA->next;
-	pA->next = p;
-	if (pB)
-		pB->prev = p;
-	else
-		pTail = p;
-	p->prev = pA;
-	p->next = pB;
 }
 
-ParticleSystem::Particle *ParticleSystem::removeParticle(Particle *p)
+void ParticleSystem::insertRandom(uint32 first, uint32 count)
 {
-	// The linked list is updated in this function and old pointers may be
-	// invalidated. The returned pointer will inform the caller of the new
-	// pointer to the next particle.
-	Particle *pNext = nullptr;
-
-	// Removes the particle from the linked list.
-	if (p->prev)
-		p->prev->next = p->next;
-	else
-		pHead = p->next;
+	uint64 oldcount = drawOrder.size();
 
-	if (p->next)
+	// Each new particle is placed before a randomly selected existing particle
+	// (or after all of them). The positions are sorted so every particle can
+	// be inserted in a single pass.
+	insertPositions.resize(count);
+	for (uint32 i = 0; i < count; i++)
 	{
-		p->next->prev = p->prev;
-		pNext = p->next;
+		// Nonuniform, but 64-bit is so large nobody will notice. Hopefully.
+		uint64 pos = rng.rand() % (oldcount + 1);
+		insertPositions[i] = (pos << 32) | (first + i);
 	}
-	else
-		pTail = p->prev;
 
-	// The (in memory) last particle can now be moved into the free slot.
-	// It will skip the moving if it happens to be the removed particle.
-	pFree--;
-	if (p != pFree)
+	std::sort(insertPositions.begin(), insertPositions.end());
+
+	drawOrder.resize(oldcount + count);
+
+	size_t src = (size_t) oldcount;
+	size_t dst = drawOrder.size();
+
+	for (uint32 i = count; i > 0; i--)
 	{
-		*p = *pFree;
-		if (pNext == pFree)
-			pNext = p;
+		size_t pos = (size_t) (insertPositions[i - 1] >> 32);
 
-		if (p->prev)
-			p->prev->next = p;
-		else
-			pHead = p;
+		while (src > pos)
+			drawOrder[--dst] = drawOrder[--src];
 
-		if (p->next)
-			p->next->prev = p;
-		else
-			pTail = p;
+		drawOrder[--dst] = (uint32) (insertPositions[i - 1] & LOVE_UINT32_MAX);
 	}
-
-	activeParticles--;
-	return pNext;
 }
 
 void ParticleSystem::setTexture(Texture *tex)
@@ -835,6 +984,16 @@ bool ParticleSystem::hasRelativeRotation() const
 	return relativeRotation;
 }
 
+void ParticleSystem::setInstanced(bool enable)
+{
+	instanced = enable;
+}
+
+bool ParticleSystem::isInstanced() const
+{
+	return instanced;
+}
+
 uint32 ParticleSystem::getCount() const
 {
 	return activeParticles;
@@ -862,9 +1021,7 @@ void ParticleSystem::reset()
 	if (pMem == nullptr)
 		return;
 
-	pFree = pMem;
-	pHead = nullptr;
-	pTail = nullptr;
+	drawOrder.clear();
 	activeParticles = 0;
 	life = lifetime;
 	emitCounter = 0;
@@ -877,8 +1034,12 @@ void ParticleSystem::emit(uint32 num)
 
 	num = std::min(num, maxParticles - activeParticles);
 
+	uint32 first = activeParticles;
+
 	while (num--)
 		addParticle(1.0f);
+
+	insertParticles(first);
 }
 
 bool ParticleSystem::isActive() const
@@ -906,102 +1067,288 @@ bool ParticleSystem::isFull() const
 	return activeParticles == maxParticles;
 }
 
+void ParticleSystem::integrateParticles(uint32 start, uint32 end, float dt)
+{
+	ParticleData &p = particles;
+
+	uint32 i = start;
+
+#if defined(LOVE_SIMD_SSE)
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 vdt = _mm_set1_ps(dt);
+
+	for (; i + 4 <= end; i += 4)
+	{
+		// Decrease lifespan.
+		__m128 life = _mm_sub_ps(_mm_loadu_ps(&p.life[i]), vdt);
+		_mm_storeu_ps(&p.life[i], life);
+
+		__m128 px = _mm_loadu_ps(&p.positionX[i]);
+		__m128 py = _mm_loadu_ps(&p.positionY[i]);
+
+		// Get the normalized vector from particle center to particle, leaving
+		// zero-length vectors alone.
+		__m128 rx = _mm_sub_ps(px, _mm_loadu_ps(&p.originX[i]));
+		__m128 ry = _mm_sub_ps(py, _mm_loadu_ps(&p.originY[i]));
+		__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)));
+		__m128 invlen = _mm_and_ps(_mm_cmpgt_ps(len, zero), _mm_div_ps(one, len));
+		rx = _mm_mul_ps(rx, invlen);
+		ry = _mm_mul_ps(ry, invlen);
+
+		// Radial acceleration, plus tangential acceleration along the
+		// perpendicular vector (-ry, rx).
+		__m128 ra = _mm_loadu_ps(&p.radialAcceleration[i]);
+		__m128 ta = _mm_loadu_ps(&p.tangentialAcceleration[i]);
+		__m128 ax = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rx, ra), _mm_mul_ps(ry, ta)), _mm_loadu_ps(&p.linearAccelerationX[i]));
+		__m128 ay = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ry, ra), _mm_mul_ps(rx, ta)), _mm_loadu_ps(&p.linearAccelerationY[i]));
+
+		// Update velocity and apply damping.
+		__m128 damping = _mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(&p.linearDamping[i]), vdt)));
+		__m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&p.velocityX[i]), _mm_mul_ps(ax, vdt)), damping);
+		__m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&p.velocityY[i]), _mm_mul_ps(ay, vdt)), damping);
+		_mm_storeu_ps(&p.velocityX[i], vx);
+		_mm_storeu_ps(&p.velocityY[i], vy);
+
+		// Modify position.
+		_mm_storeu_ps(&p.positionX[i], _mm_add_ps(px, _mm_mul_ps(vx, vdt)));
+		_mm_storeu_ps(&p.positionY[i], _mm_add_ps(py, _mm_mul_ps(vy, vdt)));
+
+		__m128 t = _mm_sub_ps(one, _mm_div_ps(life, _mm_loadu_ps(&p.lifetime[i])));
+		_mm_storeu_ps(&p.age[i], t);
+
+		// Rotate.
+		__m128 spinstart = _mm_loadu_ps(&p.spinStart[i]);
+		__m128 spin = _mm_add_ps(spinstart, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.spinEnd[i]), spinstart), t));
+		__m128 rotation = _mm_add_ps(_mm_loadu_ps(&p.rotation[i]), _mm_mul_ps(spin, vdt));
+		_mm_storeu_ps(&p.rotation[i], rotation);
+		_mm_storeu_ps(&p.angle[i], rotation);
+	}
+
+#elif defined(LOVE_SIMD_NEON)
+
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t vdt = vdupq_n_f32(dt);
+
+	for (; i + 4 <= end; i += 4)
+	{
+		// Decrease lifespan.
+		float32x4_t life = vsubq_f32(vld1q_f32(&p.life[i]), vdt);
+		vst1q_f32(&p.life[i], life);
+
+		float32x4_t px = vld1q_f32(&p.positionX[i]);
+		float32x4_t py = vld1q_f32(&p.positionY[i]);
+
+		// Get the normalized vector from particle center to particle, leaving
+		// zero-length vectors alone.
+		float32x4_t rx = vsubq_f32(px, vld1q_f32(&p.originX[i]));
+		float32x4_t ry = vsubq_f32(py, vld1q_f32(&p.originY[i]));
+		float32x4_t len2 = vmlaq_f32(vmulq_f32(rx, rx), ry, ry);
+		uint32x4_t nonzero = vcgtq_f32(len2, zero);
+		float32x4_t invlen = vreinterpretq_f32_u32(vandq_u32(nonzero, vreinterpretq_u32_f32(reciprocalSqrt(len2))));
+		rx = vmulq_f32(rx, invlen);
+		ry = vmulq_f32(ry, invlen);
+
+		// Radial acceleration, plus tangential acceleration along the
+		// perpendicular vector (-ry, rx).
+		float32x4_t ra = vld1q_f32(&p.radialAcceleration[i]);
+		float32x4_t ta = vld1q_f32(&p.tangentialAcceleration[i]);
+		float32x4_t ax = vaddq_f32(vmlsq_f32(vmulq_f32(rx, ra), ry, ta), vld1q_f32(&p.linearAccelerationX[i]));
+		float32x4_t ay = vaddq_f32(vmlaq_f32(vmulq_f32(ry, ra), rx, ta), vld1q_f32(&p.linearAccelerationY[i]));
+
+		// Update velocity and apply damping.
+		float32x4_t damping = reciprocal(vmlaq_f32(one, vld1q_f32(&p.linearDamping[i]), vdt));
+		float32x4_t vx = vmulq_f32(vmlaq_f32(vld1q_f32(&p.velocityX[i]), ax, vdt), damping);
+		float32x4_t vy = vmulq_f32(vmlaq_f32(vld1q_f32(&p.velocityY[i]), ay, vdt), damping);
+		vst1q_f32(&p.velocityX[i], vx);
+		vst1q_f32(&p.velocityY[i], vy);
+
+		// Modify position.
+		vst1q_f32(&p.positionX[i], vmlaq_f32(px, vx, vdt));
+		vst1q_f32(&p.positionY[i], vmlaq_f32(py, vy, vdt));
+
+		float32x4_t t = vmlsq_f32(one, life, reciprocal(vld1q_f32(&p.lifetime[i])));
+		vst1q_f32(&p.age[i], t);
+
+		// Rotate.
+		float32x4_t spinstart = vld1q_f32(&p.spinStart[i]);
+		float32x4_t spin = vmlaq_f32(spinstart, vsubq_f32(vld1q_f32(&p.spinEnd[i]), spinstart), t);
+		float32x4_t rotation = vmlaq_f32(vld1q_f32(&p.rotation[i]), spin, vdt);
+		vst1q_f32(&p.rotation[i], rotation);
+		vst1q_f32(&p.angle[i], rotation);
+	}
+
+#endif
+
+	// Remaining particles (or all of them, without SIMD support.)
+	for (; i < end; i++)
+	{
+		// Decrease lifespan.
+		p.life[i] -= dt;
+
+		love::Vector2 ppos(p.positionX[i], p.positionY[i]);
+
+		// Get vector from particle center to particle.
+		love::Vector2 radial = ppos - love::Vector2(p.originX[i], p.originY[i]);
+		radial.normalize();
+		love::Vector2 tangential(-radial.y, radial.x);
+
+		// Resize radial and tangential acceleration.
+		radial *= p.radialAcceleration[i];
+		tangential *= p.tangentialAcceleration[i];
+
+		love::Vector2 accel(p.linearAccelerationX[i], p.linearAccelerationY[i]);
+		love::Vector2 velocity(p.velocityX[i], p.velocityY[i]);
+
+		// Update velocity.
+		velocity += (radial + tangential + accel) * dt;
+
+		// Apply damping.
+		velocity *= 1.0f / (1.0f + p.linearDamping[i] * dt);
+
+		// Modify position.
+		ppos += velocity * dt;
+
+		p.velocityX[i] = velocity.x;
+		p.velocityY[i] = velocity.y;
+		p.positionX[i] = ppos.x;
+		p.positionY[i] = ppos.y;
+
+		const float t = 1.0f - p.life[i] / p.lifetime[i];
+		p.age[i] = t;
+
+		// Rotate.
+		p.rotation[i] += (p.spinStart[i] * (1.0f - t) + p.spinEnd[i] * t) * dt;
+		p.angle[i] = p.rotation[i];
+	}
+}
+
+void ParticleSystem::interpolateParticles(uint32 start, uint32 end)
+{
+	ParticleData &p = particles;
+
+	size_t numsizes = sizes.size();
+	size_t numcolors = colors.size();
+	size_t numquads = quads.size();
+
+	for (uint32 j = start; j < end; j++)
+	{
+		// Dead particles are about to be removed, and their age is out of
+		// range.
+		if (p.life[j] <= 0.0f)
+			continue;
+
+		const float t = p.age[j];
+
+		if (relativeRotation)
+			p.angle[j] += atan2f(p.velocityY[j], p.velocityX[j]);
+
+		// Change size according to given intervals:
+		// i = 0       1       2      3          n-1
+		//     |-------|-------|------|--- ... ---|
+		// t = 0    1/(n-1)        3/(n-1)        1
+		//
+		// `s' is the interpolation variable scaled to the current
+		// interval width, e.g. if n = 5 and t = 0.3, then the current
+		// indices are 1,2 and s = 0.3 - 0.25 = 0.05
+		float s = p.sizeOffset[j] + t * p.sizeIntervalSize[j]; // size variation
+		s *= (float)(numsizes - 1); // 0 <= s < sizes.size()
+		size_t i = (size_t)s;
+		size_t k = (i == numsizes - 1) ? i : i + 1; // boundary check (prevents failing on t = 1.0f)
+		s -= (float)i; // transpose s to be in interval [0:1]: i <= s < i + 1 ~> 0 <= s < 1
+		p.size[j] = sizes[i] * (1.0f - s) + sizes[k] * s;
+
+		// Update color according to given intervals (as above)
+		s = t * (float)(numcolors - 1);
+		i = (size_t)s;
+		k = (i == numcolors - 1) ? i : i + 1;
+		s -= (float)i;                            // 0 <= s <= 1
+		lerpColor(colors[i], colors[k], s, p.color[j]);
+
+		// Update the quad index.
+		if (numquads > 0)
+		{
+			s = t * (float) numquads; // [0:numquads-1] (clamped below)
+			i = (s > 0.0f) ? (size_t) s : 0;
+			p.quadIndex[j] = (int) ((i < numquads) ? i : numquads - 1);
+		}
+	}
+}
+
 void ParticleSystem::update(float dt)
 {
 	if (pMem == nullptr || dt == 0.0f)
 		return;
 
-	// Traverse all particles and update.
-	Particle *p = pHead;
+	if (activeParticles > 0)
+	{
+		integrateParticles(0, activeParticles, dt);
+		interpolateParticles(0, activeParticles);
+	}
+
+	finishUpdate(dt);
+}
+
+void ParticleSystem::update(const std::vector<ParticleSystem *> &systems, float dt)
+{
+	if (dt == 0.0f)
+		return;
+
+	struct Chunk
+	{
+		ParticleSystem *system;
+		uint32 start;
+		uint32 end;
+	};
+
+	std::vector<ParticleSystem *> updating;
+	std::vector<Chunk> chunks;
+
+	updating.reserve(systems.size());
 
-	while (p)
+	for (ParticleSystem *ps : systems)
 	{
-		// Decrease lifespan.
-		p->life -= dt;
+		if (ps->pMem == nullptr)
+			continue;
 
-		if (p->life <= 0)
-			p = removeParticle(p);
-		else
+		if (std::find(updating.begin(), updating.end(), ps) != updating.end())
+			throw love::Exception("The same ParticleSystem cannot be updated more than once at a time.");
+
+		updating.push_back(ps);
+
+		for (uint32 start = 0; start < ps->activeParticles; start += UPDATE_CHUNK_SIZE)
 		{
-			// Temp variables.
-			love::Vector2 radial, tangential;
-			love::Vector2 ppos = p->position;
-
-			// Get vector from particle center to particle.
-			radial = ppos - p->origin;
-			radial.normalize();
-			tangential = radial;
-
-			// Resize radial acceleration.
-			radial *= p->radialAcceleration;
-
-			// Calculate tangential acceleration.
-			{
-				float a = tangential.x;
-				tangential.x = -tangential.y;
-				tangential.y = a;
-			}
-
-			// Resize tangential.
-			tangential *= p->tangentialAcceleration;
-
-			// Update velocity.
-			p->velocity += (radial + tangential + p->linearAcceleration) * dt;
-
-			// Apply damping.
-			p->velocity *= 1.0f / (1.0f + p->linearDamping * dt);
-
-			// Modify position.
-			ppos += p->velocity * dt;
-
-			p->position = ppos;
-
-			const float t = 1.0f - p->life / p->lifetime;
-
-			// Rotate.
-			p->rotation += (p->spinStart * (1.0f - t) + p->spinEnd * t) * dt;
-
-			p->angle = p->rotation;
-
-			if (relativeRotation)
-				p->angle += atan2f(p->velocity.y, p->velocity.x);
-
-			// Change size according to given intervals:
-			// i = 0       1       2      3          n-1
-			//     |-------|-------|------|--- ... ---|
-			// t = 0    1/(n-1)        3/(n-1)        1
-			//
-			// `s' is the interpolation variable scaled to the current
-			// interval width, e.g. if n = 5 and t = 0.3, then the current
-			// indices are 1,2 and s = 0.3 - 0.25 = 0.05
-			float s = p->sizeOffset + t * p->sizeIntervalSize; // size variation
-			s *= (float)(sizes.size() - 1); // 0 <= s < sizes.size()
-			size_t i = (size_t)s;
-			size_t k = (i == sizes.size() - 1) ? i : i + 1; // boundary check (prevents failing on t = 1.0f)
-			s -= (float)i; // transpose s to be in interval [0:1]: i <= s < i + 1 ~> 0 <= s < 1
-			p->size = sizes[i] * (1.0f - s) + sizes[k] * s;
-
-			// Update color according to given intervals (as above)
-			s = t * (float)(colors.size() - 1);
-			i = (size_t)s;
-			k = (i == colors.size() - 1) ? i : i + 1;
-			s -= (float)i;                            // 0 <= s <= 1
-			p->color = colors[i] * (1.0f - s) + colors[k] * s;
-
-			// Update the quad index.
-			k = quads.size();
-			if (k > 0)
-			{
-				s = t * (float) k; // [0:numquads-1] (clamped below)
-				i = (s > 0.0f) ? (size_t) s : 0;
-				p->quadIndex = (int) ((i < k) ? i : k - 1);
-			}
-
-			// Next particle.
-			p = p->next;
+			Chunk chunk = {ps, start, std::min(start + UPDATE_CHUNK_SIZE, ps->activeParticles)};
+			chunks.push_back(chunk);
 		}
 	}
 
+	auto pool = love::thread::WorkerPool::getShared();
+
+	pool->parallelFor((int) chunks.size(), [&](int i)
+	{
+		const Chunk &chunk = chunks[i];
+		chunk.system->integrateParticles(chunk.start, chunk.end, dt);
+		chunk.system->interpolateParticles(chunk.start, chunk.end);
+	});
+
+	// Emitting uses each system's own random number generator, so systems
+	// can still be finished independently of each other.
+	pool->parallelFor((int) updating.size(), [&](int i)
+	{
+		updating[i]->finishUpdate(dt);
+	});
+}
+
+void ParticleSystem::finishUpdate(float dt)
+{
+	if (activeParticles > 0)
+		removeDeadParticles();
+
+	uint32 first = activeParticles;
+
 	// Make some more particles.
 	if (active)
 	{
@@ -1019,6 +1366,8 @@ void ParticleSystem::update(float dt)
 			stop();
 	}
 
+	insertParticles(first);
+
 	prevPosition = position;
 }
 
@@ -1031,6 +1380,9 @@ void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
 
 	gfx->flushStreamDraws();
 
+	if (instanced && drawInstanced(gfx, m))
+		return;
+
 	if (Shader::isDefaultActive())
 		Shader::attachDefault(Shader::STANDARD_DEFAULT);
 
@@ -1041,28 +1393,28 @@ void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
 	const Vector2 *texcoords = texture->getQuad()->getVertexTexCoords();
 
 	Vertex *pVerts = (Vertex *) buffer->map();
-	Particle *p = pHead;
+	const ParticleData &p = particles;
 
 	bool useQuads = !quads.empty();
 
 	Matrix3 t;
 
 	// set the vertex data for each particle (transformation, texcoords, color)
-	while (p)
+	for (uint32 i : drawOrder)
 	{
 		if (useQuads)
 		{
-			positions = quads[p->quadIndex]->getVertexPositions();
-			texcoords = quads[p->quadIndex]->getVertexTexCoords();
+			positions = quads[p.quadIndex[i]]->getVertexPositions();
+			texcoords = quads[p.quadIndex[i]]->getVertexTexCoords();
 		}
 
 		// particle vertices are image vertices transformed by particle info
-		t.setTransformation(p->position.x, p->position.y, p->angle, p->size, p->size, offset.x, offset.y, 0.0f, 0.0f);
+		t.setTransformation(p.positionX[i], p.positionY[i], p.angle[i], p.size[i], p.size[i], offset.x, offset.y, 0.0f, 0.0f);
 		t.transformXY(pVerts, positions, 4);
 
 		// Particle colors are stored as floats (0-1) but vertex colors are
 		// unsigned bytes (0-255).
-		Color32 c = toColor32(p->color);
+		Color32 c = toColor32(p.color[i]);
 
 		// set the texture coordinate and color data for particle vertices
 		for (int v = 0; v < 4; v++)
@@ -1073,7 +1425,6 @@ void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
 		}
 
 		pVerts += 4;
-		p = p->next;
 	}
 
 	buffer->unmap();
@@ -1086,6 +1437,122 @@ void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
 	gfx->drawQuads(0, pCount, vertexAttributes, vertexbuffers, texture);
 }
 
+bool ParticleSystem::drawInstanced(Graphics *gfx, const Matrix4 &m)
+{
+	if (!gfx->getCapabilities().features[Graphics::FEATURE_INSTANCING])
+		return false;
+
+	// Custom shaders don't know how to expand the per-particle data.
+	if (!Shader::isDefaultActive() || Shader::standardShaders[Shader::STANDARD_PARTICLE] == nullptr)
+		return false;
+
+	if (quads.size() > (size_t) MAX_INSTANCED_QUADS)
+		return false;
+
+	if (cornerBuffer == nullptr)
+	{
+		// Same order as the vertices of a Quad, drawn as a triangle strip.
+		const Vector2 corners[4] = {
+			Vector2(0.0f, 0.0f),
+			Vector2(0.0f, 1.0f),
+			Vector2(1.0f, 0.0f),
+			Vector2(1.0f, 1.0f),
+		};
+
+		cornerBuffer = gfx->newBuffer(sizeof(corners), corners, BUFFER_VERTEX, vertex::USAGE_STATIC, 0);
+	}
+
+	if (instanceBuffer == nullptr)
+	{
+		size_t bytes = sizeof(Instance) * maxParticles;
+		instanceBuffer = gfx->newBuffer(bytes, nullptr, BUFFER_VERTEX, vertex::USAGE_DYNAMIC, Buffer::MAP_EXPLICIT_RANGE_MODIFY);
+	}
+
+	Shader::attachDefault(Shader::STANDARD_PARTICLE);
+
+	Shader *shader = Shader::current;
+	shader->checkMainTexture(texture);
+
+	const Shader::UniformInfo *quadinfo = shader->getUniformInfo(Shader::BUILTIN_PARTICLE_QUADS);
+	int transformattrib = shader->getVertexAttributeIndex("love_ParticleTransform");
+	int colorattrib = shader->getVertexAttributeIndex("love_ParticleColor");
+	int quadattrib = shader->getVertexAttributeIndex("love_ParticleQuad");
+
+	if (quadinfo == nullptr || transformattrib < 0 || colorattrib < 0 || quadattrib < 0)
+		return false;
+
+	// Each quad gets its texture coordinate rectangle and its size, which the
+	// vertex shader combines with a corner of the unit square.
+	bool useQuads = !quads.empty();
+	int numquads = useQuads ? (int) quads.size() : 1;
+
+	for (int i = 0; i < numquads; i++)
+	{
+		const Quad *quad = useQuads ? quads[i].get() : texture->getQuad();
+		const Vector2 *texcoords = quad->getVertexTexCoords();
+		const Vector2 *positions = quad->getVertexPositions();
+
+		float *data = quadinfo->floats + i * 8;
+
+		data[0] = texcoords[0].x;
+		data[1] = texcoords[0].y;
+		data[2] = texcoords[3].x - texcoords[0].x;
+		data[3] = texcoords[3].y - texcoords[0].y;
+
+		data[4] = positions[3].x;
+		data[5] = positions[3].y;
+		data[6] = offset.x;
+		data[7] = offset.y;
+	}
+
+	shader->updateUniform(quadinfo, numquads * 2);
+
+	uint32 pCount = getCount();
+	const ParticleData &p = particles;
+
+	Instance *instances = (Instance *) instanceBuffer->map();
+
+	for (uint32 i : drawOrder)
+	{
+		instances->x = p.positionX[i];
+		instances->y = p.positionY[i];
+		instances->size = p.size[i];
+		instances->angle = p.angle[i];
+		instances->color = toColor32(p.color[i]);
+		instances->quadIndex = useQuads ? (float) p.quadIndex[i] : 0.0f;
+
+		instances++;
+	}
+
+	instanceBuffer->setMappedRangeModified(0, sizeof(Instance) * pCount);
+	instanceBuffer->unmap();
+
+	vertex::Attributes attributes;
+	attributes.set(ATTRIB_POS, vertex::DATA_FLOAT, 2, 0, 0);
+	attributes.setBufferLayout(0, (uint16) sizeof(Vector2), STEP_PER_VERTEX);
+
+	attributes.set(transformattrib, vertex::DATA_FLOAT, 4, (uint16) offsetof(Instance, x), 1);
+	attributes.set(colorattrib, vertex::DATA_UNORM8, 4, (uint16) offsetof(Instance, color), 1);
+	attributes.set(quadattrib, vertex::DATA_FLOAT, 1, (uint16) offsetof(Instance, quadIndex), 1);
+	attributes.setBufferLayout(1, (uint16) sizeof(Instance), STEP_PER_INSTANCE);
+
+	vertex::BufferBindings buffers;
+	buffers.set(0, cornerBuffer, 0);
+	buffers.set(1, instanceBuffer, 0);
+
+	Graphics::TempTransform transform(gfx, m);
+
+	Graphics::DrawCommand cmd(&attributes, &buffers);
+	cmd.primitiveType = PRIMITIVE_TRIANGLE_STRIP;
+	cmd.vertexCount = 4;
+	cmd.instanceCount = (int) pCount;
+	cmd.texture = texture;
+
+	gfx->draw(cmd);
+
+	return true;
+}
+
 bool ParticleSystem::getConstant(const char *in, AreaSpreadDistribution &out)
 {
 	return distributions.find(in, out);
@@ -30,6 +30,7 @@
 #include "Quad.h"
 #include "Texture.h"
 #include "Buffer.h"
+#include "math/RandomGenerator.h"
 
 // STL
 #include <vector>
@@ -83,6 +84,12 @@ class ParticleSystem : public Drawable
 	 **/
 	static const uint32 MAX_PARTICLES = LOVE_INT32_MAX / 4;
 
+	/**
+	 * Maximum number of Quads an instanced ParticleSystem can be drawn with.
+	 * Must match the size of love_ParticleQuads in wrap_GraphicsShader.lua.
+	 **/
+	static const int MAX_INSTANCED_QUADS = 32;
+
 	/**
 	 * Creates a particle system with the specified buffer size and texture.
 	 **/
@@ -451,6 +458,16 @@ class ParticleSystem : public Drawable
 	void setRelativeRotation(bool enable);
 	bool hasRelativeRotation() const;
 
+	/**
+	 * Sets whether the particles are drawn with instancing, where a single
+	 * record per particle is uploaded and expanded into a quad on the GPU.
+	 * The regular path is used instead when instancing isn't supported, a
+	 * custom shader is active, or there are more than MAX_INSTANCED_QUADS
+	 * Quads.
+	 **/
+	void setInstanced(bool enable);
+	bool isInstanced() const;
+
 	/**
 	 * Returns the amount of particles that are currently active in the system.
 	 **/
@@ -510,6 +527,16 @@ class ParticleSystem : public Drawable
 	 **/
 	void update(float dt);
 
+	/**
+	 * Updates several particle systems at once, with the work split across
+	 * multiple threads. Large systems are also split up. The result is the
+	 * same as calling update(dt) on each system, regardless of the number of
+	 * threads used.
+	 * @param systems The particle systems to update. Each may appear once.
+	 * @param dt Time since last update.
+	 **/
+	static void update(const std::vector<ParticleSystem *> &systems, float dt);
+
 	// Implements Drawable.
 	void draw(Graphics *gfx, const Matrix4 &m) override;
 
@@ -523,39 +550,62 @@ class ParticleSystem : public Drawable
 
 private:
 
-	// Represents a single particle.
-	struct Particle
+	// Particle data, with one contiguous array per attribute so update() can
+	// process several particles at once.
+	struct ParticleData
 	{
-		Particle *prev;
-		Particle *next;
-
-		float lifetime;
-		float life;
+		float *lifetime;
+		float *life;
 
-		love::Vector2 position;
+		float *positionX;
+		float *positionY;
 
 		// Particles gravitate towards this point.
-		love::Vector2 origin;
+		float *originX;
+		float *originY;
 
-		love::Vector2 velocity;
-		love::Vector2 linearAcceleration;
-		float radialAcceleration;
-		float tangentialAcceleration;
+		float *velocityX;
+		float *velocityY;
+		float *linearAccelerationX;
+		float *linearAccelerationY;
+		float *radialAcceleration;
+		float *tangentialAcceleration;
 
-		float linearDamping;
+		float *linearDamping;
 
-		float size;
-		float sizeOffset;
-		float sizeIntervalSize;
+		float *size;
+		float *sizeOffset;
+		float *sizeIntervalSize;
 
-		float rotation; // Amount of rotation applied to the final angle.
-		float angle;
-		float spinStart;
-		float spinEnd;
+		float *rotation; // Amount of rotation applied to the final angle.
+		float *angle;
+		float *spinStart;
+		float *spinEnd;
+
+		// How far along its lifetime the particle is, in [0, 1].
+		float *age;
 
-		Colorf color;
+		Colorf *color;
 
-		int quadIndex;
+		int *quadIndex;
+	};
+
+	// Used by the vertex buffer.
+	struct Vertex
+	{
+		float x, y;
+		float s, t;
+		Color32 color;
+	};
+
+	// Used by the instance buffer when drawing with instancing.
+	struct Instance
+	{
+		float x, y;
+		float size;
+		float angle;
+		Color32 color;
+		float quadIndex;
 	};
 
 	void resetOffset();
@@ -564,25 +614,41 @@ class ParticleSystem : public Drawable
 	void deleteBuffers();
 
 	void addParticle(float t);
-	Particle *removeParticle(Particle *p);
+	void copyParticle(uint32 src, uint32 dst);
+	void removeDeadParticles();
 
 	// Called by addParticle.
-	void initParticle(Particle *p, float t);
-	void insertTop(Particle *p);
-	void insertBottom(Particle *p);
-	void insertRandom(Particle *p);
+	void initParticle(uint32 index, float t);
+
+	// Adds particles [first, activeParticles) to the draw order, according to
+	// the insert mode.
+	void insertParticles(uint32 first);
+	void insertRandom(uint32 first, uint32 count);
+
+	// Called by update. The first two only touch particles in the given
+	// range, so different ranges can be processed by different threads.
+	void integrateParticles(uint32 start, uint32 end, float dt);
+	void interpolateParticles(uint32 start, uint32 end);
+	void finishUpdate(float dt);
+
+	// Called by draw. Returns false if the regular path should be used.
+	bool drawInstanced(Graphics *gfx, const Matrix4 &m);
 
-	// Pointer to the beginning of the allocated memory.
-	Particle *pMem;
+	// Pointer to the beginning of the allocated memory for all particle data.
+	void *pMem;
 
-	// Pointer to a free particle.
-	Particle *pFree;
+	ParticleData particles;
 
-	// Pointer to the start of the linked list.
-	Particle *pHead;
+	// Indices of the active particles, in the order they're drawn.
+	std::vector<uint32> drawOrder;
 
-	// Pointer to the end of the linked list.
-	Particle *pTail;
+	// Scratch space used when removing and inserting particles.
+	std::vector<uint32> particleRemap;
+	std::vector<uint64> insertPositions;
+
+	// Every system has its own random number sequence, so its results don't
+	// depend on the order in which systems are updated.
+	love::math::RandomGenerator rng;
 
 	// The texture to be drawn.
 	StrongRef<Texture> texture;
@@ -673,9 +739,15 @@ class ParticleSystem : public Drawable
 
 	bool relativeRotation;
 
+	bool instanced;
+
 	const vertex::Attributes vertexAttributes;
 	Buffer *buffer;
 
+	// Only created once the ParticleSystem is drawn with instancing.
+	Buffer *instanceBuffer;
+	Buffer *cornerBuffer;
+
 	static StringMap<AreaSpreadDistribution, DISTRIBUTION_MAX_ENUM>::Entry distributionsEntries[];
 	static StringMap<AreaSpreadDistribution, DISTRIBUTION_MAX_ENUM> distributions;
 
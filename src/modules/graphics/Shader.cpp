@@ -197,6 +197,7 @@ StringMap<Shader::BuiltinUniform, Shader::BUILTIN_MAX_ENUM>::Entry Shader::built
 	{ "ViewNormalFromLocal", BUILTIN_MATRIX_VIEW_NORMAL_FROM_LOCAL },
 	{ "love_PointSize",      BUILTIN_POINT_SIZE                    },
 	{ "love_ScreenSize",     BUILTIN_SCREEN_SIZE                   },
+	{ "love_ParticleQuads",  BUILTIN_PARTICLE_QUADS                },
 };
 
 StringMap<Shader::BuiltinUniform, Shader::BUILTIN_MAX_ENUM> Shader::builtinNames(Shader::builtinNameEntries, sizeof(Shader::builtinNameEntries));
@@ -74,6 +74,7 @@ class Shader : public Object, public Resource
 		BUILTIN_MATRIX_VIEW_NORMAL_FROM_LOCAL,
 		BUILTIN_POINT_SIZE,
 		BUILTIN_SCREEN_SIZE,
+		BUILTIN_PARTICLE_QUADS,
 		BUILTIN_MAX_ENUM
 	};
 
@@ -95,6 +96,7 @@ class Shader : public Object, public Resource
 		STANDARD_DEFAULT,
 		STANDARD_VIDEO,
 		STANDARD_ARRAY,
+		STANDARD_PARTICLE,
 		STANDARD_MAX_ENUM
 	};
 
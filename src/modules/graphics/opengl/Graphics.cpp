@@ -215,7 +215,7 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 		// resize to fit if needed, later.
 		streamBufferState.vb[0] = CreateStreamBuffer(BUFFER_VERTEX, 1024 * 1024 * 1);
 		streamBufferState.vb[1] = CreateStreamBuffer(BUFFER_VERTEX, 256  * 1024 * 1);
-		streamBufferState.indexBuffer = CreateStreamBuffer(BUFFER_INDEX, sizeof(uint16) * LOVE_UINT16_MAX);
+		streamBufferState.indexBuffer = CreateStreamBuffer(BUFFER_INDEX, sizeof(uint16) * (LOVE_UINT16_MAX + 1));
 	}
 
 	// Reload all volatile objects.
@@ -236,8 +236,13 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 		if (i == Shader::STANDARD_ARRAY && !capabilities.textureTypes[TEXTURE_2D_ARRAY])
 			continue;
 
+		if (i == Shader::STANDARD_PARTICLE && !capabilities.features[FEATURE_INSTANCING])
+			continue;
+
 		// Apparently some intel GMA drivers on windows fail to compile shaders
 		// which use array textures despite claiming support for the extension.
+		// The instanced particle shader is optional as well, ParticleSystems
+		// use their regular draw path without it.
 		try
 		{
 			if (!Shader::standardShaders[i])
@@ -250,7 +255,7 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 		{
 			if (i == Shader::STANDARD_ARRAY)
 				capabilities.textureTypes[TEXTURE_2D_ARRAY] = false;
-			else
+			else if (i != Shader::STANDARD_PARTICLE)
 				throw;
 		}
 	}
@@ -1019,6 +1024,14 @@ void Graphics::present(void *screenshotCallbackData)
 	gl.stats.shaderSwitches = 0;
 	canvasSwitchCount = 0;
 	drawCallsBatched = 0;
+	sortedBatchesBefore = 0;
+	sortedBatchesAfter = 0;
+	indexLimitFlushes = 0;
+
+	frameIndex++;
+
+	// Glyphs rasterized in the background during the last frame.
+	Font::uploadAsyncGlyphs();
 
 	// This assumes temporary canvases will only be used within a render pass.
 	for (int i = (int) temporaryCanvases.size() - 1; i >= 0; i--)
@@ -1312,7 +1325,7 @@ void Graphics::setBlendMode(BlendMode mode, BlendAlpha alphamode)
 
 void Graphics::setPointSize(float size)
 {
-	if (streamBufferState.primitiveMode == PRIMITIVE_POINTS)
+	if (streamBufferState.primitiveMode == PRIMITIVE_POINTS || isSortedBatchActive())
 		flushStreamDraws();
 
 	gl.setPointSize(size * getCurrentDPIScale());
@@ -1381,7 +1394,8 @@ void Graphics::initCapabilities()
 	capabilities.features[FEATURE_SHADER_DERIVATIVES] = GLAD_VERSION_2_0 || GLAD_ES_VERSION_3_0 || GLAD_OES_standard_derivatives;
 	capabilities.features[FEATURE_GLSL3] = GLAD_ES_VERSION_3_0 || gl.isCoreProfile();
 	capabilities.features[FEATURE_INSTANCING] = gl.isInstancingSupported();
-	static_assert(FEATURE_MAX_ENUM == 8, "Graphics::initCapabilities must be updated when adding a new graphics feature!");
+	capabilities.features[FEATURE_INDEX_UINT32] = GLAD_VERSION_1_1 || GLAD_ES_VERSION_3_0 || GLAD_OES_element_index_uint;
+	static_assert(FEATURE_MAX_ENUM == 9, "Graphics::initCapabilities must be updated when adding a new graphics feature!");
 
 	capabilities.limits[LIMIT_POINT_SIZE] = gl.getMaxPointSize();
 	capabilities.limits[LIMIT_TEXTURE_SIZE] = gl.getMax2DTextureSize();
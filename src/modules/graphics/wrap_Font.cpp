@@ -264,6 +264,80 @@ int w_Font_getDPIScale(lua_State *L)
 	return 1;
 }
 
+int w_Font_setAsyncRasterization(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	t->setAsyncRasterization(luax_checkboolean(L, 2));
+	return 0;
+}
+
+int w_Font_isAsyncRasterization(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	luax_pushboolean(L, t->isAsyncRasterization());
+	return 1;
+}
+
+int w_Font_preload(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	const char *text = luaL_checkstring(L, 2);
+	luax_catchexcept(L, [&](){ t->preload(text); });
+	return 0;
+}
+
+int w_Font_setTextureMemoryBudget(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	lua_Number bytes = luaL_checknumber(L, 2);
+	t->setTextureMemoryBudget((int64) bytes);
+	return 0;
+}
+
+int w_Font_getTextureMemoryBudget(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	lua_pushnumber(L, (lua_Number) t->getTextureMemoryBudget());
+	return 1;
+}
+
+int w_Font_getAtlasStats(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	Font::AtlasStats stats = t->getAtlasStats();
+
+	if (lua_istable(L, 2))
+		lua_pushvalue(L, 2);
+	else
+		lua_createtable(L, 0, 8);
+
+	lua_pushinteger(L, stats.pages);
+	lua_setfield(L, -2, "pages");
+
+	lua_pushinteger(L, stats.glyphs);
+	lua_setfield(L, -2, "glyphs");
+
+	lua_pushnumber(L, (lua_Number) stats.textureMemory);
+	lua_setfield(L, -2, "texturememory");
+
+	lua_pushnumber(L, (lua_Number) stats.textureMemoryBudget);
+	lua_setfield(L, -2, "texturememorybudget");
+
+	lua_pushnumber(L, stats.occupancy);
+	lua_setfield(L, -2, "occupancy");
+
+	lua_pushnumber(L, (lua_Number) stats.evictions);
+	lua_setfield(L, -2, "evictions");
+
+	lua_pushnumber(L, (lua_Number) stats.rasterizations);
+	lua_setfield(L, -2, "rasterizations");
+
+	lua_pushinteger(L, stats.frameRasterizations);
+	lua_setfield(L, -2, "framerasterizations");
+
+	return 1;
+}
+
 static const luaL_Reg w_Font_functions[] =
 {
 	{ "getHeight", w_Font_getHeight },
@@ -280,6 +354,12 @@ static const luaL_Reg w_Font_functions[] =
 	{ "getKerning", w_Font_getKerning },
 	{ "setFallbacks", w_Font_setFallbacks },
 	{ "getDPIScale", w_Font_getDPIScale },
+	{ "setTextureMemoryBudget", w_Font_setTextureMemoryBudget },
+	{ "getTextureMemoryBudget", w_Font_getTextureMemoryBudget },
+	{ "getAtlasStats", w_Font_getAtlasStats },
+	{ "setAsyncRasterization", w_Font_setAsyncRasterization },
+	{ "isAsyncRasterization", w_Font_isAsyncRasterization },
+	{ "preload", w_Font_preload },
 	{ 0, 0 }
 };
 
@@ -2116,13 +2116,15 @@ int w_setDefaultShaderCode(lua_State *L)
 			lua_getfield(L, -2, "pixel");
 			lua_getfield(L, -3, "videopixel");
 			lua_getfield(L, -4, "arraypixel");
+			lua_getfield(L, -5, "particlevertex");
 
-			std::string vertex = luax_checkstring(L, -4);
-			std::string pixel = luax_checkstring(L, -3);
-			std::string videopixel = luax_checkstring(L, -2);
-			std::string arraypixel = luax_checkstring(L, -1);
+			std::string vertex = luax_checkstring(L, -5);
+			std::string pixel = luax_checkstring(L, -4);
+			std::string videopixel = luax_checkstring(L, -3);
+			std::string arraypixel = luax_checkstring(L, -2);
+			std::string particlevertex = luax_checkstring(L, -1);
 
-			lua_pop(L, 5);
+			lua_pop(L, 6);
 
 			Graphics::defaultShaderCode[Shader::STANDARD_DEFAULT][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
 			Graphics::defaultShaderCode[Shader::STANDARD_DEFAULT][lang][i].source[ShaderStage::STAGE_PIXEL] = pixel;
@@ -2132,6 +2134,9 @@ int w_setDefaultShaderCode(lua_State *L)
 
 			Graphics::defaultShaderCode[Shader::STANDARD_ARRAY][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
 			Graphics::defaultShaderCode[Shader::STANDARD_ARRAY][lang][i].source[ShaderStage::STAGE_PIXEL] = arraypixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_PARTICLE][lang][i].source[ShaderStage::STAGE_VERTEX] = particlevertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_PARTICLE][lang][i].source[ShaderStage::STAGE_PIXEL] = pixel;
 		}
 	}
 
@@ -2300,7 +2305,7 @@ int w_getStats(lua_State *L)
 	if (lua_istable(L, 1))
 		lua_pushvalue(L, 1);
 	else
-		lua_createtable(L, 0, 7);
+		lua_createtable(L, 0, 11);
 
 	lua_pushinteger(L, stats.drawCalls);
 	lua_setfield(L, -2, "drawcalls");
@@ -2308,6 +2313,15 @@ int w_getStats(lua_State *L)
 	lua_pushinteger(L, stats.drawCallsBatched);
 	lua_setfield(L, -2, "drawcallsbatched");
 
+	lua_pushinteger(L, stats.sortedBatchesBefore);
+	lua_setfield(L, -2, "sortedbatchesbefore");
+
+	lua_pushinteger(L, stats.sortedBatchesAfter);
+	lua_setfield(L, -2, "sortedbatchesafter");
+
+	lua_pushinteger(L, stats.indexLimitFlushes);
+	lua_setfield(L, -2, "indexlimitflushes");
+
 	lua_pushinteger(L, stats.canvasSwitches);
 	lua_setfield(L, -2, "canvasswitches");
 
@@ -2801,6 +2815,45 @@ int w_flushBatch(lua_State *)
 	return 0;
 }
 
+int w_beginSortedBatch(lua_State *L)
+{
+	luax_catchexcept(L, [&](){ instance()->beginSortedBatch(); });
+	return 0;
+}
+
+int w_endSortedBatch(lua_State *L)
+{
+	luax_catchexcept(L, [&](){ instance()->endSortedBatch(); });
+	return 0;
+}
+
+int w_isSortedBatchActive(lua_State *L)
+{
+	luax_pushboolean(L, instance()->isSortedBatchActive());
+	return 1;
+}
+
+int w_updateParticleSystems(lua_State *L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+	float dt = (float) luaL_checknumber(L, 2);
+
+	int count = (int) luax_objlen(L, 1);
+
+	std::vector<ParticleSystem *> systems;
+	systems.reserve(count);
+
+	for (int i = 1; i <= count; i++)
+	{
+		lua_rawgeti(L, 1, i);
+		systems.push_back(luax_checktype<ParticleSystem>(L, -1));
+		lua_pop(L, 1);
+	}
+
+	luax_catchexcept(L, [&](){ ParticleSystem::update(systems, dt); });
+	return 0;
+}
+
 int w_getStackDepth(lua_State *L)
 {
 	lua_pushnumber(L, instance()->getStackDepth());
@@ -3016,6 +3069,10 @@ static const luaL_Reg functions[] =
 	{ "polygon", w_polygon },
 
 	{ "flushBatch", w_flushBatch },
+	{ "beginSortedBatch", w_beginSortedBatch },
+	{ "endSortedBatch", w_endSortedBatch },
+	{ "isSortedBatchActive", w_isSortedBatchActive },
+	{ "updateParticleSystems", w_updateParticleSystems },
 
 	{ "getStackDepth", w_getStackDepth },
 	{ "push", w_push },
@@ -446,6 +446,11 @@ function love.graphics._transformGLSLErrorMessages(message)
 	return table_concat(lines, "\n")
 end
 
+-- VS2013 has a 16KB limit for raw strings, so the file is split in two here.
+-- DO NOT REMOVE THE NEXT TWO LINES.
+--)luastring"--"
+R"luastring"--(
+
 local defaultcode = {
 	vertex = [[
 vec4 position(mat4 clipSpaceFromLocal, vec4 localPosition) {
@@ -463,6 +468,32 @@ void effect() {
 uniform ArrayImage MainTex;
 void effect() {
 	love_PixelColor = Texel(MainTex, VaryingTexCoord.xyz) * VaryingColor;
+}]],
+	particlevertex = [[
+// Per-instance particle data: x, y, size and angle; color; quad index.
+attribute vec4 love_ParticleTransform;
+attribute vec4 love_ParticleColor;
+attribute float love_ParticleQuad;
+
+// Two entries per quad: its texture coordinate rectangle, and its size in
+// pixels followed by the ParticleSystem's offset. See ParticleSystem.cpp.
+uniform vec4 love_ParticleQuads[64];
+
+vec4 position(mat4 clipSpaceFromLocal, vec4 localPosition) {
+	// localPosition is the corner of the quad, in [0, 1].
+	int quad = int(love_ParticleQuad + 0.5) * 2;
+	vec4 texrect = love_ParticleQuads[quad];
+	vec4 geometry = love_ParticleQuads[quad + 1];
+
+	VaryingTexCoord = vec4(texrect.xy + localPosition.xy * texrect.zw, 0.0, 1.0);
+	VaryingColor = gammaCorrectColor(love_ParticleColor) * ConstantColor;
+
+	vec2 v = (localPosition.xy * geometry.xy - geometry.zw) * love_ParticleTransform.z;
+	float c = cos(love_ParticleTransform.w);
+	float s = sin(love_ParticleTransform.w);
+	vec2 pos = love_ParticleTransform.xy + vec2(c * v.x - s * v.y, s * v.x + c * v.y);
+
+	return clipSpaceFromLocal * vec4(pos, 0.0, 1.0);
 }]],
 }
 
@@ -484,6 +515,7 @@ for lang, info in pairs(langs) do
 			pixel = createShaderStageCode("PIXEL", defaultcode.pixel, info.target, info.gles, false, gammacorrect, false),
 			videopixel = createShaderStageCode("PIXEL", defaultcode.videopixel, info.target, info.gles, false, gammacorrect, true),
 			arraypixel = createShaderStageCode("PIXEL", defaultcode.arraypixel, info.target, info.gles, false, gammacorrect, true),
+			particlevertex = createShaderStageCode("VERTEX", defaultcode.particlevertex, info.target, info.gles, false, gammacorrect),
 		}
 	end
 end
@@ -641,6 +641,20 @@ int w_ParticleSystem_hasRelativeRotation(lua_State *L)
 	return 1;
 }
 
+int w_ParticleSystem_setInstanced(lua_State *L)
+{
+	ParticleSystem *t = luax_checkparticlesystem(L, 1);
+	t->setInstanced(luax_checkboolean(L, 2));
+	return 0;
+}
+
+int w_ParticleSystem_isInstanced(lua_State *L)
+{
+	ParticleSystem *t = luax_checkparticlesystem(L, 1);
+	luax_pushboolean(L, t->isInstanced());
+	return 1;
+}
+
 int w_ParticleSystem_getCount(lua_State *L)
 {
 	ParticleSystem *t = luax_checkparticlesystem(L, 1);
@@ -811,6 +825,8 @@ static const luaL_Reg w_ParticleSystem_functions[] =
 	{ "getOffset", w_ParticleSystem_getOffset },
 	{ "setRelativeRotation", w_ParticleSystem_setRelativeRotation },
 	{ "hasRelativeRotation", w_ParticleSystem_hasRelativeRotation },
+	{ "setInstanced", w_ParticleSystem_setInstanced },
+	{ "isInstanced", w_ParticleSystem_isInstanced },
 	{ "getCount", w_ParticleSystem_getCount },
 	{ "start", w_ParticleSystem_start },
 	{ "stop", w_ParticleSystem_stop },
@@ -21,8 +21,25 @@
 #include "ImageData.h"
 #include "Image.h"
 #include "filesystem/Filesystem.h"
+#include "thread/WorkerPool.h"
 
 #include <algorithm> // min/max
+#include <vector>
+#include <math.h>
+
+#if defined(LOVE_SIMD_SSE)
+#include <xmmintrin.h>
+#endif
+
+// The 8 bit row conversions need SSE2.
+#if defined(LOVE_SIMD_SSE) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LOVE_IMAGEDATA_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 using love::thread::Lock;
 
@@ -650,23 +667,13 @@ static void pasteRGBA32FtoRGBA16F(Row src, Row dst, int w)
 		dst.f16[i] = float32to16(src.f32[i]);
 }
 
-void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh)
+// Clips a region copied from one image to another to the inside of both.
+// Returns false if the region ends up completely out of bounds.
+static bool clipRegion(int srcW, int srcH, int dstW, int dstH, int &dx, int &dy, int &sx, int &sy, int &sw, int &sh)
 {
-	PixelFormat dstformat = getFormat();
-	PixelFormat srcformat = src->getFormat();
-
-	int srcW = src->getWidth();
-	int srcH = src->getHeight();
-	int dstW = getWidth();
-	int dstH = getHeight();
-
-	size_t srcpixelsize = src->getPixelSize();
-	size_t dstpixelsize = getPixelSize();
-
-	// Check bounds; if the data ends up completely out of bounds, get out early.
 	if (sx >= srcW || sx + sw < 0 || sy >= srcH || sy + sh < 0
 			|| dx >= dstW || dx + sw < 0 || dy >= dstH || dy + sh < 0)
-		return;
+		return false;
 
 	// Normalize values to the inside of both images.
 	if (dx < 0)
@@ -706,6 +713,26 @@ void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, in
 	if (sy + sh > srcH)
 		sh = srcH - sy;
 
+	return true;
+}
+
+void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh)
+{
+	PixelFormat dstformat = getFormat();
+	PixelFormat srcformat = src->getFormat();
+
+	int srcW = src->getWidth();
+	int srcH = src->getHeight();
+	int dstW = getWidth();
+	int dstH = getHeight();
+
+	size_t srcpixelsize = src->getPixelSize();
+	size_t dstpixelsize = getPixelSize();
+
+	// Check bounds; if the data ends up completely out of bounds, get out early.
+	if (!clipRegion(srcW, srcH, dstW, dstH, dx, dy, sx, sy, sw, sh))
+		return;
+
 	Lock lock2(src->mutex);
 	Lock lock1(mutex);
 
@@ -775,6 +802,713 @@ void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, in
 	}
 }
 
+namespace
+{
+
+// Conversions between pixel components and floats, used by the row kernels.
+
+struct UNorm8
+{
+	typedef uint8 T;
+	static float toFloat(uint8 v) { return v / 255.0f; }
+	static uint8 fromFloat(float f) { return (uint8) (clamp01(f) * 255.0f + 0.5f); }
+};
+
+struct UNorm16
+{
+	typedef uint16 T;
+	static float toFloat(uint16 v) { return v / 65535.0f; }
+	static uint16 fromFloat(float f) { return (uint16) (clamp01(f) * 65535.0f + 0.5f); }
+};
+
+struct Half
+{
+	typedef float16 T;
+	static float toFloat(float16 v) { return float16to32(v); }
+	static float16 fromFloat(float f) { return float32to16(f); }
+};
+
+struct Float
+{
+	typedef float T;
+	static float toFloat(float v) { return v; }
+	static float fromFloat(float f) { return f; }
+};
+
+typedef void (*RowReadFunction)(const uint8 *src, Colorf *dst, int w);
+typedef void (*RowWriteFunction)(const Colorf *src, uint8 *dst, int w);
+
+// Missing components are read as 0, except alpha which is 1, to match
+// getPixel.
+template <typename C, int N>
+void readRow(const uint8 *src, Colorf *dst, int w)
+{
+	const typename C::T *s = (const typename C::T *) src;
+
+	for (int i = 0; i < w; i++)
+	{
+		const typename C::T *p = s + i * N;
+
+		dst[i].r = C::toFloat(p[0]);
+		dst[i].g = N > 1 ? C::toFloat(p[1 % N]) : 0.0f;
+		dst[i].b = N > 2 ? C::toFloat(p[2 % N]) : 0.0f;
+		dst[i].a = N > 3 ? C::toFloat(p[3 % N]) : 1.0f;
+	}
+}
+
+template <typename C, int N>
+void writeRow(const Colorf *src, uint8 *dst, int w)
+{
+	typename C::T *d = (typename C::T *) dst;
+
+	for (int i = 0; i < w; i++)
+	{
+		typename C::T *p = d + i * N;
+
+		p[0] = C::fromFloat(src[i].r);
+		if (N > 1) p[1 % N] = C::fromFloat(src[i].g);
+		if (N > 2) p[2 % N] = C::fromFloat(src[i].b);
+		if (N > 3) p[3 % N] = C::fromFloat(src[i].a);
+	}
+}
+
+#if defined(LOVE_IMAGEDATA_SSE2)
+
+template <>
+void readRow<UNorm8, 4>(const uint8 *src, Colorf *dst, int w)
+{
+	float *d = (float *) dst;
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+
+	for (; i + 4 <= w; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *) (src + i * 4));
+		__m128i lo = _mm_unpacklo_epi8(v, zero);
+		__m128i hi = _mm_unpackhi_epi8(v, zero);
+
+		// Divided rather than multiplied by 1/255, to match the scalar code.
+		_mm_storeu_ps(d + i * 4 + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(d + i * 4 + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(d + i * 4 + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(d + i * 4 + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+
+	for (; i < w; i++)
+	{
+		const uint8 *p = src + i * 4;
+		dst[i].set(UNorm8::toFloat(p[0]), UNorm8::toFloat(p[1]), UNorm8::toFloat(p[2]), UNorm8::toFloat(p[3]));
+	}
+}
+
+template <>
+void writeRow<UNorm8, 4>(const Colorf *src, uint8 *dst, int w)
+{
+	const float *s = (const float *) src;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	int i = 0;
+
+	for (; i + 4 <= w; i += 4)
+	{
+		__m128i v[4];
+		for (int j = 0; j < 4; j++)
+		{
+			__m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + i * 4 + j * 4), zero), one);
+			v[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, scale), half));
+		}
+
+		__m128i lo = _mm_packs_epi32(v[0], v[1]);
+		__m128i hi = _mm_packs_epi32(v[2], v[3]);
+		_mm_storeu_si128((__m128i *) (dst + i * 4), _mm_packus_epi16(lo, hi));
+	}
+
+	for (; i < w; i++)
+	{
+		uint8 *p = dst + i * 4;
+		p[0] = UNorm8::fromFloat(src[i].r);
+		p[1] = UNorm8::fromFloat(src[i].g);
+		p[2] = UNorm8::fromFloat(src[i].b);
+		p[3] = UNorm8::fromFloat(src[i].a);
+	}
+}
+
+#elif defined(LOVE_SIMD_NEON)
+
+template <>
+void writeRow<UNorm8, 4>(const Colorf *src, uint8 *dst, int w)
+{
+	const float *s = (const float *) src;
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	int i = 0;
+
+	for (; i + 4 <= w; i += 4)
+	{
+		uint16x4_t v[4];
+		for (int j = 0; j < 4; j++)
+		{
+			float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(s + i * 4 + j * 4), zero), one);
+			v[j] = vmovn_u32(vcvtq_u32_f32(vmlaq_n_f32(half, x, 255.0f)));
+		}
+
+		uint8x8_t lo = vmovn_u16(vcombine_u16(v[0], v[1]));
+		uint8x8_t hi = vmovn_u16(vcombine_u16(v[2], v[3]));
+		vst1q_u8(dst + i * 4, vcombine_u8(lo, hi));
+	}
+
+	for (; i < w; i++)
+	{
+		uint8 *p = dst + i * 4;
+		p[0] = UNorm8::fromFloat(src[i].r);
+		p[1] = UNorm8::fromFloat(src[i].g);
+		p[2] = UNorm8::fromFloat(src[i].b);
+		p[3] = UNorm8::fromFloat(src[i].a);
+	}
+}
+
+#endif
+
+// Returns false for packed formats, which use the per-pixel functions instead.
+bool getRowFunctions(PixelFormat format, RowReadFunction &read, RowWriteFunction &write)
+{
+	switch (format)
+	{
+	case PIXELFORMAT_R8: read = readRow<UNorm8, 1>; write = writeRow<UNorm8, 1>; return true;
+	case PIXELFORMAT_RG8: read = readRow<UNorm8, 2>; write = writeRow<UNorm8, 2>; return true;
+	case PIXELFORMAT_RGBA8: read = readRow<UNorm8, 4>; write = writeRow<UNorm8, 4>; return true;
+	case PIXELFORMAT_R16: read = readRow<UNorm16, 1>; write = writeRow<UNorm16, 1>; return true;
+	case PIXELFORMAT_RG16: read = readRow<UNorm16, 2>; write = writeRow<UNorm16, 2>; return true;
+	case PIXELFORMAT_RGBA16: read = readRow<UNorm16, 4>; write = writeRow<UNorm16, 4>; return true;
+	case PIXELFORMAT_R16F: read = readRow<Half, 1>; write = writeRow<Half, 1>; return true;
+	case PIXELFORMAT_RG16F: read = readRow<Half, 2>; write = writeRow<Half, 2>; return true;
+	case PIXELFORMAT_RGBA16F: read = readRow<Half, 4>; write = writeRow<Half, 4>; return true;
+	case PIXELFORMAT_R32F: read = readRow<Float, 1>; write = writeRow<Float, 1>; return true;
+	case PIXELFORMAT_RG32F: read = readRow<Float, 2>; write = writeRow<Float, 2>; return true;
+	case PIXELFORMAT_RGBA32F: read = readRow<Float, 4>; write = writeRow<Float, 4>; return true;
+	default: read = nullptr; write = nullptr; return false;
+	}
+}
+
+// The row kernels below work on one RGBA pixel per SIMD register. They leave
+// alpha alone unless the operation changes it.
+
+#if defined(LOVE_SIMD_SSE)
+
+inline __m128 alphaMask()
+{
+	return _mm_cmpgt_ps(_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f), _mm_setzero_ps());
+}
+
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// 1 / v, or 0 where v <= 0.
+inline __m128 reciprocalOrZero(__m128 v)
+{
+	__m128 r = _mm_div_ps(_mm_set1_ps(1.0f), v);
+	return _mm_and_ps(_mm_cmpgt_ps(v, _mm_setzero_ps()), r);
+}
+
+#define LOVE_SPLAT(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+
+#elif defined(LOVE_SIMD_NEON)
+
+inline uint32x4_t alphaMask()
+{
+	const uint32 mask[4] = {0, 0, 0, 0xFFFFFFFF};
+	return vld1q_u32(mask);
+}
+
+// NEON on 32 bit ARM has no division, only an estimate which needs a couple
+// of Newton-Raphson steps to be accurate enough.
+inline float32x4_t reciprocalOrZero(float32x4_t v)
+{
+	float32x4_t r = vrecpeq_f32(v);
+	r = vmulq_f32(vrecpsq_f32(v, r), r);
+	r = vmulq_f32(vrecpsq_f32(v, r), r);
+	uint32x4_t positive = vcgtq_f32(v, vdupq_n_f32(0.0f));
+	return vreinterpretq_f32_u32(vandq_u32(positive, vreinterpretq_u32_f32(r)));
+}
+
+#define LOVE_SPLAT(v, i) vdupq_lane_f32((i) < 2 ? vget_low_f32(v) : vget_high_f32(v), (i) & 1)
+
+#endif
+
+void transformRow(float *d, int count, const float m[20])
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 c0 = _mm_setr_ps(m[0], m[5], m[10], m[15]);
+	const __m128 c1 = _mm_setr_ps(m[1], m[6], m[11], m[16]);
+	const __m128 c2 = _mm_setr_ps(m[2], m[7], m[12], m[17]);
+	const __m128 c3 = _mm_setr_ps(m[3], m[8], m[13], m[18]);
+	const __m128 c4 = _mm_setr_ps(m[4], m[9], m[14], m[19]);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 v = _mm_loadu_ps(d + i);
+		__m128 r = _mm_mul_ps(c0, LOVE_SPLAT(v, 0));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, LOVE_SPLAT(v, 1)));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, LOVE_SPLAT(v, 2)));
+		r = _mm_add_ps(r, _mm_mul_ps(c3, LOVE_SPLAT(v, 3)));
+		_mm_storeu_ps(d + i, _mm_add_ps(r, c4));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float c[20] = {
+		m[0], m[5], m[10], m[15],
+		m[1], m[6], m[11], m[16],
+		m[2], m[7], m[12], m[17],
+		m[3], m[8], m[13], m[18],
+		m[4], m[9], m[14], m[19],
+	};
+	const float32x4_t c0 = vld1q_f32(c + 0);
+	const float32x4_t c1 = vld1q_f32(c + 4);
+	const float32x4_t c2 = vld1q_f32(c + 8);
+	const float32x4_t c3 = vld1q_f32(c + 12);
+	const float32x4_t c4 = vld1q_f32(c + 16);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t v = vld1q_f32(d + i);
+		float32x4_t r = vmlaq_f32(c4, c0, LOVE_SPLAT(v, 0));
+		r = vmlaq_f32(r, c1, LOVE_SPLAT(v, 1));
+		r = vmlaq_f32(r, c2, LOVE_SPLAT(v, 2));
+		r = vmlaq_f32(r, c3, LOVE_SPLAT(v, 3));
+		vst1q_f32(d + i, r);
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float r = d[i + 0], g = d[i + 1], b = d[i + 2], a = d[i + 3];
+
+		d[i + 0] = m[0]  * r + m[1]  * g + m[2]  * b + m[3]  * a + m[4];
+		d[i + 1] = m[5]  * r + m[6]  * g + m[7]  * b + m[8]  * a + m[9];
+		d[i + 2] = m[10] * r + m[11] * g + m[12] * b + m[13] * a + m[14];
+		d[i + 3] = m[15] * r + m[16] * g + m[17] * b + m[18] * a + m[19];
+	}
+#endif
+}
+
+void premultiplyRow(float *d, int count)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 mask = alphaMask();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 v = _mm_loadu_ps(d + i);
+		_mm_storeu_ps(d + i, _mm_mul_ps(v, select(mask, one, LOVE_SPLAT(v, 3))));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const uint32x4_t mask = alphaMask();
+	const float32x4_t one = vdupq_n_f32(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t v = vld1q_f32(d + i);
+		vst1q_f32(d + i, vmulq_f32(v, vbslq_f32(mask, one, LOVE_SPLAT(v, 3))));
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float a = d[i + 3];
+		d[i + 0] *= a;
+		d[i + 1] *= a;
+		d[i + 2] *= a;
+	}
+#endif
+}
+
+void unpremultiplyRow(float *d, int count)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 mask = alphaMask();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 v = _mm_loadu_ps(d + i);
+		__m128 inva = reciprocalOrZero(LOVE_SPLAT(v, 3));
+		_mm_storeu_ps(d + i, _mm_mul_ps(v, select(mask, one, inva)));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const uint32x4_t mask = alphaMask();
+	const float32x4_t one = vdupq_n_f32(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t v = vld1q_f32(d + i);
+		float32x4_t inva = reciprocalOrZero(LOVE_SPLAT(v, 3));
+		vst1q_f32(d + i, vmulq_f32(v, vbslq_f32(mask, one, inva)));
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float a = d[i + 3];
+		float inva = a > 0.0f ? 1.0f / a : 0.0f;
+		d[i + 0] *= inva;
+		d[i + 1] *= inva;
+		d[i + 2] *= inva;
+	}
+#endif
+}
+
+void thresholdRow(float *d, int count, float value)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 mask = alphaMask();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 edge = _mm_set1_ps(value);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 v = _mm_loadu_ps(d + i);
+		__m128 t = _mm_and_ps(_mm_cmpge_ps(v, edge), one);
+		_mm_storeu_ps(d + i, select(mask, v, t));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const uint32x4_t mask = alphaMask();
+	const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+	const float32x4_t edge = vdupq_n_f32(value);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t v = vld1q_f32(d + i);
+		float32x4_t t = vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(v, edge), one));
+		vst1q_f32(d + i, vbslq_f32(mask, v, t));
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		d[i + 0] = d[i + 0] >= value ? 1.0f : 0.0f;
+		d[i + 1] = d[i + 1] >= value ? 1.0f : 0.0f;
+		d[i + 2] = d[i + 2] >= value ? 1.0f : 0.0f;
+	}
+#endif
+}
+
+void blendAlphaRow(float *d, const float *s, int count)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 mask = alphaMask();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 dv = _mm_loadu_ps(d + i);
+		__m128 sv = _mm_loadu_ps(s + i);
+		__m128 sa = LOVE_SPLAT(sv, 3);
+		__m128 da = _mm_mul_ps(LOVE_SPLAT(dv, 3), _mm_sub_ps(one, sa));
+		__m128 a = _mm_add_ps(sa, da);
+		__m128 c = _mm_add_ps(_mm_mul_ps(sv, sa), _mm_mul_ps(dv, da));
+		_mm_storeu_ps(d + i, select(mask, a, _mm_mul_ps(c, reciprocalOrZero(a))));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const uint32x4_t mask = alphaMask();
+	const float32x4_t one = vdupq_n_f32(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t dv = vld1q_f32(d + i);
+		float32x4_t sv = vld1q_f32(s + i);
+		float32x4_t sa = LOVE_SPLAT(sv, 3);
+		float32x4_t da = vmulq_f32(LOVE_SPLAT(dv, 3), vsubq_f32(one, sa));
+		float32x4_t a = vaddq_f32(sa, da);
+		float32x4_t c = vmlaq_f32(vmulq_f32(sv, sa), dv, da);
+		vst1q_f32(d + i, vbslq_f32(mask, a, vmulq_f32(c, reciprocalOrZero(a))));
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float sa = s[i + 3];
+		float da = d[i + 3] * (1.0f - sa);
+		float a = sa + da;
+		float inva = a > 0.0f ? 1.0f / a : 0.0f;
+
+		d[i + 0] = (s[i + 0] * sa + d[i + 0] * da) * inva;
+		d[i + 1] = (s[i + 1] * sa + d[i + 1] * da) * inva;
+		d[i + 2] = (s[i + 2] * sa + d[i + 2] * da) * inva;
+		d[i + 3] = a;
+	}
+#endif
+}
+
+void blendAddRow(float *d, const float *s, int count)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 mask = alphaMask();
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 dv = _mm_loadu_ps(d + i);
+		__m128 sv = _mm_loadu_ps(s + i);
+		__m128 r = _mm_add_ps(dv, _mm_mul_ps(sv, LOVE_SPLAT(sv, 3)));
+		_mm_storeu_ps(d + i, select(mask, dv, r));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const uint32x4_t mask = alphaMask();
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t dv = vld1q_f32(d + i);
+		float32x4_t sv = vld1q_f32(s + i);
+		float32x4_t r = vmlaq_f32(dv, sv, LOVE_SPLAT(sv, 3));
+		vst1q_f32(d + i, vbslq_f32(mask, dv, r));
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float sa = s[i + 3];
+		d[i + 0] += s[i + 0] * sa;
+		d[i + 1] += s[i + 1] * sa;
+		d[i + 2] += s[i + 2] * sa;
+	}
+#endif
+}
+
+void blendMultiplyRow(float *d, const float *s, int count)
+{
+#if defined(LOVE_SIMD_SSE)
+	const __m128 mask = alphaMask();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		__m128 dv = _mm_loadu_ps(d + i);
+		__m128 sv = _mm_loadu_ps(s + i);
+		__m128 sa = LOVE_SPLAT(sv, 3);
+		__m128 f = _mm_add_ps(_mm_sub_ps(one, sa), _mm_mul_ps(sv, sa));
+		_mm_storeu_ps(d + i, select(mask, dv, _mm_mul_ps(dv, f)));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const uint32x4_t mask = alphaMask();
+	const float32x4_t one = vdupq_n_f32(1.0f);
+
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float32x4_t dv = vld1q_f32(d + i);
+		float32x4_t sv = vld1q_f32(s + i);
+		float32x4_t sa = LOVE_SPLAT(sv, 3);
+		float32x4_t f = vmlaq_f32(vsubq_f32(one, sa), sv, sa);
+		vst1q_f32(d + i, vbslq_f32(mask, dv, vmulq_f32(dv, f)));
+	}
+#else
+	for (int i = 0; i < count * 4; i += 4)
+	{
+		float sa = s[i + 3];
+		d[i + 0] *= 1.0f - sa + s[i + 0] * sa;
+		d[i + 1] *= 1.0f - sa + s[i + 1] * sa;
+		d[i + 2] *= 1.0f - sa + s[i + 2] * sa;
+	}
+#endif
+}
+
+#undef LOVE_SPLAT
+
+} // anonymous namespace
+
+void ImageData::applyRowKernel(const Rect &rect, const RowKernel &kernel, ImageData *src, int sx, int sy)
+{
+	if (rect.w <= 0 || rect.h <= 0)
+		return;
+
+	if (!inside(rect.x, rect.y) || !inside(rect.x + rect.w - 1, rect.y + rect.h - 1))
+		throw love::Exception("Invalid rectangle dimensions.");
+
+	RowReadFunction read = nullptr;
+	RowWriteFunction write = nullptr;
+	getRowFunctions(format, read, write);
+
+	RowReadFunction srcread = nullptr;
+	RowWriteFunction srcwrite = nullptr;
+	if (src != nullptr)
+		getRowFunctions(src->format, srcread, srcwrite);
+
+	size_t pixelsize = getPixelSize();
+	size_t srcpixelsize = src != nullptr ? src->getPixelSize() : 0;
+
+	// Enough rows per job to make handing them to another thread worthwhile.
+	const int minpixelsperjob = 16 * 1024;
+	int rowsperjob = std::max(minpixelsperjob / rect.w, 1);
+	int jobs = (rect.h + rowsperjob - 1) / rowsperjob;
+
+	auto job = [&](int index)
+	{
+		std::vector<Colorf> dstrow(rect.w);
+		std::vector<Colorf> srcrow(src != nullptr ? rect.w : 0);
+
+		int starty = rect.y + index * rowsperjob;
+		int endy = std::min(starty + rowsperjob, rect.y + rect.h);
+
+		for (int y = starty; y < endy; y++)
+		{
+			uint8 *d = data + (y * width + rect.x) * pixelsize;
+
+			if (read != nullptr)
+				read(d, dstrow.data(), rect.w);
+			else
+			{
+				for (int x = 0; x < rect.w; x++)
+					pixelGetFunction((const Pixel *) (d + x * pixelsize), dstrow[x]);
+			}
+
+			if (src != nullptr)
+			{
+				const uint8 *s = src->data + ((sy + y - rect.y) * src->width + sx) * srcpixelsize;
+
+				if (srcread != nullptr)
+					srcread(s, srcrow.data(), rect.w);
+				else
+				{
+					for (int x = 0; x < rect.w; x++)
+						src->pixelGetFunction((const Pixel *) (s + x * srcpixelsize), srcrow[x]);
+				}
+			}
+
+			kernel((float *) dstrow.data(), src != nullptr ? (const float *) srcrow.data() : nullptr, rect.w);
+
+			if (write != nullptr)
+				write(dstrow.data(), d, rect.w);
+			else
+			{
+				for (int x = 0; x < rect.w; x++)
+					pixelSetFunction(dstrow[x], (Pixel *) (d + x * pixelsize));
+			}
+		}
+	};
+
+	love::thread::WorkerPool::getShared()->parallelFor(jobs, job);
+}
+
+void ImageData::blend(ImageData *src, BlendMode mode, int dx, int dy, int sx, int sy, int sw, int sh)
+{
+	if (!clipRegion(src->getWidth(), src->getHeight(), getWidth(), getHeight(), dx, dy, sx, sy, sw, sh))
+		return;
+
+	// Rows are processed in parallel, so they can't overlap with each other.
+	StrongRef<ImageData> srccopy;
+	if (src == this)
+	{
+		srccopy.set(src->clone(), Acquire::NORETAIN);
+		src = srccopy.get();
+	}
+
+	Lock lock2(src->mutex);
+	Lock lock1(mutex);
+
+	Rect rect = {dx, dy, sw, sh};
+
+	switch (mode)
+	{
+	case BLEND_ALPHA:
+		applyRowKernel(rect, blendAlphaRow, src, sx, sy);
+		break;
+	case BLEND_ADD:
+		applyRowKernel(rect, blendAddRow, src, sx, sy);
+		break;
+	case BLEND_MULTIPLY:
+		applyRowKernel(rect, blendMultiplyRow, src, sx, sy);
+		break;
+	case BLEND_REPLACE:
+	default:
+		applyRowKernel(rect, [](float *d, const float *s, int count)
+		{
+			memcpy(d, s, sizeof(float) * 4 * count);
+		}, src, sx, sy);
+		break;
+	}
+}
+
+void ImageData::transformColor(const float matrix[20], const Rect &rect)
+{
+	float m[20];
+	memcpy(m, matrix, sizeof(float) * 20);
+
+	Lock lock(mutex);
+
+	applyRowKernel(rect, [&m](float *d, const float *, int count)
+	{
+		transformRow(d, count, m);
+	});
+}
+
+void ImageData::applyGamma(float gamma, const Rect &rect)
+{
+	Lock lock(mutex);
+
+	applyRowKernel(rect, [gamma](float *d, const float *, int count)
+	{
+		for (int i = 0; i < count * 4; i += 4)
+		{
+			d[i + 0] = powf(std::max(d[i + 0], 0.0f), gamma);
+			d[i + 1] = powf(std::max(d[i + 1], 0.0f), gamma);
+			d[i + 2] = powf(std::max(d[i + 2], 0.0f), gamma);
+		}
+	});
+}
+
+void ImageData::premultiplyAlpha(const Rect &rect)
+{
+	Lock lock(mutex);
+
+	applyRowKernel(rect, [](float *d, const float *, int count)
+	{
+		premultiplyRow(d, count);
+	});
+}
+
+void ImageData::unpremultiplyAlpha(const Rect &rect)
+{
+	Lock lock(mutex);
+
+	applyRowKernel(rect, [](float *d, const float *, int count)
+	{
+		unpremultiplyRow(d, count);
+	});
+}
+
+void ImageData::threshold(float value, const Rect &rect)
+{
+	Lock lock(mutex);
+
+	applyRowKernel(rect, [value](float *d, const float *, int count)
+	{
+		thresholdRow(d, count, value);
+	});
+}
+
+void ImageData::swizzle(const int channels[4], const Rect &rect)
+{
+	int c[4];
+	for (int i = 0; i < 4; i++)
+	{
+		if (channels[i] < 0 || channels[i] > SWIZZLE_ONE)
+			throw love::Exception("Invalid swizzle channel: %d", channels[i]);
+		c[i] = channels[i];
+	}
+
+	Lock lock(mutex);
+
+	applyRowKernel(rect, [&c](float *d, const float *, int count)
+	{
+		for (int i = 0; i < count * 4; i += 4)
+		{
+			const float v[6] = {d[i + 0], d[i + 1], d[i + 2], d[i + 3], 0.0f, 1.0f};
+			d[i + 0] = v[c[0]];
+			d[i + 1] = v[c[1]];
+			d[i + 2] = v[c[2]];
+			d[i + 3] = v[c[3]];
+		}
+	});
+}
+
 love::thread::Mutex *ImageData::getMutex() const
 {
 	return mutex;
@@ -893,6 +1627,21 @@ std::vector<std::string> ImageData::getConstants(FormatHandler::EncodedFormat)
 	return encodedFormats.getNames();
 }
 
+bool ImageData::getConstant(const char *in, BlendMode &out)
+{
+	return blendModes.find(in, out);
+}
+
+bool ImageData::getConstant(BlendMode in, const char *&out)
+{
+	return blendModes.find(in, out);
+}
+
+std::vector<std::string> ImageData::getConstants(BlendMode)
+{
+	return blendModes.getNames();
+}
+
 StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM>::Entry ImageData::encodedFormatEntries[] =
 {
 	{"tga", FormatHandler::ENCODED_TGA},
@@ -901,5 +1650,15 @@ StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM>::Entry
 
 StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM> ImageData::encodedFormats(ImageData::encodedFormatEntries, sizeof(ImageData::encodedFormatEntries));
 
+StringMap<ImageData::BlendMode, ImageData::BLEND_MAX_ENUM>::Entry ImageData::blendModeEntries[] =
+{
+	{"alpha",    BLEND_ALPHA   },
+	{"add",      BLEND_ADD     },
+	{"multiply", BLEND_MULTIPLY},
+	{"replace",  BLEND_REPLACE },
+};
+
+StringMap<ImageData::BlendMode, ImageData::BLEND_MAX_ENUM> ImageData::blendModes(ImageData::blendModeEntries, sizeof(ImageData::blendModeEntries));
+
 } // image
 } // love
@@ -27,11 +27,15 @@
 #include "common/pixelformat.h"
 #include "common/floattypes.h"
 #include "common/Color.h"
+#include "common/math.h"
 #include "filesystem/FileData.h"
 #include "thread/threads.h"
 #include "ImageDataBase.h"
 #include "FormatHandler.h"
 
+// C++
+#include <functional>
+
 using love::thread::Mutex;
 
 namespace love
@@ -59,6 +63,23 @@ class ImageData : public ImageDataBase
 	typedef void (*PixelSetFunction)(const Colorf &c, Pixel *p);
 	typedef void (*PixelGetFunction)(const Pixel *p, Colorf &c);
 
+	// How blend() combines the source pixels with the existing ones.
+	enum BlendMode
+	{
+		BLEND_ALPHA,
+		BLEND_ADD,
+		BLEND_MULTIPLY,
+		BLEND_REPLACE,
+		BLEND_MAX_ENUM
+	};
+
+	// Values for swizzle() which aren't channel indices.
+	enum SwizzleConstant
+	{
+		SWIZZLE_ZERO = 4,
+		SWIZZLE_ONE = 5,
+	};
+
 	static love::Type type;
 
 	ImageData(Data *data);
@@ -79,6 +100,45 @@ class ImageData : public ImageDataBase
 	 **/
 	void paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh);
 
+	/**
+	 * Blends part of another ImageData onto this one. The arguments after the
+	 * blend mode are the same as paste(). Unlike paste(), any two pixel
+	 * formats can be used.
+	 **/
+	void blend(ImageData *src, BlendMode mode, int dx, int dy, int sx, int sy, int sw, int sh);
+
+	/**
+	 * The functions below modify the pixels in a rectangle of the ImageData.
+	 * Rows are converted to floating point RGBA, processed, and converted
+	 * back, split across multiple threads for large rectangles.
+	 **/
+
+	/**
+	 * Multiplies each pixel by a 4x5 row-major color matrix. The 5th column is
+	 * added to the result.
+	 **/
+	void transformColor(const float matrix[20], const Rect &rect);
+
+	/**
+	 * Raises the red, green, and blue components to the given power.
+	 **/
+	void applyGamma(float gamma, const Rect &rect);
+
+	void premultiplyAlpha(const Rect &rect);
+	void unpremultiplyAlpha(const Rect &rect);
+
+	/**
+	 * Sets the red, green, and blue components to 1 if they're greater than or
+	 * equal to the given value, and 0 otherwise.
+	 **/
+	void threshold(float value, const Rect &rect);
+
+	/**
+	 * Rearranges the components of each pixel. Each value is the index of the
+	 * source component (0-3) or a SwizzleConstant.
+	 **/
+	void swizzle(const int channels[4], const Rect &rect);
+
 	/**
 	 * Checks whether a position is inside this ImageData. Useful for checking bounds.
 	 * @param x The position along the x-axis.
@@ -133,8 +193,18 @@ class ImageData : public ImageDataBase
 	static bool getConstant(FormatHandler::EncodedFormat in, const char *&out);
 	static std::vector<std::string> getConstants(FormatHandler::EncodedFormat);
 
+	static bool getConstant(const char *in, BlendMode &out);
+	static bool getConstant(BlendMode in, const char *&out);
+	static std::vector<std::string> getConstants(BlendMode);
+
 private:
 
+	// Processes rows of floating point RGBA pixels in place. src is only used
+	// by blend(), and is nullptr otherwise.
+	typedef std::function<void(float *dst, const float *src, int count)> RowKernel;
+
+	void applyRowKernel(const Rect &rect, const RowKernel &kernel, ImageData *src = nullptr, int sx = 0, int sy = 0);
+
 	// Create imagedata. Initialize with data if not null.
 	void create(int width, int height, PixelFormat format, void *data = nullptr);
 
@@ -156,6 +226,9 @@ class ImageData : public ImageDataBase
 	static StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM>::Entry encodedFormatEntries[];
 	static StringMap<FormatHandler::EncodedFormat, FormatHandler::ENCODED_MAX_ENUM> encodedFormats;
 
+	static StringMap<BlendMode, BLEND_MAX_ENUM>::Entry blendModeEntries[];
+	static StringMap<BlendMode, BLEND_MAX_ENUM> blendModes;
+
 }; // ImageData
 
 } // image
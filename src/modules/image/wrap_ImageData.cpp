@@ -223,6 +223,130 @@ int w_ImageData_paste(lua_State *L)
 	return 0;
 }
 
+int w_ImageData_blend(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	ImageData *src = luax_checkimagedata(L, 2);
+
+	ImageData::BlendMode mode;
+	const char *modestr = luaL_checkstring(L, 3);
+	if (!ImageData::getConstant(modestr, mode))
+		return luax_enumerror(L, "blend mode", ImageData::getConstants(mode), modestr);
+
+	int dx = (int) luaL_optinteger(L, 4, 0);
+	int dy = (int) luaL_optinteger(L, 5, 0);
+	int sx = (int) luaL_optinteger(L, 6, 0);
+	int sy = (int) luaL_optinteger(L, 7, 0);
+	int sw = (int) luaL_optinteger(L, 8, src->getWidth());
+	int sh = (int) luaL_optinteger(L, 9, src->getHeight());
+
+	luax_catchexcept(L, [&](){ t->blend(src, mode, dx, dy, sx, sy, sw, sh); });
+	return 0;
+}
+
+static Rect luax_optrect(lua_State *L, int startidx, ImageData *t)
+{
+	Rect r;
+	r.x = (int) luaL_optinteger(L, startidx + 0, 0);
+	r.y = (int) luaL_optinteger(L, startidx + 1, 0);
+	r.w = (int) luaL_optinteger(L, startidx + 2, t->getWidth() - r.x);
+	r.h = (int) luaL_optinteger(L, startidx + 3, t->getHeight() - r.y);
+	return r;
+}
+
+int w_ImageData_transformColor(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	// Either a 4x4 matrix, or a 4x5 matrix whose last column is an offset.
+	int len = (int) luax_objlen(L, 2);
+	if (len != 16 && len != 20)
+		return luaL_error(L, "Color matrix must have 16 or 20 numbers (got %d).", len);
+
+	int columns = len / 4;
+	float matrix[20] = {0.0f};
+
+	for (int row = 0; row < 4; row++)
+	{
+		for (int column = 0; column < columns; column++)
+		{
+			lua_rawgeti(L, 2, row * columns + column + 1);
+			matrix[row * 5 + column] = (float) luaL_checknumber(L, -1);
+			lua_pop(L, 1);
+		}
+	}
+
+	Rect r = luax_optrect(L, 3, t);
+	luax_catchexcept(L, [&](){ t->transformColor(matrix, r); });
+	return 0;
+}
+
+int w_ImageData_applyGamma(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	float gamma = (float) luaL_checknumber(L, 2);
+	Rect r = luax_optrect(L, 3, t);
+	luax_catchexcept(L, [&](){ t->applyGamma(gamma, r); });
+	return 0;
+}
+
+int w_ImageData_premultiplyAlpha(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	Rect r = luax_optrect(L, 2, t);
+	luax_catchexcept(L, [&](){ t->premultiplyAlpha(r); });
+	return 0;
+}
+
+int w_ImageData_unpremultiplyAlpha(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	Rect r = luax_optrect(L, 2, t);
+	luax_catchexcept(L, [&](){ t->unpremultiplyAlpha(r); });
+	return 0;
+}
+
+int w_ImageData_threshold(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+	float value = (float) luaL_checknumber(L, 2);
+	Rect r = luax_optrect(L, 3, t);
+	luax_catchexcept(L, [&](){ t->threshold(value, r); });
+	return 0;
+}
+
+int w_ImageData_swizzle(lua_State *L)
+{
+	ImageData *t = luax_checkimagedata(L, 1);
+
+	// e.g. "bgra", or "rgb1" to make every pixel opaque.
+	size_t len = 0;
+	const char *str = luaL_checklstring(L, 2, &len);
+	if (len != 4)
+		return luaL_error(L, "Swizzle string must have 4 characters.");
+
+	int channels[4];
+	for (int i = 0; i < 4; i++)
+	{
+		switch (str[i])
+		{
+		case 'r': channels[i] = 0; break;
+		case 'g': channels[i] = 1; break;
+		case 'b': channels[i] = 2; break;
+		case 'a': channels[i] = 3; break;
+		case '0': channels[i] = ImageData::SWIZZLE_ZERO; break;
+		case '1': channels[i] = ImageData::SWIZZLE_ONE; break;
+		default:
+			return luaL_error(L, "Invalid swizzle character '%c' (expected one of r, g, b, a, 0, 1).", str[i]);
+		}
+	}
+
+	Rect r = luax_optrect(L, 3, t);
+	luax_catchexcept(L, [&](){ t->swizzle(channels, r); });
+	return 0;
+}
+
 int w_ImageData_encode(lua_State *L)
 {
 	ImageData *t = luax_checkimagedata(L, 1);
@@ -320,6 +444,13 @@ static const luaL_Reg w_ImageData_functions[] =
 	{ "getPixel", w_ImageData_getPixel },
 	{ "setPixel", w_ImageData_setPixel },
 	{ "paste", w_ImageData_paste },
+	{ "blend", w_ImageData_blend },
+	{ "transformColor", w_ImageData_transformColor },
+	{ "applyGamma", w_ImageData_applyGamma },
+	{ "premultiplyAlpha", w_ImageData_premultiplyAlpha },
+	{ "unpremultiplyAlpha", w_ImageData_unpremultiplyAlpha },
+	{ "threshold", w_ImageData_threshold },
+	{ "swizzle", w_ImageData_swizzle },
 	{ "encode", w_ImageData_encode },
 
 	// Used in the Lua wrapper code.
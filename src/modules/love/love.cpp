@@ -343,6 +343,14 @@ static int w__requestRecordingPermission(lua_State *L)
 	return 0;
 }
 
+static int w__setAudioBackend(lua_State *L)
+{
+#ifdef LOVE_ENABLE_AUDIO
+	love::audio::setRequestedBackend(luaL_optstring(L, 1, ""));
+#endif
+	return 0;
+}
+
 static int w_love_setDeprecationOutput(lua_State *L)
 {
 	bool enable = love::luax_checkboolean(L, 1);
@@ -423,6 +431,8 @@ int luaopen_love(lua_State *L)
 	lua_setfield(L, -2, "_setAudioMixWithSystem");
 	lua_pushcfunction(L, w__requestRecordingPermission);
 	lua_setfield(L, -2, "_requestRecordingPermission");
+	lua_pushcfunction(L, w__setAudioBackend);
+	lua_setfield(L, -2, "_setAudioBackend");
 
 	lua_newtable(L);
 
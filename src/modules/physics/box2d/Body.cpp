@@ -93,6 +93,31 @@ float Body::getAngle()
 	return body->GetAngle();
 }
 
+void Body::getInterpolatedPosition(float alpha, float &x_o, float &y_o)
+{
+	b2Vec2 position;
+	float angle;
+	world->getInterpolatedTransform(body, alpha, position, angle);
+
+	b2Vec2 v = Physics::scaleUp(position);
+	x_o = v.x;
+	y_o = v.y;
+}
+
+float Body::getInterpolatedAngle(float alpha)
+{
+	b2Vec2 position;
+	float angle;
+	world->getInterpolatedTransform(body, alpha, position, angle);
+	return angle;
+}
+
+void Body::resetInterpolation()
+{
+	if (udata != nullptr)
+		udata->interpolationUpdate = 0;
+}
+
 void Body::getWorldCenter(float &x_o, float &y_o)
 {
 	b2Vec2 v = Physics::scaleUp(body->GetWorldCenter());
@@ -203,11 +228,13 @@ void Body::applyForce(float fx, float fy, bool wake)
 void Body::setX(float x)
 {
 	body->SetTransform(Physics::scaleDown(b2Vec2(x, getY())), getAngle());
+	resetInterpolation();
 }
 
 void Body::setY(float y)
 {
 	body->SetTransform(Physics::scaleDown(b2Vec2(getX(), y)), getAngle());
+	resetInterpolation();
 }
 
 void Body::setLinearVelocity(float x, float y)
@@ -218,6 +245,7 @@ void Body::setLinearVelocity(float x, float y)
 void Body::setAngle(float d)
 {
 	body->SetTransform(body->GetPosition(), d);
+	resetInterpolation();
 }
 
 void Body::setAngularVelocity(float r)
@@ -228,6 +256,7 @@ void Body::setAngularVelocity(float r)
 void Body::setPosition(float x, float y)
 {
 	body->SetTransform(Physics::scaleDown(b2Vec2(x, y)), body->GetAngle());
+	resetInterpolation();
 }
 
 void Body::setAngularDamping(float d)
@@ -23,6 +23,7 @@
 
 // LOVE
 #include "common/math.h"
+#include "common/int.h"
 #include "common/runtime.h"
 #include "common/Object.h"
 #include "physics/Body.h"
@@ -49,6 +50,13 @@ struct bodyudata
 {
 	// Reference to arbitrary data.
 	Reference *ref = nullptr;
+
+	// Position and angle from before the last timestep of an interpolated
+	// World update. Only valid while interpolationUpdate matches the World's
+	// update count.
+	b2Vec2 previousPosition;
+	float previousAngle = 0.0f;
+	uint64 interpolationUpdate = 0;
 };
 
 /**
@@ -101,6 +109,28 @@ class Body : public love::physics::Body
 	 **/
 	void getPosition(float &x_o, float &y_o);
 
+	/**
+	 * Gets the position of the Body blended between the last two timesteps
+	 * of an interpolated World update. Same as getPosition otherwise.
+	 * @param alpha The blend factor, from 0 (previous) to 1 (current).
+	 * @param[out] x_o The x-component of the position.
+	 * @param[out] y_o The y-component of the position.
+	 **/
+	void getInterpolatedPosition(float alpha, float &x_o, float &y_o);
+
+	/**
+	 * Gets the angle (rad) of the Body blended between the last two
+	 * timesteps of an interpolated World update. Same as getAngle otherwise.
+	 * @param alpha The blend factor, from 0 (previous) to 1 (current).
+	 **/
+	float getInterpolatedAngle(float alpha);
+
+	/**
+	 * Makes the interpolated position and angle equal the current ones until
+	 * the next interpolated World update. Used when the Body is moved.
+	 **/
+	void resetInterpolation();
+
 	/**
 	 * Gets the velocity in the current center of mass.
 	 * @param[out] x_o The x-component of the velocity.
@@ -48,9 +48,9 @@ const char *Physics::getName() const
 	return "love.physics.box2d";
 }
 
-World *Physics::newWorld(float gx, float gy, bool sleep)
+World *Physics::newWorld(float gx, float gy, bool sleep, int threads)
 {
-	return new World(b2Vec2(gx, gy), sleep);
+	return new World(b2Vec2(gx, gy), sleep, threads);
 }
 
 Body *Physics::newBody(World *world, float x, float y, Body::Type type)
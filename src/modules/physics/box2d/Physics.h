@@ -73,8 +73,9 @@ class Physics : public Module
 	 * @param gx Gravity along x-axis.
 	 * @param gy Gravity along y-axis.
 	 * @param sleep Whether the World allows sleep.
+	 * @param threads The number of threads used to step the World.
 	 **/
-	World *newWorld(float gx, float gy, bool sleep);
+	World *newWorld(float gx, float gy, bool sleep, int threads);
 
 	/**
 	 * Creates a new Body at the specified position.
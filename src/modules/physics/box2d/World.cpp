@@ -25,6 +25,7 @@
 #include "Contact.h"
 #include "Physics.h"
 #include "common/Reference.h"
+#include "thread/WorkerPool.h"
 
 // Needed for World::getJoints. It should be moved to wrapper code...
 #include "wrap_Joint.h"
@@ -230,6 +231,8 @@ World::World()
 	, end(this)
 	, presolve(this)
 	, postsolve(this)
+	, contactEventsBuffered(false)
+	, updateCount(0)
 {
 	world = new b2World(b2Vec2(0,0));
 	world->SetAllowSleeping(true);
@@ -241,19 +244,25 @@ World::World()
 	registerObject(world, this);
 }
 
-World::World(b2Vec2 gravity, bool sleep)
+World::World(b2Vec2 gravity, bool sleep, int threads)
 	: world(nullptr)
 	, destructWorld(false)
 	, begin(this)
 	, end(this)
 	, presolve(this)
 	, postsolve(this)
+	, contactEventsBuffered(false)
+	, updateCount(0)
 {
+	if (threads < 1)
+		throw love::Exception("A World must use at least one thread.");
+
 	world = new b2World(Physics::scaleDown(gravity));
 	world->SetAllowSleeping(sleep);
 	world->SetContactListener(this);
 	world->SetContactFilter(this);
 	world->SetDestructionListener(this);
+	setThreadCount(threads);
 	b2BodyDef def;
 	groundBody = world->CreateBody(&def);
 	registerObject(world, this);
@@ -271,8 +280,49 @@ void World::update(float dt)
 
 void World::update(float dt, int velocityIterations, int positionIterations)
 {
-	world->Step(dt, velocityIterations, positionIterations);
+	update(dt, velocityIterations, positionIterations, 1, false);
+}
+
+void World::update(float dt, int velocityIterations, int positionIterations, int substeps, bool interpolate)
+{
+	if (substeps < 1)
+		throw love::Exception("The number of substeps must be at least 1.");
+
+	updateCount++;
+	float stepdt = dt / substeps;
+
+	for (int i = 0; i < substeps; i++)
+	{
+		if (interpolate && i == substeps - 1)
+		{
+			// Static bodies only move when they're set to, and setting a
+			// Body's position resets its interpolation anyway.
+			for (b2Body *b = world->GetBodyList(); b; b = b->GetNext())
+			{
+				bodyudata *udata = (bodyudata *) b->GetUserData();
+				if (udata == nullptr || b->GetType() == b2_staticBody)
+					continue;
+
+				udata->previousPosition = b->GetPosition();
+				udata->previousAngle = b->GetAngle();
+				udata->interpolationUpdate = updateCount;
+			}
+		}
+
+		world->Step(stepdt, velocityIterations, positionIterations);
+
+		destroyMarkedObjects();
+
+		if (destructWorld)
+		{
+			destroy();
+			return;
+		}
+	}
+}
 
+void World::destroyMarkedObjects()
+{
 	// Destroy all objects marked during the time step.
 	for (Body *b : destructBodies)
 	{
@@ -295,19 +345,22 @@ void World::update(float dt, int velocityIterations, int positionIterations)
 	destructBodies.clear();
 	destructFixtures.clear();
 	destructJoints.clear();
-
-	if (destructWorld)
-		destroy();
 }
 
 void World::BeginContact(b2Contact *contact)
 {
-	begin.process(contact);
+	if (contactEventsBuffered)
+		bufferContactEvent(CONTACT_EVENT_BEGIN, contact);
+	else
+		begin.process(contact);
 }
 
 void World::EndContact(b2Contact *contact)
 {
-	end.process(contact);
+	if (contactEventsBuffered)
+		bufferContactEvent(CONTACT_EVENT_END, contact);
+	else
+		end.process(contact);
 
 	// Letting the Contact know that the b2Contact will be destroyed any second.
 	Contact *c = (Contact *)findObject(contact);
@@ -323,7 +376,47 @@ void World::PreSolve(b2Contact *contact, const b2Manifold *oldManifold)
 
 void World::PostSolve(b2Contact *contact, const b2ContactImpulse *impulse)
 {
-	postsolve.process(contact, impulse);
+	if (contactEventsBuffered)
+		bufferContactEvent(CONTACT_EVENT_POSTSOLVE, contact, impulse);
+	else
+		postsolve.process(contact, impulse);
+}
+
+void World::bufferContactEvent(ContactEventType type, b2Contact *contact, const b2ContactImpulse *impulse)
+{
+	Fixture *a = (Fixture *)findObject(contact->GetFixtureA());
+	Fixture *b = (Fixture *)findObject(contact->GetFixtureB());
+	if (a == nullptr || b == nullptr)
+		throw love::Exception("A fixture has escaped Memoizer!");
+
+	ContactEvent event = {};
+	event.type = type;
+	event.fixtureA = a;
+	event.fixtureB = b;
+
+	if (contact->GetManifold()->pointCount > 0)
+	{
+		b2WorldManifold manifold;
+		contact->GetWorldManifold(&manifold);
+		event.normal[0] = manifold.normal.x;
+		event.normal[1] = manifold.normal.y;
+	}
+
+	if (impulse)
+	{
+		event.pointCount = impulse->count;
+		for (int i = 0; i < impulse->count; i++)
+		{
+			event.normalImpulses[i] = Physics::scaleUp(impulse->normalImpulses[i]);
+			event.tangentImpulses[i] = Physics::scaleUp(impulse->tangentImpulses[i]);
+		}
+	}
+	else
+		event.pointCount = contact->GetManifold()->pointCount;
+
+	a->retain();
+	b->retain();
+	contactEvents.push_back(event);
 }
 
 bool World::ShouldCollide(b2Fixture *fixtureA, b2Fixture *fixtureB)
@@ -441,7 +534,16 @@ int World::getGravity(lua_State *L)
 
 void World::translateOrigin(float x, float y)
 {
-	world->ShiftOrigin(Physics::scaleDown(b2Vec2(x, y)));
+	b2Vec2 origin = Physics::scaleDown(b2Vec2(x, y));
+	world->ShiftOrigin(origin);
+
+	// Keep interpolated positions in the same coordinate space.
+	for (b2Body *b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		bodyudata *udata = (bodyudata *) b->GetUserData();
+		if (udata != nullptr)
+			udata->previousPosition -= origin;
+	}
 }
 
 void World::setSleepingAllowed(bool allow)
@@ -454,6 +556,30 @@ bool World::isSleepingAllowed() const
 	return world->GetAllowSleeping();
 }
 
+void World::setThreadCount(int threads)
+{
+	if (threads < 1)
+		throw love::Exception("A World must use at least one thread.");
+
+	if (world->IsLocked())
+		throw love::Exception("The thread count can't be changed during a World update.");
+
+	world->SetTaskRunner(threads > 1 ? &taskRunner : nullptr, threads);
+}
+
+int World::getThreadCount() const
+{
+	return world->GetTaskCount();
+}
+
+void World::TaskRunner::ParallelFor(int32 count, b2Task *task)
+{
+	love::thread::WorkerPool::getShared()->parallelFor(count, [task](int i)
+	{
+		task->Execute(i);
+	});
+}
+
 bool World::isLocked() const
 {
 	return world->IsLocked();
@@ -476,24 +602,127 @@ int World::getContactCount() const
 
 int World::getBodies(lua_State *L) const
 {
-	lua_newtable(L);
-	b2Body *b = world->GetBodyList();
-	int i = 1;
-	do
+	std::vector<Body *> bodies;
+	getBodies(bodies);
+
+	lua_createtable(L, (int) bodies.size(), 0);
+	for (int i = 0; i < (int) bodies.size(); i++)
+	{
+		luax_pushtype(L, bodies[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+void World::setContactEventsBuffered(bool buffered)
+{
+	contactEventsBuffered = buffered;
+}
+
+bool World::isContactEventsBuffered() const
+{
+	return contactEventsBuffered;
+}
+
+const std::vector<World::ContactEvent> &World::getContactEvents() const
+{
+	return contactEvents;
+}
+
+void World::clearContactEvents()
+{
+	for (const ContactEvent &event : contactEvents)
+	{
+		event.fixtureA->release();
+		event.fixtureB->release();
+	}
+	contactEvents.clear();
+}
+
+void World::getBodies(std::vector<Body *> &bodies) const
+{
+	bodies.reserve(bodies.size() + getBodyCount());
+
+	for (b2Body *b = world->GetBodyList(); b != nullptr; b = b->GetNext())
 	{
-		if (!b)
-			break;
 		if (b == groundBody)
 			continue;
 		Body *body = (Body *)findObject(b);
 		if (!body)
 			throw love::Exception("A body has escaped Memoizer!");
-		luax_pushtype(L, body);
-		lua_rawseti(L, -2, i);
-		i++;
+		bodies.push_back(body);
+	}
+}
+
+void World::getBodyStates(Body * const *bodies, size_t count, float *dst) const
+{
+	for (size_t i = 0; i < count; i++, dst += BODY_STATE_COMPONENTS)
+	{
+		const b2Body *b = bodies[i]->body;
+
+		b2Vec2 position = Physics::scaleUp(b->GetPosition());
+		b2Vec2 velocity = Physics::scaleUp(b->GetLinearVelocity());
+
+		dst[0] = position.x;
+		dst[1] = position.y;
+		dst[2] = b->GetAngle();
+		dst[3] = velocity.x;
+		dst[4] = velocity.y;
+		dst[5] = b->GetAngularVelocity();
 	}
-	while ((b = b->GetNext()));
-	return 1;
+}
+
+void World::setBodyStates(Body * const *bodies, size_t count, const float *src)
+{
+	// Checked up front, so a failure doesn't leave only some Bodies changed.
+	if (world->IsLocked())
+		throw love::Exception("Body states can't be set during a World update.");
+
+	for (size_t i = 0; i < count; i++, src += BODY_STATE_COMPONENTS)
+	{
+		b2Body *b = bodies[i]->body;
+
+		b->SetTransform(Physics::scaleDown(b2Vec2(src[0], src[1])), src[2]);
+		b->SetLinearVelocity(Physics::scaleDown(b2Vec2(src[3], src[4])));
+		b->SetAngularVelocity(src[5]);
+
+		bodies[i]->resetInterpolation();
+	}
+}
+
+void World::getBodyStates(Body * const *bodies, size_t count, float alpha, float *dst) const
+{
+	for (size_t i = 0; i < count; i++, dst += BODY_STATE_COMPONENTS)
+	{
+		const b2Body *b = bodies[i]->body;
+
+		b2Vec2 position;
+		float angle;
+		getInterpolatedTransform(b, alpha, position, angle);
+
+		position = Physics::scaleUp(position);
+		b2Vec2 velocity = Physics::scaleUp(b->GetLinearVelocity());
+
+		dst[0] = position.x;
+		dst[1] = position.y;
+		dst[2] = angle;
+		dst[3] = velocity.x;
+		dst[4] = velocity.y;
+		dst[5] = b->GetAngularVelocity();
+	}
+}
+
+void World::getInterpolatedTransform(const b2Body *body, float alpha, b2Vec2 &position, float &angle) const
+{
+	position = body->GetPosition();
+	angle = body->GetAngle();
+
+	const bodyudata *udata = (const bodyudata *) body->GetUserData();
+	if (udata == nullptr || udata->interpolationUpdate == 0 || udata->interpolationUpdate != updateCount)
+		return;
+
+	position = udata->previousPosition + alpha * (position - udata->previousPosition);
+	angle = udata->previousAngle + alpha * (angle - udata->previousAngle);
 }
 
 int World::getJoints(lua_State *L) const
@@ -591,6 +820,9 @@ void World::destroy()
 	//disable callbacks
 	begin.ref = end.ref = presolve.ref = postsolve.ref = filter.ref = nullptr;
 
+	contactEventsBuffered = false;
+	clearContactEvents();
+
 	// Cleaning up the world.
 	b2Body *b = world->GetBodyList();
 	while (b)
@@ -631,6 +863,30 @@ love::Object *World::findObject(void *b2object) const
 		return nullptr;
 }
 
+bool World::getConstant(const char *in, ContactEventType &out)
+{
+	return contactEventTypes.find(in, out);
+}
+
+bool World::getConstant(ContactEventType in, const char *&out)
+{
+	return contactEventTypes.find(in, out);
+}
+
+std::vector<std::string> World::getConstants(ContactEventType)
+{
+	return contactEventTypes.getNames();
+}
+
+StringMap<World::ContactEventType, World::CONTACT_EVENT_MAX_ENUM>::Entry World::contactEventTypeEntries[] =
+{
+	{"begin", World::CONTACT_EVENT_BEGIN},
+	{"end", World::CONTACT_EVENT_END},
+	{"postsolve", World::CONTACT_EVENT_POSTSOLVE},
+};
+
+StringMap<World::ContactEventType, World::CONTACT_EVENT_MAX_ENUM> World::contactEventTypes(World::contactEventTypeEntries, sizeof(World::contactEventTypeEntries));
+
 } // box2d
 } // physics
 } // love
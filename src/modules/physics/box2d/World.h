@@ -25,6 +25,7 @@
 #include "common/Object.h"
 #include "common/runtime.h"
 #include "common/Reference.h"
+#include "common/StringMap.h"
 
 // STD
 #include <vector>
@@ -69,6 +70,38 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 
 	static love::Type type;
 
+	// The number of floats in each Body's state for getBodyStates and
+	// setBodyStates: x, y, angle, linear velocity x and y, angular velocity.
+	static const int BODY_STATE_COMPONENTS = 6;
+
+	enum ContactEventType
+	{
+		CONTACT_EVENT_BEGIN,
+		CONTACT_EVENT_END,
+		CONTACT_EVENT_POSTSOLVE,
+		CONTACT_EVENT_MAX_ENUM
+	};
+
+	/**
+	 * A begin, end or postsolve contact event, recorded instead of calling
+	 * into Lua when contact events are buffered. The Fixtures are retained
+	 * until the event is cleared.
+	 **/
+	struct ContactEvent
+	{
+		ContactEventType type;
+		Fixture *fixtureA;
+		Fixture *fixtureB;
+
+		// World manifold normal, from fixture A to fixture B.
+		float normal[2];
+
+		// Manifold points for begin and end, impulses for postsolve.
+		int pointCount;
+		float normalImpulses[2];
+		float tangentImpulses[2];
+	};
+
 	class ContactCallback
 	{
 	public:
@@ -125,8 +158,9 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 	 * @param gravity The gravity of the World.
 	 * @param sleep True if the bodies should be able to sleep,
 	 * false otherwise.
+	 * @param threads The number of threads used to step the World.
 	 **/
-	World(b2Vec2 gravity, bool sleep);
+	World(b2Vec2 gravity, bool sleep, int threads);
 
 	virtual ~World();
 
@@ -139,6 +173,15 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 	void update(float dt);
 	void update(float dt, int velocityIterations, int positionIterations);
 
+	/**
+	 * Updates the world in a number of equal timesteps.
+	 * @param dt The total time to advance the world by.
+	 * @param substeps The number of timesteps dt is split into.
+	 * @param interpolate Whether to keep the position and angle of each Body
+	 * from before the last timestep, for getInterpolatedTransform.
+	 **/
+	void update(float dt, int velocityIterations, int positionIterations, int substeps, bool interpolate);
+
 	// From b2ContactListener
 	void BeginContact(b2Contact *contact);
 	void EndContact(b2Contact *contact);
@@ -220,6 +263,19 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 	 **/
 	bool isSleepingAllowed() const;
 
+	/**
+	 * Sets the number of threads used to solve islands and update contacts
+	 * during a timestep. With more than one thread, the results of an update
+	 * are the same for any thread count.
+	 * @param threads The number of threads, 1 to only use the calling thread.
+	 **/
+	void setThreadCount(int threads);
+
+	/**
+	 * Gets the number of threads used to step the World.
+	 **/
+	int getThreadCount() const;
+
 	/**
 	 * Returns whether this World is currently locked.
 	 * If it's locked, it's in the middle of a timestep.
@@ -251,6 +307,65 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 	 **/
 	int getBodies(lua_State *L) const;
 
+	/**
+	 * Get all the Bodies in the World, in the same order as the Lua version.
+	 * @param bodies The vector to append the Bodies to.
+	 **/
+	void getBodies(std::vector<Body *> &bodies) const;
+
+	/**
+	 * Writes the state of each Body to consecutive floats in dst, with
+	 * BODY_STATE_COMPONENTS floats per Body. Positions and velocities are in
+	 * pixels, like the Body getters.
+	 * @param bodies The Bodies to read. They must belong to this World.
+	 * @param count The number of Bodies.
+	 * @param dst The destination, with room for the states of all Bodies.
+	 **/
+	void getBodyStates(Body * const *bodies, size_t count, float *dst) const;
+
+	/**
+	 * Sets the state of each Body from consecutive floats in src, in the
+	 * format written by getBodyStates. Can't be used during a timestep.
+	 * @param bodies The Bodies to modify. They must belong to this World.
+	 * @param count The number of Bodies.
+	 * @param src The states of all Bodies.
+	 **/
+	void setBodyStates(Body * const *bodies, size_t count, const float *src);
+
+	/**
+	 * Like getBodyStates, but with positions and angles interpolated as in
+	 * getInterpolatedTransform.
+	 **/
+	void getBodyStates(Body * const *bodies, size_t count, float alpha, float *dst) const;
+
+	/**
+	 * Gets the position and angle of a Body (in meters and radians), blended
+	 * between their values before and after the last timestep of the most
+	 * recent interpolated update. The current values are returned if that
+	 * update wasn't interpolated, or if the Body has been moved since.
+	 * @param alpha The blend factor, from 0 (before) to 1 (after).
+	 **/
+	void getInterpolatedTransform(const b2Body *body, float alpha, b2Vec2 &position, float &angle) const;
+
+	/**
+	 * Sets whether begin, end and postsolve contact events are recorded for
+	 * getContactEvents instead of being sent to the callbacks immediately.
+	 * The presolve callback is always called immediately.
+	 **/
+	void setContactEventsBuffered(bool buffered);
+	bool isContactEventsBuffered() const;
+
+	/**
+	 * Gets the buffered contact events, in the order they happened. Events
+	 * accumulate until clearContactEvents is called.
+	 **/
+	const std::vector<ContactEvent> &getContactEvents() const;
+	void clearContactEvents();
+
+	static bool getConstant(const char *in, ContactEventType &out);
+	static bool getConstant(ContactEventType in, const char *&out);
+	static std::vector<std::string> getConstants(ContactEventType);
+
 	/**
 	 * Get an array of all the Joints in the World.
 	 * @return An array of Joints.
@@ -290,6 +405,18 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 
 private:
 
+	// Runs the parallel parts of a Box2D timestep on the shared WorkerPool.
+	class TaskRunner : public b2TaskRunner
+	{
+	public:
+		void ParallelFor(int32 count, b2Task *task) override;
+	};
+
+	void bufferContactEvent(ContactEventType type, b2Contact *contact, const b2ContactImpulse *impulse = nullptr);
+
+	// Destroys the objects whose destruction was requested during a timestep.
+	void destroyMarkedObjects();
+
 	// Pointer to the Box2D world.
 	b2World *world;
 
@@ -308,6 +435,17 @@ class World : public Object, public b2ContactListener, public b2ContactFilter, p
 
 	std::unordered_map<void *, love::Object *> box2dObjectMap;
 
+	bool contactEventsBuffered;
+	std::vector<ContactEvent> contactEvents;
+
+	TaskRunner taskRunner;
+
+	// Incremented by every update, see bodyudata::interpolationUpdate.
+	uint64 updateCount;
+
+	static StringMap<ContactEventType, CONTACT_EVENT_MAX_ENUM>::Entry contactEventTypeEntries[];
+	static StringMap<ContactEventType, CONTACT_EVENT_MAX_ENUM> contactEventTypes;
+
 }; // World
 
 } // box2d
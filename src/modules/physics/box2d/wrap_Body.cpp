@@ -69,6 +69,27 @@ int w_Body_getPosition(lua_State *L)
 	return 2;
 }
 
+int w_Body_getInterpolatedPosition(lua_State *L)
+{
+	Body *t = luax_checkbody(L, 1);
+	float alpha = (float)luaL_checknumber(L, 2);
+
+	float x_o, y_o;
+	t->getInterpolatedPosition(alpha, x_o, y_o);
+	lua_pushnumber(L, x_o);
+	lua_pushnumber(L, y_o);
+
+	return 2;
+}
+
+int w_Body_getInterpolatedAngle(lua_State *L)
+{
+	Body *t = luax_checkbody(L, 1);
+	float alpha = (float)luaL_checknumber(L, 2);
+	lua_pushnumber(L, t->getInterpolatedAngle(alpha));
+	return 1;
+}
+
 int w_Body_getTransform(lua_State *L)
 {
 	Body *t = luax_checkbody(L, 1);
@@ -650,6 +671,8 @@ static const luaL_Reg w_Body_functions[] =
 	{ "getY", w_Body_getY },
 	{ "getAngle", w_Body_getAngle },
 	{ "getPosition", w_Body_getPosition },
+	{ "getInterpolatedPosition", w_Body_getInterpolatedPosition },
+	{ "getInterpolatedAngle", w_Body_getInterpolatedAngle },
 	{ "getTransform", w_Body_getTransform },
 	{ "setTransform", w_Body_setTransform },
 	{ "getLinearVelocity", w_Body_getLinearVelocity },
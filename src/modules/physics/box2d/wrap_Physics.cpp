@@ -56,9 +56,19 @@ int w_newWorld(lua_State *L)
 	float gx = (float)luaL_optnumber(L, 1, 0);
 	float gy = (float)luaL_optnumber(L, 2, 0);
 	bool sleep = luax_optboolean(L, 3, true);
+	int threads = 1;
+
+	if (!lua_isnoneornil(L, 4))
+	{
+		luaL_checktype(L, 4, LUA_TTABLE);
+
+		lua_getfield(L, 4, "threads");
+		threads = (int) luaL_optinteger(L, -1, 1);
+		lua_pop(L, 1);
+	}
 
 	World *w;
-	luax_catchexcept(L, [&](){ w = instance()->newWorld(gx, gy, sleep); });
+	luax_catchexcept(L, [&](){ w = instance()->newWorld(gx, gy, sleep, threads); });
 	luax_pushtype(L, w);
 	w->release();
 
@@ -19,6 +19,8 @@
  **/
 
 #include "wrap_World.h"
+#include "wrap_Body.h"
+#include "common/Data.h"
 
 namespace love
 {
@@ -43,15 +45,36 @@ int w_World_update(lua_State *L)
 	// Make sure the world callbacks are using the calling Lua thread.
 	t->setCallbacksL(L);
 
-	if (lua_isnoneornil(L, 3))
-		luax_catchexcept(L, [&](){ t->update(dt); });
-	else
+	// Box2D 2.3's recommended defaults.
+	int velocityiterations = 8;
+	int positioniterations = 3;
+	int settingsidx = 3;
+
+	if (!lua_isnoneornil(L, 3) && !lua_istable(L, 3))
 	{
-		int velocityiterations = (int) luaL_checkinteger(L, 3);
-		int positioniterations = (int) luaL_checkinteger(L, 4);
-		luax_catchexcept(L, [&](){ t->update(dt, velocityiterations, positioniterations); });
+		velocityiterations = (int) luaL_checkinteger(L, 3);
+		positioniterations = (int) luaL_checkinteger(L, 4);
+		settingsidx = 5;
 	}
 
+	int substeps = 1;
+	bool interpolate = false;
+
+	if (!lua_isnoneornil(L, settingsidx))
+	{
+		luaL_checktype(L, settingsidx, LUA_TTABLE);
+
+		lua_getfield(L, settingsidx, "substeps");
+		substeps = (int) luaL_optinteger(L, -1, 1);
+		lua_pop(L, 1);
+
+		lua_getfield(L, settingsidx, "interpolate");
+		interpolate = luax_optboolean(L, -1, false);
+		lua_pop(L, 1);
+	}
+
+	luax_catchexcept(L, [&](){ t->update(dt, velocityiterations, positioniterations, substeps, interpolate); });
+
 	return 0;
 }
 
@@ -123,6 +146,21 @@ int w_World_isSleepingAllowed(lua_State *L)
 	return 1;
 }
 
+int w_World_setThreadCount(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+	int threads = (int) luaL_checkinteger(L, 2);
+	luax_catchexcept(L, [&](){ t->setThreadCount(threads); });
+	return 0;
+}
+
+int w_World_getThreadCount(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+	lua_pushinteger(L, t->getThreadCount());
+	return 1;
+}
+
 int w_World_isLocked(lua_State *L)
 {
 	World *t = luax_checkworld(L, 1);
@@ -160,6 +198,195 @@ int w_World_getBodies(lua_State *L)
 	return ret;
 }
 
+// Gets the Bodies for getBodyStates and setBodyStates from an optional array.
+static void luax_checkbodylist(lua_State *L, int idx, World *world, std::vector<Body *> &bodies)
+{
+	if (lua_isnoneornil(L, idx))
+	{
+		luax_catchexcept(L, [&](){ world->getBodies(bodies); });
+		return;
+	}
+
+	luaL_checktype(L, idx, LUA_TTABLE);
+	int count = (int) luax_objlen(L, idx);
+	bodies.reserve(count);
+
+	for (int i = 1; i <= count; i++)
+	{
+		lua_rawgeti(L, idx, i);
+		Body *body = luax_checkbody(L, -1);
+		if (body->getWorld() != world)
+			luaL_error(L, "Body at index %d does not belong to this World.", i);
+		bodies.push_back(body);
+		lua_pop(L, 1);
+	}
+}
+
+// Gets the float array for getBodyStates and setBodyStates within a Data.
+static float *luax_checkbodystates(lua_State *L, int idx, size_t count)
+{
+	Data *data = luax_checktype<Data>(L, idx);
+	lua_Integer offset = luaL_optinteger(L, idx + 1, 0);
+
+	if (offset < 0 || offset % sizeof(float) != 0)
+		luaL_error(L, "Offset must be a non-negative multiple of %d.", (int) sizeof(float));
+
+	size_t size = count * World::BODY_STATE_COMPONENTS * sizeof(float);
+	if ((size_t) offset > data->getSize() || size > data->getSize() - (size_t) offset)
+		luaL_error(L, "Data is too small to hold the states of %d bodies at offset %d.", (int) count, (int) offset);
+
+	return (float *) ((char *) data->getData() + offset);
+}
+
+int w_World_getBodyStates(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+
+	std::vector<Body *> bodies;
+	luax_checkbodylist(L, 2, t, bodies);
+
+	float *dst = luax_checkbodystates(L, 3, bodies.size());
+
+	if (lua_isnoneornil(L, 5))
+		t->getBodyStates(bodies.data(), bodies.size(), dst);
+	else
+		t->getBodyStates(bodies.data(), bodies.size(), (float) luaL_checknumber(L, 5), dst);
+
+	lua_pushinteger(L, (lua_Integer) bodies.size());
+	return 1;
+}
+
+int w_World_setBodyStates(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+
+	std::vector<Body *> bodies;
+	luax_checkbodylist(L, 2, t, bodies);
+
+	const float *src = luax_checkbodystates(L, 3, bodies.size());
+	luax_catchexcept(L, [&](){ t->setBodyStates(bodies.data(), bodies.size(), src); });
+
+	lua_pushinteger(L, (lua_Integer) bodies.size());
+	return 1;
+}
+
+int w_World_setContactEventsBuffered(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+	t->setContactEventsBuffered(luax_checkboolean(L, 2));
+	return 0;
+}
+
+int w_World_isContactEventsBuffered(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+	luax_pushboolean(L, t->isContactEventsBuffered());
+	return 1;
+}
+
+int w_World_getContactEventCount(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+	lua_pushinteger(L, (lua_Integer) t->getContactEvents().size());
+	return 1;
+}
+
+// The layout of each event written to a Data by World:getContactEvents.
+struct ContactEventData
+{
+	int32 type;
+	int32 pointCount;
+	float normal[2];
+	float normalImpulses[2];
+	float tangentImpulses[2];
+};
+
+int w_World_getContactEvents(lua_State *L)
+{
+	World *t = luax_checkworld(L, 1);
+	const std::vector<World::ContactEvent> &events = t->getContactEvents();
+	int count = (int) events.size();
+
+	if (lua_isnoneornil(L, 2))
+	{
+		// Each event is {type, fixtureA, fixtureB, normalx, normaly, ...},
+		// followed by the impulses for postsolve events, in the same order
+		// as the callback arguments.
+		lua_createtable(L, count, 0);
+
+		for (int i = 0; i < count; i++)
+		{
+			const World::ContactEvent &e = events[i];
+			int impulses = e.type == World::CONTACT_EVENT_POSTSOLVE ? e.pointCount : 0;
+
+			const char *typestr = nullptr;
+			World::getConstant(e.type, typestr);
+
+			lua_createtable(L, 5 + impulses * 2, 0);
+			lua_pushstring(L, typestr);
+			lua_rawseti(L, -2, 1);
+			luax_pushtype(L, e.fixtureA);
+			lua_rawseti(L, -2, 2);
+			luax_pushtype(L, e.fixtureB);
+			lua_rawseti(L, -2, 3);
+			lua_pushnumber(L, e.normal[0]);
+			lua_rawseti(L, -2, 4);
+			lua_pushnumber(L, e.normal[1]);
+			lua_rawseti(L, -2, 5);
+
+			for (int j = 0; j < impulses; j++)
+			{
+				lua_pushnumber(L, e.normalImpulses[j]);
+				lua_rawseti(L, -2, 6 + j * 2);
+				lua_pushnumber(L, e.tangentImpulses[j]);
+				lua_rawseti(L, -2, 7 + j * 2);
+			}
+
+			lua_rawseti(L, -2, i + 1);
+		}
+
+		t->clearContactEvents();
+		return 1;
+	}
+
+	Data *data = luax_checktype<Data>(L, 2);
+	lua_Integer offset = luaL_optinteger(L, 3, 0);
+
+	if (offset < 0 || offset % sizeof(float) != 0)
+		return luaL_error(L, "Offset must be a non-negative multiple of %d.", (int) sizeof(float));
+
+	size_t size = events.size() * sizeof(ContactEventData);
+	if ((size_t) offset > data->getSize() || size > data->getSize() - (size_t) offset)
+		return luaL_error(L, "Data is too small to hold %d contact events at offset %d.", count, (int) offset);
+
+	ContactEventData *dst = (ContactEventData *) ((char *) data->getData() + offset);
+
+	lua_pushinteger(L, count);
+	lua_createtable(L, count * 2, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		const World::ContactEvent &e = events[i];
+
+		dst[i].type = (int32) e.type;
+		dst[i].pointCount = (int32) e.pointCount;
+		for (int j = 0; j < 2; j++)
+		{
+			dst[i].normal[j] = e.normal[j];
+			dst[i].normalImpulses[j] = e.normalImpulses[j];
+			dst[i].tangentImpulses[j] = e.tangentImpulses[j];
+		}
+
+		luax_pushtype(L, e.fixtureA);
+		lua_rawseti(L, -2, i * 2 + 1);
+		luax_pushtype(L, e.fixtureB);
+		lua_rawseti(L, -2, i * 2 + 2);
+	}
+
+	t->clearContactEvents();
+	return 2;
+}
+
 int w_World_getJoints(lua_State *L)
 {
 	World *t = luax_checkworld(L, 1);
@@ -238,11 +465,19 @@ static const luaL_Reg w_World_functions[] =
 	{ "translateOrigin", w_World_translateOrigin },
 	{ "setSleepingAllowed", w_World_setSleepingAllowed },
 	{ "isSleepingAllowed", w_World_isSleepingAllowed },
+	{ "setThreadCount", w_World_setThreadCount },
+	{ "getThreadCount", w_World_getThreadCount },
 	{ "isLocked", w_World_isLocked },
 	{ "getBodyCount", w_World_getBodyCount },
 	{ "getJointCount", w_World_getJointCount },
 	{ "getContactCount", w_World_getContactCount },
 	{ "getBodies", w_World_getBodies },
+	{ "getBodyStates", w_World_getBodyStates },
+	{ "setBodyStates", w_World_setBodyStates },
+	{ "setContactEventsBuffered", w_World_setContactEventsBuffered },
+	{ "isContactEventsBuffered", w_World_isContactEventsBuffered },
+	{ "getContactEventCount", w_World_getContactEventCount },
+	{ "getContactEvents", w_World_getContactEvents },
 	{ "getJoints", w_World_getJoints },
 	{ "getContacts", w_World_getContacts },
 	{ "queryBoundingBox", w_World_queryBoundingBox },
@@ -31,9 +31,9 @@ Sound::~Sound()
 {
 }
 
-SoundData *Sound::newSoundData(Decoder *decoder)
+SoundData *Sound::newSoundData(Decoder *decoder, bool async)
 {
-	return new SoundData(decoder);
+	return new SoundData(decoder, async);
 }
 
 SoundData *Sound::newSoundData(int samples, int sampleRate, int bitDepth, int channels)
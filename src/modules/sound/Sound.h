@@ -52,11 +52,12 @@ class Sound : public Module
 	/**
 	 * Creates new SoundData from a decoder. Fully expands the
 	 * encoded sound data into raw sound data. Not recommended
-	 * on large (long-duration) files.
+	 * on large (long-duration) files, unless async is true.
 	 * @param decoder The file to decode the data from.
+	 * @param async Whether to decode on a background thread.
 	 * @return A SoundData object, or zero if the file type couldn't be handled.
 	 **/
-	SoundData *newSoundData(Decoder *decoder);
+	SoundData *newSoundData(Decoder *decoder, bool async = false);
 
 	/**
 	 * Creates a new SoundData with the specified number of samples and format.
@@ -19,78 +19,434 @@
  **/
 
 #include "SoundData.h"
+#include "common/config.h"
+#include "thread/threads.h"
 
 // C
 #include <cstdlib>
 #include <cstring>
 
 // C++
+#include <algorithm>
+#include <cmath>
+#include <deque>
 #include <limits>
 #include <iostream>
 #include <vector>
 
+#if defined(LOVE_SIMD_SSE)
+#include <xmmintrin.h>
+#endif
+
+// The integer conversions need SSE2.
+#if defined(LOVE_SIMD_SSE) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LOVE_SOUNDDATA_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace love
 {
 namespace sound
 {
 
+namespace
+{
+
+// Number of sample frames converted at a time by the bulk operations.
+const int BLOCK_FRAMES = 1024;
+
+const float INT16_TO_FLOAT = 1.0f / 32767.0f;
+const float UINT8_TO_FLOAT = 1.0f / 127.0f;
+
+inline float clampSample(float x, float lower, float upper)
+{
+	// Written so NaN becomes the lower bound, like _mm_max_ps does.
+	x = x > lower ? x : lower;
+	return x < upper ? x : upper;
+}
+
+// Samples are scaled, clamped to what the integer type can hold, and rounded
+// to the nearest integer, so converting to float and back doesn't change them.
+inline int16 toInt16Sample(float x)
+{
+	return (int16) std::lrint(clampSample(x * 32767.0f, -32768.0f, 32767.0f));
+}
+
+inline uint8 toUint8Sample(float x)
+{
+	return (uint8) std::lrint(clampSample(x * 127.0f + 128.0f, 0.0f, 255.0f));
+}
+
+#if defined(LOVE_SIMD_NEON)
+
+// Rounds to the nearest integer, with ties to even like lrint.
+inline int32x4_t roundToInt(float32x4_t v)
+{
+#if defined(__aarch64__)
+	return vcvtnq_s32_f32(v);
+#else
+	// 32 bit ARM has no rounding conversion. Adding and subtracting 1.5 * 2^23
+	// rounds away the fractional bits, for values below 2^22.
+	const float32x4_t magic = vdupq_n_f32(12582912.0f);
+	return vcvtq_s32_f32(vsubq_f32(vaddq_f32(v, magic), magic));
+#endif
+}
+
+#endif
+
+void int16ToFloat(const int16 *src, float *dst, size_t n)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SOUNDDATA_SSE2)
+	const __m128 scale = _mm_set1_ps(INT16_TO_FLOAT);
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+		// Sign-extend to 32 bits by shifting each value down from the top half.
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	for (; i + 8 <= n; i += 8)
+	{
+		int16x8_t v = vld1q_s16(src + i);
+		float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+		float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+		vst1q_f32(dst + i + 0, vmulq_n_f32(lo, INT16_TO_FLOAT));
+		vst1q_f32(dst + i + 4, vmulq_n_f32(hi, INT16_TO_FLOAT));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = (float) src[i] * INT16_TO_FLOAT;
+}
+
+void uint8ToFloat(const uint8 *src, float *dst, size_t n)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SOUNDDATA_SSE2)
+	const __m128 scale = _mm_set1_ps(UINT8_TO_FLOAT);
+	const __m128 offset = _mm_set1_ps(128.0f);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i w[2] = {_mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero)};
+		for (int j = 0; j < 2; j++)
+		{
+			__m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(w[j], zero));
+			__m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(w[j], zero));
+			_mm_storeu_ps(dst + i + j * 8 + 0, _mm_mul_ps(_mm_sub_ps(lo, offset), scale));
+			_mm_storeu_ps(dst + i + j * 8 + 4, _mm_mul_ps(_mm_sub_ps(hi, offset), scale));
+		}
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t offset = vdupq_n_f32(128.0f);
+	for (; i + 16 <= n; i += 16)
+	{
+		uint8x16_t v = vld1q_u8(src + i);
+		uint16x8_t w[2] = {vmovl_u8(vget_low_u8(v)), vmovl_u8(vget_high_u8(v))};
+		for (int j = 0; j < 2; j++)
+		{
+			float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(w[j])));
+			float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(w[j])));
+			vst1q_f32(dst + i + j * 8 + 0, vmulq_n_f32(vsubq_f32(lo, offset), UINT8_TO_FLOAT));
+			vst1q_f32(dst + i + j * 8 + 4, vmulq_n_f32(vsubq_f32(hi, offset), UINT8_TO_FLOAT));
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = ((float) src[i] - 128.0f) * UINT8_TO_FLOAT;
+}
+
+void floatToInt16(const float *src, int16 *dst, size_t n)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SOUNDDATA_SSE2)
+	// _mm_cvtps_epi32 rounds to nearest (ties to even) by default, like lrint.
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 lower = _mm_set1_ps(-32768.0f);
+	const __m128 upper = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 0), scale), lower), upper);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lower), upper);
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t lower = vdupq_n_f32(-32768.0f);
+	const float32x4_t upper = vdupq_n_f32(32767.0f);
+	for (; i + 8 <= n; i += 8)
+	{
+		float32x4_t a = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i + 0), 32767.0f), lower), upper);
+		float32x4_t b = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32767.0f), lower), upper);
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(roundToInt(a)), vqmovn_s32(roundToInt(b))));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = toInt16Sample(src[i]);
+}
+
+void floatToUint8(const float *src, uint8 *dst, size_t n)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SOUNDDATA_SSE2)
+	const __m128 scale = _mm_set1_ps(127.0f);
+	const __m128 offset = _mm_set1_ps(128.0f);
+	const __m128 lower = _mm_set1_ps(0.0f);
+	const __m128 upper = _mm_set1_ps(255.0f);
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v[4];
+		for (int j = 0; j < 4; j++)
+		{
+			__m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i + j * 4), scale), offset);
+			v[j] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(x, lower), upper));
+		}
+		__m128i lo = _mm_packs_epi32(v[0], v[1]);
+		__m128i hi = _mm_packs_epi32(v[2], v[3]);
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t offset = vdupq_n_f32(128.0f);
+	const float32x4_t lower = vdupq_n_f32(0.0f);
+	const float32x4_t upper = vdupq_n_f32(255.0f);
+	for (; i + 16 <= n; i += 16)
+	{
+		uint16x4_t v[4];
+		for (int j = 0; j < 4; j++)
+		{
+			float32x4_t x = vaddq_f32(vmulq_n_f32(vld1q_f32(src + i + j * 4), 127.0f), offset);
+			x = vminq_f32(vmaxq_f32(x, lower), upper);
+			v[j] = vmovn_u32(vreinterpretq_u32_s32(roundToInt(x)));
+		}
+		uint8x8_t lo = vqmovn_u16(vcombine_u16(v[0], v[1]));
+		uint8x8_t hi = vqmovn_u16(vcombine_u16(v[2], v[3]));
+		vst1q_u8(dst + i, vcombine_u8(lo, hi));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = toUint8Sample(src[i]);
+}
+
+void toFloat(const uint8 *src, int bitDepth, float *dst, size_t n)
+{
+	if (bitDepth == 16)
+		int16ToFloat((const int16 *) src, dst, n);
+	else
+		uint8ToFloat(src, dst, n);
+}
+
+void fromFloat(const float *src, int bitDepth, uint8 *dst, size_t n)
+{
+	if (bitDepth == 16)
+		floatToInt16(src, (int16 *) dst, n);
+	else
+		floatToUint8(src, dst, n);
+}
+
+// dst += src * gain
+void scaleAdd(float *dst, const float *src, float gain, size_t n)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SIMD_SSE)
+	const __m128 g = _mm_set1_ps(gain);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 d = _mm_loadu_ps(dst + i);
+		_mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	for (; i + 4 <= n; i += 4)
+		vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+#endif
+
+	for (; i < n; i++)
+		dst[i] += src[i] * gain;
+}
+
+void scale(float *dst, float gain, size_t n)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SIMD_SSE)
+	const __m128 g = _mm_set1_ps(gain);
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), g));
+#elif defined(LOVE_SIMD_NEON)
+	for (; i + 4 <= n; i += 4)
+		vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(dst + i), gain));
+#endif
+
+	for (; i < n; i++)
+		dst[i] *= gain;
+}
+
+} // anonymous namespace
+
 love::Type SoundData::type("SoundData", &Data::type);
 
-SoundData::SoundData(Decoder *decoder)
-	: data(0)
-	, size(0)
-	, sampleRate(Decoder::DEFAULT_SAMPLE_RATE)
-	, bitDepth(0)
-	, channels(0)
+// Decodes SoundData in the background, one at a time.
+class SoundData::DecodeThread : public thread::Threadable
 {
-	if (decoder->getBitDepth() != 8 && decoder->getBitDepth() != 16)
-		throw love::Exception("Invalid bit depth: %d", decoder->getBitDepth());
+public:
 
-	size_t bufferSize = 524288; // 0x80000
-	int decoded = decoder->decode();
+	DecodeThread()
+		: stopping(false)
+	{
+		threadName = "SoundDecoder";
+	}
 
-	while (decoded > 0)
+	virtual ~DecodeThread() {}
+
+	void threadFunction() override
 	{
-		// Expand or allocate buffer. Note that realloc may move
-		// memory to other locations.
-		if (!data || bufferSize < size + decoded)
+		while (true)
 		{
-			while (bufferSize < size + decoded)
-				bufferSize <<= 1;
-			data = (uint8 *) realloc(data, bufferSize);
+			Job job;
+
+			{
+				thread::Lock lock(mutex);
+
+				while (!stopping && jobs.empty())
+					cond->wait(mutex);
+
+				if (stopping)
+					return;
+
+				job = jobs.front();
+				jobs.pop_front();
+			}
+
+			job.soundData->decodeAsync(job.decoder);
 		}
+	}
 
-		if (!data)
-			throw love::Exception("Not enough memory.");
+	void push(SoundData *soundData, Decoder *decoder)
+	{
+		thread::Lock lock(mutex);
 
-		// Copy memory into new part of memory.
-		memcpy(data + size, decoder->getBuffer(), decoded);
+		Job job;
+		job.soundData.set(soundData);
+		job.decoder.set(decoder);
 
-		// Overflow check.
-		if (size > std::numeric_limits<size_t>::max() - decoded)
+		jobs.push_back(job);
+		cond->signal();
+	}
+
+	void stop()
+	{
+		thread::Lock lock(mutex);
+		stopping = true;
+		cond->signal();
+	}
+
+	static DecodeThread *getInstance()
+	{
+		struct Holder
 		{
-			free(data);
-			throw love::Exception("Not enough memory.");
+			DecodeThread *thread = nullptr;
+			bool started = false;
+
+			~Holder()
+			{
+				if (thread != nullptr)
+				{
+					thread->stop();
+					thread->wait();
+					thread->release();
+				}
+			}
+		};
+
+		static Holder holder;
+
+		if (!holder.started)
+		{
+			holder.started = true;
+
+			DecodeThread *thread = new DecodeThread();
+
+			if (thread->start())
+				holder.thread = thread;
+			else
+				thread->release();
 		}
 
-		// Keep this up to date.
-		size += decoded;
+		return holder.thread;
+	}
 
-		decoded = decoder->decode();
+private:
+
+	struct Job
+	{
+		StrongRef<SoundData> soundData;
+		StrongRef<Decoder> decoder;
+	};
+
+	thread::MutexRef mutex;
+	thread::ConditionalRef cond;
+	std::deque<Job> jobs;
+	bool stopping;
+
+}; // DecodeThread
+
+SoundData::SoundData(Decoder *decoder, bool async)
+	: data(0)
+	, size(0)
+	, decodedSize(0)
+	, ready(true)
+	, sampleRate(Decoder::DEFAULT_SAMPLE_RATE)
+	, bitDepth(0)
+	, channels(0)
+{
+	if (decoder->getBitDepth() != 8 && decoder->getBitDepth() != 16)
+		throw love::Exception("Invalid bit depth: %d", decoder->getBitDepth());
+
+	double duration = async ? decoder->getDuration() : -1.0;
+	DecodeThread *thread = duration > 0.0 ? DecodeThread::getInstance() : nullptr;
+
+	if (thread == nullptr)
+	{
+		decode(decoder);
+		return;
 	}
 
-	// Shrink buffer if necessary.
-	if (data && bufferSize > size)
-		data = (uint8 *) realloc(data, size);
+	double samples = std::floor(duration * decoder->getSampleRate() + 0.5);
+	if (samples > std::numeric_limits<int>::max())
+		throw love::Exception("Data is too big!");
 
-	channels = decoder->getChannelCount();
-	bitDepth = decoder->getBitDepth();
-	sampleRate = decoder->getSampleRate();
+	load((int) samples, decoder->getSampleRate(), decoder->getBitDepth(), decoder->getChannelCount());
+
+	// The caller keeps using its Decoder, so decode with our own copy.
+	Decoder *clone = decoder->clone();
+
+	decodedSize = 0;
+	ready = false;
+
+	thread->push(this, clone);
+	clone->release();
 }
 
 SoundData::SoundData(int samples, int sampleRate, int bitDepth, int channels)
 	: data(0)
 	, size(0)
+	, decodedSize(0)
+	, ready(true)
 	, sampleRate(0)
 	, bitDepth(0)
 	, channels(0)
@@ -101,6 +457,8 @@ SoundData::SoundData(int samples, int sampleRate, int bitDepth, int channels)
 SoundData::SoundData(void *d, int samples, int sampleRate, int bitDepth, int channels)
 	: data(0)
 	, size(0)
+	, decodedSize(0)
+	, ready(true)
 	, sampleRate(0)
 	, bitDepth(0)
 	, channels(0)
@@ -111,11 +469,18 @@ SoundData::SoundData(void *d, int samples, int sampleRate, int bitDepth, int cha
 SoundData::SoundData(const SoundData &c)
 	: data(0)
 	, size(0)
+	, decodedSize(0)
+	, ready(true)
 	, sampleRate(0)
 	, bitDepth(0)
 	, channels(0)
 {
+	// Copying now would give a truncated copy which claims to be complete.
+	if (!c.isReady())
+		throw love::Exception("Cannot clone SoundData while it is being decoded.");
+
 	load(c.getSampleCount(), c.getSampleRate(), c.getBitDepth(), c.getChannelCount(), c.getData());
+	decodeError = c.decodeError;
 }
 
 SoundData::~SoundData()
@@ -129,6 +494,82 @@ SoundData *SoundData::clone() const
 	return new SoundData(*this);
 }
 
+void SoundData::decode(Decoder *decoder)
+{
+	size_t bufferSize = 524288; // 0x80000
+	int decoded = decoder->decode();
+
+	while (decoded > 0)
+	{
+		// Expand or allocate buffer. Note that realloc may move
+		// memory to other locations.
+		if (!data || bufferSize < size + decoded)
+		{
+			while (bufferSize < size + decoded)
+				bufferSize <<= 1;
+			data = (uint8 *) realloc(data, bufferSize);
+		}
+
+		if (!data)
+			throw love::Exception("Not enough memory.");
+
+		// Copy memory into new part of memory.
+		memcpy(data + size, decoder->getBuffer(), decoded);
+
+		// Overflow check.
+		if (size > std::numeric_limits<size_t>::max() - decoded)
+		{
+			free(data);
+			throw love::Exception("Not enough memory.");
+		}
+
+		// Keep this up to date.
+		size += decoded;
+
+		decoded = decoder->decode();
+	}
+
+	// Shrink buffer if necessary.
+	if (data && bufferSize > size)
+		data = (uint8 *) realloc(data, size);
+
+	channels = decoder->getChannelCount();
+	bitDepth = decoder->getBitDepth();
+	sampleRate = decoder->getSampleRate();
+	decodedSize = size;
+}
+
+void SoundData::decodeAsync(Decoder *decoder)
+{
+	try
+	{
+		while (decodedSize < size)
+		{
+			// Stop early if nothing else references this SoundData anymore.
+			if (getReferenceCount() <= 1)
+				break;
+
+			int decoded = decoder->decode();
+			if (decoded <= 0)
+				break;
+
+			// The buffer can't grow while it's in use, so anything past the
+			// size the Decoder reported is dropped.
+			size_t offset = decodedSize;
+			size_t count = std::min((size_t) decoded, size - offset);
+
+			memcpy(data + offset, decoder->getBuffer(), count);
+			decodedSize = offset + count;
+		}
+	}
+	catch (love::Exception &e)
+	{
+		decodeError = e.what();
+	}
+
+	ready = true;
+}
+
 void SoundData::load(int samples, int sampleRate, int bitDepth, int channels, void *newData)
 {
 	if (samples <= 0)
@@ -167,6 +608,8 @@ void SoundData::load(int samples, int sampleRate, int bitDepth, int channels, vo
 		memcpy(data, newData, size);
 	else
 		memset(data, bitDepth == 8 ? 128 : 0, size);
+
+	decodedSize = size;
 }
 
 void *SoundData::getData() const
@@ -214,12 +657,12 @@ void SoundData::setSample(int i, float sample)
 	{
 		// 16-bit sample values are signed.
 		int16 *s = (int16 *) data;
-		s[i] = (int16) (sample * (float) LOVE_INT16_MAX);
+		s[i] = toInt16Sample(sample);
 	}
 	else
 	{
 		// 8-bit sample values are unsigned internally.
-		data[i] = (uint8) ((sample * 127.0f) + 128.0f);
+		data[i] = toUint8Sample(sample);
 	}
 }
 
@@ -258,5 +701,232 @@ float SoundData::getSample(int i, int channel) const
 	return getSample(i * channels + (channel - 1));
 }
 
+void SoundData::checkRange(int start, int count, int channel) const
+{
+	if (channel < 0 || channel > channels)
+		throw love::Exception("Invalid channel: %d (expected 1-%d, or 0 for every channel)", channel, channels);
+
+	if (start < 0 || count < 0 || (int64) start + count > getSampleCount())
+		throw love::Exception("Sample range [%d, %d) is out of range for a SoundData with %d samples.", start, start + count, getSampleCount());
+}
+
+void SoundData::checkWritable() const
+{
+	if (!ready)
+		throw love::Exception("Cannot modify SoundData while it is being decoded.");
+}
+
+void SoundData::getSamples(int start, int count, int channel, float *dst) const
+{
+	checkRange(start, count, channel);
+
+	size_t framesize = (size_t) channels * (bitDepth / 8);
+	const uint8 *src = data + (size_t) start * framesize;
+
+	if (channel == 0 || channels == 1)
+	{
+		toFloat(src, bitDepth, dst, (size_t) count * channels);
+		return;
+	}
+
+	// Convert whole frames a block at a time, then pick out the channel.
+	std::vector<float> block((size_t) std::min(count, BLOCK_FRAMES) * channels);
+
+	for (int offset = 0; offset < count; offset += BLOCK_FRAMES)
+	{
+		int frames = std::min(count - offset, BLOCK_FRAMES);
+		toFloat(src + (size_t) offset * framesize, bitDepth, &block[0], (size_t) frames * channels);
+
+		for (int i = 0; i < frames; i++)
+			dst[offset + i] = block[(size_t) i * channels + (channel - 1)];
+	}
+}
+
+void SoundData::setSamples(int start, int count, int channel, const float *src)
+{
+	checkWritable();
+	checkRange(start, count, channel);
+
+	size_t framesize = (size_t) channels * (bitDepth / 8);
+	uint8 *dst = data + (size_t) start * framesize;
+
+	if (channel == 0 || channels == 1)
+	{
+		fromFloat(src, bitDepth, dst, (size_t) count * channels);
+		return;
+	}
+
+	std::vector<float> block((size_t) std::min(count, BLOCK_FRAMES) * channels);
+
+	for (int offset = 0; offset < count; offset += BLOCK_FRAMES)
+	{
+		int frames = std::min(count - offset, BLOCK_FRAMES);
+		uint8 *p = dst + (size_t) offset * framesize;
+
+		toFloat(p, bitDepth, &block[0], (size_t) frames * channels);
+
+		for (int i = 0; i < frames; i++)
+			block[(size_t) i * channels + (channel - 1)] = src[offset + i];
+
+		fromFloat(&block[0], bitDepth, p, (size_t) frames * channels);
+	}
+}
+
+void SoundData::mix(const SoundData *src, float gain, int dstStart, int srcStart, int count)
+{
+	checkWritable();
+
+	if (src->getChannelCount() != channels)
+		throw love::Exception("Cannot mix SoundData with %d channels into SoundData with %d channels.", src->getChannelCount(), channels);
+
+	checkRange(dstStart, count, 0);
+	src->checkRange(srcStart, count, 0);
+
+	// Mixing a SoundData into itself would read frames which were already
+	// changed, if the ranges overlap.
+	std::vector<float> copy;
+	if (src == this)
+	{
+		copy.resize((size_t) count * channels);
+		if (count > 0)
+			getSamples(srcStart, count, 0, &copy[0]);
+	}
+
+	size_t framesize = (size_t) channels * (bitDepth / 8);
+	size_t srcframesize = (size_t) channels * (src->getBitDepth() / 8);
+
+	std::vector<float> dstblock((size_t) std::min(count, BLOCK_FRAMES) * channels);
+	std::vector<float> srcblock(src == this ? 0 : dstblock.size());
+
+	for (int offset = 0; offset < count; offset += BLOCK_FRAMES)
+	{
+		int frames = std::min(count - offset, BLOCK_FRAMES);
+		size_t n = (size_t) frames * channels;
+		uint8 *d = data + (size_t) (dstStart + offset) * framesize;
+
+		const float *s = nullptr;
+		if (src == this)
+			s = &copy[(size_t) offset * channels];
+		else
+		{
+			const uint8 *p = (const uint8 *) src->getData() + (size_t) (srcStart + offset) * srcframesize;
+			toFloat(p, src->getBitDepth(), &srcblock[0], n);
+			s = &srcblock[0];
+		}
+
+		toFloat(d, bitDepth, &dstblock[0], n);
+		scaleAdd(&dstblock[0], s, gain, n);
+		fromFloat(&dstblock[0], bitDepth, d, n);
+	}
+}
+
+void SoundData::applyGain(float gain, int start, int count)
+{
+	checkWritable();
+	checkRange(start, count, 0);
+
+	size_t framesize = (size_t) channels * (bitDepth / 8);
+	std::vector<float> block((size_t) std::min(count, BLOCK_FRAMES) * channels);
+
+	for (int offset = 0; offset < count; offset += BLOCK_FRAMES)
+	{
+		int frames = std::min(count - offset, BLOCK_FRAMES);
+		size_t n = (size_t) frames * channels;
+		uint8 *p = data + (size_t) (start + offset) * framesize;
+
+		toFloat(p, bitDepth, &block[0], n);
+		scale(&block[0], gain, n);
+		fromFloat(&block[0], bitDepth, p, n);
+	}
+}
+
+SoundData *SoundData::resample(int newSampleRate) const
+{
+	if (newSampleRate <= 0)
+		throw love::Exception("Invalid sample rate: %d", newSampleRate);
+
+	int count = getSampleCount();
+
+	double outcount = std::floor((double) count * newSampleRate / sampleRate + 0.5);
+	if (outcount > std::numeric_limits<int>::max())
+		throw love::Exception("Data is too big!");
+
+	int outsamples = std::max((int) outcount, 1);
+
+	std::vector<float> in((size_t) count * channels);
+	std::vector<float> out((size_t) outsamples * channels);
+
+	getSamples(0, count, 0, &in[0]);
+
+	double step = (double) sampleRate / newSampleRate;
+
+	for (int i = 0; i < outsamples; i++)
+	{
+		double pos = i * step;
+		int j = std::min((int) pos, count - 1);
+		int k = std::min(j + 1, count - 1);
+		float t = (float) (pos - j);
+
+		const float *a = &in[(size_t) j * channels];
+		const float *b = &in[(size_t) k * channels];
+		float *o = &out[(size_t) i * channels];
+
+		for (int c = 0; c < channels; c++)
+			o[c] = a[c] + (b[c] - a[c]) * t;
+	}
+
+	SoundData *resampled = new SoundData(outsamples, newSampleRate, bitDepth, channels);
+	fromFloat(&out[0], bitDepth, resampled->data, out.size());
+
+	return resampled;
+}
+
+SoundData *SoundData::convert(int newBitDepth) const
+{
+	if (newBitDepth != 8 && newBitDepth != 16)
+		throw love::Exception("Invalid bit depth: %d", newBitDepth);
+
+	int count = getSampleCount();
+	SoundData *converted = new SoundData(count, sampleRate, newBitDepth, channels);
+
+	size_t framesize = (size_t) channels * (bitDepth / 8);
+	size_t newframesize = (size_t) channels * (newBitDepth / 8);
+	std::vector<float> block((size_t) std::min(count, BLOCK_FRAMES) * channels);
+
+	for (int offset = 0; offset < count; offset += BLOCK_FRAMES)
+	{
+		int frames = std::min(count - offset, BLOCK_FRAMES);
+		size_t n = (size_t) frames * channels;
+
+		toFloat(data + (size_t) offset * framesize, bitDepth, &block[0], n);
+		fromFloat(&block[0], newBitDepth, converted->data + (size_t) offset * newframesize, n);
+	}
+
+	return converted;
+}
+
+bool SoundData::isReady() const
+{
+	return ready;
+}
+
+size_t SoundData::getDecodedSize() const
+{
+	return decodedSize;
+}
+
+float SoundData::getDecodeProgress() const
+{
+	if (ready || size == 0)
+		return 1.0f;
+
+	return (float) ((double) decodedSize / (double) size);
+}
+
+const std::string &SoundData::getDecodeError() const
+{
+	return decodeError;
+}
+
 } // sound
 } // love
@@ -26,6 +26,10 @@
 #include "common/int.h"
 #include "Decoder.h"
 
+// C++
+#include <atomic>
+#include <string>
+
 namespace love
 {
 namespace sound
@@ -37,7 +41,13 @@ class SoundData : public love::Data
 
 	static love::Type type;
 
-	SoundData(Decoder *decoder);
+	/**
+	 * Decodes all audio from the Decoder. If async is true and the Decoder
+	 * knows its duration, a buffer of that size is allocated up front and
+	 * filled with silence, and a clone of the Decoder fills it in from the
+	 * start on a background thread. Otherwise everything is decoded here.
+	 **/
+	SoundData(Decoder *decoder, bool async = false);
 	SoundData(int samples, int sampleRate, int bitDepth, int channels);
 	SoundData(void *d, int samples, int sampleRate, int bitDepth, int channels);
 	SoundData(const SoundData &c);
@@ -61,13 +71,85 @@ class SoundData : public love::Data
 	float getSample(int i) const;
 	float getSample(int i, int channel) const;
 
+	/**
+	 * Converts count sample frames starting at frame start to floats in
+	 * [-1, 1]. If channel is 0 every channel is copied, interleaved.
+	 * Otherwise only the given channel (starting at 1) is copied.
+	 **/
+	void getSamples(int start, int count, int channel, float *dst) const;
+
+	/**
+	 * Sets count sample frames starting at frame start from floats, which are
+	 * clamped to [-1, 1]. The channel works the same as in getSamples.
+	 **/
+	void setSamples(int start, int count, int channel, const float *src);
+
+	/**
+	 * Adds count sample frames of another SoundData, multiplied by gain, to
+	 * this one. Both must have the same number of channels. The result is
+	 * clamped to [-1, 1].
+	 **/
+	void mix(const SoundData *src, float gain, int dstStart, int srcStart, int count);
+
+	/**
+	 * Multiplies count sample frames starting at frame start by gain.
+	 **/
+	void applyGain(float gain, int start, int count);
+
+	/**
+	 * Creates a copy of this SoundData with a different sample rate, using
+	 * linear interpolation.
+	 **/
+	SoundData *resample(int sampleRate) const;
+
+	/**
+	 * Creates a copy of this SoundData with a different bit depth.
+	 **/
+	SoundData *convert(int bitDepth) const;
+
+	/**
+	 * Gets whether background decoding has finished, either successfully or
+	 * with an error. Always true for SoundData which wasn't decoded in the
+	 * background.
+	 **/
+	bool isReady() const;
+
+	/**
+	 * Gets the number of bytes at the start of the data which have been
+	 * decoded so far. Bytes past that are silence until they're decoded.
+	 **/
+	size_t getDecodedSize() const;
+
+	/**
+	 * Gets the fraction of the data which has been decoded, in [0, 1].
+	 **/
+	float getDecodeProgress() const;
+
+	/**
+	 * Gets the error which stopped background decoding early, if any. Only
+	 * valid once isReady() returns true.
+	 **/
+	const std::string &getDecodeError() const;
+
 private:
 
+	class DecodeThread;
+
 	void load(int samples, int sampleRate, int bitDepth, int channels, void *newData = 0);
+	void decode(Decoder *decoder);
+	void decodeAsync(Decoder *decoder);
+
+	void checkRange(int start, int count, int channel) const;
+	void checkWritable() const;
 
 	uint8 *data;
 	size_t size;
 
+	// Written by the background decoding thread, if there is one.
+	std::atomic<size_t> decodedSize;
+	std::atomic<bool> ready;
+	std::string decodeError;
+
 	int sampleRate;
 	int bitDepth;
 	int channels;
@@ -67,6 +67,19 @@ int w_newSoundData(lua_State *L)
 	// Must be string or decoder.
 	else
 	{
+		bool async = false;
+
+		if (!lua_isnoneornil(L, 2))
+		{
+			luaL_checktype(L, 2, LUA_TTABLE);
+
+			lua_getfield(L, 2, "async");
+			async = luax_optboolean(L, -1, false);
+			lua_pop(L, 1);
+
+			lua_settop(L, 1);
+		}
+
 		// Convert to Decoder, if necessary.
 		if (!luax_istype(L, 1, Decoder::type))
 		{
@@ -74,7 +87,7 @@ int w_newSoundData(lua_State *L)
 			lua_replace(L, 1);
 		}
 
-		luax_catchexcept(L, [&](){ t = instance()->newSoundData(luax_checkdecoder(L, 1)); });
+		luax_catchexcept(L, [&](){ t = instance()->newSoundData(luax_checkdecoder(L, 1), async); });
 	}
 
 	luax_pushtype(L, t);
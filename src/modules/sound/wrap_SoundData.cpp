@@ -21,6 +21,11 @@
 #include "wrap_SoundData.h"
 
 #include "data/wrap_Data.h"
+#include "data/ByteData.h"
+
+// C++
+#include <algorithm>
+#include <vector>
 
 // Shove the wrap_SoundData.lua code directly into a raw string literal.
 static const char sounddata_lua[] =
@@ -121,6 +126,160 @@ int w_SoundData_getSample(lua_State *L)
 	return 1;
 }
 
+int w_SoundData_getSamples(lua_State *L)
+{
+	SoundData *sd = luax_checksounddata(L, 1);
+
+	// An existing ByteData can be reused instead of creating a new one.
+	love::data::ByteData *dest = nullptr;
+	int startidx = 2;
+	if (luax_istype(L, 2, love::data::ByteData::type))
+	{
+		dest = luax_checktype<love::data::ByteData>(L, 2);
+		startidx = 3;
+	}
+
+	int start = (int) luaL_optinteger(L, startidx + 0, 0);
+	int count = (int) luaL_optinteger(L, startidx + 1, sd->getSampleCount() - start);
+	int channel = (int) luaL_optinteger(L, startidx + 2, 0);
+
+	size_t floats = (size_t) std::max(count, 0) * (channel == 0 ? sd->getChannelCount() : 1);
+
+	if (dest != nullptr)
+	{
+		if (dest->getSize() < floats * sizeof(float))
+			return luaL_error(L, "ByteData is too small to hold %d samples (needs %d bytes).", (int) floats, (int) (floats * sizeof(float)));
+
+		luax_catchexcept(L, [&](){ sd->getSamples(start, count, channel, (float *) dest->getData()); });
+		lua_pushvalue(L, 2);
+		return 1;
+	}
+
+	luax_catchexcept(L, [&]() {
+		dest = new love::data::ByteData(std::max(floats, (size_t) 1) * sizeof(float));
+	});
+
+	luax_catchexcept(L,
+		[&](){ sd->getSamples(start, count, channel, (float *) dest->getData()); },
+		[&](bool failed){ if (failed) dest->release(); }
+	);
+
+	luax_pushtype(L, dest);
+	dest->release();
+	return 1;
+}
+
+int w_SoundData_setSamples(lua_State *L)
+{
+	SoundData *sd = luax_checksounddata(L, 1);
+	int start = (int) luaL_optinteger(L, 3, 0);
+	int channel = (int) luaL_optinteger(L, 4, 0);
+	int channels = channel == 0 ? sd->getChannelCount() : 1;
+
+	std::vector<float> values;
+	const float *src = nullptr;
+	size_t floats = 0;
+
+	if (lua_istable(L, 2))
+	{
+		floats = luax_objlen(L, 2);
+		values.resize(floats);
+
+		for (size_t i = 0; i < floats; i++)
+		{
+			lua_rawgeti(L, 2, (int) i + 1);
+			values[i] = (float) luaL_checknumber(L, -1);
+			lua_pop(L, 1);
+		}
+
+		src = values.empty() ? nullptr : &values[0];
+	}
+	else
+	{
+		love::Data *data = love::data::luax_checkdata(L, 2);
+		floats = data->getSize() / sizeof(float);
+		src = (const float *) data->getData();
+	}
+
+	if (floats % channels != 0)
+		return luaL_error(L, "Number of samples (%d) must be a multiple of the channel count (%d).", (int) floats, channels);
+
+	int count = (int) (floats / channels);
+	luax_catchexcept(L, [&](){ sd->setSamples(start, count, channel, src); });
+	return 0;
+}
+
+int w_SoundData_mix(lua_State *L)
+{
+	SoundData *sd = luax_checksounddata(L, 1);
+	SoundData *src = luax_checksounddata(L, 2);
+	float gain = (float) luaL_optnumber(L, 3, 1.0);
+	int dstStart = (int) luaL_optinteger(L, 4, 0);
+	int srcStart = (int) luaL_optinteger(L, 5, 0);
+
+	int remaining = std::min(sd->getSampleCount() - dstStart, src->getSampleCount() - srcStart);
+	int count = (int) luaL_optinteger(L, 6, remaining);
+
+	luax_catchexcept(L, [&](){ sd->mix(src, gain, dstStart, srcStart, count); });
+	return 0;
+}
+
+int w_SoundData_applyGain(lua_State *L)
+{
+	SoundData *sd = luax_checksounddata(L, 1);
+	float gain = (float) luaL_checknumber(L, 2);
+	int start = (int) luaL_optinteger(L, 3, 0);
+	int count = (int) luaL_optinteger(L, 4, sd->getSampleCount() - start);
+
+	luax_catchexcept(L, [&](){ sd->applyGain(gain, start, count); });
+	return 0;
+}
+
+int w_SoundData_resample(lua_State *L)
+{
+	SoundData *sd = luax_checksounddata(L, 1);
+	int sampleRate = (int) luaL_checkinteger(L, 2);
+
+	SoundData *resampled = nullptr;
+	luax_catchexcept(L, [&](){ resampled = sd->resample(sampleRate); });
+
+	luax_pushtype(L, resampled);
+	resampled->release();
+	return 1;
+}
+
+int w_SoundData_convert(lua_State *L)
+{
+	SoundData *sd = luax_checksounddata(L, 1);
+	int bitDepth = (int) luaL_checkinteger(L, 2);
+
+	SoundData *converted = nullptr;
+	luax_catchexcept(L, [&](){ converted = sd->convert(bitDepth); });
+
+	luax_pushtype(L, converted);
+	converted->release();
+	return 1;
+}
+
+int w_SoundData_isReady(lua_State *L)
+{
+	SoundData *t = luax_checksounddata(L, 1);
+	bool ready = t->isReady();
+
+	if (ready && !t->getDecodeError().empty())
+		return luaL_error(L, "%s", t->getDecodeError().c_str());
+
+	luax_pushboolean(L, ready);
+	return 1;
+}
+
+int w_SoundData_getDecodeProgress(lua_State *L)
+{
+	SoundData *t = luax_checksounddata(L, 1);
+	lua_pushnumber(L, t->getDecodeProgress());
+	return 1;
+}
+
 int w_SoundData_getChannels(lua_State *L)
 {
 	luax_markdeprecated(L, "SoundData:getChannels", API_METHOD, DEPRECATED_RENAMED, "SoundData:getChannelCount");
@@ -137,6 +296,14 @@ static const luaL_Reg w_SoundData_functions[] =
 	{ "getDuration", w_SoundData_getDuration },
 	{ "setSample", w_SoundData_setSample },
 	{ "getSample", w_SoundData_getSample },
+	{ "getSamples", w_SoundData_getSamples },
+	{ "setSamples", w_SoundData_setSamples },
+	{ "mix", w_SoundData_mix },
+	{ "applyGain", w_SoundData_applyGain },
+	{ "resample", w_SoundData_resample },
+	{ "convert", w_SoundData_convert },
+	{ "isReady", w_SoundData_isReady },
+	{ "getDecodeProgress", w_SoundData_getDecodeProgress },
 
 	// Deprecated
 	{ "getChannels", w_SoundData_getChannels },
@@ -73,6 +73,20 @@ local objectcache = setmetatable({}, {
 	end,
 })
 
+-- Clamps a scaled sample value to the integer type's range and rounds it to
+-- the nearest integer (ties to even), like lrint in the C++ version.
+local function toIntSample(v, lower, upper)
+	if not (v > lower) then
+		return lower
+	elseif v > upper then
+		return upper
+	end
+	local r = floor(v + 0.5)
+	if r - v == 0.5 and r % 2 == 1 then
+		r = r - 1
+	end
+	return r
+end
 
 -- Overwrite existing functions with new FFI versions.
 
@@ -128,14 +142,17 @@ function SoundData:setSample(i, channel, sample)
 		error("Attempt to set out-of-range sample!", 2)
 	end
 
+	-- The float casts are needed to make values end up the same as in the C++
+	-- version of this method.
+	sample = tonumber(ffi.cast(float, sample))
+
 	if p.bytedepth == 2 then
 		-- 16-bit data is stored as signed values internally.
-		p.pointer[i] = sample * p.maxvalue
+		p.pointer[i] = toIntSample(tonumber(ffi.cast(float, sample * p.maxvalue)), -32768, 32767)
 	else
 		-- 8-bit data is stored as unsigned values internally.
-		-- The float cast is needed to make values end up the same as in the
-		-- C++ version of this method.
-		p.pointer[i] = ffi.cast(float, (sample * 127) + 128)
+		local v = tonumber(ffi.cast(float, sample * 127))
+		p.pointer[i] = toIntSample(tonumber(ffi.cast(float, v + 128)), 0, 255)
 	end
 end
 
@@ -22,6 +22,8 @@
 
 #include <timer/Timer.h>
 
+#include <algorithm>
+
 namespace love
 {
 namespace thread
@@ -32,15 +34,183 @@ love::Type Channel::type("Channel", &Object::type);
 Channel::Channel()
 	: sent(0)
 	, received(0)
+	, mode(MODE_UNBOUNDED)
+	, capacity(0)
+	, cells(nullptr)
+	, enqueuePos(0)
+	, dequeuePos(0)
+	, waiters(0)
 {
 }
 
+Channel::Channel(Mode mode, int capacity)
+	: sent(0)
+	, received(0)
+	, mode(mode)
+	, capacity(0)
+	, cells(nullptr)
+	, enqueuePos(0)
+	, dequeuePos(0)
+	, waiters(0)
+{
+	if (mode == MODE_UNBOUNDED)
+		return;
+
+	// The ring buffer can't tell a full cell from an empty one with only one
+	// cell.
+	if (capacity < 2)
+		throw love::Exception("Channel capacity must be at least 2.");
+
+	this->capacity = (uint64) capacity;
+	cells = new Cell[capacity];
+
+	for (int i = 0; i < capacity; i++)
+		cells[i].sequence.store((uint64) i, std::memory_order_relaxed);
+}
+
 Channel::~Channel()
 {
+	delete[] cells;
+}
+
+bool Channel::tryPushBounded(const Variant &var, uint64 &id)
+{
+	uint64 pos = enqueuePos.load(std::memory_order_relaxed);
+	Cell *cell = nullptr;
+
+	while (true)
+	{
+		cell = &cells[pos % capacity];
+		uint64 seq = cell->sequence.load(std::memory_order_acquire);
+		int64 diff = (int64) seq - (int64) pos;
+
+		if (diff == 0)
+		{
+			// There's only one producer in SPSC mode, so nothing else can have
+			// claimed the cell.
+			if (mode == MODE_SPSC)
+			{
+				enqueuePos.store(pos + 1, std::memory_order_relaxed);
+				break;
+			}
+
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return false; // Full.
+		else
+			pos = enqueuePos.load(std::memory_order_relaxed);
+	}
+
+	cell->value = var;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	id = pos + 1;
+	return true;
+}
+
+bool Channel::tryPopBounded(Variant *var)
+{
+	uint64 pos = dequeuePos.load(std::memory_order_relaxed);
+	Cell *cell = nullptr;
+
+	while (true)
+	{
+		cell = &cells[pos % capacity];
+		uint64 seq = cell->sequence.load(std::memory_order_acquire);
+		int64 diff = (int64) seq - (int64) (pos + 1);
+
+		if (diff == 0)
+		{
+			if (mode == MODE_SPSC)
+			{
+				dequeuePos.store(pos + 1, std::memory_order_relaxed);
+				break;
+			}
+
+			if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return false; // Empty.
+		else
+			pos = dequeuePos.load(std::memory_order_relaxed);
+	}
+
+	*var = cell->value;
+	cell->value = Variant();
+	cell->sequence.store(pos + capacity, std::memory_order_release);
+
+	return true;
+}
+
+bool Channel::waitBounded(const std::function<bool()> &attempt, double timeout)
+{
+	// The other side is often in the middle of an operation, so a short spin
+	// avoids going to sleep in most cases.
+	for (int i = 0; i < 64; i++)
+	{
+		if (attempt())
+			return true;
+	}
+
+	Lock l(mutex);
+	waiters.fetch_add(1);
+
+	bool success = false;
+
+	while (true)
+	{
+		// Pairs with the fence in notifyBounded: either the attempt sees the
+		// other thread's change, or the other thread sees this waiter.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (attempt())
+		{
+			success = true;
+			break;
+		}
+
+		if (timeout < 0)
+			cond->wait(mutex);
+		else if (timeout == 0)
+			break;
+		else
+		{
+			double start = love::timer::Timer::getTime();
+			cond->wait(mutex, std::max((int) (timeout * 1000), 1));
+			double stop = love::timer::Timer::getTime();
+
+			timeout = std::max(timeout - (stop - start), 0.0);
+		}
+	}
+
+	waiters.fetch_sub(1);
+	return success;
+}
+
+void Channel::notifyBounded()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (waiters.load(std::memory_order_relaxed) > 0)
+	{
+		Lock l(mutex);
+		cond->broadcast();
+	}
 }
 
 uint64 Channel::push(const Variant &var)
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		uint64 id = 0;
+		waitBounded([&]() { return tryPushBounded(var, id); }, -1.0);
+		notifyBounded();
+		return id;
+	}
+
 	Lock l(mutex);
 
 	queue.push(var);
@@ -51,6 +221,12 @@ uint64 Channel::push(const Variant &var)
 
 bool Channel::supply(const Variant &var)
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		uint64 id = push(var);
+		return waitBounded([&]() { return hasRead(id); }, -1.0);
+	}
+
 	Lock l(mutex);
 	uint64 id = push(var);
 
@@ -62,6 +238,23 @@ bool Channel::supply(const Variant &var)
 
 bool Channel::supply(const Variant &var, double timeout)
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		if (timeout < 0)
+			return false;
+
+		double start = love::timer::Timer::getTime();
+
+		uint64 id = 0;
+		if (!waitBounded([&]() { return tryPushBounded(var, id); }, timeout))
+			return false;
+
+		notifyBounded();
+
+		timeout = std::max(timeout - (love::timer::Timer::getTime() - start), 0.0);
+		return waitBounded([&]() { return hasRead(id); }, timeout);
+	}
+
 	Lock l(mutex);
 	uint64 id = push(var);
 
@@ -82,6 +275,15 @@ bool Channel::supply(const Variant &var, double timeout)
 
 bool Channel::pop(Variant *var)
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		if (!tryPopBounded(var))
+			return false;
+
+		notifyBounded();
+		return true;
+	}
+
 	Lock l(mutex);
 
 	if (queue.empty())
@@ -98,6 +300,13 @@ bool Channel::pop(Variant *var)
 
 bool Channel::demand(Variant *var)
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		waitBounded([&]() { return tryPopBounded(var); }, -1.0);
+		notifyBounded();
+		return true;
+	}
+
 	Lock l(mutex);
 
 	while (!pop(var))
@@ -108,6 +317,15 @@ bool Channel::demand(Variant *var)
 
 bool Channel::demand(Variant *var, double timeout)
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		if (timeout < 0 || !waitBounded([&]() { return tryPopBounded(var); }, timeout))
+			return false;
+
+		notifyBounded();
+		return true;
+	}
+
 	Lock l(mutex);
 
 	while (timeout >= 0)
@@ -127,6 +345,23 @@ bool Channel::demand(Variant *var, double timeout)
 
 bool Channel::peek(Variant *var)
 {
+	if (mode == MODE_MPMC)
+		throw love::Exception("Channel:peek cannot be used with mpmc Channels.");
+
+	if (mode == MODE_SPSC)
+	{
+		// Only safe from the consuming thread, which is the only one that can
+		// remove the value.
+		uint64 pos = dequeuePos.load(std::memory_order_relaxed);
+		const Cell &cell = cells[pos % capacity];
+
+		if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+			return false;
+
+		*var = cell.value;
+		return true;
+	}
+
 	Lock l(mutex);
 
 	if (queue.empty())
@@ -138,18 +373,42 @@ bool Channel::peek(Variant *var)
 
 int Channel::getCount() const
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		uint64 dequeued = dequeuePos.load(std::memory_order_acquire);
+		uint64 enqueued = enqueuePos.load(std::memory_order_acquire);
+		return enqueued > dequeued ? (int) (enqueued - dequeued) : 0;
+	}
+
 	Lock l(mutex);
 	return (int) queue.size();
 }
 
 bool Channel::hasRead(uint64 id) const
 {
+	if (mode != MODE_UNBOUNDED)
+		return dequeuePos.load(std::memory_order_acquire) >= id;
+
 	Lock l(mutex);
 	return received >= id;
 }
 
 void Channel::clear()
 {
+	if (mode != MODE_UNBOUNDED)
+	{
+		Variant var;
+		bool popped = false;
+
+		while (tryPopBounded(&var))
+			popped = true;
+
+		if (popped)
+			notifyBounded();
+
+		return;
+	}
+
 	Lock l(mutex);
 
 	// We're already empty.
@@ -164,6 +423,77 @@ void Channel::clear()
 	cond->broadcast();
 }
 
+uint64 Channel::pushMany(const std::vector<Variant> &vars)
+{
+	if (vars.empty())
+		return 0;
+
+	if (mode != MODE_UNBOUNDED)
+	{
+		uint64 id = 0;
+		for (const Variant &var : vars)
+			id = push(var);
+		return id;
+	}
+
+	Lock l(mutex);
+
+	for (const Variant &var : vars)
+		queue.push(var);
+
+	sent += vars.size();
+	cond->broadcast();
+
+	return sent;
+}
+
+int Channel::popMany(std::vector<Variant> &vars, int max)
+{
+	int count = 0;
+
+	if (mode != MODE_UNBOUNDED)
+	{
+		Variant var;
+		while (count < max && tryPopBounded(&var))
+		{
+			vars.push_back(var);
+			count++;
+		}
+
+		if (count > 0)
+			notifyBounded();
+
+		return count;
+	}
+
+	Lock l(mutex);
+
+	while (count < max && !queue.empty())
+	{
+		vars.push_back(queue.front());
+		queue.pop();
+		count++;
+	}
+
+	if (count > 0)
+	{
+		received += count;
+		cond->broadcast();
+	}
+
+	return count;
+}
+
+Channel::Mode Channel::getMode() const
+{
+	return mode;
+}
+
+int Channel::getCapacity() const
+{
+	return (int) capacity;
+}
+
 void Channel::lockMutex()
 {
 	mutex->lock();
@@ -174,5 +504,29 @@ void Channel::unlockMutex()
 	mutex->unlock();
 }
 
+bool Channel::getConstant(const char *in, Mode &out)
+{
+	return modes.find(in, out);
+}
+
+bool Channel::getConstant(Mode in, const char *&out)
+{
+	return modes.find(in, out);
+}
+
+std::vector<std::string> Channel::getConstants(Mode)
+{
+	return modes.getNames();
+}
+
+StringMap<Channel::Mode, Channel::MODE_MAX_ENUM>::Entry Channel::modeEntries[] =
+{
+	{ "unbounded", MODE_UNBOUNDED },
+	{ "spsc",      MODE_SPSC      },
+	{ "mpmc",      MODE_MPMC      },
+};
+
+StringMap<Channel::Mode, Channel::MODE_MAX_ENUM> Channel::modes(Channel::modeEntries, sizeof(Channel::modeEntries));
+
 } // thread
 } // love
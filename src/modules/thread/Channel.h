@@ -22,11 +22,15 @@
 #define LOVE_THREAD_CHANNEL_H
 
 // STL
+#include <atomic>
+#include <functional>
 #include <queue>
+#include <vector>
 
 // LOVE
 #include "common/Variant.h"
 #include "common/int.h"
+#include "common/StringMap.h"
 #include "threads.h"
 
 namespace love
@@ -43,7 +47,28 @@ friend int w_Channel_performAtomic(lua_State *);
 
 	static love::Type type;
 
+	enum Mode
+	{
+		// Unlimited size, guarded by a mutex.
+		MODE_UNBOUNDED,
+
+		// Fixed size lock-free ring buffer, for one thread pushing and one
+		// thread popping at a time.
+		MODE_SPSC,
+
+		// Fixed size lock-free ring buffer, for any number of threads.
+		MODE_MPMC,
+
+		MODE_MAX_ENUM
+	};
+
 	Channel();
+
+	/**
+	 * In the bounded (lock-free) modes, pushing waits while the Channel is
+	 * full, and performAtomic only excludes other performAtomic calls.
+	 **/
+	Channel(Mode mode, int capacity);
 	~Channel();
 
 	uint64 push(const Variant &var);
@@ -57,11 +82,42 @@ friend int w_Channel_performAtomic(lua_State *);
 	bool hasRead(uint64 id) const;
 	void clear();
 
+	/**
+	 * Pushes all of the values in order, and returns the ID of the last one.
+	 **/
+	uint64 pushMany(const std::vector<Variant> &vars);
+
+	/**
+	 * Pops up to max values without waiting. Returns the number popped.
+	 **/
+	int popMany(std::vector<Variant> &vars, int max);
+
+	Mode getMode() const;
+	int getCapacity() const;
+
+	static bool getConstant(const char *in, Mode &out);
+	static bool getConstant(Mode in, const char *&out);
+	static std::vector<std::string> getConstants(Mode);
+
 private:
 
+	struct Cell
+	{
+		std::atomic<uint64> sequence;
+		Variant value;
+	};
+
 	void lockMutex();
 	void unlockMutex();
 
+	bool tryPushBounded(const Variant &var, uint64 &id);
+	bool tryPopBounded(Variant *var);
+
+	// Calls attempt until it succeeds, sleeping between tries once a short
+	// spin has failed. A negative timeout waits forever.
+	bool waitBounded(const std::function<bool()> &attempt, double timeout);
+	void notifyBounded();
+
 	MutexRef mutex;
 	ConditionalRef cond;
 	std::queue<Variant> queue;
@@ -69,6 +125,23 @@ friend int w_Channel_performAtomic(lua_State *);
 	uint64 sent;
 	uint64 received;
 
+	Mode mode;
+	uint64 capacity;
+	Cell *cells;
+
+	// Kept on separate cache lines, since producers and consumers write them
+	// from different threads.
+	char padding0[64];
+	std::atomic<uint64> enqueuePos;
+	char padding1[64];
+	std::atomic<uint64> dequeuePos;
+	char padding2[64];
+
+	std::atomic<int> waiters;
+
+	static StringMap<Mode, MODE_MAX_ENUM>::Entry modeEntries[];
+	static StringMap<Mode, MODE_MAX_ENUM> modes;
+
 }; // Channel
 
 } // thread
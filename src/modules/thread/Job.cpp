@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "Job.h"
+
+#include <timer/Timer.h>
+
+#include <algorithm>
+
+namespace love
+{
+namespace thread
+{
+
+love::Type Job::type("Job", &Object::type);
+
+Job::Job(const std::vector<Variant> &args, Channel *channel)
+	: args(args)
+	, channel(channel)
+	, done(false)
+{
+}
+
+Job::~Job()
+{
+}
+
+bool Job::isDone() const
+{
+	return done.load(std::memory_order_acquire);
+}
+
+bool Job::wait(double timeout)
+{
+	if (isDone())
+		return true;
+
+	Lock l(mutex);
+
+	if (timeout < 0)
+	{
+		while (!isDone())
+			cond->wait(mutex);
+		return true;
+	}
+
+	while (!isDone() && timeout > 0)
+	{
+		double start = love::timer::Timer::getTime();
+		cond->wait(mutex, std::max((int) (timeout * 1000), 1));
+		double stop = love::timer::Timer::getTime();
+
+		timeout -= (stop - start);
+	}
+
+	return isDone();
+}
+
+const std::vector<Variant> &Job::getResults() const
+{
+	return results;
+}
+
+const std::string &Job::getError() const
+{
+	return error;
+}
+
+std::vector<Variant> Job::takeArgs()
+{
+	std::vector<Variant> a;
+	std::swap(a, args);
+	return a;
+}
+
+void Job::finish(const std::vector<Variant> &results, const std::string &error)
+{
+	{
+		Lock l(mutex);
+
+		this->results = results;
+		this->error = error;
+
+		done.store(true, std::memory_order_release);
+		cond->broadcast();
+
+		for (const Waiter &w : waiters)
+		{
+			Lock wl(w.mutex);
+			w.cond->broadcast();
+		}
+	}
+
+	if (channel.get() != nullptr)
+	{
+		channel->push(Variant(&Job::type, this));
+		channel.set(nullptr);
+	}
+}
+
+void Job::addWaiter(Mutex *mutex, Conditional *cond)
+{
+	Lock l(this->mutex);
+	waiters.push_back({mutex, cond});
+}
+
+void Job::removeWaiter(Conditional *cond)
+{
+	Lock l(mutex);
+
+	for (auto it = waiters.begin(); it != waiters.end(); ++it)
+	{
+		if (it->cond == cond)
+		{
+			waiters.erase(it);
+			break;
+		}
+	}
+}
+
+} // thread
+} // love
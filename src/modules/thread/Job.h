@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_THREAD_JOB_H
+#define LOVE_THREAD_JOB_H
+
+// STL
+#include <atomic>
+#include <string>
+#include <vector>
+
+// LOVE
+#include "common/Object.h"
+#include "common/Variant.h"
+#include "Channel.h"
+#include "threads.h"
+
+namespace love
+{
+namespace thread
+{
+
+/**
+ * A single call to a Pool's job function, and its results once it has run.
+ **/
+class Job : public love::Object
+{
+public:
+
+	static love::Type type;
+
+	/**
+	 * @param args The arguments passed to the job function.
+	 * @param channel If not null, the Job pushes itself onto this Channel once
+	 *        it's done.
+	 **/
+	Job(const std::vector<Variant> &args, Channel *channel);
+	virtual ~Job();
+
+	bool isDone() const;
+
+	/**
+	 * Waits for the job to finish.
+	 * @param timeout The maximum time to wait in seconds, or a negative value
+	 *        to wait indefinitely.
+	 * @return Whether the job is done.
+	 **/
+	bool wait(double timeout = -1.0);
+
+	/**
+	 * Only valid once the job is done.
+	 **/
+	const std::vector<Variant> &getResults() const;
+	const std::string &getError() const;
+
+	/**
+	 * Takes the arguments, for the thread which runs the job.
+	 **/
+	std::vector<Variant> takeArgs();
+
+	/**
+	 * Stores the results, wakes up any threads waiting for the job, and pushes
+	 * the job to its Channel.
+	 **/
+	void finish(const std::vector<Variant> &results, const std::string &error);
+
+	/**
+	 * Makes finish also broadcast cond (while holding mutex), until the waiter
+	 * is removed. Used by Pool workers, which wait for a job and for new work
+	 * to do at the same time.
+	 **/
+	void addWaiter(Mutex *mutex, Conditional *cond);
+	void removeWaiter(Conditional *cond);
+
+private:
+
+	struct Waiter
+	{
+		Mutex *mutex;
+		Conditional *cond;
+	};
+
+	std::vector<Variant> args;
+	std::vector<Variant> results;
+	std::string error;
+
+	StrongRef<Channel> channel;
+
+	std::vector<Waiter> waiters;
+
+	std::atomic<bool> done;
+
+	MutexRef mutex;
+	ConditionalRef cond;
+
+}; // Job
+
+} // thread
+} // love
+
+#endif // LOVE_THREAD_JOB_H
@@ -0,0 +1,471 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "LuaPool.h"
+#include "LuaThread.h"
+#include "common/Exception.h"
+
+#include <timer/Timer.h>
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+
+namespace love
+{
+namespace thread
+{
+
+// Registry key for the Worker which owns a Lua state.
+static const char *WORKER_REGISTRY_KEY = "_love_poolworker";
+
+/**
+ * The job queues, shared by the pool and its worker threads. Each worker keeps
+ * a reference to it, so it outlives the pool until the workers have stopped.
+ **/
+class LuaPool::Scheduler : public love::Object
+{
+public:
+
+	Scheduler(const std::string &name, love::Data *code, int numqueues);
+	virtual ~Scheduler();
+
+	void submit(Job *job, int worker);
+	Job *takeJob(int worker);
+
+	/**
+	 * Returns null once the pool has been stopped and every queue is empty.
+	 **/
+	Job *waitForJob(int worker);
+
+	/**
+	 * Sleeps until there's a queued job, the given job is done, or the timeout
+	 * (in milliseconds, or -1 for none) runs out.
+	 **/
+	void waitForWork(Job *job, int timeout);
+	void addJobWaiter(Job *job);
+	void removeJobWaiter(Job *job);
+
+	void stop();
+
+	int getQueueCount() const { return (int) queues.size(); }
+	int getPendingJobCount() const { return std::max(queuedJobs.load(), 0); }
+
+	StrongRef<love::Data> code;
+	std::string name;
+
+private:
+
+	struct Queue
+	{
+		std::deque<Job *> jobs;
+		MutexRef mutex;
+	};
+
+	std::vector<Queue *> queues;
+
+	std::atomic<int> nextQueue;
+	std::atomic<int> queuedJobs;
+
+	// Used for putting workers to sleep while there are no queued jobs.
+	MutexRef sleepMutex;
+	ConditionalRef sleepCond;
+	int sleepingWorkers;
+	bool stopping;
+
+}; // Scheduler
+
+class LuaPool::Worker : public Threadable
+{
+public:
+
+	Worker(Scheduler *scheduler, int index);
+	virtual ~Worker();
+
+	// Implements Threadable.
+	void threadFunction() override;
+
+	void runJob(Job *job);
+
+	/**
+	 * Runs other jobs from the pool while waiting for a job to finish.
+	 **/
+	bool waitFor(Job *job, double timeout);
+
+	StrongRef<Scheduler> scheduler;
+	int index;
+
+private:
+
+	lua_State *L;
+	int funcRef;
+	std::string initError;
+
+}; // Worker
+
+LuaPool::Scheduler::Scheduler(const std::string &name, love::Data *code, int numqueues)
+	: code(code)
+	, name(name)
+	, nextQueue(0)
+	, queuedJobs(0)
+	, sleepingWorkers(0)
+	, stopping(false)
+{
+	for (int i = 0; i < numqueues; i++)
+		queues.push_back(new Queue());
+}
+
+LuaPool::Scheduler::~Scheduler()
+{
+	// Workers empty every queue before they stop, so there are no jobs left.
+	for (Queue *queue : queues)
+		delete queue;
+}
+
+void LuaPool::Scheduler::submit(Job *job, int worker)
+{
+	int count = (int) queues.size();
+
+	if (worker < 0 || worker >= count)
+		worker = (int) ((unsigned int) nextQueue++ % (unsigned int) count);
+
+	job->retain();
+
+	{
+		Lock lock(queues[worker]->mutex);
+		queues[worker]->jobs.push_back(job);
+	}
+
+	queuedJobs++;
+
+	Lock lock(sleepMutex);
+	if (sleepingWorkers > 0)
+		sleepCond->signal();
+}
+
+Job *LuaPool::Scheduler::takeJob(int worker)
+{
+	int count = (int) queues.size();
+
+	for (int i = 0; i < count; i++)
+	{
+		Queue *queue = queues[(worker + i) % count];
+		Lock lock(queue->mutex);
+
+		if (queue->jobs.empty())
+			continue;
+
+		Job *job = nullptr;
+
+		// Workers take the newest job from their own queue, which is the most
+		// likely to have its data in the cache, and steal the oldest job from
+		// the other end of other queues.
+		if (i == 0)
+		{
+			job = queue->jobs.back();
+			queue->jobs.pop_back();
+		}
+		else
+		{
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+		}
+
+		queuedJobs--;
+		return job;
+	}
+
+	return nullptr;
+}
+
+Job *LuaPool::Scheduler::waitForJob(int worker)
+{
+	while (true)
+	{
+		Job *job = takeJob(worker);
+		if (job != nullptr)
+			return job;
+
+		Lock lock(sleepMutex);
+
+		if (queuedJobs > 0)
+			continue;
+
+		if (stopping)
+			return nullptr;
+
+		sleepingWorkers++;
+		sleepCond->wait(sleepMutex);
+		sleepingWorkers--;
+	}
+}
+
+void LuaPool::Scheduler::waitForWork(Job *job, int timeout)
+{
+	Lock lock(sleepMutex);
+
+	if (queuedJobs > 0 || job->isDone())
+		return;
+
+	sleepingWorkers++;
+	sleepCond->wait(sleepMutex, timeout);
+	sleepingWorkers--;
+}
+
+void LuaPool::Scheduler::addJobWaiter(Job *job)
+{
+	job->addWaiter(sleepMutex, sleepCond);
+}
+
+void LuaPool::Scheduler::removeJobWaiter(Job *job)
+{
+	job->removeWaiter(sleepCond);
+}
+
+void LuaPool::Scheduler::stop()
+{
+	Lock lock(sleepMutex);
+	stopping = true;
+	sleepCond->broadcast();
+}
+
+LuaPool::Worker::Worker(Scheduler *scheduler, int index)
+	: scheduler(scheduler)
+	, index(index)
+	, L(nullptr)
+	, funcRef(LUA_NOREF)
+{
+	threadName = scheduler->name;
+}
+
+LuaPool::Worker::~Worker()
+{
+}
+
+void LuaPool::Worker::threadFunction()
+{
+	L = LuaThread::newLuaState();
+
+	lua_pushlightuserdata(L, this);
+	lua_setfield(L, LUA_REGISTRYINDEX, WORKER_REGISTRY_KEY);
+
+	lua_pushcfunction(L, luax_traceback);
+	int tracebackidx = lua_gettop(L);
+
+	// The code is run once per worker, and returns the job function.
+	love::Data *code = scheduler->code.get();
+	if (luaL_loadbuffer(L, (const char *) code->getData(), code->getSize(), scheduler->name.c_str()) != 0)
+		initError = luax_tostring(L, -1);
+	else if (lua_pcall(L, 0, 1, tracebackidx) != 0)
+		initError = luax_tostring(L, -1);
+	else if (!lua_isfunction(L, -1))
+		initError = "Pool code must return a function.";
+	else
+		funcRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	lua_settop(L, 0);
+
+	while (Job *job = scheduler->waitForJob(index))
+		runJob(job);
+
+	lua_close(L);
+	L = nullptr;
+
+	// Taken by the pool before the thread was started.
+	release();
+}
+
+void LuaPool::Worker::runJob(Job *job)
+{
+	std::vector<Variant> args = job->takeArgs();
+	std::vector<Variant> results;
+	std::string error = initError;
+
+	if (error.empty())
+	{
+		// This can be called while another job is running on this state (when
+		// a job waits for another one), so leave the rest of the stack alone.
+		int top = lua_gettop(L);
+
+		lua_pushcfunction(L, luax_traceback);
+		lua_rawgeti(L, LUA_REGISTRYINDEX, funcRef);
+
+		for (const Variant &arg : args)
+			arg.toLua(L);
+
+		int nargs = (int) args.size();
+		args.clear();
+
+		if (lua_pcall(L, nargs, LUA_MULTRET, top + 1) != 0)
+			error = luax_tostring(L, -1);
+		else
+		{
+			int nresults = lua_gettop(L) - (top + 1);
+
+			for (int i = 1; i <= nresults; i++)
+			{
+				try
+				{
+					results.push_back(Variant::fromLua(L, top + 1 + i));
+				}
+				catch (love::Exception &e)
+				{
+					error = e.what();
+					break;
+				}
+
+				if (results.back().getType() == Variant::UNKNOWN)
+				{
+					error = "Job return value #" + std::to_string(i) + " must be a boolean, number, string, love type, or flat table.";
+					break;
+				}
+			}
+		}
+
+		lua_settop(L, top);
+	}
+
+	if (!error.empty())
+		results.clear();
+
+	job->finish(results, error);
+	job->release();
+}
+
+bool LuaPool::Worker::waitFor(Job *job, double timeout)
+{
+	double start = love::timer::Timer::getTime();
+
+	// The job wakes up the scheduler's sleeping workers when it finishes, so
+	// this can sleep until either it's done or there's another job to run.
+	scheduler->addJobWaiter(job);
+
+	while (!job->isDone())
+	{
+		Job *other = scheduler->takeJob(index);
+		if (other != nullptr)
+		{
+			runJob(other);
+			continue;
+		}
+
+		int timeoutms = -1;
+		if (timeout >= 0)
+		{
+			double remaining = timeout - (love::timer::Timer::getTime() - start);
+			if (remaining <= 0)
+				break;
+			timeoutms = std::max((int) (remaining * 1000), 1);
+		}
+
+		scheduler->waitForWork(job, timeoutms);
+	}
+
+	scheduler->removeJobWaiter(job);
+
+	return job->isDone();
+}
+
+love::Type LuaPool::type("Pool", &Object::type);
+
+LuaPool::LuaPool(const std::string &name, love::Data *code, int numthreads)
+{
+	if (numthreads < 1)
+		throw love::Exception("A Pool must have at least one thread.");
+
+	scheduler.set(new Scheduler(name, code, numthreads), Acquire::NORETAIN);
+
+	for (int i = 0; i < numthreads; i++)
+	{
+		Worker *worker = new Worker(scheduler, i);
+
+		// The thread only retains the worker once it has started running, so
+		// this reference keeps it alive until then. threadFunction releases it.
+		worker->retain();
+
+		if (!worker->start())
+		{
+			worker->release();
+			worker->release();
+			break;
+		}
+
+		workers.push_back(worker);
+	}
+
+	if (workers.empty())
+		throw love::Exception("Could not start the Pool's threads.");
+}
+
+LuaPool::~LuaPool()
+{
+	scheduler->stop();
+
+	// Started workers keep themselves alive until their thread ends.
+	for (Worker *worker : workers)
+		worker->release();
+}
+
+void LuaPool::submit(lua_State *L, Job *job)
+{
+	int worker = -1;
+
+	lua_getfield(L, LUA_REGISTRYINDEX, WORKER_REGISTRY_KEY);
+	Worker *w = (Worker *) lua_touserdata(L, -1);
+	lua_pop(L, 1);
+
+	if (w != nullptr && w->scheduler.get() == scheduler.get())
+		worker = w->index;
+
+	scheduler->submit(job, worker);
+}
+
+int LuaPool::getThreadCount() const
+{
+	return (int) workers.size();
+}
+
+int LuaPool::getPendingJobCount() const
+{
+	return scheduler->getPendingJobCount();
+}
+
+bool LuaPool::wait(lua_State *L, Job *job, double timeout)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, WORKER_REGISTRY_KEY);
+	Worker *w = (Worker *) lua_touserdata(L, -1);
+	lua_pop(L, 1);
+
+	if (w != nullptr)
+		return w->waitFor(job, timeout);
+	else
+		return job->wait(timeout);
+}
+
+int LuaPool::getDefaultThreadCount()
+{
+	// hardware_concurrency can return 0 if it doesn't know.
+	return std::max((int) std::thread::hardware_concurrency() - 1, 1);
+}
+
+} // thread
+} // love
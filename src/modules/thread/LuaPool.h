@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_THREAD_LUAPOOL_H
+#define LOVE_THREAD_LUAPOOL_H
+
+// STL
+#include <string>
+#include <vector>
+
+// LOVE
+#include "common/Data.h"
+#include "common/Object.h"
+#include "common/Variant.h"
+#include "Job.h"
+#include "threads.h"
+
+namespace love
+{
+namespace thread
+{
+
+/**
+ * A set of persistent worker threads, each with its own Lua state, which run
+ * jobs submitted from any thread. The pool's code is run once in each state
+ * when the pool is created, and must return the function that is called for
+ * every job.
+ *
+ * Each worker has its own queue of jobs. Workers take the newest job from
+ * their own queue, and when it's empty they steal the oldest job from the
+ * other workers' queues.
+ **/
+class LuaPool : public love::Object
+{
+public:
+
+	static love::Type type;
+
+	LuaPool(const std::string &name, love::Data *code, int numthreads);
+
+	/**
+	 * The worker threads finish every queued job before they stop. The
+	 * destructor doesn't wait for them, since it can be called from one of
+	 * them (when the last reference to the pool is in a worker's Lua state).
+	 **/
+	virtual ~LuaPool();
+
+	/**
+	 * Adds a job to the pool. Jobs submitted from one of the pool's own worker
+	 * threads are added to that worker's queue.
+	 * @param L The Lua state of the calling thread.
+	 **/
+	void submit(lua_State *L, Job *job);
+
+	int getThreadCount() const;
+	int getPendingJobCount() const;
+
+	/**
+	 * Waits for a job to finish. When called from a pool's worker thread, the
+	 * worker runs other jobs from its pool while it waits, so jobs which wait
+	 * for other jobs can't use up every worker.
+	 * @param L The Lua state of the calling thread.
+	 **/
+	static bool wait(lua_State *L, Job *job, double timeout);
+
+	static int getDefaultThreadCount();
+
+private:
+
+	class Scheduler;
+	class Worker;
+
+	StrongRef<Scheduler> scheduler;
+	std::vector<Worker *> workers;
+
+}; // LuaPool
+
+} // thread
+} // love
+
+#endif // LOVE_THREAD_LUAPOOL_H
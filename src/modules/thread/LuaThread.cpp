@@ -48,23 +48,7 @@ void LuaThread::threadFunction()
 {
 	error.clear();
 
-	lua_State *L = luaL_newstate();
-	luaL_openlibs(L);
-
-#ifdef LOVE_BUILD_STANDALONE
-	luax_preload(L, luaopen_love, "love");
-	luax_require(L, "love");
-	lua_pop(L, 1);
-#endif // LOVE_BUILD_STANDALONE
-
-	luax_require(L, "love.thread");
-	lua_pop(L, 1);
-
-	// We load love.filesystem by default, since require still exists without it
-	// but won't load files from the proper paths. love.filesystem also must be
-	// loaded before using any love function that can take a filepath argument.
-	luax_require(L, "love.filesystem");
-	lua_pop(L, 1);
+	lua_State *L = newLuaState();
 
 	lua_pushcfunction(L, luax_traceback);
 	int tracebackidx = lua_gettop(L);
@@ -90,6 +74,29 @@ void LuaThread::threadFunction()
 		onError();
 }
 
+lua_State *LuaThread::newLuaState()
+{
+	lua_State *L = luaL_newstate();
+	luaL_openlibs(L);
+
+#ifdef LOVE_BUILD_STANDALONE
+	luax_preload(L, luaopen_love, "love");
+	luax_require(L, "love");
+	lua_pop(L, 1);
+#endif // LOVE_BUILD_STANDALONE
+
+	luax_require(L, "love.thread");
+	lua_pop(L, 1);
+
+	// We load love.filesystem by default, since require still exists without it
+	// but won't load files from the proper paths. love.filesystem also must be
+	// loaded before using any love function that can take a filepath argument.
+	luax_require(L, "love.filesystem");
+	lua_pop(L, 1);
+
+	return L;
+}
+
 bool LuaThread::start(const std::vector<Variant> &args)
 {
 	this->args = args;
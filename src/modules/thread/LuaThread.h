@@ -49,6 +49,12 @@ class LuaThread : public Threadable
 
 	bool start(const std::vector<Variant> &args);
 
+	/**
+	 * Creates a new Lua state with the standard libraries, love.thread and
+	 * love.filesystem loaded, as used by Threads and Pools.
+	 **/
+	static lua_State *newLuaState();
+
 private:
 
 	void onError();
@@ -30,11 +30,21 @@ LuaThread *ThreadModule::newThread(const std::string &name, love::Data *data)
 	return new LuaThread(name, data);
 }
 
+LuaPool *ThreadModule::newPool(const std::string &name, love::Data *data, int numthreads)
+{
+	return new LuaPool(name, data, numthreads);
+}
+
 Channel *ThreadModule::newChannel()
 {
 	return new Channel();
 }
 
+Channel *ThreadModule::newChannel(Channel::Mode mode, int capacity)
+{
+	return new Channel(mode, capacity);
+}
+
 Channel *ThreadModule::getChannel(const std::string &name)
 {
 	Lock lock(namedChannelMutex);
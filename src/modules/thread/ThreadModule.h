@@ -33,6 +33,7 @@
 #include "Thread.h"
 #include "Channel.h"
 #include "LuaThread.h"
+#include "LuaPool.h"
 #include "threads.h"
 
 namespace love
@@ -45,7 +46,9 @@ class ThreadModule : public love::Module
 
 	virtual ~ThreadModule() {}
 	virtual LuaThread *newThread(const std::string &name, love::Data *data);
+	virtual LuaPool *newPool(const std::string &name, love::Data *data, int numthreads);
 	virtual Channel *newChannel();
+	virtual Channel *newChannel(Channel::Mode mode, int capacity);
 	virtual Channel *getChannel(const std::string &name);
 
 	// Implements Module.
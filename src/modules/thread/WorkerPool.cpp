@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "WorkerPool.h"
+
+// C++
+#include <algorithm>
+#include <thread>
+
+namespace love
+{
+namespace thread
+{
+
+WorkerPool::Worker::Worker(WorkerPool *pool)
+	: pool(pool)
+{
+	threadName = "WorkerPool";
+}
+
+void WorkerPool::Worker::threadFunction()
+{
+	uint64 lastgeneration = 0;
+
+	{
+		Lock lock(pool->mutex);
+		pool->workerThreads.push_back(std::this_thread::get_id());
+	}
+
+	while (true)
+	{
+		{
+			Lock lock(pool->mutex);
+
+			while (!pool->stopping && pool->generation == lastgeneration)
+				pool->workCond->wait(pool->mutex);
+
+			if (pool->stopping)
+				return;
+
+			lastgeneration = pool->generation;
+			pool->activeWorkers++;
+		}
+
+		pool->runJobs();
+
+		{
+			Lock lock(pool->mutex);
+			if (--pool->activeWorkers == 0)
+				pool->doneCond->broadcast();
+		}
+	}
+}
+
+WorkerPool::WorkerPool(int numthreads)
+	: job(nullptr)
+	, jobCount(0)
+	, nextIndex(0)
+	, remaining(0)
+	, generation(0)
+	, activeWorkers(0)
+	, stopping(false)
+{
+	for (int i = 0; i < numthreads; i++)
+	{
+		Worker *worker = new Worker(this);
+
+		if (!worker->start())
+		{
+			worker->release();
+			break;
+		}
+
+		workers.push_back(worker);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		Lock lock(mutex);
+		stopping = true;
+		workCond->broadcast();
+	}
+
+	for (Worker *worker : workers)
+	{
+		worker->wait();
+		worker->release();
+	}
+}
+
+void WorkerPool::parallelFor(int count, const std::function<void(int)> &func)
+{
+	if (count <= 0)
+		return;
+
+	// Nested calls can't wait for the pool, since they're running on it.
+	if (workers.empty() || count == 1 || isPoolThread())
+	{
+		for (int i = 0; i < count; i++)
+			func(i);
+		return;
+	}
+
+	Lock calllock(callMutex);
+
+	{
+		Lock lock(mutex);
+
+		// Workers which woke up too late to help with the previous call may
+		// still be looking at its state.
+		while (activeWorkers > 0)
+			doneCond->wait(mutex);
+
+		job = &func;
+		jobCount = count;
+		nextIndex = 0;
+		remaining = count;
+		error = nullptr;
+		callerThread = std::this_thread::get_id();
+
+		generation++;
+		workCond->broadcast();
+	}
+
+	runJobs();
+
+	std::exception_ptr err;
+
+	{
+		Lock lock(mutex);
+
+		while (remaining > 0 || activeWorkers > 0)
+			doneCond->wait(mutex);
+
+		job = nullptr;
+		jobCount = 0;
+		callerThread = std::thread::id();
+		std::swap(err, error);
+	}
+
+	if (err)
+		std::rethrow_exception(err);
+}
+
+void WorkerPool::runJobs()
+{
+	while (true)
+	{
+		int i = nextIndex++;
+		if (i >= jobCount)
+			break;
+
+		try
+		{
+			(*job)(i);
+		}
+		catch (...)
+		{
+			// Kept as-is so the caller gets the original exception type.
+			Lock lock(mutex);
+			if (!error)
+				error = std::current_exception();
+		}
+
+		if (--remaining == 0)
+		{
+			Lock lock(mutex);
+			doneCond->broadcast();
+		}
+	}
+}
+
+bool WorkerPool::isPoolThread() const
+{
+	std::thread::id id = std::this_thread::get_id();
+
+	Lock lock(mutex);
+
+	if (id == callerThread)
+		return true;
+
+	return std::find(workerThreads.begin(), workerThreads.end(), id) != workerThreads.end();
+}
+
+int WorkerPool::getThreadCount() const
+{
+	return (int) workers.size();
+}
+
+WorkerPool *WorkerPool::getShared()
+{
+	// hardware_concurrency can return 0 if it doesn't know.
+	static WorkerPool pool(std::max((int) std::thread::hardware_concurrency() - 1, 0));
+	return &pool;
+}
+
+} // thread
+} // love
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_THREAD_WORKER_POOL_H
+#define LOVE_THREAD_WORKER_POOL_H
+
+// LOVE
+#include "common/config.h"
+#include "common/int.h"
+#include "threads.h"
+
+// C++
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace love
+{
+namespace thread
+{
+
+/**
+ * A persistent set of worker threads, used to split up work which can be done
+ * in parallel. The thread which hands out the work also does some of it while
+ * it waits for the rest to finish.
+ **/
+class WorkerPool
+{
+public:
+
+	WorkerPool(int numthreads);
+	~WorkerPool();
+
+	/**
+	 * Calls func(i) for every i in [0, count), spread across the pool's
+	 * threads. Returns once every call has finished. If any call throws, the
+	 * first exception is rethrown here after all calls are done.
+	 *
+	 * Calls made from inside func (or from any of the pool's threads) run
+	 * every call on the calling thread instead, since the pool is already
+	 * busy with the outer call.
+	 **/
+	void parallelFor(int count, const std::function<void(int)> &func);
+
+	/**
+	 * Returns the number of worker threads, not including the calling thread.
+	 **/
+	int getThreadCount() const;
+
+	/**
+	 * Gets a pool shared by everything in LOVE, which has one worker thread
+	 * for each CPU core except the one the calling thread is using.
+	 **/
+	static WorkerPool *getShared();
+
+private:
+
+	class Worker : public Threadable
+	{
+	public:
+
+		Worker(WorkerPool *pool);
+		virtual ~Worker() {}
+
+		// Implements Threadable.
+		void threadFunction() override;
+
+	private:
+
+		WorkerPool *pool;
+
+	}; // Worker
+
+	void runJobs();
+	bool isPoolThread() const;
+
+	std::vector<Worker *> workers;
+	std::vector<std::thread::id> workerThreads;
+
+	// The thread running the current parallelFor call, if there is one.
+	std::thread::id callerThread;
+
+	// Held for the duration of a parallelFor call.
+	MutexRef callMutex;
+
+	MutexRef mutex;
+	ConditionalRef workCond;
+	ConditionalRef doneCond;
+
+	const std::function<void(int)> *job;
+	int jobCount;
+	std::atomic<int> nextIndex;
+	std::atomic<int> remaining;
+
+	uint64 generation;
+	int activeWorkers;
+	bool stopping;
+
+	std::exception_ptr error;
+
+}; // WorkerPool
+
+} // thread
+} // love
+
+#endif // LOVE_THREAD_WORKER_POOL_H
@@ -20,6 +20,9 @@
 
 #include "wrap_Channel.h"
 
+// C++
+#include <limits>
+
 namespace love
 {
 namespace thread
@@ -94,7 +97,9 @@ int w_Channel_peek(lua_State *L)
 {
 	Channel *c = luax_checkchannel(L, 1);
 	Variant var;
-	if (c->peek(&var))
+	bool result = false;
+	luax_catchexcept(L, [&]() { result = c->peek(&var); });
+	if (result)
 		var.toLua(L);
 	else
 		lua_pushnil(L);
@@ -123,6 +128,72 @@ int w_Channel_clear(lua_State *L)
 	return 0;
 }
 
+int w_Channel_pushMany(lua_State *L)
+{
+	Channel *c = luax_checkchannel(L, 1);
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	int count = (int) luax_objlen(L, 2);
+	std::vector<Variant> vars;
+	vars.reserve(count);
+
+	luax_catchexcept(L, [&]() {
+		for (int i = 1; i <= count; i++)
+		{
+			lua_rawgeti(L, 2, i);
+			vars.push_back(Variant::fromLua(L, -1));
+			lua_pop(L, 1);
+
+			if (vars.back().getType() == Variant::UNKNOWN)
+				throw love::Exception("Value #%d: boolean, number, string, love type, or table expected", i);
+		}
+
+		uint64 id = c->pushMany(vars);
+		lua_pushnumber(L, (lua_Number) id);
+	});
+
+	return 1;
+}
+
+int w_Channel_popMany(lua_State *L)
+{
+	Channel *c = luax_checkchannel(L, 1);
+	int max = (int) luaL_optinteger(L, 2, std::numeric_limits<int>::max());
+
+	std::vector<Variant> vars;
+	c->popMany(vars, max);
+
+	lua_createtable(L, (int) vars.size(), 0);
+	for (int i = 0; i < (int) vars.size(); i++)
+	{
+		vars[i].toLua(L);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
+int w_Channel_getMode(lua_State *L)
+{
+	Channel *c = luax_checkchannel(L, 1);
+	const char *str = nullptr;
+	if (!Channel::getConstant(c->getMode(), str))
+		return luaL_error(L, "Unknown channel mode.");
+	lua_pushstring(L, str);
+	return 1;
+}
+
+int w_Channel_getCapacity(lua_State *L)
+{
+	Channel *c = luax_checkchannel(L, 1);
+	int capacity = c->getCapacity();
+	if (capacity > 0)
+		lua_pushinteger(L, capacity);
+	else
+		lua_pushnil(L);
+	return 1;
+}
+
 int w_Channel_performAtomic(lua_State *L)
 {
 	Channel *c = luax_checkchannel(L, 1);
@@ -160,6 +231,10 @@ static const luaL_Reg w_Channel_functions[] =
 	{ "getCount", w_Channel_getCount },
 	{ "hasRead", w_Channel_hasRead },
 	{ "clear", w_Channel_clear },
+	{ "pushMany", w_Channel_pushMany },
+	{ "popMany", w_Channel_popMany },
+	{ "getMode", w_Channel_getMode },
+	{ "getCapacity", w_Channel_getCapacity },
 	{ "performAtomic", w_Channel_performAtomic },
 	{ 0, 0 }
 };
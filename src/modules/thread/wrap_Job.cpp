@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_Job.h"
+#include "LuaPool.h"
+
+namespace love
+{
+namespace thread
+{
+
+Job *luax_checkjob(lua_State *L, int idx)
+{
+	return luax_checktype<Job>(L, idx);
+}
+
+int w_Job_wait(lua_State *L)
+{
+	Job *job = luax_checkjob(L, 1);
+	double timeout = luaL_optnumber(L, 2, -1.0);
+
+	luax_pushboolean(L, LuaPool::wait(L, job, timeout));
+	return 1;
+}
+
+int w_Job_isDone(lua_State *L)
+{
+	Job *job = luax_checkjob(L, 1);
+	luax_pushboolean(L, job->isDone());
+	return 1;
+}
+
+int w_Job_getResults(lua_State *L)
+{
+	Job *job = luax_checkjob(L, 1);
+	if (!job->isDone())
+		return 0;
+
+	const std::vector<Variant> &results = job->getResults();
+	luaL_checkstack(L, (int) results.size(), nullptr);
+
+	for (const Variant &v : results)
+		v.toLua(L);
+
+	return (int) results.size();
+}
+
+int w_Job_getError(lua_State *L)
+{
+	Job *job = luax_checkjob(L, 1);
+	if (!job->isDone() || job->getError().empty())
+		lua_pushnil(L);
+	else
+		luax_pushstring(L, job->getError());
+	return 1;
+}
+
+static const luaL_Reg w_Job_functions[] =
+{
+	{ "wait", w_Job_wait },
+	{ "isDone", w_Job_isDone },
+	{ "getResults", w_Job_getResults },
+	{ "getError", w_Job_getError },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_job(lua_State *L)
+{
+	return luax_register_type(L, &Job::type, w_Job_functions, nullptr);
+}
+
+} // thread
+} // love
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2006-2021 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_LuaPool.h"
+#include "wrap_Channel.h"
+
+namespace love
+{
+namespace thread
+{
+
+LuaPool *luax_checkpool(lua_State *L, int idx)
+{
+	return luax_checktype<LuaPool>(L, idx);
+}
+
+static int submitJob(lua_State *L, LuaPool *pool, Channel *channel, int startidx)
+{
+	std::vector<Variant> args;
+	int nargs = lua_gettop(L) - startidx + 1;
+
+	for (int i = 0; i < nargs; ++i)
+	{
+		luax_catchexcept(L, [&]() {
+			args.push_back(Variant::fromLua(L, startidx + i));
+		});
+
+		if (args.back().getType() == Variant::UNKNOWN)
+		{
+			args.clear();
+			return luaL_argerror(L, startidx + i, "boolean, number, string, love type, or flat table expected");
+		}
+	}
+
+	Job *job = new Job(args, channel);
+	pool->submit(L, job);
+
+	luax_pushtype(L, job);
+	job->release();
+	return 1;
+}
+
+int w_Pool_submit(lua_State *L)
+{
+	LuaPool *pool = luax_checkpool(L, 1);
+	return submitJob(L, pool, nullptr, 2);
+}
+
+int w_Pool_submitTo(lua_State *L)
+{
+	LuaPool *pool = luax_checkpool(L, 1);
+	Channel *channel = luax_checkchannel(L, 2);
+	return submitJob(L, pool, channel, 3);
+}
+
+int w_Pool_getThreadCount(lua_State *L)
+{
+	LuaPool *pool = luax_checkpool(L, 1);
+	lua_pushinteger(L, pool->getThreadCount());
+	return 1;
+}
+
+int w_Pool_getPendingJobCount(lua_State *L)
+{
+	LuaPool *pool = luax_checkpool(L, 1);
+	lua_pushinteger(L, pool->getPendingJobCount());
+	return 1;
+}
+
+static const luaL_Reg w_Pool_functions[] =
+{
+	{ "submit", w_Pool_submit },
+	{ "submitTo", w_Pool_submitTo },
+	{ "getThreadCount", w_Pool_getThreadCount },
+	{ "getPendingJobCount", w_Pool_getPendingJobCount },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_pool(lua_State *L)
+{
+	return luax_register_type(L, &LuaPool::type, w_Pool_functions, nullptr);
+}
+
+} // thread
+} // love
@@ -22,6 +22,8 @@
 #include "wrap_ThreadModule.h"
 #include "wrap_LuaThread.h"
 #include "wrap_Channel.h"
+#include "wrap_LuaPool.h"
+#include "wrap_Job.h"
 #include "ThreadModule.h"
 
 #include "filesystem/File.h"
@@ -37,10 +39,13 @@ namespace thread
 
 #define instance() (Module::getInstance<ThreadModule>(Module::M_THREAD))
 
-int w_newThread(lua_State *L)
+/**
+ * Gets the Lua code for a Thread or Pool from a filename, string of code, File,
+ * or Data at index 1. Replaces the value at index 1 with the resulting Data.
+ **/
+static love::Data *luax_checkthreadcode(lua_State *L, std::string &name)
 {
-	std::string name = "Thread code";
-	love::Data *data = nullptr;
+	name = "Thread code";
 
 	if (lua_isstring(L, 1))
 	{
@@ -68,22 +73,69 @@ int w_newThread(lua_State *L)
 	{
 		love::filesystem::FileData *fdata = luax_checktype<love::filesystem::FileData>(L, 1);
 		name = std::string("@") + fdata->getFilename();
-		data = fdata;
-	}
-	else
-	{
-		data = luax_checktype<love::Data>(L, 1);
+		return fdata;
 	}
 
+	return luax_checktype<love::Data>(L, 1);
+}
+
+int w_newThread(lua_State *L)
+{
+	std::string name;
+	love::Data *data = luax_checkthreadcode(L, name);
+
 	LuaThread *t = instance()->newThread(name, data);
 	luax_pushtype(L, t);
 	t->release();
 	return 1;
 }
 
+int w_newPool(lua_State *L)
+{
+	std::string name;
+	love::Data *data = luax_checkthreadcode(L, name);
+	int numthreads = (int) luaL_optinteger(L, 2, LuaPool::getDefaultThreadCount());
+
+	if (numthreads < 1)
+		return luaL_error(L, "A Pool must have at least one thread.");
+
+	LuaPool *p = nullptr;
+	luax_catchexcept(L, [&](){ p = instance()->newPool(name, data, numthreads); });
+
+	luax_pushtype(L, p);
+	p->release();
+	return 1;
+}
+
 int w_newChannel(lua_State *L)
 {
-	Channel *c = instance()->newChannel();
+	Channel *c = nullptr;
+
+	if (lua_istable(L, 1))
+	{
+		Channel::Mode mode = Channel::MODE_MPMC;
+
+		lua_getfield(L, 1, "mode");
+		if (!lua_isnoneornil(L, -1))
+		{
+			const char *modestr = luaL_checkstring(L, -1);
+			if (!Channel::getConstant(modestr, mode))
+				return luax_enumerror(L, "channel mode", Channel::getConstants(mode), modestr);
+		}
+		lua_pop(L, 1);
+
+		lua_getfield(L, 1, "capacity");
+		int capacity = (int) luaL_optinteger(L, -1, 0);
+		lua_pop(L, 1);
+
+		if (mode != Channel::MODE_UNBOUNDED && capacity == 0)
+			return luaL_error(L, "A capacity must be given for bounded Channels.");
+
+		luax_catchexcept(L, [&](){ c = instance()->newChannel(mode, capacity); });
+	}
+	else
+		c = instance()->newChannel();
+
 	luax_pushtype(L, c);
 	c->release();
 	return 1;
@@ -101,6 +153,7 @@ int w_getChannel(lua_State *L)
 static const luaL_Reg module_functions[] =
 {
 	{ "newThread", w_newThread },
+	{ "newPool", w_newPool },
 	{ "newChannel", w_newChannel },
 	{ "getChannel", w_getChannel },
 	{ 0, 0 }
@@ -109,6 +162,8 @@ static const luaL_Reg module_functions[] =
 static const lua_CFunction types[] = {
 	luaopen_thread,
 	luaopen_channel,
+	luaopen_pool,
+	luaopen_job,
 	0
 };
 
@@ -45,6 +45,12 @@ class Video : public Module
 	 * Create a VideoStream representing video frames
 	 **/
 	virtual VideoStream *newVideoStream(love::filesystem::File *file) = 0;
+
+	/**
+	 * Sets the number of threads used to decode VideoStreams.
+	 **/
+	virtual void setDecoderThreadCount(int count) = 0;
+	virtual int getDecoderThreadCount() const = 0;
 }; // Video
 
 } // video
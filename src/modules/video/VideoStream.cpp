@@ -19,6 +19,7 @@
  **/
 
 #include "VideoStream.h"
+#include "timer/Timer.h"
 
 using love::thread::Lock;
 
@@ -64,6 +65,12 @@ bool VideoStream::isPlaying() const
 	return frameSync->isPlaying();
 }
 
+VideoStream::Stats VideoStream::getStats() const
+{
+	Stats stats = {};
+	return stats;
+}
+
 VideoStream::Frame::Frame()
 	: yplane(nullptr)
 	, cbplane(nullptr)
@@ -95,6 +102,7 @@ double VideoStream::FrameSync::tell() const
 VideoStream::DeltaSync::DeltaSync()
 	: playing(false)
 	, position(0)
+	, positionTime(0)
 	, speed(1)
 {
 }
@@ -104,31 +112,38 @@ VideoStream::DeltaSync::~DeltaSync()
 }
 
 double VideoStream::DeltaSync::getPosition() const
-{
-	return position;
-}
-
-void VideoStream::DeltaSync::update(double dt)
 {
 	Lock l(mutex);
 	if (playing)
-		position += dt*speed;
+		return position + (love::timer::Timer::getTime() - positionTime)*speed;
+	return position;
 }
 
 void VideoStream::DeltaSync::play()
 {
-	playing = true;
+	Lock l(mutex);
+	if (!playing)
+	{
+		positionTime = love::timer::Timer::getTime();
+		playing = true;
+	}
 }
 
 void VideoStream::DeltaSync::pause()
 {
-	playing = false;
+	Lock l(mutex);
+	if (playing)
+	{
+		position = getPosition();
+		playing = false;
+	}
 }
 
 void VideoStream::DeltaSync::seek(double time)
 {
 	Lock l(mutex);
 	position = time;
+	positionTime = love::timer::Timer::getTime();
 }
 
 bool VideoStream::DeltaSync::isPlaying() const
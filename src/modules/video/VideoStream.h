@@ -23,6 +23,7 @@
 
 // LOVE
 #include "common/Stream.h"
+#include "common/int.h"
 #include "audio/Source.h"
 #include "thread/threads.h"
 
@@ -53,6 +54,16 @@ class VideoStream : public Stream
 	class FrameSync;
 	class DeltaSync;
 
+	struct Stats
+	{
+		int64 framesDecoded;
+		int64 framesDropped; // Decoded but never displayed.
+		int framesBuffered;
+		double decodeTime; // Total, in seconds.
+	};
+
+	virtual Stats getStats() const;
+
 	// The stream now owns the sync, do not reuse or free
 	virtual void setSync(FrameSync *frameSync);
 	virtual FrameSync *getSync() const;
@@ -95,7 +106,6 @@ class VideoStream : public Stream
 		~DeltaSync();
 
 		virtual double getPosition() const override;
-		virtual void update(double dt) override;
 
 		virtual void play() override;
 		virtual void pause() override;
@@ -104,7 +114,11 @@ class VideoStream : public Stream
 
 	private:
 		bool playing;
+		// Position when playback last started, was sought, or was paused.
 		double position;
+		// Time when position was set, so the current position can be worked
+		// out from the clock instead of needing regular updates.
+		double positionTime;
 		double speed;
 		love::thread::MutexRef mutex;
 	};
@@ -23,6 +23,8 @@
 
 // LOVE
 #include "TheoraVideoStream.h"
+#include "Video.h"
+#include "timer/Timer.h"
 
 using love::filesystem::File;
 
@@ -37,7 +39,11 @@ TheoraVideoStream::TheoraVideoStream(love::filesystem::File *file)
 	: demuxer(file)
 	, headerParsed(false)
 	, decoder(nullptr)
-	, frameReady(false)
+	, frontBuffer(nullptr)
+	, frontTime(0)
+	, worker(nullptr)
+	, wasPlaying(false)
+	, stats()
 	, lastFrame(0)
 	, nextFrame(0)
 {
@@ -46,8 +52,9 @@ TheoraVideoStream::TheoraVideoStream(love::filesystem::File *file)
 
 	th_info_init(&videoInfo);
 
-	frontBuffer = new Frame();
-	backBuffer = new Frame();
+	// The front buffer, plus the queued frames.
+	for (int i = 0; i < MAX_QUEUED_FRAMES + 1; i++)
+		frames.push_back(new Frame());
 
 	try
 	{
@@ -55,12 +62,15 @@ TheoraVideoStream::TheoraVideoStream(love::filesystem::File *file)
 	}
 	catch (love::Exception &ex)
 	{
-		delete backBuffer;
-		delete frontBuffer;
+		for (Frame *frame : frames)
+			delete frame;
 		th_info_clear(&videoInfo);
 		throw ex;
 	}
 
+	frontBuffer = frames[0];
+	freeFrames.assign(frames.begin() + 1, frames.end());
+
 	frameSync.set(new DeltaSync(), Acquire::NORETAIN);
 }
 
@@ -71,8 +81,8 @@ TheoraVideoStream::~TheoraVideoStream()
 
 	th_info_clear(&videoInfo);
 
-	delete frontBuffer;
-	delete backBuffer;
+	for (Frame *frame : frames)
+		delete frame;
 }
 
 int TheoraVideoStream::getWidth() const
@@ -98,8 +108,44 @@ const std::string &TheoraVideoStream::getFilename() const
 
 void TheoraVideoStream::setSync(FrameSync *frameSync)
 {
+	{
+		love::thread::Lock l(bufferMutex);
+		this->frameSync = frameSync;
+	}
+
+	wakeWorker();
+}
+
+void TheoraVideoStream::play()
+{
+	VideoStream::play();
+	wakeWorker();
+}
+
+void TheoraVideoStream::pause()
+{
+	VideoStream::pause();
+	wakeWorker();
+}
+
+void TheoraVideoStream::seek(double offset)
+{
+	VideoStream::seek(offset);
+	wakeWorker();
+}
+
+void TheoraVideoStream::setWorker(Worker *worker)
+{
+	love::thread::Lock l(bufferMutex);
+	this->worker = worker;
+}
+
+void TheoraVideoStream::wakeWorker()
+{
+	// The lock keeps the Worker from being unset while it's in use.
 	love::thread::Lock l(bufferMutex);
-	this->frameSync = frameSync;
+	if (worker != nullptr)
+		worker->wake(this);
 }
 
 const void *TheoraVideoStream::getFrontBuffer() const
@@ -162,27 +208,25 @@ void TheoraVideoStream::parseHeader()
 	decoder = th_decode_alloc(&videoInfo, setupInfo);
 	th_setup_free(setupInfo);
 
-	Frame *buffers[2] = {backBuffer, frontBuffer};
-
 	yPlaneXOffset = cPlaneXOffset = videoInfo.pic_x;
 	yPlaneYOffset = cPlaneYOffset = videoInfo.pic_y;
 
 	scaleFormat(videoInfo.pixel_fmt, cPlaneXOffset, cPlaneYOffset);
 
-	for (int i = 0; i < 2; i++)
+	for (Frame *frame : frames)
 	{
-		buffers[i]->cw = buffers[i]->yw = videoInfo.pic_width;
-		buffers[i]->ch = buffers[i]->yh = videoInfo.pic_height;
+		frame->cw = frame->yw = videoInfo.pic_width;
+		frame->ch = frame->yh = videoInfo.pic_height;
 
-		scaleFormat(videoInfo.pixel_fmt, buffers[i]->cw, buffers[i]->ch);
+		scaleFormat(videoInfo.pixel_fmt, frame->cw, frame->ch);
 
-		buffers[i]->yplane = new unsigned char[buffers[i]->yw * buffers[i]->yh];
-		buffers[i]->cbplane = new unsigned char[buffers[i]->cw * buffers[i]->ch];
-		buffers[i]->crplane = new unsigned char[buffers[i]->cw * buffers[i]->ch];
+		frame->yplane = new unsigned char[frame->yw * frame->yh];
+		frame->cbplane = new unsigned char[frame->cw * frame->ch];
+		frame->crplane = new unsigned char[frame->cw * frame->ch];
 
-		memset(buffers[i]->yplane, 16, buffers[i]->yw * buffers[i]->yh);
-		memset(buffers[i]->cbplane, 128, buffers[i]->cw * buffers[i]->ch);
-		memset(buffers[i]->crplane, 128, buffers[i]->cw * buffers[i]->ch);
+		memset(frame->yplane, 16, frame->yw * frame->yh);
+		memset(frame->cbplane, 128, frame->cw * frame->ch);
+		memset(frame->crplane, 128, frame->cw * frame->ch);
 	}
 
 	headerParsed = true;
@@ -203,26 +247,75 @@ void TheoraVideoStream::seekDecoder(double target)
 	th_decode_ctl(decoder, TH_DECCTL_SET_GRANPOS, &packet.granulepos, sizeof(packet.granulepos));
 }
 
-void TheoraVideoStream::threadedFillBackBuffer(double dt)
+static void copyPlane(unsigned char *dst, int w, int h, const th_img_plane &src, unsigned int xoffset, unsigned int yoffset)
+{
+	const unsigned char *srcdata = src.data + src.stride * yoffset + xoffset;
+
+	if (src.stride == w)
+	{
+		memcpy(dst, srcdata, w * h);
+		return;
+	}
+
+	for (int y = 0; y < h; ++y)
+		memcpy(dst + w * y, srcdata + src.stride * y, w);
+}
+
+void TheoraVideoStream::copyFrame(const th_ycbcr_buffer &bufferinfo, Frame *frame) const
+{
+	copyPlane(frame->yplane, frame->yw, frame->yh, bufferinfo[0], yPlaneXOffset, yPlaneYOffset);
+	copyPlane(frame->cbplane, frame->cw, frame->ch, bufferinfo[1], cPlaneXOffset, cPlaneYOffset);
+	copyPlane(frame->crplane, frame->cw, frame->ch, bufferinfo[2], cPlaneXOffset, cPlaneYOffset);
+}
+
+void TheoraVideoStream::threadedUpdate(double dt)
 {
+	StrongRef<FrameSync> sync;
+	{
+		love::thread::Lock l(bufferMutex);
+		sync = frameSync;
+	}
+
 	// Synchronize
-	frameSync->update(dt);
-	double position = frameSync->getPosition();
+	sync->update(dt);
+	double position = sync->getPosition();
+
+	// Seeking backwards, so the queued frames are no longer useful.
+	bool seekback = false;
+	{
+		love::thread::Lock l(bufferMutex);
+		if (position < frontTime)
+		{
+			for (const QueuedFrame &queued : queuedFrames)
+				freeFrames.push_back(queued.frame);
+			queuedFrames.clear();
+			frontTime = position;
+			seekback = true;
+		}
+	}
 
-	// Seeking backwards
-	if (position < lastFrame)
+	if (seekback)
 		seekDecoder(position);
 
+	double starttime = love::timer::Timer::getTime();
+	int decoded = 0;
+	int dropped = 0;
+
 	th_ycbcr_buffer bufferinfo;
-	bool hasFrame = false;
 
-	// Until we are at the end of the stream, or we are displaying the right frame
+	// Until we are at the end of the stream, or the frame queue is full.
 	unsigned int framesBehind = 0;
 	bool failedSeek = false;
-	while (!demuxer.isEos() && position >= nextFrame)
+	while (!demuxer.isEos())
 	{
+		{
+			love::thread::Lock l(bufferMutex);
+			if (freeFrames.empty())
+				break;
+		}
+
 		// If we can't catch up, seek
-		if (framesBehind++ > 5 && !failedSeek)
+		if (framesBehind > 5 && !failedSeek)
 		{
 			seekDecoder(position);
 			framesBehind = 0;
@@ -230,57 +323,62 @@ void TheoraVideoStream::threadedFillBackBuffer(double dt)
 		}
 
 		th_decode_ycbcr_out(decoder, bufferinfo);
-		hasFrame = true;
+		double frametime = nextFrame;
 
+		bool eos = false;
 		ogg_int64_t granulePosition;
 		do
 		{
 			if (demuxer.readPacket(packet))
-				return;
+			{
+				eos = true;
+				break;
+			}
 		} while (th_decode_packetin(decoder, &packet, &granulePosition) != 0);
+
+		if (eos)
+			break;
+
 		lastFrame = nextFrame;
 		nextFrame = th_granule_time(decoder, granulePosition);
-	}
+		decoded++;
 
-	// Only swap once, even if we read many frames to get here
-	if (hasFrame)
-	{
-		// Don't swap whilst we're writing to the backbuffer
+		// The next frame is already due, so this one would never be shown.
+		if (nextFrame <= position)
 		{
-			love::thread::Lock l(bufferMutex);
-			frameReady = false;
+			dropped++;
+			framesBehind++;
+			continue;
 		}
 
-		for (int y = 0; y < backBuffer->yh; ++y)
-		{
-			memcpy(backBuffer->yplane+backBuffer->yw*y,
-					bufferinfo[0].data+
-						bufferinfo[0].stride*(y+yPlaneYOffset)+yPlaneXOffset,
-					backBuffer->yw);
-		}
+		framesBehind = 0;
 
-		for (int y = 0; y < backBuffer->ch; ++y)
+		// Only this thread takes frames from the free list, so this can't have
+		// changed since the check above.
+		Frame *frame = nullptr;
 		{
-			memcpy(backBuffer->cbplane+backBuffer->cw*y,
-					bufferinfo[1].data+
-						bufferinfo[1].stride*(y+cPlaneYOffset)+cPlaneXOffset,
-					backBuffer->cw);
+			love::thread::Lock l(bufferMutex);
+			frame = freeFrames.back();
+			freeFrames.pop_back();
 		}
 
-		for (int y = 0; y < backBuffer->ch; ++y)
-		{
-			memcpy(backBuffer->crplane+backBuffer->cw*y,
-					bufferinfo[2].data+
-						bufferinfo[2].stride*(y+cPlaneYOffset)+cPlaneXOffset,
-					backBuffer->cw);
-		}
+		copyFrame(bufferinfo, frame);
 
-		// Re-enable swapping
 		{
 			love::thread::Lock l(bufferMutex);
-			frameReady = true;
+			queuedFrames.push_back({frame, frametime});
 		}
 	}
+
+	double decodetime = love::timer::Timer::getTime() - starttime;
+
+	{
+		love::thread::Lock l(bufferMutex);
+		stats.framesDecoded += decoded;
+		stats.framesDropped += dropped;
+		if (decoded > 0)
+			stats.decodeTime += decodetime;
+	}
 }
 
 void TheoraVideoStream::fillBackBuffer()
@@ -290,24 +388,58 @@ void TheoraVideoStream::fillBackBuffer()
 
 bool TheoraVideoStream::swapBuffers()
 {
-	if (demuxer.isEos())
-		return false;
+	bool playing = frameSync->isPlaying();
+	double position = frameSync->getPosition();
+
+	love::thread::Lock l(bufferMutex);
+
+	// The sync can be played, paused or sought without going through this
+	// stream (e.g. when it's an audio Source), so look for those here too.
+	if (playing != wasPlaying || position < frontTime)
+	{
+		wasPlaying = playing;
+		wakeWorker();
+	}
 
-	if (!frameSync->isPlaying())
+	if (!playing)
 		return false;
 
-	love::thread::Lock l(bufferMutex);
-	if (!frameReady)
+	// Show the most recent frame which is due, skipping any others.
+	Frame *next = nullptr;
+	while (!queuedFrames.empty() && queuedFrames.front().time <= position)
+	{
+		if (next != nullptr)
+		{
+			freeFrames.push_back(next);
+			stats.framesDropped++;
+		}
+
+		next = queuedFrames.front().frame;
+		frontTime = queuedFrames.front().time;
+		queuedFrames.pop_front();
+	}
+
+	if (next == nullptr)
 		return false;
-	frameReady = false;
 
-	Frame *temp = frontBuffer;
-	frontBuffer = backBuffer;
-	backBuffer = temp;
+	freeFrames.push_back(frontBuffer);
+	frontBuffer = next;
+
+	// There's room in the queue for another frame now.
+	wakeWorker();
 
 	return true;
 }
 
+VideoStream::Stats TheoraVideoStream::getStats() const
+{
+	love::thread::Lock l(bufferMutex);
+
+	Stats s = stats;
+	s.framesBuffered = (int) queuedFrames.size();
+	return s;
+}
+
 } // theora
 } // video
 } // love
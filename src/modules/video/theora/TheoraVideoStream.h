@@ -29,6 +29,10 @@
 #include "thread/threads.h"
 #include "OggDemuxer.h"
 
+// C++
+#include <deque>
+#include <vector>
+
 // OGG/Theora
 #include <ogg/ogg.h>
 #include <theora/codec.h>
@@ -41,6 +45,8 @@ namespace video
 namespace theora
 {
 
+class Worker;
+
 class TheoraVideoStream : public love::video::VideoStream
 {
 public:
@@ -57,11 +63,34 @@ class TheoraVideoStream : public love::video::VideoStream
 	const std::string &getFilename() const;
 	void setSync(FrameSync *frameSync);
 
+	void play() override;
+	void pause() override;
+	void seek(double offset) override;
 	bool isPlaying() const;
 
-	void threadedFillBackBuffer(double dt);
+	// Sets the Worker which is told when the stream needs decoding again.
+	void setWorker(Worker *worker);
+
+	Stats getStats() const override;
+
+	// Decodes frames ahead of the playback position until the frame queue is
+	// full, or the end of the stream is reached. There's nothing more to do
+	// after that until a frame is shown, the stream is sought, or playback
+	// starts or stops, and the Worker is woken when one of those happens.
+	void threadedUpdate(double dt);
+
+	// Number of decoded frames which can be queued up ahead of the one being
+	// displayed.
+	static const int MAX_QUEUED_FRAMES = 4;
 
 private:
+
+	struct QueuedFrame
+	{
+		Frame *frame;
+		double time;
+	};
+
 	OggDemuxer demuxer;
 
 	bool headerParsed;
@@ -71,21 +100,34 @@ class TheoraVideoStream : public love::video::VideoStream
 	th_info videoInfo;
 	th_dec_ctx *decoder;
 
+	// All frames, for cleanup.
+	std::vector<Frame *> frames;
+
+	// The rest are protected by bufferMutex.
 	Frame *frontBuffer;
-	Frame *backBuffer;
+	double frontTime;
+	std::deque<QueuedFrame> queuedFrames;
+	std::vector<Frame *> freeFrames;
+
 	unsigned int yPlaneXOffset;
 	unsigned int cPlaneXOffset;
 	unsigned int yPlaneYOffset;
 	unsigned int cPlaneYOffset;
 
 	love::thread::MutexRef bufferMutex;
-	bool frameReady;
+
+	Worker *worker;
+	bool wasPlaying;
+
+	Stats stats;
 
 	double lastFrame;
 	double nextFrame;
 
 	void parseHeader();
 	void seekDecoder(double target);
+	void copyFrame(const th_ycbcr_buffer &bufferinfo, Frame *frame) const;
+	void wakeWorker();
 }; // TheoraVideoStream
 
 } // theora
@@ -19,13 +19,17 @@
  **/
 
 // STL
+#include <algorithm>
+#include <limits>
+#include <thread>
 #include <vector>
 
 // LOVE
 #include "Video.h"
-#include "common/delay.h"
 #include "timer/Timer.h"
 
+#include <math.h>
+
 namespace love
 {
 namespace video
@@ -33,92 +37,234 @@ namespace video
 namespace theora
 {
 
+// Streams which are waiting to be woken are still looked at this often (in
+// seconds), so ones which are no longer used anywhere get removed.
+static const double IDLE_CHECK_INTERVAL = 1.0;
+
 Video::Video()
 {
-	workerThread = new Worker();
-	workerThread->start();
+	// hardware_concurrency can return 0 if it doesn't know.
+	int cores = (int) std::thread::hardware_concurrency();
+	worker = new Worker(std::min(std::max(cores / 2, 1), 4));
 }
 
 Video::~Video()
 {
-	delete workerThread;
+	delete worker;
 }
 
 VideoStream *Video::newVideoStream(love::filesystem::File *file)
 {
 	TheoraVideoStream *stream = new TheoraVideoStream(file);
-	workerThread->addStream(stream);
+	worker->addStream(stream);
 	return stream;
 }
 
+void Video::setDecoderThreadCount(int count)
+{
+	worker->setThreadCount(count);
+}
+
+int Video::getDecoderThreadCount() const
+{
+	return worker->getThreadCount();
+}
+
 const char *Video::getName() const
 {
 	return "love.video.theora";
 }
 
-Worker::Worker()
-	: stopping(false)
+Worker::DecodeThread::DecodeThread(Worker *worker)
+	: worker(worker)
 {
 	threadName = "VideoWorker";
 }
 
+void Worker::DecodeThread::threadFunction()
+{
+	worker->run();
+}
+
+Worker::Worker(int threadcount)
+	: stopping(false)
+{
+	startThreads(threadcount);
+}
+
 Worker::~Worker()
 {
-	stop();
+	stopThreads();
+
+	// Streams can outlive the module.
+	for (StreamEntry &entry : streams)
+		entry.stream->setWorker(nullptr);
 }
 
 void Worker::addStream(TheoraVideoStream *stream)
 {
+	// The stream locks itself and then the Worker when it wakes it, so this
+	// is done before locking the Worker.
+	stream->setWorker(this);
+
 	love::thread::Lock l(mutex);
-	streams.push_back(stream);
+
+	double now = love::timer::Timer::getTime();
+
+	StreamEntry entry;
+	entry.stream.set(stream);
+	entry.busy = false;
+	entry.woken = false;
+	entry.lastUpdate = now;
+	entry.nextUpdate = now;
+
+	streams.push_back(entry);
 	cond->broadcast();
 }
 
-void Worker::stop()
+void Worker::wake(TheoraVideoStream *stream)
 {
+	love::thread::Lock l(mutex);
+
+	for (StreamEntry &entry : streams)
 	{
-		love::thread::Lock l(mutex);
-		stopping = true;
+		if (entry.stream.get() != stream)
+			continue;
+
+		if (entry.busy)
+			entry.woken = true;
+		else
+			entry.nextUpdate = love::timer::Timer::getTime();
+
 		cond->broadcast();
+		break;
 	}
+}
+
+void Worker::setThreadCount(int count)
+{
+	if (count < 1 || count > MAX_THREADS)
+		throw love::Exception("Invalid number of video decoder threads: %d (must be between 1 and %d)", count, (int) MAX_THREADS);
 
-	owner->wait();
+	if (count == getThreadCount())
+		return;
+
+	stopThreads();
+	startThreads(count);
 }
 
-void Worker::threadFunction()
+int Worker::getThreadCount() const
 {
-	double lastFrame = love::timer::Timer::getTime();
+	return (int) threads.size();
+}
 
-	while (true)
+void Worker::startThreads(int count)
+{
 	{
-		love::sleep(2);
-
 		love::thread::Lock l(mutex);
+		stopping = false;
+	}
 
-		while (!stopping && streams.empty())
+	for (int i = 0; i < count; i++)
+	{
+		DecodeThread *thread = new DecodeThread(this);
+
+		if (!thread->start())
 		{
-			cond->wait(mutex);
-			lastFrame = love::timer::Timer::getTime();
+			thread->release();
+			break;
 		}
 
-		if (stopping)
-			return;
+		threads.push_back(thread);
+	}
+
+	if (threads.empty())
+		throw love::Exception("Could not start video decoder thread.");
+}
+
+void Worker::stopThreads()
+{
+	{
+		love::thread::Lock l(mutex);
+		stopping = true;
+		cond->broadcast();
+	}
+
+	for (DecodeThread *thread : threads)
+	{
+		thread->wait();
+		thread->release();
+	}
+
+	threads.clear();
+}
 
-		double curFrame = love::timer::Timer::getTime();
-		double dt = curFrame-lastFrame;
-		lastFrame = curFrame;
+void Worker::run()
+{
+	while (true)
+	{
+		StreamEntry *entry = nullptr;
+		double dt = 0.0;
 
-		for (auto it = streams.begin(); it != streams.end(); ++it)
 		{
-			TheoraVideoStream *stream = *it;
-			if (stream->getReferenceCount() == 1)
+			love::thread::Lock l(mutex);
+
+			while (!stopping && entry == nullptr)
 			{
-				// We're the only ones left
-				streams.erase(it);
-				break;
+				StreamEntry *next = nullptr;
+
+				for (auto it = streams.begin(); it != streams.end();)
+				{
+					if (it->busy)
+					{
+						++it;
+						continue;
+					}
+
+					// We're the only ones left
+					if (it->stream->getReferenceCount() == 1)
+					{
+						it = streams.erase(it);
+						continue;
+					}
+
+					if (next == nullptr || it->nextUpdate < next->nextUpdate)
+						next = &(*it);
+
+					++it;
+				}
+
+				double now = love::timer::Timer::getTime();
+
+				if (next == nullptr)
+					cond->wait(mutex);
+				else if (next->nextUpdate > now)
+					cond->wait(mutex, std::max((int) ceil((next->nextUpdate - now) * 1000.0), 1));
+				else
+				{
+					entry = next;
+					entry->busy = true;
+					dt = now - entry->lastUpdate;
+					entry->lastUpdate = now;
+				}
 			}
 
-			stream->threadedFillBackBuffer(dt);
+			if (stopping)
+				return;
+		}
+
+		// Decoding happens without the lock held, so other threads can work
+		// on other streams at the same time.
+		entry->stream->threadedUpdate(dt);
+
+		{
+			love::thread::Lock l(mutex);
+			double now = love::timer::Timer::getTime();
+
+			entry->busy = false;
+			entry->nextUpdate = entry->woken ? now : now + IDLE_CHECK_INTERVAL;
+			entry->woken = false;
+			cond->broadcast();
 		}
 	}
 }
@@ -22,6 +22,7 @@
 #define LOVE_VIDEO_THEORA_VIDEO_H
 
 // STL
+#include <list>
 #include <vector>
 
 // LOVE
@@ -51,26 +52,68 @@ class Video : public love::video::Video
 
 	VideoStream *newVideoStream(love::filesystem::File* file);
 
+	void setDecoderThreadCount(int count) override;
+	int getDecoderThreadCount() const override;
+
 private:
-	Worker *workerThread;
+	Worker *worker;
 }; // Video
 
-class Worker : public love::thread::Threadable
+/**
+ * Decodes video streams using a pool of threads. Each stream is updated by at
+ * most one thread at a time, and only when it's woken because it has room for
+ * more frames or its playback state changed.
+ **/
+class Worker
 {
 public:
-	Worker();
-	virtual ~Worker();
 
-	// Implements Threadable
-	void threadFunction();
+	static const int MAX_THREADS = 16;
+
+	Worker(int threadcount);
+	~Worker();
 
 	void addStream(TheoraVideoStream *stream);
-	// Frees itself!
-	void stop();
+
+	// Makes the stream be updated as soon as a thread is free.
+	void wake(TheoraVideoStream *stream);
+
+	// Waits for any in-progress updates to finish before changing the number
+	// of threads.
+	void setThreadCount(int count);
+	int getThreadCount() const;
 
 private:
 
-	std::vector<StrongRef<TheoraVideoStream>> streams;
+	class DecodeThread : public love::thread::Threadable
+	{
+	public:
+		DecodeThread(Worker *worker);
+		virtual ~DecodeThread() {}
+
+		// Implements Threadable
+		void threadFunction() override;
+
+	private:
+		Worker *worker;
+	}; // DecodeThread
+
+	struct StreamEntry
+	{
+		StrongRef<TheoraVideoStream> stream;
+		bool busy;
+		// Woken while busy, so it needs another update straight away.
+		bool woken;
+		double lastUpdate;
+		double nextUpdate;
+	};
+
+	void run();
+	void startThreads(int count);
+	void stopThreads();
+
+	std::list<StreamEntry> streams;
+	std::vector<DecodeThread *> threads;
 
 	love::thread::MutexRef mutex;
 	love::thread::ConditionalRef cond;
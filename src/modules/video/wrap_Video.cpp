@@ -51,6 +51,19 @@ int w_newVideoStream(lua_State *L)
 	return 1;
 }
 
+int w_setDecoderThreadCount(lua_State *L)
+{
+	int count = (int) luaL_checkinteger(L, 1);
+	luax_catchexcept(L, [&]() { instance()->setDecoderThreadCount(count); });
+	return 0;
+}
+
+int w_getDecoderThreadCount(lua_State *L)
+{
+	lua_pushinteger(L, instance()->getDecoderThreadCount());
+	return 1;
+}
+
 static const lua_CFunction types[] =
 {
 	luaopen_videostream,
@@ -60,6 +73,8 @@ static const lua_CFunction types[] =
 static const luaL_Reg functions[] =
 {
 	{ "newVideoStream", w_newVideoStream },
+	{ "setDecoderThreadCount", w_setDecoderThreadCount },
+	{ "getDecoderThreadCount", w_getDecoderThreadCount },
 	{ 0, 0 }
 };
 
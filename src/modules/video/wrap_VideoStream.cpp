@@ -109,6 +109,31 @@ int w_VideoStream_isPlaying(lua_State *L)
 	return 1;
 }
 
+int w_VideoStream_getStats(lua_State *L)
+{
+	auto stream = luax_checkvideostream(L, 1);
+	VideoStream::Stats stats = stream->getStats();
+
+	if (lua_istable(L, 2))
+		lua_pushvalue(L, 2);
+	else
+		lua_createtable(L, 0, 4);
+
+	lua_pushnumber(L, (lua_Number) stats.framesDecoded);
+	lua_setfield(L, -2, "framesdecoded");
+
+	lua_pushnumber(L, (lua_Number) stats.framesDropped);
+	lua_setfield(L, -2, "framesdropped");
+
+	lua_pushinteger(L, stats.framesBuffered);
+	lua_setfield(L, -2, "framesbuffered");
+
+	lua_pushnumber(L, stats.decodeTime);
+	lua_setfield(L, -2, "decodetime");
+
+	return 1;
+}
+
 static const luaL_Reg videostream_functions[] =
 {
 	{ "setSync", w_VideoStream_setSync },
@@ -119,6 +144,7 @@ static const luaL_Reg videostream_functions[] =
 	{ "rewind", w_VideoStream_rewind },
 	{ "tell", w_VideoStream_tell },
 	{ "isPlaying", w_VideoStream_isPlaying },
+	{ "getStats", w_VideoStream_getStats },
 	{ 0, 0 }
 };
 
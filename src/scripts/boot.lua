@@ -426,6 +426,7 @@ function love.init()
 		audio = {
 			mixwithsystem = true, -- Only relevant for Android / iOS.
 			mic = false, -- Only relevant for Android.
+			backend = false, -- "openal", "software" or "null". Otherwise OpenAL is tried first.
 		},
 		console = false, -- Only relevant for windows.
 		identity = false,
@@ -480,6 +481,12 @@ function love.init()
 		love._requestRecordingPermission(c.audio and c.audio.mic)
 	end
 
+	if love._setAudioBackend then
+		if c.audio and c.audio.backend then
+			love._setAudioBackend(c.audio.backend)
+		end
+	end
+
 	-- Gets desired modules.
 	for k,v in ipairs{
 		"data",